@@ -1098,6 +1098,21 @@ CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor(cp_context_t *ctx, const c
  */
 CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor_from_memory(cp_context_t *context, const char *buffer, unsigned int buffer_len, cp_status_t *error) CP_GCC_NONNULL(1, 2);
 
+/**
+ * Copies the specified plug-in information, eg. a descriptor that has
+ * been kept in parsed form by the client, into a plug-in information
+ * structure that can be installed to the specified plug-in context like
+ * one loaded using ::cp_load_plugin_descriptor. The source is not
+ * modified and is not referenced by the copy. The returned plug-in
+ * information must be released using ::cp_release_info.
+ *
+ * @param ctx the plug-in context
+ * @param info the plug-in information to be copied
+ * @param status a pointer to the location where status code is to be stored, or NULL
+ * @return pointer to the information structure or NULL if error occurs
+ */
+CP_C_API cp_plugin_info_t * cp_copy_plugin_descriptor(cp_context_t *ctx, const cp_plugin_info_t *info, cp_status_t *status) CP_GCC_NONNULL(1, 2);
+
 /**
  * Installs the plug-in described by the specified plug-in information
  * structure to the specified plug-in context. The plug-in information
@@ -1363,3 +1363,201 @@ CP_C_API cp_plugin_info_t * cp_load_plugin_descriptor_from_memory(cp_context_t *
 
 	return plugin;
 }
+
+/**
+ * Duplicates an optional string of a copied descriptor.
+ * 
+ * @param dst the location where the duplicate is stored
+ * @param src the string to be duplicated, or NULL
+ * @return non-zero on success or zero if memory allocation fails
+ */
+static int copy_str(char **dst, const char *src) {
+	*dst = NULL;
+	if (src == NULL) {
+		return 1;
+	}
+	return (*dst = strdup(src)) != NULL;
+}
+
+/**
+ * Copies a configuration element and its children. The attributes are
+ * copied into a single block like the parser does. On failure the
+ * partially copied element can be freed like a complete one.
+ * 
+ * @param dst the configuration element to be initialized
+ * @param src the configuration element to be copied
+ * @param parent the parent of the copy, or NULL for the root
+ * @return non-zero on success or zero if memory allocation fails
+ */
+static int copy_cfg_element(cp_cfg_element_t *dst, const cp_cfg_element_t *src, cp_cfg_element_t *parent) {
+	unsigned int i;
+
+	memset(dst, 0, sizeof(cp_cfg_element_t));
+	dst->parent = parent;
+	dst->index = src->index;
+	if (!copy_str(&(dst->name), src->name)
+		|| !copy_str(&(dst->value), src->value)) {
+		return 0;
+	}
+	if (src->num_atts > 0) {
+		char *attr_data;
+		size_t attr_size = 0;
+
+		for (i = 0; i < src->num_atts * 2; i++) {
+			attr_size += strlen(src->atts[i]) + 1;
+		}
+		if ((dst->atts = malloc(src->num_atts * 2 * sizeof(char *))) == NULL) {
+			return 0;
+		}
+		if ((attr_data = malloc(attr_size * sizeof(char))) == NULL) {
+			free(dst->atts);
+			dst->atts = NULL;
+			return 0;
+		}
+		for (i = 0; i < src->num_atts * 2; i++) {
+			strcpy(attr_data, src->atts[i]);
+			dst->atts[i] = attr_data;
+			attr_data += strlen(src->atts[i]) + 1;
+		}
+		dst->num_atts = src->num_atts;
+	}
+	if (src->num_children > 0) {
+		if ((dst->children = malloc(src->num_children * sizeof(cp_cfg_element_t))) == NULL) {
+			return 0;
+		}
+		for (i = 0; i < src->num_children; i++) {
+			dst->num_children = i + 1;
+			if (!copy_cfg_element(dst->children + i, src->children + i, dst)) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * Copies plug-in information. On failure the partially copied plug-in
+ * information can be freed like a complete one.
+ * 
+ * @param dst the plug-in information to be initialized
+ * @param src the plug-in information to be copied
+ * @return non-zero on success or zero if memory allocation fails
+ */
+static int copy_plugin_info(cp_plugin_info_t *dst, const cp_plugin_info_t *src) {
+	unsigned int i;
+
+	memset(dst, 0, sizeof(cp_plugin_info_t));
+	if (!copy_str(&(dst->identifier), src->identifier)
+		|| !copy_str(&(dst->name), src->name)
+		|| !copy_str(&(dst->version), src->version)
+		|| !copy_str(&(dst->provider_name), src->provider_name)
+		|| !copy_str(&(dst->plugin_path), src->plugin_path)
+		|| !copy_str(&(dst->abi_bw_compatibility), src->abi_bw_compatibility)
+		|| !copy_str(&(dst->api_bw_compatibility), src->api_bw_compatibility)
+		|| !copy_str(&(dst->req_cpluff_version), src->req_cpluff_version)
+		|| !copy_str(&(dst->runtime_lib_name), src->runtime_lib_name)
+		|| !copy_str(&(dst->runtime_funcs_symbol), src->runtime_funcs_symbol)) {
+		return 0;
+	}
+
+	if (src->num_imports > 0) {
+		if ((dst->imports = malloc(src->num_imports * sizeof(cp_plugin_import_t))) == NULL) {
+			return 0;
+		}
+		memset(dst->imports, 0, src->num_imports * sizeof(cp_plugin_import_t));
+		dst->num_imports = src->num_imports;
+		for (i = 0; i < src->num_imports; i++) {
+			dst->imports[i].optional = src->imports[i].optional;
+			if (!copy_str(&(dst->imports[i].plugin_id), src->imports[i].plugin_id)
+				|| !copy_str(&(dst->imports[i].version), src->imports[i].version)) {
+				return 0;
+			}
+		}
+	}
+
+	if (src->num_ext_points > 0) {
+		if ((dst->ext_points = malloc(src->num_ext_points * sizeof(cp_ext_point_t))) == NULL) {
+			return 0;
+		}
+		memset(dst->ext_points, 0, src->num_ext_points * sizeof(cp_ext_point_t));
+		dst->num_ext_points = src->num_ext_points;
+		for (i = 0; i < src->num_ext_points; i++) {
+			dst->ext_points[i].plugin = dst;
+			if (!copy_str(&(dst->ext_points[i].local_id), src->ext_points[i].local_id)
+				|| !copy_str(&(dst->ext_points[i].identifier), src->ext_points[i].identifier)
+				|| !copy_str(&(dst->ext_points[i].name), src->ext_points[i].name)
+				|| !copy_str(&(dst->ext_points[i].schema_path), src->ext_points[i].schema_path)) {
+				return 0;
+			}
+		}
+	}
+
+	if (src->num_extensions > 0) {
+		if ((dst->extensions = malloc(src->num_extensions * sizeof(cp_extension_t))) == NULL) {
+			return 0;
+		}
+		memset(dst->extensions, 0, src->num_extensions * sizeof(cp_extension_t));
+		dst->num_extensions = src->num_extensions;
+		for (i = 0; i < src->num_extensions; i++) {
+			cp_extension_t *extension = dst->extensions + i;
+
+			extension->plugin = dst;
+			if (!copy_str(&(extension->ext_point_id), src->extensions[i].ext_point_id)
+				|| !copy_str(&(extension->local_id), src->extensions[i].local_id)
+				|| !copy_str(&(extension->identifier), src->extensions[i].identifier)
+				|| !copy_str(&(extension->name), src->extensions[i].name)) {
+				return 0;
+			}
+			if (src->extensions[i].configuration != NULL) {
+				if ((extension->configuration = malloc(sizeof(cp_cfg_element_t))) == NULL
+					|| !copy_cfg_element(extension->configuration, src->extensions[i].configuration, NULL)) {
+					return 0;
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+CP_C_API cp_plugin_info_t * cp_copy_plugin_descriptor(cp_context_t *context, const cp_plugin_info_t *info, cp_status_t *error) {
+	cp_status_t status = CP_OK;
+	cp_plugin_info_t *plugin = NULL;
+
+	CHECK_NOT_NULL(context);
+	CHECK_NOT_NULL(info);
+	cpi_lock_context(context);
+	cpi_check_invocation(context, CPI_CF_ANY, __func__);
+	do {
+		if ((plugin = malloc(sizeof(cp_plugin_info_t))) == NULL
+			|| !copy_plugin_info(plugin, info)) {
+			status = CP_ERR_RESOURCE;
+			break;
+		}
+
+		// Increase plug-in usage count
+		if ((status = cpi_register_info(context, plugin, (void (*)(cp_context_t *, void *)) dealloc_plugin_info)) != CP_OK) {
+			break;
+		}
+	} while (0);
+
+	// Report possible errors
+	if (status != CP_OK) {
+		cpi_errorf(context,
+			N_("Insufficient system resources to copy the plug-in descriptor of %s."),
+			info->identifier != NULL ? info->identifier : "");
+	}
+	cpi_unlock_context(context);
+
+	// Release the partial copy on failure
+	if (status != CP_OK && plugin != NULL) {
+		cpi_free_plugin(plugin);
+		plugin = NULL;
+	}
+
+	// Return error code
+	if (error != NULL) {
+		*error = status;
+	}
+
+	return plugin;
+}
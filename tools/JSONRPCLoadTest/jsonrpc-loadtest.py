@@ -0,0 +1,216 @@
+#!/usr/bin/env python
+#
+#      Copyright (C) 2005-2012 Team XBMC
+#      http://www.xbmc.org
+#
+#  This Program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This Program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with XBMC; see the file COPYING.  If not, write to
+#  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+#  http://www.gnu.org/copyleft/gpl.html
+#
+
+"""
+Load test for the JSON-RPC TCP server.
+
+Opens a number of connections to a running XBMC, sends requests from all of
+them at the same time and reports the request latency percentiles. Optionally
+one extra connection keeps sending JSONRPC.NotifyAll, so every client also has
+to receive announcements while its requests are answered.
+
+  jsonrpc-loadtest.py --clients 500 --requests 20 --announce 10
+
+With --pid the memory usage of the XBMC process is reported as well, which is
+useful together with methods that return big responses:
+
+  jsonrpc-loadtest.py --clients 4 --requests 10 --pid `pidof xbmc.bin` \
+    --method VideoLibrary.GetMovies --params '{"properties": ["title", "plot"]}'
+"""
+
+import json
+import optparse
+import socket
+import sys
+import threading
+import time
+
+class Connection:
+  def __init__(self, host, port):
+    self.sock = socket.create_connection((host, port))
+    self.buffer = ""
+    self.next_id = 0
+    self.last_size = 0
+    self.reset_scan()
+
+  def call(self, method, params=None):
+    self.next_id += 1
+    request = {"jsonrpc": "2.0", "method": method, "id": self.next_id}
+    if params is not None:
+      request["params"] = params
+    self.sock.sendall(json.dumps(request).encode("utf-8"))
+
+    # skip announcements until the response arrives
+    while True:
+      message = self.read_message()
+      if message is None:
+        raise IOError("connection closed")
+      if message.get("id") == self.next_id:
+        return message
+
+  def read_message(self):
+    while True:
+      end = self.find_object_end()
+      if end > 0:
+        data, self.buffer = self.buffer[:end], self.buffer[end:]
+        self.last_size = len(data)
+        self.reset_scan()
+        return json.loads(data)
+
+      data = self.sock.recv(65536)
+      if not data:
+        return None
+      self.buffer += data.decode("utf-8")
+
+  def reset_scan(self):
+    self.scan_pos = 0
+    self.depth = 0
+    self.in_string = False
+    self.escaped = False
+
+  def find_object_end(self):
+    # continue where the last call stopped, big responses arrive in many pieces
+    for i in range(self.scan_pos, len(self.buffer)):
+      c = self.buffer[i]
+      if self.in_string:
+        if self.escaped:
+          self.escaped = False
+        elif c == "\\":
+          self.escaped = True
+        elif c == '"':
+          self.in_string = False
+      elif c == '"':
+        self.in_string = True
+      elif c in "{[":
+        self.depth += 1
+      elif c in "}]":
+        self.depth -= 1
+        if self.depth == 0:
+          return i + 1
+    self.scan_pos = len(self.buffer)
+    return 0
+
+  def close(self):
+    self.sock.close()
+
+def run_client(connection, options, start, latencies, sizes, errors):
+  start.wait()
+  try:
+    for i in range(options.requests):
+      begin = time.time()
+      response = connection.call(options.method, options.params)
+      latencies.append(time.time() - begin)
+      sizes.append(connection.last_size)
+      if "error" in response:
+        errors.append(json.dumps(response["error"]))
+  except Exception as e:
+    errors.append(str(e))
+
+def read_memory(pid):
+  # peak and current resident set size in kB
+  memory = {}
+  try:
+    for line in open("/proc/%d/status" % pid):
+      key, value = line.split(":", 1)
+      if key in ("VmHWM", "VmRSS"):
+        memory[key] = int(value.split()[0])
+  except (IOError, ValueError):
+    pass
+  return memory
+
+def run_announcer(connection, options, done):
+  while not done.is_set():
+    connection.call("JSONRPC.NotifyAll", {"sender": "loadtest", "message": "ping"})
+    time.sleep(1.0 / options.announce)
+
+def percentile(values, p):
+  if not values:
+    return 0.0
+  index = min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))
+  return values[index]
+
+def main():
+  parser = optparse.OptionParser()
+  parser.add_option("--host", default="127.0.0.1", help="host XBMC runs on [%default]")
+  parser.add_option("--port", type="int", default=9090, help="JSON-RPC TCP port [%default]")
+  parser.add_option("--clients", type="int", default=200, help="number of connections [%default]")
+  parser.add_option("--requests", type="int", default=50, help="requests per connection [%default]")
+  parser.add_option("--method", default="JSONRPC.Ping", help="method to call [%default]")
+  parser.add_option("--params", default=None, help="parameters of the method as JSON")
+  parser.add_option("--announce", type="float", default=0, help="announcements per second to trigger while testing [%default]")
+  parser.add_option("--pid", type="int", default=0, help="process ID of XBMC, to report its memory usage")
+  options, args = parser.parse_args()
+
+  if options.params is not None:
+    options.params = json.loads(options.params)
+
+  connections = []
+  for i in range(options.clients):
+    connections.append(Connection(options.host, options.port))
+
+  start = threading.Event()
+  done = threading.Event()
+  latencies = []
+  sizes = []
+  errors = []
+
+  threads = []
+  for connection in connections:
+    thread = threading.Thread(target=run_client, args=(connection, options, start, latencies, sizes, errors))
+    thread.start()
+    threads.append(thread)
+
+  announcer = None
+  if options.announce > 0:
+    announcer = threading.Thread(target=run_announcer, args=(Connection(options.host, options.port), options, done))
+    announcer.daemon = True
+    announcer.start()
+
+  memory_before = read_memory(options.pid) if options.pid else {}
+
+  begin = time.time()
+  start.set()
+  for thread in threads:
+    thread.join()
+  duration = time.time() - begin
+  done.set()
+
+  for connection in connections:
+    connection.close()
+
+  latencies.sort()
+  print("%d clients, %d requests in %.2f s (%.0f requests/s), %d errors" %
+      (options.clients, len(latencies), duration, len(latencies) / max(duration, 0.001), len(errors)))
+  for p in (50, 90, 99, 100):
+    print("  p%-3d %8.2f ms" % (p, percentile(latencies, p) * 1000))
+  if sizes:
+    print("  response size %d bytes average, %d bytes max" % (sum(sizes) / len(sizes), max(sizes)))
+  if options.pid:
+    memory_after = read_memory(options.pid)
+    for key in ("VmRSS", "VmHWM"):
+      print("  %s %8d kB -> %8d kB" % (key, memory_before.get(key, 0), memory_after.get(key, 0)))
+  for error in errors[:5]:
+    print("  error: %s" % error)
+
+  return 1 if errors else 0
+
+if __name__ == "__main__":
+  sys.exit(main())
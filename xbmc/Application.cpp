@@ -55,10 +55,12 @@
 #include "utils/LCDFactory.h"
 #endif
 #include "guilib/GUIControlProfiler.h"
+#include "guilib/RenderScheduler.h"
 #include "utils/LangCodeExpander.h"
 #include "GUIInfoManager.h"
 #include "playlists/PlayListFactory.h"
 #include "guilib/GUIFontManager.h"
+#include "guilib/GUITextLayoutCache.h"
 #include "guilib/GUIColorManager.h"
 #include "guilib/GUITextLayout.h"
 #include "addons/Skin.h"
@@ -326,6 +328,7 @@
 #include "utils/SaveFileStateJob.h"
 #include "utils/AlarmClock.h"
 #include "utils/StringUtils.h"
+#include "utils/StartupTimeline.h"
 
 #ifdef _LINUX
 #include "XHandle.h"
@@ -366,6 +369,84 @@ using namespace XbmcThreads;
 
 #define MAX_FFWD_SPEED 5
 
+/*!
+ \brief A step of the startup that doesn't depend on the steps running next to it.
+
+ The step runs on the job pool while the application thread continues, Wait()
+ blocks until it is done and returns whether it succeeded.
+ */
+class CStartupJob : public CJob
+{
+public:
+  class CResult
+  {
+  public:
+    CResult() : m_succeeded(false) {}
+    bool Wait() { m_done.Wait(); return m_succeeded; }
+
+  private:
+    friend class CStartupJob;
+    CEvent m_done;
+    bool   m_succeeded;
+  };
+
+  CStartupJob(const char *name, CResult &result) : m_name(name), m_result(result) {}
+  virtual ~CStartupJob() {}
+  virtual const char *GetType() const { return "startup"; }
+
+  virtual bool DoWork()
+  {
+    bool succeeded;
+    {
+      CStartupPhase phase(m_name);
+      succeeded = Run();
+    }
+    // the result lives with the waiter, it can't be touched once the event is set
+    m_result.m_succeeded = succeeded;
+    m_result.m_done.Set();
+    return succeeded;
+  }
+
+protected:
+  virtual bool Run() = 0;
+
+private:
+  const char *m_name;
+  CResult    &m_result;
+};
+
+class CLoadLanguageJob : public CStartupJob
+{
+public:
+  CLoadLanguageJob(const CStdString &language, CResult &result)
+    : CStartupJob("load language strings", result), m_language(language) {}
+
+protected:
+  virtual bool Run()
+  {
+    CStdString strLanguagePath = "special://xbmc/language/";
+
+    CLog::Log(LOGINFO, "load %s language file, from path: %s", m_language.c_str(), strLanguagePath.c_str());
+    return g_localizeStrings.Load(strLanguagePath, m_language);
+  }
+
+private:
+  CStdString m_language;
+};
+
+class CAddonMgrInitJob : public CStartupJob
+{
+public:
+  CAddonMgrInitJob(CResult &result) : CStartupJob("init addon manager", result) {}
+
+protected:
+  virtual bool Run()
+  {
+    // currently bails out if either cpluff Dll is unavailable or system dir can not be scanned
+    return CAddonMgr::Get().Init();
+  }
+};
+
 //extern IDirectSoundRenderer* m_pAudioDecoder;
 CApplication::CApplication(void)
   : m_pPlayer(NULL)
@@ -421,10 +502,14 @@ CApplication::CApplication(void)
   m_frameCount = 0;
 
   m_bPresentFrame = false;
+  m_bRenderIdle = false;
+  m_bProcessGUI = true;
+  m_lastGUIProcessTime = 0;
   m_bPlatformDirectories = true;
 
   m_bStandalone = false;
   m_bEnableLegacyRes = false;
+  m_bStartupBenchmark = false;
   m_bSystemScreenSaverEnable = false;
   m_pInertialScrollingHandler = new CInertialScrollingHandler();
 #ifdef HAS_DVD_DRIVE
@@ -465,6 +550,8 @@ CApplication::~CApplication(void)
 
 bool CApplication::OnEvent(XBMC_Event& newEvent)
 {
+  g_renderScheduler.Wake();
+
   switch(newEvent.type)
   {
     case XBMC_QUIT:
@@ -718,27 +805,33 @@ bool CApplication::Create()
   // Initialize core peripheral port support. Note: If these parameters
   // are 0 and NULL, respectively, then the default number and types of
   // controllers will be initialized.
+  CStartupPhase windowSystemPhase("init window system");
   if (!g_Windowing.InitWindowSystem())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Unable to init windowing system");
     return false;
   }
+  windowSystemPhase.End();
 
   g_powerManager.Initialize();
 
   // Load the AudioEngine before settings as they need to query the engine
+  CStartupPhase loadEnginePhase("load audio engine");
   if (!CAEFactory::LoadEngine())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Failed to load an AudioEngine");
     FatalErrorHandler(true, true, true);
   }
+  loadEnginePhase.End();
 
   CLog::Log(LOGNOTICE, "load settings...");
 
+  CStartupPhase settingsPhase("load settings");
   g_guiSettings.Initialize();  // Initialize default Settings - don't move
   g_powerManager.SetDefaults();
   if (!g_settings.Load())
     FatalErrorHandler(true, true, true);
+  settingsPhase.End();
 
   CLog::Log(LOGINFO, "creating subdirectories");
   CLog::Log(LOGINFO, "userdata folder: %s", g_settings.GetProfileUserDataFolder().c_str());
@@ -753,23 +846,30 @@ bool CApplication::Create()
   // initialize our charset converter
   g_charsetConverter.reset();
 
-  // Load the langinfo to have user charset <-> utf-8 conversion
   CStdString strLanguage = g_guiSettings.GetString("locale.language");
   strLanguage[0] = toupper(strLanguage[0]);
 
+  // Load the langinfo to have user charset <-> utf-8 conversion. The charset converter
+  // reads it, so it has to be in place before anything else runs next to the startup
+  CStartupPhase langInfoPhase("load language info");
   CStdString strLangInfoPath;
   strLangInfoPath.Format("special://xbmc/language/%s/langinfo.xml", strLanguage.c_str());
-
   CLog::Log(LOGINFO, "load language info file: %s", strLangInfoPath.c_str());
   g_langInfo.Load(strLangInfoPath);
+  langInfoPhase.End();
 
-  CStdString strLanguagePath = "special://xbmc/language/";
+  // the strings and the addons don't depend on each other, load them on the job pool.
+  // The AudioEngine names its devices with localized strings so it has to wait for the
+  // strings, everything after it may use addons.
+  CStartupJob::CResult languageLoaded, addonsLoaded;
+  CJobManager::GetInstance().AddJob(new CLoadLanguageJob(strLanguage, languageLoaded), NULL, CJob::PRIORITY_HIGH);
+  CJobManager::GetInstance().AddJob(new CAddonMgrInitJob(addonsLoaded), NULL, CJob::PRIORITY_HIGH);
 
-  CLog::Log(LOGINFO, "load %s language file, from path: %s", strLanguage.c_str(), strLanguagePath.c_str());
-  if (!g_localizeStrings.Load(strLanguagePath, strLanguage))
+  if (!languageLoaded.Wait())
     FatalErrorHandler(false, false, true);
 
   // start the AudioEngine
+  CStartupPhase audioPhase("start audio engine");
   if (!CAEFactory::StartEngine())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Failed to start the AudioEngine");
@@ -780,16 +880,18 @@ bool CApplication::Create()
   SetHardwareVolume(g_settings.m_fVolumeLevel);
   CAEFactory::AE->SetMute     (g_settings.m_bMute);
   CAEFactory::AE->SetSoundMode(g_guiSettings.GetInt("audiooutput.guisoundmode"));
+  audioPhase.End();
 
   // start-up Addons Framework
-  // currently bails out if either cpluff Dll is unavailable or system dir can not be scanned
-  if (!CAddonMgr::Get().Init())
+  if (!addonsLoaded.Wait())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Unable to start CAddonMgr");
     FatalErrorHandler(true, true, true);
   }
 
+  CStartupPhase peripheralsPhase("init peripherals");
   g_peripherals.Initialise();
+  peripheralsPhase.End();
 
   // Create the Mouse, Keyboard, Remote, and Joystick devices
   // Initialize after loading settings to get joystick deadzone setting
@@ -826,6 +928,7 @@ bool CApplication::Create()
   // force initial window creation to be windowed, if fullscreen, it will switch to it below
   // fixes the white screen of death if starting fullscreen and switching to windowed.
   bool bFullScreen = false;
+  CStartupPhase windowPhase("create window");
   if (!g_Windowing.CreateNewWindow("XBMC", bFullScreen, g_settings.m_ResInfo[RES_WINDOW], OnEvent))
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Unable to create window");
@@ -833,6 +936,7 @@ bool CApplication::Create()
   }
 #else
   bool bFullScreen = g_guiSettings.m_LookAndFeelResolution != RES_WINDOW;
+  CStartupPhase windowPhase("create window");
   if (!g_Windowing.CreateNewWindow("XBMC", bFullScreen, g_settings.m_ResInfo[g_guiSettings.m_LookAndFeelResolution], OnEvent))
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Unable to create window");
@@ -845,6 +949,7 @@ bool CApplication::Create()
     CLog::Log(LOGFATAL, "CApplication::Create: Unable to init rendering system");
     return false;
   }
+  windowPhase.End();
 
   // set GUI res and force the clear of the screen
   g_graphicsContext.SetVideoResolution(g_guiSettings.m_LookAndFeelResolution);
@@ -867,8 +972,10 @@ bool CApplication::Create()
 
   // The key mappings may already have been loaded by a peripheral
   CLog::Log(LOGINFO, "load keymapping");
+  CStartupPhase keymapPhase("load keymap");
   if (!CButtonTranslator::GetInstance().Load())
       FatalErrorHandler(false, false, true);
+  keymapPhase.End();
 
   int iResolution = g_graphicsContext.GetVideoResolution();
   CLog::Log(LOGINFO, "GUI format %ix%i %s",
@@ -1161,7 +1268,9 @@ bool CApplication::Initialize()
 #endif
 #endif
 
+  CStartupPhase servicesPhase("start services");
   StartServices();
+  servicesPhase.End();
 
   // Init DPMS, before creating the corresponding setting control.
   m_dpms = new DPMSSupport();
@@ -1281,14 +1390,18 @@ bool CApplication::Initialize()
   /* window id's 3000 - 3100 are reserved for python */
 
   // Make sure we have at least the default skin
+  CStartupPhase skinPhase("load skin");
   if (!LoadSkin(g_guiSettings.GetString("lookandfeel.skin")) && !LoadSkin(DEFAULT_SKIN))
   {
       CLog::Log(LOGERROR, "Default skin '%s' not found! Terminating..", DEFAULT_SKIN);
       FatalErrorHandler(true, true, true);
   }
+  skinPhase.End();
 
+  CStartupPhase pvrPhase("start epg and pvr");
   StartEPGManager();
   StartPVRManager();
+  pvrPhase.End();
 
   if (g_advancedSettings.m_splashImage)
     SAFE_DELETE(m_splash);
@@ -2097,6 +2210,7 @@ void CApplication::NewFrame()
   }
 
   m_frameCond.notifyAll();
+  g_renderScheduler.Wake();
 }
 
 void CApplication::Render()
@@ -2112,6 +2226,18 @@ void CApplication::Render()
     return;
   }
 
+  if (!m_bProcessGUI)
+  {
+    // idle, only input was polled. Poll again at 25 fps unless something wakes us earlier
+    unsigned int frameTime = XbmcThreads::SystemClockMillis() - m_lastFrameTime;
+    g_renderScheduler.FrameDone(frameTime, false, true);
+    if (frameTime < 40)
+      g_renderScheduler.Wait(40 - frameTime);
+    m_lastFrameTime = XbmcThreads::SystemClockMillis();
+    CTimeUtils::UpdateFrameTime(false);
+    return;
+  }
+
   MEASURE_FUNCTION;
 
   int vsync_mode = g_guiSettings.GetInt("videoscreen.vsync");
@@ -2119,6 +2245,7 @@ void CApplication::Render()
   bool decrement = false;
   bool hasRendered = false;
   bool limitFrames = false;
+  bool waitForEvents = false;
   unsigned int singleFrameTime = 10; // default limit 100 fps
 
   {
@@ -2155,10 +2282,14 @@ void CApplication::Render()
         if (extPlayerActive)
         {
           ResetScreenSaver();  // Prevent screensaver dimming the screen
-          singleFrameTime = 1000;  // 1 fps, high wakeup latency but v.low CPU usage
+          singleFrameTime = 1000;  // 1 fps, v.low CPU usage, input wakes us up
+          waitForEvents = true;
         }
         else if (lowfps)
-          singleFrameTime = 200;  // 5 fps, <=200 ms latency to wake up
+        {
+          singleFrameTime = 200;  // 5 fps, input wakes us up
+          waitForEvents = true;
+        }
       }
 
       decrement = true;
@@ -2204,15 +2335,30 @@ void CApplication::Render()
   else
     flip = true;
 
+  unsigned int frameTime = now - m_lastFrameTime;
+  g_renderScheduler.FrameDone(frameTime, true, m_bRenderIdle);
+  g_fontManager.FrameDone();
+  g_textLayoutCache.FrameDone();
+
+  // when not flipping, the render loop goes idle until the render scheduler wakes it
+  m_bRenderIdle = !flip;
+
   //fps limiter, make sure each frame lasts at least singleFrameTime milliseconds
   if (limitFrames || !flip)
   {
     if (!limitFrames)
+    {
       singleFrameTime = 40; //if not flipping, loop at 25 fps
+      waitForEvents = true;
+    }
 
-    unsigned int frameTime = now - m_lastFrameTime;
     if (frameTime < singleFrameTime)
-      Sleep(singleFrameTime - frameTime);
+    {
+      if (waitForEvents)
+        g_renderScheduler.Wait(singleFrameTime - frameTime);
+      else
+        Sleep(singleFrameTime - frameTime);
+    }
   }
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
 
@@ -2220,6 +2366,11 @@ void CApplication::Render()
     g_graphicsContext.Flip(dirtyRegions);
   CTimeUtils::UpdateFrameTime(flip);
 
+  // the startup is done once the first window after the startup animation is on screen
+  if (flip && CStartupTimeline::Get().IsRecording() && !m_bInitializing &&
+      g_windowManager.GetActiveWindow() != WINDOW_STARTUP_ANIM)
+    OnStartupDone();
+
   g_renderManager.UpdateResolution();
   g_renderManager.ManageCaptures();
 
@@ -2231,6 +2382,16 @@ void CApplication::Render()
   m_frameCond.notifyAll();
 }
 
+void CApplication::OnStartupDone()
+{
+  double elapsed = CStartupTimeline::Get().Finish();
+  if (m_bStartupBenchmark)
+  {
+    printf("Startup took %.1f ms, the timeline is in the log and in special://temp/xbmc-startup.json\n", elapsed);
+    getApplicationMessenger().Quit();
+  }
+}
+
 void CApplication::SetStandAlone(bool value)
 {
   g_advancedSettings.m_handleMounting = m_bStandalone = value;
@@ -2427,6 +2588,8 @@ bool CApplication::OnAppCommand(const CAction &action)
 
 bool CApplication::OnAction(const CAction &action)
 {
+  g_renderScheduler.Wake();
+
 #ifdef HAS_HTTPAPI
   // Let's tell the outside world about this action, ignoring mouse moves
   if (g_settings.m_HttpApiBroadcastLevel>=2 && action.GetID() != ACTION_MOUSE_MOVE)
@@ -2813,6 +2976,16 @@ void CApplication::FrameMove(bool processEvents)
     ProcessPeripherals(frameTime);
     m_pInertialScrollingHandler->ProcessInertialScroll(frameTime);
   }
+
+  // once nothing is drawn anymore, only process the GUI when something asks for it
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  bool pending = g_renderScheduler.TakePending(now);
+  m_bProcessGUI = !m_bRenderIdle || pending ||
+                  now - m_lastGUIProcessTime >= (unsigned int)g_advancedSettings.m_guiIdleRefreshInterval;
+  if (!m_bProcessGUI)
+    return;
+  m_lastGUIProcessTime = now;
+
   if (!m_bStop)
     g_windowManager.Process(CTimeUtils::GetFrameTime());
   g_windowManager.FrameMove();
@@ -3450,6 +3623,9 @@ void CApplication::Stop(int exitCode)
     StopServices();
     //Sleep(5000);
 
+    CLog::Log(LOGNOTICE, "stop announcements");
+    CAnnouncementManager::Deinitialize();
+
 #ifdef HAS_WEB_SERVER
   CWebServer::UnregisterRequestHandler(&m_httpImageHandler);
   CWebServer::UnregisterRequestHandler(&m_httpVfsHandler);
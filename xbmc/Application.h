@@ -334,6 +334,13 @@ public:
     return m_bTestMode;
   }
 
+  /*! \brief Quit as soon as the first window is on screen, after reporting the startup timeline
+   */
+  void SetStartupBenchmark(bool value)
+  {
+    m_bStartupBenchmark = value;
+  }
+
   bool IsPresentFrame();
 
   void Minimize();
@@ -395,10 +402,14 @@ protected:
   bool m_bPresentFrame;
   unsigned int m_lastFrameTime;
   unsigned int m_lastRenderTime;
+  bool m_bRenderIdle;                 // nothing was drawn, the GUI is only processed when the render scheduler asks for it
+  bool m_bProcessGUI;                 // whether the GUI is processed and drawn this frame
+  unsigned int m_lastGUIProcessTime;
 
   bool m_bStandalone;
   bool m_bEnableLegacyRes;
   bool m_bTestMode;
+  bool m_bStartupBenchmark;
   bool m_bSystemScreenSaverEnable;
   
   int        m_frameCount;
@@ -414,6 +425,7 @@ protected:
   void SetHardwareVolume(float hardwareVolume);
   void UpdateLCD();
   void FatalErrorHandler(bool WindowSystemInitialized, bool MapDrives, bool InitNetwork);
+  void OnStartupDone();
 
   bool PlayStack(const CFileItem& item, bool bRestart);
   bool SwitchToFullScreen();
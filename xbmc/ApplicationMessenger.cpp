@@ -35,6 +35,7 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "guilib/GUIWindowManager.h"
+#include "guilib/RenderScheduler.h"
 #include "settings/Settings.h"
 #include "settings/GUISettings.h"
 #include "FileItem.h"
@@ -171,6 +172,7 @@ void CApplicationMessenger::SendMessage(ThreadMessage& message, bool wait)
     m_vecWindowMessages.push(msg);
   else
     m_vecMessages.push(msg);
+  g_renderScheduler.Wake();
   lock.Leave();  // this releases the lock on the vec of messages and
                  //   allows the ProcessMessage to execute and therefore
                  //   delete the message itself. Therefore any accesss
@@ -69,6 +69,10 @@
 #include "music/dialogs/GUIDialogMusicInfo.h"
 #include "storage/MediaManager.h"
 #include "utils/TimeUtils.h"
+#include "threads/SystemClock.h"
+#include "guilib/RenderScheduler.h"
+#include "guilib/GUIFontManager.h"
+#include "guilib/GUITextLayoutCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 
@@ -240,6 +244,16 @@ const infomap system_labels[] =  {{ "hasnetwork",       SYSTEM_ETHERNET_LINK_ACT
                                   { "buildversion",     SYSTEM_BUILD_VERSION },
                                   { "builddate",        SYSTEM_BUILD_DATE },
                                   { "fps",              SYSTEM_FPS },
+                                  { "frametime",        SYSTEM_FRAMETIME },
+                                  { "renderwakeups",    SYSTEM_RENDER_WAKEUPS },
+                                  { "glyphsperframe",   SYSTEM_GLYPHS_PER_FRAME },
+                                  { "prewarmedglyphs",  SYSTEM_PREWARMED_GLYPHS },
+                                  { "textlayouthitrate", SYSTEM_TEXTLAYOUT_HITRATE },
+                                  { "textlayouttime",   SYSTEM_TEXTLAYOUT_TIME },
+                                  { "dirtyregions",     SYSTEM_DIRTY_REGIONS },
+                                  { "renderpasses",     SYSTEM_RENDER_PASSES },
+                                  { "redrawnpixels",    SYSTEM_REDRAWN_PIXELS },
+                                  { "dirtyregiontime",  SYSTEM_DIRTY_REGION_TIME },
                                   { "dvdtraystate",     SYSTEM_DVD_TRAY_STATE },
                                   { "freememory",       SYSTEM_FREE_MEMORY },
                                   { "language",         SYSTEM_LANGUAGE },
@@ -1286,6 +1300,36 @@ CStdString CGUIInfoManager::GetLabel(int info, int contextWindow, CStdString *fa
   case SYSTEM_FPS:
     strLabel.Format("%02.2f", m_fps);
     break;
+  case SYSTEM_FRAMETIME:
+    strLabel.Format("%02.2f", g_renderScheduler.GetFrameTime());
+    break;
+  case SYSTEM_RENDER_WAKEUPS:
+    strLabel.Format("%02.2f", g_renderScheduler.GetWakeupsPerSecond());
+    break;
+  case SYSTEM_GLYPHS_PER_FRAME:
+    strLabel.Format("%u", g_fontManager.GetPeakGlyphsPerFrame());
+    break;
+  case SYSTEM_PREWARMED_GLYPHS:
+    strLabel.Format("%u", g_fontManager.GetPrewarmedGlyphsPerSecond());
+    break;
+  case SYSTEM_TEXTLAYOUT_HITRATE:
+    strLabel.Format("%02.2f", g_textLayoutCache.GetHitRate());
+    break;
+  case SYSTEM_TEXTLAYOUT_TIME:
+    strLabel.Format("%02.2f", g_textLayoutCache.GetLayoutTime());
+    break;
+  case SYSTEM_DIRTY_REGIONS:
+    strLabel.Format("%02.2f", g_windowManager.GetDirtyRegionStats().regions);
+    break;
+  case SYSTEM_RENDER_PASSES:
+    strLabel.Format("%02.2f", g_windowManager.GetDirtyRegionStats().passes);
+    break;
+  case SYSTEM_REDRAWN_PIXELS:
+    strLabel.Format("%.0f", g_windowManager.GetDirtyRegionStats().pixels);
+    break;
+  case SYSTEM_DIRTY_REGION_TIME:
+    strLabel.Format("%02.3f", g_windowManager.GetDirtyRegionStats().solveTime);
+    break;
   case PLAYER_VOLUME:
     strLabel.Format("%2.1f dB", CAEUtil::PercentToGain(g_settings.m_fVolumeLevel));
     break;
@@ -3105,6 +3149,8 @@ CStdString CGUIInfoManager::GetDate(bool bNumbersOnly)
 
 CStdString CGUIInfoManager::GetTime(TIME_FORMAT format) const
 {
+  bool seconds = format == TIME_FORMAT_SS || format == TIME_FORMAT_MM_SS || format == TIME_FORMAT_HH_MM_SS || format == TIME_FORMAT_H_MM_SS;
+  g_renderScheduler.ScheduleClockTick(seconds);
   CDateTime time=CDateTime::GetCurrentDateTime();
   return LocalizeTime(time, format);
 }
@@ -3750,10 +3796,21 @@ CStdString CGUIInfoManager::GetCurrentPlayTime(TIME_FORMAT format) const
   if (format == TIME_FORMAT_GUESS && GetTotalPlayTime() >= 3600)
     format = TIME_FORMAT_HH_MM_SS;
   if (g_application.IsPlayingAudio() || g_application.IsPlayingVideo())
-    return StringUtils::SecondsToTimeString((int)(GetPlayTime()/1000), format);
+  {
+    int64_t playTime = GetPlayTime();
+    ScheduleNextPlayTimeSecond(playTime);
+    return StringUtils::SecondsToTimeString((int)(playTime/1000), format);
+  }
   return "";
 }
 
+void CGUIInfoManager::ScheduleNextPlayTimeSecond(int64_t playTime) const
+{
+  // make sure the time is updated when the next second has played
+  if (!g_application.IsPaused())
+    g_renderScheduler.ScheduleWakeup(XbmcThreads::SystemClockMillis() + 1000 - (unsigned int)(playTime % 1000));
+}
+
 int CGUIInfoManager::GetTotalPlayTime() const
 {
   int iTotalTime = (int)g_application.GetTotalTime();
@@ -3772,7 +3829,10 @@ CStdString CGUIInfoManager::GetCurrentPlayTimeRemaining(TIME_FORMAT format) cons
     format = TIME_FORMAT_HH_MM_SS;
   int timeRemaining = GetPlayTimeRemaining();
   if (timeRemaining && (g_application.IsPlayingAudio() || g_application.IsPlayingVideo()))
+  {
+    ScheduleNextPlayTimeSecond(GetPlayTime());
     return StringUtils::SecondsToTimeString(timeRemaining, format);
+  }
   return "";
 }
 
@@ -129,17 +129,22 @@ namespace INFO
 #define SYSTEM_BUILD_DATE           121
 #define SYSTEM_ETHERNET_LINK_ACTIVE 122
 #define SYSTEM_FPS                  123
+#define SYSTEM_FRAMETIME            124
 #define SYSTEM_ALWAYS_TRUE          125   // useful for <visible fade="10" start="hidden">true</visible>, to fade in a control
 #define SYSTEM_ALWAYS_FALSE         126   // used for <visible fade="10">false</visible>, to fade out a control (ie not particularly useful!)
 #define SYSTEM_MEDIA_DVD            127
 #define SYSTEM_DVDREADY             128
 #define SYSTEM_HAS_ALARM            129
+#define SYSTEM_RENDER_WAKEUPS       130
+#define SYSTEM_GLYPHS_PER_FRAME     131
 #define SYSTEM_SCREEN_MODE          132
 #define SYSTEM_SCREEN_WIDTH         133
 #define SYSTEM_SCREEN_HEIGHT        134
 #define SYSTEM_CURRENT_WINDOW       135
 #define SYSTEM_CURRENT_CONTROL      136
+#define SYSTEM_PREWARMED_GLYPHS     137
 #define SYSTEM_DVD_LABEL            138
+#define SYSTEM_TEXTLAYOUT_HITRATE   139
 #define SYSTEM_HASLOCKS             140
 #define SYSTEM_ISMASTER             141
 #define SYSTEM_TRAYOPEN             142
@@ -149,11 +154,13 @@ namespace INFO
 #define SYSTEM_PROFILENAME          146
 #define SYSTEM_PROFILETHUMB         147
 #define SYSTEM_HAS_LOGINSCREEN      148
+#define SYSTEM_TEXTLAYOUT_TIME      149
 #define SYSTEM_HDD_SMART            150
 #define SYSTEM_HDD_TEMPERATURE      151
 #define SYSTEM_HDD_MODEL            152
 #define SYSTEM_HDD_SERIAL           153
 #define SYSTEM_HDD_FIRMWARE         154
+#define SYSTEM_DIRTY_REGIONS        155
 #define SYSTEM_HDD_PASSWORD         156
 #define SYSTEM_HDD_LOCKSTATE        157
 #define SYSTEM_HDD_LOCKKEY          158
@@ -165,6 +172,9 @@ namespace INFO
 #define LCD_HDD_TEMPERATURE         164
 #define LCD_FAN_SPEED               165
 #define LCD_DATE                    166
+#define SYSTEM_RENDER_PASSES        167
+#define SYSTEM_REDRAWN_PIXELS       168
+#define SYSTEM_DIRTY_REGION_TIME    169
 #define LCD_TIME_21                 172 // Small bigfont
 #define LCD_TIME_22                 173
 #define LCD_TIME_W21                174 // Medum bigfont
@@ -866,6 +876,11 @@ protected:
   TIME_FORMAT TranslateTimeFormat(const CStdString &format);
   bool GetItemBool(const CGUIListItem *item, int condition) const;
 
+  /*! \brief Wake the render loop when the play time reaches the next second
+   \param playTime the current play time in ms
+   */
+  void ScheduleNextPlayTimeSecond(int64_t playTime) const;
+
   /*! \brief Split an info string into it's constituent parts and parameters
    Format is:
      
@@ -38,6 +38,9 @@
 #include "PlayListPlayer.h"
 #include "guilib/LocalizeStrings.h"
 #include "guilib/GUIWindowManager.h"
+#include "guilib/RenderScheduler.h"
+#include "guilib/GUIWindowCache.h"
+#include "guilib/GUITextLayoutCache.h"
 #ifdef HAS_PYTHON
 #include "interfaces/python/XBPython.h"
 #endif
@@ -52,6 +55,9 @@
   CLocalizeStrings   g_localizeStringsTemp;
 
   CGUIWindowManager  g_windowManager;
+  CRenderScheduler   g_renderScheduler;
+  CGUIWindowCache    g_windowCache;
+  CGUITextLayoutCache g_textLayoutCache;
   XFILE::CDirectoryCache g_directoryCache;
 
   CGUITextureManager g_TextureManager;
@@ -245,6 +245,11 @@ bool CUtil::GetVolumeFromFileName(const CStdString& strFileName, CStdString& str
 
   CStdString strFileNameTemp = strFileName;
 
+  // most files aren't part of a stack, check all expressions at once first
+  boost::shared_ptr<const CRegExpList> stackRegExps = g_advancedSettings.GetRegExpList(regexps);
+  if (stackRegExps && !stackRegExps->Matches(strFileName))
+    return false;
+
   CRegExp reg(true);
 
   for (unsigned int i = 0; i < regexps.size(); i++)
@@ -618,22 +623,29 @@ bool CUtil::ExcludeFileOrFolder(const CStdString& strFileOrFolder, const CStdStr
   if (strFileOrFolder.IsEmpty())
     return false;
 
-  CRegExp regExExcludes(true);  // case insensitive regex
-
-  for (unsigned int i = 0; i < regexps.size(); i++)
+  // the arrays of the advanced settings are compiled when they are loaded
+  boost::shared_ptr<const CRegExpList> regExExcludes = g_advancedSettings.GetRegExpList(regexps);
+  if (!regExExcludes)
   {
-    if (!regExExcludes.RegComp(regexps[i].c_str()))
-    { // invalid regexp - complain in logs
-      CLog::Log(LOGERROR, "%s: Invalid exclude RegExp:'%s'", __FUNCTION__, regexps[i].c_str());
-      continue;
-    }
-    if (regExExcludes.RegFind(strFileOrFolder) > -1)
+    CRegExpList *list = new CRegExpList(true);  // case insensitive regex
+    for (unsigned int i = 0; i < regexps.size(); i++)
     {
-      CLog::Log(LOGDEBUG, "%s: File '%s' excluded. (Matches exclude rule RegExp:'%s')", __FUNCTION__, strFileOrFolder.c_str(), regexps[i].c_str());
-      return true;
+      if (!list->Add(regexps[i]))
+      { // invalid regexp - complain in logs
+        CLog::Log(LOGERROR, "%s: Invalid exclude RegExp:'%s'", __FUNCTION__, regexps[i].c_str());
+        continue;
+      }
     }
+    list->Combine();
+    regExExcludes.reset(list);
   }
-  return false;
+
+  int iExclude = regExExcludes->FindFirst(strFileOrFolder);
+  if (iExclude < 0)
+    return false;
+
+  CLog::Log(LOGDEBUG, "%s: File '%s' excluded. (Matches exclude rule RegExp:'%s')", __FUNCTION__, strFileOrFolder.c_str(), regExExcludes->GetPattern(iExclude).c_str());
+  return true;
 }
 
 void CUtil::GetFileAndProtocol(const CStdString& strURL, CStdString& strDir)
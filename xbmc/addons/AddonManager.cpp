@@ -26,6 +26,10 @@
 #include "threads/SingleLock.h"
 #include "FileItem.h"
 #include "LangInfo.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/URIUtils.h"
 #include "settings/Settings.h"
 #include "settings/GUISettings.h"
 #include "settings/AdvancedSettings.h"
@@ -62,6 +66,18 @@ cp_log_severity_t clog_to_cp(int lvl);
 void cp_fatalErrorHandler(const char *msg);
 void cp_logger(cp_log_severity_t level, const char *msg, const char *apid, void *user_data);
 
+/*! \brief Rescans the addons if an addon.xml changed since the addons were installed from the cache
+ */
+class CAddonVerifyJob : public CJob
+{
+public:
+  virtual bool DoWork()
+  {
+    CAddonMgr::Get().VerifyAddons();
+    return true;
+  }
+};
+
 /**********************************************************
  * CAddonMgr
  *
@@ -278,7 +294,15 @@ bool CAddonMgr::Init()
     return false;
   }
 
-  FindAddons();
+  // the addons are installed from the cached descriptors as they were on the last
+  // run, whether their addon.xml files changed since is checked after start
+  {
+    CSingleLock lock(m_critSection);
+    if (ScanAddons(false) > 0)
+      CJobManager::GetInstance().AddJob(new CAddonVerifyJob, NULL, CJob::PRIORITY_LOW);
+    SetChanged();
+  }
+  NotifyObservers("addons");
   return true;
 }
 
@@ -535,13 +559,153 @@ void CAddonMgr::FindAddons()
     CSingleLock lock(m_critSection);
     if (m_cpluff && m_cp_context)
     {
-      m_cpluff->scan_plugins(m_cp_context, CP_SP_UPGRADE);
+      ScanAddons(true);
       SetChanged();
     }
   }
   NotifyObservers("addons");
 }
 
+unsigned int CAddonMgr::ScanAddons(bool verify)
+{
+  // does what cp_scan_plugins(CP_SP_UPGRADE) does, but only the descriptors
+  // that changed since the last scan are read and parsed.
+  static const char *collections[] = { "special://home/addons", "special://xbmc/addons", "special://xbmcbin/addons" };
+
+  unsigned int cached = 0, unverified = 0;
+  set<CStdString> found;                                             // the addon directories
+  set<CStdString> valid;                                             // the directories with a descriptor
+  map<CStdString, cp_plugin_info_t*> parsed;                         // by path, the descriptors read from disk
+  map<CStdString, const CAddonManifestCache::Manifest*> available;   // by id, the newest version
+
+  for (unsigned int i = 0; i < sizeof(collections) / sizeof(collections[0]); i++)
+  {
+    CFileItemList items;
+    CDirectory::GetDirectory(CSpecialProtocol::TranslatePath(collections[i]), items, "",
+                             DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO | DIR_FLAG_BYPASS_CACHE);
+    for (int j = 0; j < items.Size(); j++)
+    {
+      if (!items[j]->m_bIsFolder || items[j]->GetLabel().Left(1) == ".")
+        continue;
+
+      // the same path as cpluff gives the addon, without a trailing slash
+      CStdString path = items[j]->GetPath();
+      URIUtils::RemoveSlashAtEnd(path);
+      if (!found.insert(path).second)
+        continue; // xbmcbin is usually the same as xbmc
+
+      const CAddonManifestCache::Manifest *manifest = verify ? NULL : m_manifests.Get(path);
+      if (manifest)
+        unverified++;
+      else
+      {
+        struct __stat64 st;
+        if (CFile::Stat(URIUtils::AddFileToFolder(path, "addon.xml"), &st) != 0)
+          continue;
+
+        manifest = m_manifests.Get(path, st.st_mtime, st.st_size);
+        if (manifest)
+          cached++;
+        else
+        {
+          // stat'ed first, a change while it is read is picked up by the next scan
+          cp_status_t status;
+          cp_plugin_info_t *info = m_cpluff->load_plugin_descriptor(m_cp_context, path.c_str(), &status);
+          if (!info)
+            continue;
+
+          CAddonManifestCache::Manifest read;
+          read.path    = path;
+          read.mtime   = st.st_mtime;
+          read.size    = st.st_size;
+          read.id      = info->identifier;
+          read.version = info->version ? info->version : "";
+          CAddonManifestCache::Serialize(info, read.descriptor);
+          parsed[path] = info;
+          manifest = m_manifests.Set(read);
+        }
+      }
+      valid.insert(path);
+
+      map<CStdString, const CAddonManifestCache::Manifest*>::iterator it = available.find(manifest->id);
+      if (it == available.end())
+        available[manifest->id] = manifest;
+      else if (AddonVersion(manifest->version) > AddonVersion(it->second->version))
+        it->second = manifest;
+    }
+  }
+
+  // install the new addons and upgrade the installed ones, changed descriptors are reinstalled
+  unsigned int installed = 0;
+  CAddonDescriptor descriptor;
+  for (map<CStdString, const CAddonManifestCache::Manifest*>::const_iterator it = available.begin(); it != available.end(); ++it)
+  {
+    const CAddonManifestCache::Manifest *manifest = it->second;
+    bool changed = parsed.find(manifest->path) != parsed.end();
+
+    cp_status_t status;
+    cp_plugin_info_t *current = m_cpluff->get_plugin_info(m_cp_context, manifest->id.c_str(), &status);
+    if (current)
+    {
+      bool upgrade = AddonVersion(manifest->version) > AddonVersion(current->version ? current->version : "");
+      bool reload  = changed && manifest->path == current->plugin_path;
+      m_cpluff->release_info(m_cp_context, current);
+      if (!upgrade && !reload)
+        continue;
+      m_cpluff->uninstall_plugin(m_cp_context, manifest->id.c_str());
+    }
+
+    cp_plugin_info_t *info = NULL;
+    if (changed)
+      info = parsed[manifest->path];
+    else if (descriptor.Decode(manifest->descriptor))
+      info = m_cpluff->copy_plugin_descriptor(m_cp_context, descriptor.Get(), &status);
+    else
+    {
+      CLog::Log(LOGWARNING, "ADDONS: corrupt cached descriptor of %s, reading %s", manifest->id.c_str(), manifest->path.c_str());
+      info = m_cpluff->load_plugin_descriptor(m_cp_context, manifest->path.c_str(), &status);
+    }
+    if (!info)
+      continue;
+    if (m_cpluff->install_plugin(m_cp_context, info) == CP_OK)
+      installed++;
+    if (!changed)
+      m_cpluff->release_info(m_cp_context, info);
+  }
+
+  for (map<CStdString, cp_plugin_info_t*>::iterator it = parsed.begin(); it != parsed.end(); ++it)
+    m_cpluff->release_info(m_cp_context, it->second);
+
+  m_manifests.Prune(valid);
+  m_manifests.Save();
+
+  CLog::Log(LOGDEBUG, "ADDONS: found %u addons, %u descriptors read from disk, %u cached, %u cached and not checked, %u installed",
+            (unsigned int)available.size(), (unsigned int)parsed.size(), cached, unverified, installed);
+  return unverified;
+}
+
+void CAddonMgr::VerifyAddons()
+{
+  // stat'ed without holding the lock, the addons are usable meanwhile
+  vector<CAddonManifestCache::Stamp> stamps;
+  {
+    CSingleLock lock(m_critSection);
+    m_manifests.GetStamps(stamps);
+  }
+
+  for (vector<CAddonManifestCache::Stamp>::const_iterator it = stamps.begin(); it != stamps.end(); ++it)
+  {
+    struct __stat64 st;
+    if (CFile::Stat(URIUtils::AddFileToFolder(it->path, "addon.xml"), &st) != 0 ||
+        st.st_mtime != it->mtime || st.st_size != it->size)
+    {
+      CLog::Log(LOGINFO, "ADDONS: %s changed since it was cached, rescanning the addons", it->path.c_str());
+      FindAddons();
+      return;
+    }
+  }
+}
+
 void CAddonMgr::RemoveAddon(const CStdString& ID)
 {
   if (m_cpluff && m_cp_context)
@@ -27,6 +27,7 @@
 #include <map>
 #include <deque>
 #include "AddonDatabase.h"
+#include "AddonManifestCache.h"
 
 class DllLibCPluff;
 extern "C"
@@ -113,6 +114,10 @@ namespace ADDON
     const char *GetTranslatedString(const cp_cfg_element_t *root, const char *tag);
     static AddonPtr AddonFromProps(AddonProps& props);
     void FindAddons();
+    /*! \brief Rescan the addons if the addon.xml of any cached descriptor changed
+     The addons are installed from the cached descriptors on start without checking their addon.xml.
+     */
+    void VerifyAddons();
     void RemoveAddon(const CStdString& ID);
 
     /* libcpluff */
@@ -173,6 +178,14 @@ namespace ADDON
     void LoadAddons(const CStdString &path, 
                     std::map<CStdString, AddonPtr>& unresolved);
 
+    /*! \brief Install the addons found in the addon directories with libcpluff
+     Only the addon descriptors that changed since the last scan are read and parsed,
+     the others are taken from the manifest cache.
+     \param verify whether to check addon.xml of the cached descriptors, otherwise only new addon directories are read
+     \return the number of cached descriptors that were used without checking addon.xml
+     */
+    unsigned int ScanAddons(bool verify);
+
     /* libcpluff */
     const cp_cfg_element_t *GetExtElement(cp_cfg_element_t *base, const char *path);
     cp_context_t *m_cp_context;
@@ -204,6 +217,7 @@ namespace ADDON
     static std::map<TYPE, IAddonMgrCallback*> m_managers;
     CCriticalSection m_critSection;
     CAddonDatabase m_database;
+    CAddonManifestCache m_manifests;
   };
 
 }; /* namespace ADDON */
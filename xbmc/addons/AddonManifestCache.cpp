@@ -0,0 +1,467 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "AddonManifestCache.h"
+#include "filesystem/File.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+using namespace std;
+using namespace XFILE;
+
+#define CACHE_FILE     "special://temp/addonmanifests.bin"
+#define CACHE_MAGIC    0x4d414258 // "XBAM"
+#define CACHE_VERSION  2
+
+namespace
+{
+  void PutInt(string &out, uint32_t value)
+  {
+    out.append((const char *)&value, sizeof(value));
+  }
+
+  void PutInt64(string &out, int64_t value)
+  {
+    out.append((const char *)&value, sizeof(value));
+  }
+
+  void PutString(string &out, const string &value)
+  {
+    PutInt(out, value.size());
+    out.append(value);
+  }
+
+  /* a string of a descriptor, stored with its terminator so it can be used in place. 0 is NULL */
+  void PutCString(string &out, const char *value)
+  {
+    if (!value)
+    {
+      PutInt(out, 0);
+      return;
+    }
+    size_t size = strlen(value) + 1;
+    PutInt(out, size);
+    out.append(value, size);
+  }
+
+  void PutElement(string &out, const cp_cfg_element_t *element, uint32_t &elements, uint32_t &atts)
+  {
+    elements++;
+    PutCString(out, element->name);
+    PutCString(out, element->value);
+    PutInt(out, element->index);
+    PutInt(out, element->num_atts);
+    for (unsigned int i = 0; i < element->num_atts * 2; i++)
+      PutCString(out, element->atts[i]);
+    atts += element->num_atts * 2;
+    PutInt(out, element->num_children);
+    for (unsigned int i = 0; i < element->num_children; i++)
+      PutElement(out, element->children + i, elements, atts);
+  }
+
+  class CReader
+  {
+  public:
+    CReader(const char *data, size_t size) : m_pos(data), m_end(data + size), m_ok(true) {}
+
+    uint32_t GetInt()
+    {
+      uint32_t value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    int64_t GetInt64()
+    {
+      int64_t value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    string GetString()
+    {
+      uint32_t size = GetInt();
+      if (!m_ok || size > (size_t)(m_end - m_pos))
+      {
+        m_ok = false;
+        return "";
+      }
+      string value(m_pos, size);
+      m_pos += size;
+      return value;
+    }
+
+    /* a string written by PutCString(), in place */
+    char *GetCString()
+    {
+      uint32_t size = GetInt();
+      if (!m_ok || size == 0)
+        return NULL;
+      if (size > (size_t)(m_end - m_pos) || m_pos[size - 1] != '\0')
+      {
+        m_ok = false;
+        return NULL;
+      }
+      char *value = const_cast<char *>(m_pos);
+      m_pos += size;
+      return value;
+    }
+
+    /* a count of items that take at least size bytes each */
+    uint32_t GetCount(size_t size)
+    {
+      uint32_t count = GetInt();
+      if (m_ok && count > (size_t)(m_end - m_pos) / size)
+        m_ok = false;
+      return m_ok ? count : 0;
+    }
+
+    bool IsOK() const { return m_ok; }
+
+  private:
+    void GetBytes(void *value, size_t size)
+    {
+      if (!m_ok || size > (size_t)(m_end - m_pos))
+      {
+        m_ok = false;
+        return;
+      }
+      memcpy(value, m_pos, size);
+      m_pos += size;
+    }
+
+    const char *m_pos;
+    const char *m_end;
+    bool        m_ok;
+  };
+
+  /* hands out the children and attribute arrays of the elements of a descriptor */
+  struct ElementPool
+  {
+    vector<cp_cfg_element_t> &elements;
+    vector<char*>            &atts;
+    size_t                    nextElement;
+    size_t                    nextAtt;
+  };
+
+  bool GetElement(CReader &reader, ElementPool &pool, cp_cfg_element_t *element, cp_cfg_element_t *parent)
+  {
+    element->name   = reader.GetCString();
+    element->value  = reader.GetCString();
+    element->index  = reader.GetInt();
+    element->parent = parent;
+
+    element->num_atts = reader.GetInt();
+    if (!reader.IsOK() || !element->name || element->num_atts > (pool.atts.size() - pool.nextAtt) / 2)
+      return false;
+    element->atts = element->num_atts ? &pool.atts[pool.nextAtt] : NULL;
+    pool.nextAtt += element->num_atts * 2;
+    for (unsigned int i = 0; i < element->num_atts * 2; i++)
+    {
+      if (!(element->atts[i] = reader.GetCString()))
+        return false;
+    }
+
+    element->num_children = reader.GetInt();
+    if (!reader.IsOK() || element->num_children > pool.elements.size() - pool.nextElement)
+      return false;
+    element->children = element->num_children ? &pool.elements[pool.nextElement] : NULL;
+    pool.nextElement += element->num_children;
+    for (unsigned int i = 0; i < element->num_children; i++)
+    {
+      if (!GetElement(reader, pool, element->children + i, element))
+        return false;
+    }
+    return true;
+  }
+}
+
+namespace ADDON
+{
+
+CAddonManifestCache::CAddonManifestCache()
+{
+  m_loaded  = false;
+  m_changed = false;
+}
+
+const CAddonManifestCache::Manifest *CAddonManifestCache::Get(const CStdString &path, int64_t mtime, int64_t size)
+{
+  const Manifest *manifest = Get(path);
+  if (!manifest || manifest->mtime != mtime || manifest->size != size)
+    return NULL;
+  return manifest;
+}
+
+const CAddonManifestCache::Manifest *CAddonManifestCache::Get(const CStdString &path)
+{
+  if (!m_loaded)
+    Load();
+
+  ManifestMap::const_iterator it = m_manifests.find(path);
+  if (it == m_manifests.end())
+    return NULL;
+  return &it->second;
+}
+
+const CAddonManifestCache::Manifest *CAddonManifestCache::Set(const Manifest &manifest)
+{
+  if (!m_loaded)
+    Load();
+
+  m_changed = true;
+  Manifest &cached = m_manifests[manifest.path];
+  cached = manifest;
+  return &cached;
+}
+
+void CAddonManifestCache::Prune(const set<CStdString> &paths)
+{
+  for (ManifestMap::iterator it = m_manifests.begin(); it != m_manifests.end();)
+  {
+    if (paths.find(it->first) == paths.end())
+    {
+      m_manifests.erase(it++);
+      m_changed = true;
+    }
+    else
+      ++it;
+  }
+}
+
+void CAddonManifestCache::GetStamps(vector<Stamp> &stamps)
+{
+  if (!m_loaded)
+    Load();
+
+  stamps.clear();
+  stamps.reserve(m_manifests.size());
+  for (ManifestMap::const_iterator it = m_manifests.begin(); it != m_manifests.end(); ++it)
+  {
+    Stamp stamp;
+    stamp.path  = it->second.path;
+    stamp.mtime = it->second.mtime;
+    stamp.size  = it->second.size;
+    stamps.push_back(stamp);
+  }
+}
+
+void CAddonManifestCache::Load()
+{
+  m_loaded = true;
+
+  CFile file;
+  if (!file.Open(CACHE_FILE))
+    return;
+
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > 64 * 1024 * 1024)
+    return;
+
+  string data((size_t)length, '\0');
+  if (file.Read(&data[0], length) != length)
+    return;
+  file.Close();
+
+  CReader reader(data.c_str(), data.size());
+  if (reader.GetInt() != CACHE_MAGIC || reader.GetInt() != CACHE_VERSION)
+    return;
+
+  ManifestMap manifests;
+  uint32_t count = reader.GetInt();
+  for (uint32_t i = 0; i < count && reader.IsOK(); i++)
+  {
+    Manifest manifest;
+    manifest.path       = reader.GetString();
+    manifest.mtime      = reader.GetInt64();
+    manifest.size       = reader.GetInt64();
+    manifest.id         = reader.GetString();
+    manifest.version    = reader.GetString();
+    manifest.descriptor = reader.GetString();
+    manifests[manifest.path] = manifest;
+  }
+
+  // all or nothing, a truncated cache is rebuilt from the addon directories
+  if (reader.IsOK())
+    m_manifests.swap(manifests);
+  else
+    CLog::Log(LOGWARNING, "%s - ignoring the corrupt %s", __FUNCTION__, CACHE_FILE);
+}
+
+void CAddonManifestCache::Save()
+{
+  if (!m_changed)
+    return;
+
+  string data;
+  PutInt(data, CACHE_MAGIC);
+  PutInt(data, CACHE_VERSION);
+  PutInt(data, m_manifests.size());
+  for (ManifestMap::const_iterator it = m_manifests.begin(); it != m_manifests.end(); ++it)
+  {
+    PutString(data, it->second.path);
+    PutInt64(data, it->second.mtime);
+    PutInt64(data, it->second.size);
+    PutString(data, it->second.id);
+    PutString(data, it->second.version);
+    PutString(data, it->second.descriptor);
+  }
+
+  CFile file;
+  if (file.OpenForWrite(CACHE_FILE, true) && file.Write(data.c_str(), data.size()) == (int)data.size())
+    m_changed = false;
+  else
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, CACHE_FILE);
+}
+
+void CAddonManifestCache::Serialize(const cp_plugin_info_t *info, string &descriptor)
+{
+  // the configuration elements and their attributes are counted up front, so
+  // CAddonDescriptor can allocate them at once
+  string body;
+  uint32_t elements = 0;
+  uint32_t atts = 0;
+
+  PutCString(body, info->identifier);
+  PutCString(body, info->name);
+  PutCString(body, info->version);
+  PutCString(body, info->provider_name);
+  PutCString(body, info->plugin_path);
+  PutCString(body, info->abi_bw_compatibility);
+  PutCString(body, info->api_bw_compatibility);
+  PutCString(body, info->req_cpluff_version);
+  PutCString(body, info->runtime_lib_name);
+  PutCString(body, info->runtime_funcs_symbol);
+
+  PutInt(body, info->num_imports);
+  for (unsigned int i = 0; i < info->num_imports; i++)
+  {
+    PutCString(body, info->imports[i].plugin_id);
+    PutCString(body, info->imports[i].version);
+    PutInt(body, info->imports[i].optional);
+  }
+
+  PutInt(body, info->num_ext_points);
+  for (unsigned int i = 0; i < info->num_ext_points; i++)
+  {
+    PutCString(body, info->ext_points[i].local_id);
+    PutCString(body, info->ext_points[i].identifier);
+    PutCString(body, info->ext_points[i].name);
+    PutCString(body, info->ext_points[i].schema_path);
+  }
+
+  PutInt(body, info->num_extensions);
+  for (unsigned int i = 0; i < info->num_extensions; i++)
+  {
+    const cp_extension_t &extension = info->extensions[i];
+    PutCString(body, extension.ext_point_id);
+    PutCString(body, extension.local_id);
+    PutCString(body, extension.identifier);
+    PutCString(body, extension.name);
+    PutInt(body, extension.configuration ? 1 : 0);
+    if (extension.configuration)
+      PutElement(body, extension.configuration, elements, atts);
+  }
+
+  descriptor.clear();
+  descriptor.reserve(2 * sizeof(uint32_t) + body.size());
+  PutInt(descriptor, elements);
+  PutInt(descriptor, atts);
+  descriptor.append(body);
+}
+
+CAddonDescriptor::CAddonDescriptor()
+{
+  memset(&m_info, 0, sizeof(m_info));
+}
+
+bool CAddonDescriptor::Decode(const string &descriptor)
+{
+  memset(&m_info, 0, sizeof(m_info));
+  CReader reader(descriptor.c_str(), descriptor.size());
+
+  // an element takes at least 16 bytes, an attribute 4
+  m_elements.resize(reader.GetCount(16));
+  m_atts.resize(reader.GetCount(4));
+
+  m_info.identifier           = reader.GetCString();
+  m_info.name                 = reader.GetCString();
+  m_info.version              = reader.GetCString();
+  m_info.provider_name        = reader.GetCString();
+  m_info.plugin_path          = reader.GetCString();
+  m_info.abi_bw_compatibility = reader.GetCString();
+  m_info.api_bw_compatibility = reader.GetCString();
+  m_info.req_cpluff_version   = reader.GetCString();
+  m_info.runtime_lib_name     = reader.GetCString();
+  m_info.runtime_funcs_symbol = reader.GetCString();
+  if (!reader.IsOK() || !m_info.identifier)
+    return false;
+
+  m_imports.resize(reader.GetCount(12));
+  m_info.num_imports = m_imports.size();
+  m_info.imports     = m_imports.empty() ? NULL : &m_imports[0];
+  for (unsigned int i = 0; i < m_info.num_imports; i++)
+  {
+    m_imports[i].plugin_id = reader.GetCString();
+    m_imports[i].version   = reader.GetCString();
+    m_imports[i].optional  = reader.GetInt();
+  }
+
+  m_extPoints.resize(reader.GetCount(16));
+  m_info.num_ext_points = m_extPoints.size();
+  m_info.ext_points     = m_extPoints.empty() ? NULL : &m_extPoints[0];
+  for (unsigned int i = 0; i < m_info.num_ext_points; i++)
+  {
+    m_extPoints[i].plugin      = &m_info;
+    m_extPoints[i].local_id    = reader.GetCString();
+    m_extPoints[i].identifier  = reader.GetCString();
+    m_extPoints[i].name        = reader.GetCString();
+    m_extPoints[i].schema_path = reader.GetCString();
+  }
+
+  ElementPool pool = { m_elements, m_atts, 0, 0 };
+  m_extensions.resize(reader.GetCount(20));
+  m_info.num_extensions = m_extensions.size();
+  m_info.extensions     = m_extensions.empty() ? NULL : &m_extensions[0];
+  for (unsigned int i = 0; i < m_info.num_extensions; i++)
+  {
+    cp_extension_t &extension = m_extensions[i];
+    extension.plugin        = &m_info;
+    extension.ext_point_id  = reader.GetCString();
+    extension.local_id      = reader.GetCString();
+    extension.identifier    = reader.GetCString();
+    extension.name          = reader.GetCString();
+    extension.configuration = NULL;
+    if (reader.GetInt())
+    {
+      if (pool.nextElement >= m_elements.size())
+        return false;
+      extension.configuration = &m_elements[pool.nextElement++];
+      if (!GetElement(reader, pool, extension.configuration, NULL))
+        return false;
+    }
+  }
+
+  return reader.IsOK();
+}
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+
+extern "C" {
+#include "lib/cpluff/libcpluff/cpluff.h"
+}
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ADDON
+{
+  /*!
+   \brief Cache of the parsed addon descriptors (addon.xml) of the installed addons.
+
+   A descriptor is kept in parsed form with the modification time and size of its
+   addon.xml, so a descriptor that didn't change doesn't go through the XML parser
+   again. The cache is stored in special://temp, on start the descriptors are taken
+   from it without reading the addon.xml files one by one. Not thread safe, the addon
+   manager serializes the access.
+   */
+  class CAddonManifestCache
+  {
+  public:
+    struct Manifest
+    {
+      CStdString  path;        ///< the addon directory
+      int64_t     mtime;       ///< of addon.xml
+      int64_t     size;        ///< of addon.xml
+      CStdString  id;
+      CStdString  version;
+      std::string descriptor;  ///< the parsed addon.xml, see Serialize()
+    };
+
+    /*! \brief The modification time and size of addon.xml a descriptor was read with
+     */
+    struct Stamp
+    {
+      CStdString path;         ///< the addon directory
+      int64_t    mtime;
+      int64_t    size;
+    };
+
+    CAddonManifestCache();
+
+    /*! \brief Get the descriptor of the addon in a directory
+     \param path the addon directory
+     \param mtime the current modification time of its addon.xml
+     \param size the current size of its addon.xml
+     \return the descriptor if it is cached and addon.xml didn't change since, NULL otherwise
+     */
+    const Manifest *Get(const CStdString &path, int64_t mtime, int64_t size);
+
+    /*! \brief Get the descriptor of the addon in a directory without checking its addon.xml
+     \param path the addon directory
+     \return the descriptor if it is cached, NULL otherwise
+     */
+    const Manifest *Get(const CStdString &path);
+
+    /*! \brief Add or replace the descriptor of the addon in manifest.path
+     \return the cached descriptor
+     */
+    const Manifest *Set(const Manifest &manifest);
+
+    /*! \brief Drop the descriptors of the addons that are no longer installed
+     \param paths the directories of the installed addons
+     */
+    void Prune(const std::set<CStdString> &paths);
+
+    /*! \brief Get the modification times and sizes of addon.xml the cached descriptors were read with
+     \param stamps [out] one for each cached descriptor
+     */
+    void GetStamps(std::vector<Stamp> &stamps);
+
+    /*! \brief Write the cache if it changed since it was read
+     */
+    void Save();
+
+    /*! \brief Serialize a descriptor parsed by cpluff for Manifest::descriptor
+     \param info the descriptor
+     \param descriptor [out] the serialized descriptor, see CAddonDescriptor
+     */
+    static void Serialize(const cp_plugin_info_t *info, std::string &descriptor);
+
+  private:
+    void Load();
+
+    typedef std::map<CStdString, Manifest> ManifestMap;
+    ManifestMap m_manifests;
+    bool        m_loaded;
+    bool        m_changed;
+  };
+
+  /*!
+   \brief A cached descriptor in the layout of the descriptors parsed by cpluff.
+
+   The strings point into the serialized descriptor, which has to outlive this. cpluff
+   only installs descriptors it allocated itself, cp_copy_plugin_descriptor() makes
+   one of this.
+   */
+  class CAddonDescriptor
+  {
+  public:
+    CAddonDescriptor();
+
+    /*! \brief Decode a descriptor serialized by CAddonManifestCache::Serialize()
+     \param descriptor the serialized descriptor
+     \return false if it is corrupt
+     */
+    bool Decode(const std::string &descriptor);
+
+    const cp_plugin_info_t *Get() const { return &m_info; }
+
+  private:
+    cp_plugin_info_t                m_info;
+    std::vector<cp_plugin_import_t> m_imports;
+    std::vector<cp_ext_point_t>     m_extPoints;
+    std::vector<cp_extension_t>     m_extensions;
+    std::vector<cp_cfg_element_t>   m_elements;
+    std::vector<char*>              m_atts;
+  };
+}
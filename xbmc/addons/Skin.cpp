@@ -24,6 +24,7 @@
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "guilib/Key.h"
+#include "guilib/GUIWindowCache.h"
 #include "utils/URIUtils.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
@@ -178,11 +179,19 @@ void CSkinInfo::LoadIncludes()
   CLog::Log(LOGINFO, "Loading skin includes from %s", includesPath.c_str());
   m_includes.ClearIncludes();
   m_includes.LoadIncludes(includesPath);
+
+  // the compiled windows on disk are checked against the includes when they are used
+  g_windowCache.Clear();
+}
+
+void CSkinInfo::LoadIncludeFile(const CStdString &includeFile)
+{
+  m_includes.LoadIncludes(includeFile);
 }
 
-void CSkinInfo::ResolveIncludes(TiXmlElement *node)
+void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<CStdString, bool> *xmlIncludeConditions /* = NULL */)
 {
-  m_includes.ResolveIncludes(node);
+  m_includes.ResolveIncludes(node, xmlIncludeConditions);
 }
 
 int CSkinInfo::GetStartWindow() const
@@ -93,7 +93,11 @@ public:
    */
   static bool TranslateResolution(const CStdString &name, RESOLUTION_INFO &res);
 
-  void ResolveIncludes(TiXmlElement *node);
+  void ResolveIncludes(TiXmlElement *node, std::map<CStdString, bool> *xmlIncludeConditions = NULL);
+
+  /*! \brief The include files of the skin that have been loaded so far
+   */
+  const std::vector<CStdString> &GetIncludeFiles() const { return m_includes.GetIncludeFiles(); };
 
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
@@ -109,6 +113,11 @@ public:
 //  static bool Check(const CStdString& strSkinDir); // checks if everything is present and accounted for without loading the skin
   static double GetMinVersion();
   void LoadIncludes();
+
+  /*! \brief Load an include file of the skin, unless it is loaded already
+   \param includeFile the path of the include file
+   */
+  void LoadIncludeFile(const CStdString &includeFile);
   const INFO::CSkinVariableString* CreateSkinVariable(const CStdString& name, int context);
 protected:
   /*! \brief Given a resolution, retrieve the corresponding directory name
@@ -20,7 +20,7 @@
  */
 #include "system.h"
 #include "Visualisation.h"
-#include "utils/fft.h"
+#include "utils/RealFFT.h"
 #include "GUIInfoManager.h"
 #include "Application.h"
 #include "music/tags/MusicInfoTag.h"
@@ -273,14 +273,15 @@ void CVisualisation::OnAudioData(const float* pAudioData, int iAudioDataLength)
   if (m_bWantsFreq)
   {
     const float *psAudioData = ptrAudioBuffer->Get();
-    memcpy(m_fFreq, psAudioData, AUDIO_BUFFER_SIZE * sizeof(float));
 
-    // FFT the data
-    twochanwithwindow(m_fFreq, AUDIO_BUFFER_SIZE);
+    // FFT the data, each channel of the interleaved stereo samples on its own,
+    // the spectra are interleaved the same way
+    m_transform->Power(psAudioData,     2, m_fFreq,     2);
+    m_transform->Power(psAudioData + 1, 2, m_fFreq + 1, 2);
 
     // Normalize the data
     float fMinData = (float)AUDIO_BUFFER_SIZE * AUDIO_BUFFER_SIZE * 3 / 8 * 0.5 * 0.5; // 3/8 for the Hann window, 0.5 as minimum amplitude
-    float fInvMinData = 1.0f/fMinData;
+    float fInvMinData = 2.0f/fMinData; // twice the power of each bin, for the one sided spectrum
     for (int i = 0; i < AUDIO_BUFFER_SIZE + 2; i++)
     {
       m_fFreq[i] *= fInvMinData;
@@ -309,12 +310,18 @@ void CVisualisation::CreateBuffers()
     m_iNumBuffers = MAX_AUDIO_BUFFERS;
   if (m_iNumBuffers < 1)
     m_iNumBuffers = 1;
+
+  // the buffers hold AUDIO_BUFFER_SIZE / 2 stereo samples, padded to get
+  // AUDIO_BUFFER_SIZE / 2 frequencies per channel
+  if (m_bWantsFreq)
+    m_transform.reset(new CRealFFT(AUDIO_BUFFER_SIZE, CRealFFT::WINDOW_HANN, AUDIO_BUFFER_SIZE / 2));
 }
 
 void CVisualisation::ClearBuffers()
 {
   m_bWantsFreq = false;
   m_iNumBuffers = 0;
+  m_transform.reset();
 
   while (m_vecBuffers.size() > 0)
   {
@@ -28,11 +28,13 @@
 #include <map>
 #include <list>
 #include <memory>
+#include <boost/shared_ptr.hpp>
 
 #define AUDIO_BUFFER_SIZE 512 // MUST BE A POWER OF 2!!!
 #define MAX_AUDIO_BUFFERS 16
 
 class CCriticalSection;
+class CRealFFT;
 
 typedef DllAddon<Visualisation, VIS_PROPS> DllVisualisation;
 
@@ -102,6 +104,7 @@ namespace ADDON
     std::list<CAudioBuffer*> m_vecBuffers;
     int m_iNumBuffers;        // Number of Audio buffers
     bool m_bWantsFreq;
+    boost::shared_ptr<CRealFFT> m_transform;    // FFT of the audio data, if the vis wants freq data
     float m_fFreq[2*AUDIO_BUFFER_SIZE];         // Frequency data
     bool m_bCalculate_Freq;       // True if the vis wants freq data
 
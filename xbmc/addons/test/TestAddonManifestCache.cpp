@@ -0,0 +1,313 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "addons/AddonManifestCache.h"
+#include "test/TestStubs.h"
+#include "threads/SystemClock.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace ADDON;
+
+namespace
+{
+  // the addons shipped with xbmc, from the directory the test runs in
+  const char *addonsPath = "../../../addons";
+
+  CAddonManifestCache::Manifest GetManifest(const CStdString &path, int64_t mtime, int64_t size)
+  {
+    CAddonManifestCache::Manifest manifest;
+    manifest.path       = path;
+    manifest.mtime      = mtime;
+    manifest.size       = size;
+    manifest.id         = path.Mid(path.ReverseFind('/') + 1);
+    manifest.version    = "1.0.0";
+    manifest.descriptor = "descriptor of " + path;
+    return manifest;
+  }
+
+  /* the descriptors of the shipped addons, parsed by cpluff */
+  class CParsedAddons
+  {
+  public:
+    CParsedAddons()
+    {
+      cp_init();
+      m_context = cp_create_context(NULL);
+
+      DIR *dir = opendir(addonsPath);
+      BOOST_REQUIRE(dir);
+      while (struct dirent *entry = readdir(dir))
+      {
+        if (entry->d_name[0] == '.')
+          continue;
+        std::string path = std::string(addonsPath) + "/" + entry->d_name;
+        cp_plugin_info_t *info = cp_load_plugin_descriptor(m_context, path.c_str(), NULL);
+        if (info)
+        {
+          m_paths.push_back(path);
+          m_addons.push_back(info);
+        }
+      }
+      closedir(dir);
+      BOOST_REQUIRE(!m_addons.empty());
+    }
+
+    ~CParsedAddons()
+    {
+      for (std::vector<cp_plugin_info_t*>::iterator it = m_addons.begin(); it != m_addons.end(); ++it)
+        cp_release_info(m_context, *it);
+      cp_destroy_context(m_context);
+      cp_destroy();
+    }
+
+    cp_context_t                   *m_context;
+    std::vector<std::string>        m_paths;
+    std::vector<cp_plugin_info_t*>  m_addons;
+  };
+
+  bool Equal(const char *a, const char *b)
+  {
+    return a == b || (a && b && strcmp(a, b) == 0);
+  }
+
+  void CheckElement(const cp_cfg_element_t *element, const cp_cfg_element_t *expected, const cp_cfg_element_t *parent)
+  {
+    BOOST_CHECK(Equal(element->name, expected->name));
+    BOOST_CHECK(Equal(element->value, expected->value));
+    BOOST_CHECK(element->parent == parent);
+    BOOST_CHECK_EQUAL(element->index, expected->index);
+    BOOST_REQUIRE_EQUAL(element->num_atts, expected->num_atts);
+    for (unsigned int i = 0; i < element->num_atts * 2; i++)
+      BOOST_CHECK(Equal(element->atts[i], expected->atts[i]));
+    BOOST_REQUIRE_EQUAL(element->num_children, expected->num_children);
+    for (unsigned int i = 0; i < element->num_children; i++)
+      CheckElement(element->children + i, expected->children + i, element);
+  }
+
+  void CheckDescriptor(const cp_plugin_info_t *info, const cp_plugin_info_t *expected)
+  {
+    BOOST_CHECK(Equal(info->identifier, expected->identifier));
+    BOOST_CHECK(Equal(info->name, expected->name));
+    BOOST_CHECK(Equal(info->version, expected->version));
+    BOOST_CHECK(Equal(info->provider_name, expected->provider_name));
+    BOOST_CHECK(Equal(info->plugin_path, expected->plugin_path));
+    BOOST_CHECK(Equal(info->req_cpluff_version, expected->req_cpluff_version));
+    BOOST_CHECK(Equal(info->runtime_lib_name, expected->runtime_lib_name));
+
+    BOOST_REQUIRE_EQUAL(info->num_imports, expected->num_imports);
+    for (unsigned int i = 0; i < info->num_imports; i++)
+    {
+      BOOST_CHECK(Equal(info->imports[i].plugin_id, expected->imports[i].plugin_id));
+      BOOST_CHECK(Equal(info->imports[i].version, expected->imports[i].version));
+      BOOST_CHECK_EQUAL(info->imports[i].optional, expected->imports[i].optional);
+    }
+
+    BOOST_REQUIRE_EQUAL(info->num_ext_points, expected->num_ext_points);
+    for (unsigned int i = 0; i < info->num_ext_points; i++)
+    {
+      BOOST_CHECK(info->ext_points[i].plugin == info);
+      BOOST_CHECK(Equal(info->ext_points[i].identifier, expected->ext_points[i].identifier));
+    }
+
+    BOOST_REQUIRE_EQUAL(info->num_extensions, expected->num_extensions);
+    for (unsigned int i = 0; i < info->num_extensions; i++)
+    {
+      const cp_extension_t &extension = info->extensions[i];
+      BOOST_CHECK(extension.plugin == info);
+      BOOST_CHECK(Equal(extension.ext_point_id, expected->extensions[i].ext_point_id));
+      BOOST_CHECK(Equal(extension.identifier, expected->extensions[i].identifier));
+      BOOST_CHECK(Equal(extension.name, expected->extensions[i].name));
+      BOOST_REQUIRE_EQUAL(extension.configuration != NULL, expected->extensions[i].configuration != NULL);
+      if (extension.configuration)
+        CheckElement(extension.configuration, expected->extensions[i].configuration, NULL);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(TestAddonManifestCache)
+
+BOOST_AUTO_TEST_CASE(TestChangedManifest)
+{
+  g_testFiles.clear();
+  {
+    CAddonManifestCache cache;
+    cache.Set(GetManifest("/addons/skin.confluence", 1351000000, 4096));
+    cache.Set(GetManifest("/addons/script.foo", 1351000000, 512));
+
+    BOOST_CHECK(cache.Get("/addons/skin.confluence", 1351000000, 4096));
+    BOOST_CHECK(!cache.Get("/addons/skin.confluence", 1351000001, 4096));
+    BOOST_CHECK(!cache.Get("/addons/skin.confluence", 1351000000, 4097));
+    BOOST_CHECK(!cache.Get("/addons/skin.foo", 1351000000, 4096));
+    cache.Save();
+  }
+
+  // read back from the cache file, like on the next start
+  CAddonManifestCache cache;
+  const CAddonManifestCache::Manifest *manifest = cache.Get("/addons/script.foo", 1351000000, 512);
+  BOOST_REQUIRE(manifest);
+  BOOST_CHECK_EQUAL(manifest->id, "script.foo");
+  BOOST_CHECK_EQUAL(manifest->descriptor, "descriptor of /addons/script.foo");
+
+  // an addon.xml changed while xbmc wasn't running
+  BOOST_CHECK(!cache.Get("/addons/skin.confluence", 1351000002, 4096));
+  BOOST_CHECK(cache.Get("/addons/skin.confluence"));
+
+  std::vector<CAddonManifestCache::Stamp> stamps;
+  cache.GetStamps(stamps);
+  BOOST_REQUIRE_EQUAL(stamps.size(), 2U);
+  BOOST_CHECK_EQUAL(stamps[1].path, "/addons/skin.confluence");
+  BOOST_CHECK_EQUAL(stamps[1].mtime, 1351000000);
+  BOOST_CHECK_EQUAL(stamps[1].size, 4096);
+
+  // replaced once it is read again, dropped once it is removed
+  cache.Set(GetManifest("/addons/skin.confluence", 1351000002, 4096));
+  BOOST_CHECK(cache.Get("/addons/skin.confluence", 1351000002, 4096));
+  std::set<CStdString> installed;
+  installed.insert("/addons/skin.confluence");
+  cache.Prune(installed);
+  BOOST_CHECK(!cache.Get("/addons/script.foo"));
+  cache.Save();
+
+  CAddonManifestCache saved;
+  BOOST_CHECK(saved.Get("/addons/skin.confluence", 1351000002, 4096));
+  BOOST_CHECK(!saved.Get("/addons/script.foo"));
+}
+
+BOOST_AUTO_TEST_CASE(TestCorruptCache)
+{
+  g_testFiles.clear();
+  {
+    CAddonManifestCache cache;
+    cache.Set(GetManifest("/addons/skin.confluence", 1351000000, 4096));
+    cache.Save();
+  }
+
+  // a truncated cache file is ignored as a whole
+  std::string &file = g_testFiles.begin()->second;
+  file.resize(file.size() - 1);
+  CAddonManifestCache cache;
+  BOOST_CHECK(!cache.Get("/addons/skin.confluence"));
+}
+
+BOOST_AUTO_TEST_CASE(TestDescriptor)
+{
+  CParsedAddons parsed;
+  for (unsigned int i = 0; i < parsed.m_addons.size(); i++)
+  {
+    const cp_plugin_info_t *info = parsed.m_addons[i];
+    std::string serialized;
+    CAddonManifestCache::Serialize(info, serialized);
+
+    CAddonDescriptor descriptor;
+    BOOST_REQUIRE(descriptor.Decode(serialized));
+    CheckDescriptor(descriptor.Get(), info);
+
+    // cpluff installs the copy like a descriptor it parsed
+    cp_plugin_info_t *copy = cp_copy_plugin_descriptor(parsed.m_context, descriptor.Get(), NULL);
+    BOOST_REQUIRE(copy);
+    CheckDescriptor(copy, info);
+    BOOST_CHECK_EQUAL(cp_install_plugin(parsed.m_context, copy), CP_OK);
+    cp_release_info(parsed.m_context, copy);
+
+    // a truncated descriptor isn't used
+    for (size_t size = 0; size < serialized.size(); size += 7)
+      BOOST_CHECK(!descriptor.Decode(serialized.substr(0, size)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestStartupTime)
+{
+  // the shipped addons as they are found on start, each run in a new plug-in context
+  const unsigned int runs = 20;
+  CParsedAddons parsed;
+  g_testFiles.clear();
+  {
+    CAddonManifestCache cache;
+    for (unsigned int i = 0; i < parsed.m_addons.size(); i++)
+    {
+      CAddonManifestCache::Manifest manifest = GetManifest(parsed.m_paths[i], 0, 0);
+      CAddonManifestCache::Serialize(parsed.m_addons[i], manifest.descriptor);
+      cache.Set(manifest);
+    }
+    cache.Save();
+  }
+
+  // each addon.xml is stat'ed, read and parsed
+  unsigned int installed = 0;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int run = 0; run < runs; run++)
+  {
+    cp_context_t *context = cp_create_context(NULL);
+    for (unsigned int i = 0; i < parsed.m_paths.size(); i++)
+    {
+      struct stat st;
+      if (stat((parsed.m_paths[i] + "/addon.xml").c_str(), &st) != 0)
+        continue;
+      cp_plugin_info_t *info = cp_load_plugin_descriptor(context, parsed.m_paths[i].c_str(), NULL);
+      if (!info)
+        continue;
+      if (cp_install_plugin(context, info) == CP_OK)
+        installed++;
+      cp_release_info(context, info);
+    }
+    cp_destroy_context(context);
+  }
+  unsigned int parseTime = XbmcThreads::SystemClockMillis() - start;
+  BOOST_CHECK_EQUAL(installed, runs * parsed.m_addons.size());
+
+  // the cache file is read, the descriptors are decoded and copied
+  installed = 0;
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int run = 0; run < runs; run++)
+  {
+    cp_context_t *context = cp_create_context(NULL);
+    CAddonManifestCache cache;
+    CAddonDescriptor descriptor;
+    for (unsigned int i = 0; i < parsed.m_paths.size(); i++)
+    {
+      const CAddonManifestCache::Manifest *manifest = cache.Get(parsed.m_paths[i]);
+      if (!manifest || !descriptor.Decode(manifest->descriptor))
+        continue;
+      cp_plugin_info_t *info = cp_copy_plugin_descriptor(context, descriptor.Get(), NULL);
+      if (!info)
+        continue;
+      if (cp_install_plugin(context, info) == CP_OK)
+        installed++;
+      cp_release_info(context, info);
+    }
+    cp_destroy_context(context);
+  }
+  unsigned int cacheTime = XbmcThreads::SystemClockMillis() - start;
+  BOOST_CHECK_EQUAL(installed, runs * parsed.m_addons.size());
+
+  BOOST_TEST_MESSAGE(runs << " starts with " << parsed.m_addons.size() << " addons: " << parseTime
+                     << " ms parsing addon.xml, " << cacheTime << " ms from the cache");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -20,6 +20,7 @@
  */
 
 #include "system.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/MathUtils.h"
@@ -45,7 +46,8 @@ CSoftAEStream::CSoftAEStream(enum AEDataFormat dataFormat, unsigned int sampleRa
   m_rgain           (1.0f ),
   m_refillBuffer    (0    ),
   m_convertFn       (NULL ),
-  m_ssrc            (NULL ),
+  m_resampleBuffer  (NULL ),
+  m_resampleFrames  (0    ),
   m_framesBuffered  (0    ),
   m_newPacket       (NULL ),
   m_packet          (NULL ),
@@ -56,8 +58,6 @@ CSoftAEStream::CSoftAEStream(enum AEDataFormat dataFormat, unsigned int sampleRa
   m_fadeRunning     (false),
   m_slave           (NULL )
 {
-  m_ssrcData.data_out = NULL;
-
   m_initDataFormat        = dataFormat;
   m_initSampleRate        = sampleRate;
   m_initEncodedSampleRate = encodedSampleRate;
@@ -108,8 +108,8 @@ void CSoftAEStream::Initialize()
 
     if (m_resample)
     {
-      _aligned_free(m_ssrcData.data_out);
-      m_ssrcData.data_out = NULL;
+      _aligned_free(m_resampleBuffer);
+      m_resampleBuffer = NULL;
     }
   }
 
@@ -187,14 +187,16 @@ void CSoftAEStream::Initialize()
   /* if we need to resample, set it up */
   if (m_resample)
   {
-    int err;
-    m_ssrc                   = src_new(SRC_SINC_MEDIUM_QUALITY, m_initChannelLayout.Count(), &err);
-    m_ssrcData.data_in       = m_convertBuffer;
-    m_internalRatio          = (double)AE.GetSampleRate() / (double)m_initSampleRate;
-    m_ssrcData.src_ratio     = m_internalRatio;
-    m_ssrcData.data_out      = (float*)_aligned_malloc(m_format.m_frameSamples * std::ceil(m_ssrcData.src_ratio) * sizeof(float), 16);
-    m_ssrcData.output_frames = m_format.m_frames * std::ceil(m_ssrcData.src_ratio);
-    m_ssrcData.end_of_input  = 0;
+    CAEResample::Quality quality = (CAEResample::Quality)g_advancedSettings.m_audioResampleQuality;
+    if (!m_resampler.Initialize(m_initChannelLayout.Count(), m_initSampleRate, AE.GetSampleRate(), quality))
+    {
+      m_valid = false;
+      return;
+    }
+
+    m_internalRatio  = (double)AE.GetSampleRate() / (double)m_initSampleRate;
+    m_resampleFrames = m_resampler.GetMaxOutputFrames(m_format.m_frames);
+    m_resampleBuffer = (float*)_aligned_malloc(m_resampleFrames * m_initChannelLayout.Count() * sizeof(float), 16);
   }
 
   m_chLayoutCount = m_format.m_channelLayout.Count();
@@ -217,11 +219,7 @@ CSoftAEStream::~CSoftAEStream()
     _aligned_free(m_convertBuffer);
 
   if (m_resample)
-  {
-    _aligned_free(m_ssrcData.data_out);
-    src_delete(m_ssrc);
-    m_ssrc = NULL;
-  }
+    _aligned_free(m_resampleBuffer);
 
   CLog::Log(LOGDEBUG, "CSoftAEStream::~CSoftAEStream - Destructed");
 }
@@ -316,12 +314,10 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
   /* resample it if we need to */
   if (m_resample)
   {
-    m_ssrcData.input_frames = samples / m_chLayoutCount;
-    if (src_process(m_ssrc, &m_ssrcData) != 0)
-      return 0;
-    data     = (uint8_t*)m_ssrcData.data_out;
-    frames   = m_ssrcData.output_frames_gen;
-    consumed = m_ssrcData.input_frames_used * m_bytesPerFrame;
+    unsigned int used;
+    frames   = m_resampler.Process(m_convertBuffer, samples / m_chLayoutCount, used, m_resampleBuffer, m_resampleFrames);
+    data     = (uint8_t*)m_resampleBuffer;
+    consumed = used * m_bytesPerFrame;
     if (!frames)
       return consumed;
 
@@ -550,10 +546,7 @@ void CSoftAEStream::InternalFlush()
 {
   /* reset the resampler */
   if (m_resample)
-  {
-    m_ssrcData.end_of_input = 0;
-    src_reset(m_ssrc);
-  }
+    m_resampler.Reset();
 
   /* invalidate any incoming samples */
   m_newPacket->data.Empty();
@@ -584,7 +577,7 @@ double CSoftAEStream::GetResampleRatio()
     return 1.0f;
 
   CSharedLock lock(m_lock);
-  return m_ssrcData.src_ratio;
+  return m_internalRatio * m_resampler.GetRatio();
 }
 
 bool CSoftAEStream::SetResampleRatio(double ratio)
@@ -594,19 +587,18 @@ bool CSoftAEStream::SetResampleRatio(double ratio)
 
   CSharedLock lock(m_lock);
 
-  int oldRatioInt = std::ceil(m_ssrcData.src_ratio);
-
   m_resampleRatio = ratio;
 
-  src_set_ratio(m_ssrc, m_resampleRatio * m_internalRatio);
-  m_ssrcData.src_ratio = m_resampleRatio * m_internalRatio;
+  /* the resampler only steps through its filter differently, nothing is rebuilt */
+  m_resampler.SetRatio(m_resampleRatio);
 
   //Check the resample buffer size and resize if necessary.
-  if (oldRatioInt < std::ceil(m_ssrcData.src_ratio))
+  unsigned int frames = m_resampler.GetMaxOutputFrames(m_format.m_frames);
+  if (frames > m_resampleFrames)
   {
-    _aligned_free(m_ssrcData.data_out);
-    m_ssrcData.data_out      = (float*)_aligned_malloc(m_format.m_frameSamples * std::ceil(m_ssrcData.src_ratio) * sizeof(float), 16);
-    m_ssrcData.output_frames = m_format.m_frames * std::ceil(m_ssrcData.src_ratio);
+    _aligned_free(m_resampleBuffer);
+    m_resampleFrames = frames;
+    m_resampleBuffer = (float*)_aligned_malloc(m_resampleFrames * m_initChannelLayout.Count() * sizeof(float), 16);
   }
   return true;
 }
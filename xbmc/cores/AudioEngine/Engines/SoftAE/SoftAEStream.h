@@ -20,7 +20,6 @@
  *
  */
 
-#include <samplerate.h>
 #include <list>
 
 #include "threads/SharedSection.h"
@@ -30,6 +29,7 @@
 #include "Utils/AEConvert.h"
 #include "Utils/AERemap.h"
 #include "Utils/AEBuffer.h"
+#include "Utils/AEResample.h"
 
 class IAEPostProc;
 class CSoftAEStream : public IAEStream
@@ -124,8 +124,9 @@ private:
   unsigned int        m_samplesPerFrame;
   CAEChannelInfo      m_aeChannelLayout;
   unsigned int        m_aeBytesPerFrame;
-  SRC_STATE          *m_ssrc;
-  SRC_DATA            m_ssrcData;
+  CAEResample         m_resampler;
+  float              *m_resampleBuffer;
+  unsigned int        m_resampleFrames;
   unsigned int        m_framesBuffered;
   std::list<PPacket*> m_outBuffer;
   unsigned int        ProcessFrameBuffer();
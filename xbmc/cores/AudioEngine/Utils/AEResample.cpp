@@ -0,0 +1,339 @@
+/*
+ *      Copyright (C) 2010-2012 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "AEResample.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+/* ratios with up to this many output frames per cycle are stepped through exactly */
+#define MAX_EXACT_PHASES 1024
+/* the least number of phases to interpolate between */
+#define MIN_PHASES       128
+/* the number of phases for ratios that aren't stepped through exactly */
+#define INEXACT_PHASES   256
+#define MAX_TAPS         256
+
+static const struct
+{
+  unsigned int taps;
+  double       beta;    /* of the kaiser window */
+  double       rolloff; /* cutoff relative to the nyquist frequency */
+} QualityInfo[] =
+{
+  /* QUALITY_LOW    */ { 16, 5.0, 0.80 },
+  /* QUALITY_MEDIUM */ { 32, 8.0, 0.88 },
+  /* QUALITY_HIGH   */ { 64, 10.0, 0.92 }
+};
+
+static unsigned int GCD(unsigned int a, unsigned int b)
+{
+  while (b)
+  {
+    unsigned int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/* modified bessel function of the first kind, for the kaiser window */
+static double BesselI0(double x)
+{
+  double sum  = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 50; ++k)
+  {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum  += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+CAEResample::CAEResample() :
+  m_channels  (0  ),
+  m_taps      (0  ),
+  m_phases    (0  ),
+  m_ratio     (1.0),
+  m_baseStep  (1.0),
+  m_stepPhases(0  ),
+  m_stepFrac  (0.0),
+  m_index     (0  ),
+  m_phase     (0  ),
+  m_frac      (0.0),
+  m_buffered  (0  )
+{
+}
+
+CAEResample::~CAEResample()
+{
+}
+
+bool CAEResample::Initialize(unsigned int channels, unsigned int inputRate, unsigned int outputRate, enum Quality quality)
+{
+  if (!channels || !inputRate || !outputRate)
+    return false;
+
+  if (quality < QUALITY_LOW || quality > QUALITY_HIGH)
+    quality = QUALITY_MEDIUM;
+
+  m_channels = channels;
+
+  /* outputRate / inputRate = L / M */
+  unsigned int gcd = GCD(inputRate, outputRate);
+  unsigned int L   = outputRate / gcd;
+  unsigned int M   = inputRate  / gcd;
+
+  if (L <= MAX_EXACT_PHASES)
+  {
+    /* a multiple of L keeps every output on a phase and leaves enough to interpolate between */
+    m_phases = L;
+    while (m_phases < MIN_PHASES)
+      m_phases += L;
+  }
+  else
+    m_phases = INEXACT_PHASES;
+
+  m_baseStep = (double)m_phases * M / L;
+
+  /* when downsampling the cutoff drops, the filter has to get longer to keep its steepness */
+  double scale = std::min(1.0, (double)outputRate / inputRate);
+  m_taps = (unsigned int)ceil(QualityInfo[quality].taps / scale);
+  m_taps = std::min((m_taps + 3) & ~3U, (unsigned int)MAX_TAPS);
+
+  BuildFilter(0.5 * scale * QualityInfo[quality].rolloff, QualityInfo[quality].beta);
+
+  m_input.resize(m_channels);
+  SetRatio(1.0);
+  Reset();
+  return true;
+}
+
+void CAEResample::BuildFilter(double cutoff, double beta)
+{
+  /*
+    phase p is the filter for an output that lies p / m_phases frames after the
+    centre of the window, there is one extra phase so that interpolation never
+    has to wrap to the next input frame
+  */
+  m_filter.resize((m_phases + 1) * m_taps);
+
+  const double half   = m_taps / 2.0;
+  const double i0Beta = BesselI0(beta);
+
+  for (unsigned int p = 0; p <= m_phases; ++p)
+  {
+    float *coeffs = &m_filter[p * m_taps];
+    double sum = 0.0;
+    for (unsigned int k = 0; k < m_taps; ++k)
+    {
+      double t = (double)p / m_phases + half - 1.0 - k;
+      double h;
+      if (fabs(t) >= half)
+        h = 0.0;
+      else
+      {
+        double x    = 2.0 * cutoff * t;
+        double sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double w    = t / half;
+        h = 2.0 * cutoff * sinc * BesselI0(beta * sqrt(1.0 - w * w)) / i0Beta;
+      }
+      coeffs[k] = (float)h;
+      sum      += h;
+    }
+
+    /* unity gain at DC for every phase */
+    for (unsigned int k = 0; k < m_taps; ++k)
+      coeffs[k] = (float)(coeffs[k] / sum);
+  }
+}
+
+void CAEResample::SetRatio(double ratio)
+{
+  if (ratio <= 0.0)
+    return;
+
+  m_ratio = ratio;
+
+  double step  = m_baseStep / ratio;
+  double whole = floor(step);
+  m_stepPhases = (unsigned int)whole;
+  m_stepFrac   = step - whole;
+
+  /* snap ratios that are exact but suffer from rounding */
+  if (m_stepFrac < 1e-9)
+    m_stepFrac = 0.0;
+  else if (m_stepFrac > 1.0 - 1e-9)
+  {
+    m_stepPhases++;
+    m_stepFrac = 0.0;
+  }
+}
+
+unsigned int CAEResample::GetMaxOutputFrames(unsigned int inFrames) const
+{
+  double step = m_stepPhases + m_stepFrac;
+  return (unsigned int)ceil((double)(inFrames + m_taps) * m_phases / step) + 1;
+}
+
+void CAEResample::Reset()
+{
+  /* prime with silence so the first output lines up with the first input */
+  m_buffered = m_taps / 2 - 1;
+  for (unsigned int ch = 0; ch < m_channels; ++ch)
+    m_input[ch].assign(m_buffered, 0.0f);
+
+  m_index = 0;
+  m_phase = 0;
+  m_frac  = 0.0;
+}
+
+inline float CAEResample::Dot(const float *x, const float *coeffs) const
+{
+#if defined(__SSE__)
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  unsigned int k = 0;
+  for (; k + 8 <= m_taps; k += 8)
+  {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(x + k    ), _mm_loadu_ps(coeffs + k    )));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(x + k + 4), _mm_loadu_ps(coeffs + k + 4)));
+  }
+  if (k < m_taps)
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(coeffs + k)));
+
+  sum0 = _mm_add_ps(sum0, sum1);
+  sum0 = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+  sum0 = _mm_add_ss(sum0, _mm_shuffle_ps(sum0, sum0, 1));
+  return _mm_cvtss_f32(sum0);
+#elif defined(__ARM_NEON__)
+  float32x4_t sum = vdupq_n_f32(0.0f);
+  for (unsigned int k = 0; k < m_taps; k += 4)
+    sum = vmlaq_f32(sum, vld1q_f32(x + k), vld1q_f32(coeffs + k));
+
+  float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+  return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+  float sum = 0.0f;
+  for (unsigned int k = 0; k < m_taps; ++k)
+    sum += x[k] * coeffs[k];
+  return sum;
+#endif
+}
+
+unsigned int CAEResample::Process(const float *in, unsigned int inFrames, unsigned int &inUsed, float *out, unsigned int outFrames)
+{
+  unsigned int produced = 0;
+  inUsed = 0;
+
+  if (!m_channels)
+    return 0;
+
+  const double step = m_stepPhases + m_stepFrac;
+  for (;;)
+  {
+    /* make as many frames as the buffered input allows */
+    while (produced < outFrames && m_index + m_taps <= m_buffered)
+    {
+      const float *c0 = &m_filter[m_phase * m_taps];
+      if (m_frac == 0.0)
+      {
+        for (unsigned int ch = 0; ch < m_channels; ++ch)
+          out[ch] = Dot(&m_input[ch][m_index], c0);
+      }
+      else
+      {
+        const float *c1   = c0 + m_taps;
+        const float  frac = (float)m_frac;
+        for (unsigned int ch = 0; ch < m_channels; ++ch)
+        {
+          float d0 = Dot(&m_input[ch][m_index], c0);
+          float d1 = Dot(&m_input[ch][m_index], c1);
+          out[ch]  = d0 + frac * (d1 - d0);
+        }
+      }
+      out += m_channels;
+      ++produced;
+
+      /* step to the next output */
+      m_frac += m_stepFrac;
+      if (m_frac >= 1.0)
+      {
+        m_frac -= 1.0;
+        ++m_phase;
+      }
+      m_phase += m_stepPhases;
+      m_index += m_phase / m_phases;
+      m_phase %= m_phases;
+    }
+
+    if (produced == outFrames || inUsed == inFrames)
+      break;
+
+    /* take the input the rest of the output needs, no more so it doesn't pile up */
+    unsigned int target = m_index + m_taps + (unsigned int)ceil((outFrames - produced - 1) * step / m_phases) + 1;
+    unsigned int take   = std::min(inFrames - inUsed, target - m_buffered);
+
+    for (unsigned int ch = 0; ch < m_channels; ++ch)
+    {
+      std::vector<float> &plane = m_input[ch];
+      plane.resize(m_buffered + take);
+      const float *src = in + inUsed * m_channels + ch;
+      for (unsigned int i = 0; i < take; ++i, src += m_channels)
+        plane[m_buffered + i] = *src;
+    }
+    m_buffered += take;
+    inUsed     += take;
+  }
+
+  /* drop the input that no future output needs */
+  if (m_index > 0)
+  {
+    unsigned int drop = std::min(m_index, m_buffered);
+    for (unsigned int ch = 0; ch < m_channels; ++ch)
+    {
+      std::vector<float> &plane = m_input[ch];
+      if (m_buffered > drop)
+        memmove(&plane[0], &plane[drop], (m_buffered - drop) * sizeof(float));
+      plane.resize(m_buffered - drop);
+    }
+    m_buffered -= drop;
+    m_index    -= drop;
+  }
+
+  return produced;
+}
+
@@ -0,0 +1,90 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2012 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <vector>
+
+/*
+  Polyphase resampler for interleaved float samples.
+
+  The windowed sinc filter is precomputed as a bank of phases. When the rates
+  have a small rational ratio (44100 <-> 48000 is 160/147) every output sample
+  lands exactly on a phase and costs one dot product per channel. Any other
+  ratio, including the fine adjustment set with SetRatio() for A/V sync, is
+  handled by interpolating between two neighbouring phases, so changing the
+  ratio never rebuilds the filter.
+*/
+class CAEResample
+{
+public:
+  enum Quality
+  {
+    QUALITY_LOW = 0,
+    QUALITY_MEDIUM,
+    QUALITY_HIGH
+  };
+
+  CAEResample();
+  ~CAEResample();
+
+  bool Initialize(unsigned int channels, unsigned int inputRate, unsigned int outputRate, enum Quality quality);
+
+  /* adjust the ratio on top of outputRate / inputRate, eg. 1.001 to play a bit slower */
+  void   SetRatio(double ratio);
+  double GetRatio() const { return m_ratio; }
+
+  /* the number of frames Process can return for inFrames input frames at most */
+  unsigned int GetMaxOutputFrames(unsigned int inFrames) const;
+
+  /*
+    resample interleaved frames, returns the number of frames written to out.
+    inUsed is set to the number of input frames that were taken, input that
+    isn't taken because out is full has to be passed in again.
+  */
+  unsigned int Process(const float *in, unsigned int inFrames, unsigned int &inUsed, float *out, unsigned int outFrames);
+
+  /* drop any buffered input, eg. on flush */
+  void Reset();
+
+private:
+  void  BuildFilter(double cutoff, double beta);
+  float Dot(const float *x, const float *coeffs) const;
+
+  unsigned int m_channels;
+  unsigned int m_taps;        /* taps per phase, a multiple of 4 */
+  unsigned int m_phases;      /* phases per input frame */
+  double       m_ratio;       /* user adjustment of the ratio */
+  double       m_baseStep;    /* input phases per output frame, without the adjustment */
+
+  /* the step per output frame, in whole phases plus a fraction of a phase */
+  unsigned int m_stepPhases;
+  double       m_stepFrac;
+
+  /* position of the next output frame */
+  unsigned int m_index;       /* first input frame under the filter */
+  unsigned int m_phase;
+  double       m_frac;
+
+  std::vector<float> m_filter;              /* (m_phases + 1) * m_taps coefficients */
+  std::vector<std::vector<float> > m_input; /* buffered input, one plane per channel */
+  unsigned int m_buffered;                  /* frames in each plane */
+};
+
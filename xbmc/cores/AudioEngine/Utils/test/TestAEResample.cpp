@@ -0,0 +1,155 @@
+/*
+ *      Copyright (C) 2010-2012 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEResample.h"
+
+#include <math.h>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  std::vector<float> Sine(unsigned int channels, unsigned int rate, double freq, unsigned int frames)
+  {
+    std::vector<float> samples(frames * channels);
+    for (unsigned int i = 0; i < frames; ++i)
+      for (unsigned int ch = 0; ch < channels; ++ch)
+        samples[i * channels + ch] = (float)(0.5 * sin(2.0 * M_PI * freq * i / rate + ch));
+    return samples;
+  }
+
+  std::vector<float> Resample(CAEResample &resample, const std::vector<float> &in, unsigned int channels, unsigned int chunk)
+  {
+    std::vector<float> out;
+    std::vector<float> block(resample.GetMaxOutputFrames(chunk) * channels);
+    unsigned int frames = in.size() / channels;
+    for (unsigned int pos = 0; pos < frames;)
+    {
+      unsigned int used;
+      unsigned int count = std::min(chunk, frames - pos);
+      unsigned int made  = resample.Process(&in[pos * channels], count, used, &block[0], block.size() / channels);
+      out.insert(out.end(), block.begin(), block.begin() + made * channels);
+      pos += used;
+    }
+    return out;
+  }
+
+  /* THD+N of a resampled sine in dB, against the ideal sine at the output rate */
+  double THDN(const std::vector<float> &out, unsigned int channels, unsigned int rate, double freq, unsigned int skip)
+  {
+    double signal = 0.0, noise = 0.0;
+    unsigned int frames = out.size() / channels;
+    for (unsigned int i = skip; i + skip < frames; ++i)
+    {
+      for (unsigned int ch = 0; ch < channels; ++ch)
+      {
+        double ideal = 0.5 * sin(2.0 * M_PI * freq * i / rate + ch);
+        double error = out[i * channels + ch] - ideal;
+        signal += ideal * ideal;
+        noise  += error * error;
+      }
+    }
+    return 10.0 * log10(noise / signal);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAEResampleTHDN)
+{
+  static const struct
+  {
+    unsigned int         in, out;
+    CAEResample::Quality quality;
+    double               limit;
+  } cases[] =
+  {
+    { 44100, 48000, CAEResample::QUALITY_LOW,    -50.0 },
+    { 44100, 48000, CAEResample::QUALITY_MEDIUM, -80.0 },
+    { 44100, 48000, CAEResample::QUALITY_HIGH,   -95.0 },
+    { 48000, 44100, CAEResample::QUALITY_HIGH,   -95.0 },
+    { 22050, 48000, CAEResample::QUALITY_HIGH,   -95.0 },
+    { 96000, 44100, CAEResample::QUALITY_HIGH,   -95.0 },
+    { 44100, 47999, CAEResample::QUALITY_HIGH,   -95.0 }
+  };
+
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+  {
+    CAEResample resample;
+    BOOST_REQUIRE(resample.Initialize(6, cases[i].in, cases[i].out, cases[i].quality));
+
+    std::vector<float> in  = Sine(6, cases[i].in, 1000.0, cases[i].in / 2);
+    std::vector<float> out = Resample(resample, in, 6, 1024);
+
+    double thdn = THDN(out, 6, cases[i].out, 1000.0, 256);
+    BOOST_CHECK_MESSAGE(thdn < cases[i].limit, cases[i].in << " -> " << cases[i].out << " THD+N " << thdn << " dB");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAEResampleChunking)
+{
+  /* the output must not depend on how the input is split up */
+  std::vector<float> in = Sine(2, 44100, 440.0, 20000);
+
+  CAEResample whole, split;
+  whole.Initialize(2, 44100, 48000, CAEResample::QUALITY_MEDIUM);
+  split.Initialize(2, 44100, 48000, CAEResample::QUALITY_MEDIUM);
+
+  std::vector<float> a = Resample(whole, in, 2, 20000);
+  std::vector<float> b = Resample(split, in, 2, 37);
+
+  BOOST_REQUIRE_EQUAL(a.size(), b.size());
+  for (unsigned int i = 0; i < a.size(); ++i)
+    BOOST_REQUIRE_EQUAL(a[i], b[i]);
+}
+
+BOOST_AUTO_TEST_CASE(TestAEResampleRatio)
+{
+  /* a sync adjustment changes the output length without a glitch */
+  CAEResample resample;
+  resample.Initialize(2, 48000, 48000, CAEResample::QUALITY_MEDIUM);
+  resample.SetRatio(1.01);
+  BOOST_CHECK_CLOSE(resample.GetRatio(), 1.01, 0.0001);
+
+  std::vector<float> in  = Sine(2, 48000, 1000.0, 48000);
+  std::vector<float> out = Resample(resample, in, 2, 512);
+
+  BOOST_CHECK_CLOSE((double)out.size() / in.size(), 1.01, 0.1);
+  BOOST_CHECK(THDN(out, 2, 48480, 1000.0, 256) < -80.0);
+}
+
+BOOST_AUTO_TEST_CASE(TestAEResampleAliasing)
+{
+  /* content above the nyquist frequency of the output is filtered out */
+  CAEResample resample;
+  resample.Initialize(1, 96000, 44100, CAEResample::QUALITY_MEDIUM);
+
+  std::vector<float> in  = Sine(1, 96000, 30000.0, 48000);
+  std::vector<float> out = Resample(resample, in, 1, 1024);
+
+  double energy = 0.0;
+  for (unsigned int i = 256; i + 256 < out.size(); ++i)
+    energy += out[i] * out[i];
+  energy /= out.size() - 512;
+
+  /* relative to the 0.125 of the input sine */
+  BOOST_CHECK(10.0 * log10(energy / 0.125) < -70.0);
+}
+
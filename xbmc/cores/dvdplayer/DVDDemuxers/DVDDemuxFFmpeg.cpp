@@ -31,6 +31,7 @@
 #endif
 #include "DVDDemuxFFmpeg.h"
 #include "DVDInputStreams/DVDInputStream.h"
+#include "DVDInputStreams/DVDFactoryInputStream.h"
 #include "DVDInputStreams/DVDInputStreamNavigator.h"
 #ifdef HAVE_LIBBLURAY
 #include "DVDInputStreams/DVDInputStreamBluray.h"
@@ -40,6 +41,8 @@
 #endif
 >>>>>>> 1495cbeb771bb5dde20a83a50d23c89a50e6f5c1
 #include "DVDDemuxUtils.h"
+#include "DVDDemuxKeyframeIndex.h"
+#include "DVDDemuxProbeCache.h"
 #include "DVDClock.h" // for DVD_TIME_BASE
 #include "utils/Win32Exception.h"
 #include "settings/AdvancedSettings.h"
@@ -50,6 +53,7 @@
 #include "threads/Thread.h"
 #include "threads/SystemClock.h"
 #include "utils/TimeUtils.h"
+#include "utils/JobManager.h"
 
 void CDemuxStreamAudioFFmpeg::GetStreamInfo(std::string& strInfo)
 {
@@ -214,6 +218,13 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_ioContext = NULL;
   for (int i = 0; i < MAX_STREAMS; i++) m_streams[i] = NULL;
   m_iCurrentPts = DVD_NOPTS_VALUE;
+  m_iKeyframeStream = -1;
+  m_fLastKeyframe = DVD_NOPTS_VALUE;
+  m_bKeyframeIndexJob = true;
+  m_iKeyframeIndexJob = 0;
+  m_iOpenStart = 0;
+  m_bProbeCached = false;
+  m_bFirstPacket = false;
 }
 
 CDVDDemuxFFmpeg::~CDVDDemuxFFmpeg()
@@ -255,6 +266,17 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
 
+  // what was found out about the file the last time it was opened
+  unsigned int openStart = XbmcThreads::SystemClockMillis();
+  std::string probeKey;
+  CDVDDemuxProbeCache::ProbeInfo probeInfo;
+  bool probeCached = false;
+  if (g_advancedSettings.m_videoProbeCache)
+  {
+    probeKey = CDVDDemuxProbeCache::GetKey(m_pInput);
+    probeCached = !probeKey.empty() && CDVDDemuxProbeCache::Get().Lookup(probeKey, probeInfo);
+  }
+
   if( m_pInput->GetContent().length() > 0 )
   {
     std::string content = m_pInput->GetContent();
@@ -308,6 +330,15 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->Seek(0, SEEK_POSSIBLE) == 0)
       m_ioContext->seekable = 0;
 
+    if( iformat == NULL && probeCached )
+    {
+      iformat = m_dllAvFormat.av_find_input_format(probeInfo.format.c_str());
+      if (iformat)
+        CLog::Log(LOGDEBUG, "%s - using cached format [%s]", __FUNCTION__, probeInfo.format.c_str());
+      else
+        probeCached = false;
+    }
+
     if( iformat == NULL )
     {
       // let ffmpeg decide which demuxer we have to open
@@ -441,22 +472,30 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       m_pFormatContext->max_analyze_duration = 500000;
 
 
-    CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
-    int iErr = m_dllAvFormat.avformat_find_stream_info(m_pFormatContext, NULL);
-    if (iErr < 0)
+    if (probeCached && CDVDDemuxProbeCache::Apply(probeInfo, m_pFormatContext, m_dllAvUtil))
+      CLog::Log(LOGDEBUG, "%s - using cached stream info", __FUNCTION__);
+    else
     {
-      CLog::Log(LOGWARNING,"could not find codec parameters for %s", strFile.c_str());
-      if (m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD) || (m_pFormatContext->nb_streams == 1 && m_pFormatContext->streams[0]->codec->codec_id == CODEC_ID_AC3))
+      probeCached = false;
+      CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
+      int iErr = m_dllAvFormat.avformat_find_stream_info(m_pFormatContext, NULL);
+      if (iErr < 0)
       {
-        // special case, our codecs can still handle it.
+        CLog::Log(LOGWARNING,"could not find codec parameters for %s", strFile.c_str());
+        if (m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD) || (m_pFormatContext->nb_streams == 1 && m_pFormatContext->streams[0]->codec->codec_id == CODEC_ID_AC3))
+        {
+          // special case, our codecs can still handle it.
+        }
+        else
+        {
+          Dispose();
+          return false;
+        }
       }
       else
-      {
-        Dispose();
-        return false;
-      }
+        CDVDDemuxProbeCache::Get().Store(probeKey, m_pFormatContext);
+      CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
     }
-    CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
   }
   // reset any timeout
   m_timeout.SetInfinite();
@@ -469,6 +508,16 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   UpdateCurrentPTS();
 
+  unsigned int probeHits = 0, probeLookups = 0;
+  CDVDDemuxProbeCache::Get().GetStats(probeHits, probeLookups);
+  CLog::Log(LOGDEBUG, "%s - opened %s in %u ms (%s stream info, probe cache hits %u/%u)", __FUNCTION__, strFile.c_str(),
+            XbmcThreads::SystemClockMillis() - openStart, probeCached ? "cached" : "probed", probeHits, probeLookups);
+
+  // the time to the first frame is logged on the first packet read
+  m_iOpenStart   = openStart;
+  m_bProbeCached = probeCached;
+  m_bFirstPacket = true;
+
   // add the ffmpeg streams to our own stream array
   if (m_pFormatContext->nb_programs)
   {
@@ -495,13 +544,134 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       AddStream(i);
   }
 
+  OpenKeyframeIndex();
+
   return true;
 }
 
+/*!
+ \brief Indexes the keyframes of a file with a demuxer of its own
+ */
+class CDVDDemuxFFmpegKeyframeIndexJob : public CDVDDemuxKeyframeIndexJob
+{
+public:
+  CDVDDemuxFFmpegKeyframeIndexJob(const std::string& strFile, const boost::shared_ptr<CEvent>& cancelled, int64_t iRate)
+    : CDVDDemuxKeyframeIndexJob(strFile, cancelled, iRate)
+  {
+    m_pInputStream = NULL;
+    m_pDemuxer = NULL;
+  }
+
+  virtual ~CDVDDemuxFFmpegKeyframeIndexJob()
+  {
+    Close();
+  }
+
+protected:
+  virtual int64_t Open()
+  {
+    m_pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, m_strFile, "");
+    if (!m_pInputStream || !m_pInputStream->IsStreamType(DVDSTREAM_TYPE_FILE) || !m_pInputStream->Open(m_strFile.c_str(), ""))
+      return 0;
+
+    m_pDemuxer = new CDVDDemuxFFmpeg();
+    m_pDemuxer->SetKeyframeIndexJob(false);
+    if (!m_pDemuxer->Open(m_pInputStream))
+      return 0;
+
+    return m_pInputStream->GetLength();
+  }
+
+  virtual bool Read()
+  {
+    DemuxPacket* pPacket = m_pDemuxer->Read();
+    if (!pPacket)
+      return false;
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+    return true;
+  }
+
+  virtual void SeekByte(int64_t pos)
+  {
+    m_pDemuxer->SeekByte(pos);
+  }
+
+  virtual int64_t GetPosition()
+  {
+    return m_pInputStream->Seek(0, SEEK_CUR);
+  }
+
+  virtual bool IsEOF()
+  {
+    return m_pInputStream->IsEOF();
+  }
+
+  virtual void Close()
+  {
+    delete m_pDemuxer;
+    m_pDemuxer = NULL;
+    delete m_pInputStream;
+    m_pInputStream = NULL;
+  }
+
+private:
+  CDVDInputStream* m_pInputStream;
+  CDVDDemuxFFmpeg* m_pDemuxer;
+};
+
+void CDVDDemuxFFmpeg::OpenKeyframeIndex()
+{
+  m_keyframeIndex.reset();
+  m_iKeyframeStream = -1;
+  m_fLastKeyframe = DVD_NOPTS_VALUE;
+
+  // the demuxer has to be able to start reading at any byte offset
+  if (!m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) || !m_pFormatContext->iformat || !m_pFormatContext->iformat->name)
+    return;
+  std::string format = m_pFormatContext->iformat->name;
+  if (format != "mpegts" && format != "mpeg")
+    return;
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams && i < MAX_STREAMS; i++)
+  {
+    if (m_streams[i] && m_streams[i]->type == STREAM_VIDEO)
+    {
+      m_iKeyframeStream = i;
+      break;
+    }
+  }
+
+  int64_t iLength = m_pInput->GetLength();
+  if (m_iKeyframeStream < 0 || iLength <= 0)
+    return;
+
+  m_keyframeIndex = CDVDDemuxKeyframeIndex::Get(m_pInput->GetFileName(), iLength);
+  if (m_bKeyframeIndexJob && g_advancedSettings.m_videoKeyframeIndexRate > 0 && !m_keyframeIndex->IsComplete())
+  {
+    m_keyframeIndexCancel.reset(new CEvent(true));
+    int64_t iRate = (int64_t)g_advancedSettings.m_videoKeyframeIndexRate * 1024;
+    m_iKeyframeIndexJob = CJobManager::GetInstance().AddJob(new CDVDDemuxFFmpegKeyframeIndexJob(m_pInput->GetFileName(), m_keyframeIndexCancel, iRate), NULL, CJob::PRIORITY_LOW);
+  }
+}
+
 void CDVDDemuxFFmpeg::Dispose()
 {
   g_demuxer.set(this);
 
+  if (m_iKeyframeIndexJob)
+  {
+    // CancelJob() only removes a job that hasn't started yet
+    m_keyframeIndexCancel->Set();
+    CJobManager::GetInstance().CancelJob(m_iKeyframeIndexJob);
+    m_iKeyframeIndexJob = 0;
+    m_keyframeIndexCancel.reset();
+  }
+  if (m_keyframeIndex)
+  {
+    m_keyframeIndex->Save();
+    m_keyframeIndex.reset();
+  }
+
   if (m_pFormatContext)
   {
     if (m_ioContext && m_pFormatContext->pb && m_pFormatContext->pb != m_ioContext)
@@ -555,6 +725,7 @@ void CDVDDemuxFFmpeg::Flush()
     m_dllAvFormat.av_read_frame_flush(m_pFormatContext);
 
   m_iCurrentPts = DVD_NOPTS_VALUE;
+  m_fLastKeyframe = DVD_NOPTS_VALUE;
 }
 
 void CDVDDemuxFFmpeg::Abort()
@@ -753,6 +924,18 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
         if (pPacket->dts != DVD_NOPTS_VALUE && (pPacket->dts > m_iCurrentPts || m_iCurrentPts == DVD_NOPTS_VALUE))
           m_iCurrentPts = pPacket->dts;
 
+        if (m_keyframeIndex && pkt.stream_index == m_iKeyframeStream && (pkt.flags & AV_PKT_FLAG_KEY) && pkt.pos >= 0)
+        {
+          CDVDDemuxKeyframeIndex::Keyframe keyframe;
+          keyframe.pts = pPacket->pts != DVD_NOPTS_VALUE ? pPacket->pts : pPacket->dts;
+          keyframe.pos = pkt.pos;
+          if (keyframe.pts != DVD_NOPTS_VALUE)
+          {
+            m_keyframeIndex->Add(keyframe, m_fLastKeyframe);
+            m_fLastKeyframe = keyframe.pts;
+          }
+        }
+
 
         // check if stream has passed full duration, needed for live streams
         if(pkt.dts != (int64_t)AV_NOPTS_VALUE)
@@ -783,6 +966,15 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
 
   if (!pPacket) return NULL;
 
+  if (m_bFirstPacket && pPacket->iSize > 0)
+  {
+    m_bFirstPacket = false;
+    unsigned int probeHits = 0, probeLookups = 0;
+    CDVDDemuxProbeCache::Get().GetStats(probeHits, probeLookups);
+    CLog::Log(LOGDEBUG, "%s - first frame of %s after %u ms (%s stream info, probe cache hits %u/%u)", __FUNCTION__, m_pInput->GetFileName().c_str(),
+              XbmcThreads::SystemClockMillis() - m_iOpenStart, m_bProbeCached ? "cached" : "probed", probeHits, probeLookups);
+  }
+
   // check streams, can we make this a bit more simple?
   if (pPacket && pPacket->iStreamId >= 0 && pPacket->iStreamId <= MAX_STREAMS)
   {
@@ -851,7 +1043,18 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
   if (m_pFormatContext->start_time != (int64_t)AV_NOPTS_VALUE)
     seek_pts += m_pFormatContext->start_time;
 
-  int ret;
+  int ret = -1;
+  CDVDDemuxKeyframeIndex::Keyframe keyframe;
+  if (m_keyframeIndex && m_keyframeIndex->Find(DVD_MSEC_TO_TIME(time), backwords, keyframe))
+  { // go straight to the keyframe instead of having the demuxer search for it
+    CSingleLock lock(m_critSection);
+    ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, keyframe.pos, AVSEEK_FLAG_BYTE);
+
+    if(ret >= 0)
+      m_iCurrentPts = keyframe.pts;
+  }
+
+  if (ret < 0)
   {
     CSingleLock lock(m_critSection);
     ret = m_dllAvFormat.av_seek_frame(m_pFormatContext, -1, seek_pts, backwords ? AVSEEK_FLAG_BACKWARD : 0);
@@ -859,6 +1062,7 @@ bool CDVDDemuxFFmpeg::SeekTime(int time, bool backwords, double *startpts)
     if(ret >= 0)
       UpdateCurrentPTS();
   }
+  m_fLastKeyframe = DVD_NOPTS_VALUE;
 
   if(m_iCurrentPts == DVD_NOPTS_VALUE)
     CLog::Log(LOGDEBUG, "%s - unknown position after seek", __FUNCTION__);
@@ -886,6 +1090,12 @@ bool CDVDDemuxFFmpeg::SeekByte(int64_t pos)
   if(ret >= 0)
     UpdateCurrentPTS();
 
+  // the demuxer usually doesn't know the time after a byte seek
+  CDVDDemuxKeyframeIndex::Keyframe keyframe;
+  if (ret >= 0 && m_iCurrentPts == DVD_NOPTS_VALUE && m_keyframeIndex && m_keyframeIndex->FindByPosition(pos, keyframe))
+    m_iCurrentPts = keyframe.pts;
+  m_fLastKeyframe = DVD_NOPTS_VALUE;
+
   return (ret >= 0);
 }
 
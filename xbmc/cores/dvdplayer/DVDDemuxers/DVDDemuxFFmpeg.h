@@ -29,7 +29,11 @@
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
 
+#include <boost/shared_ptr.hpp>
+
 class CDVDDemuxFFmpeg;
+class CDVDDemuxKeyframeIndex;
+class CEvent;
 
 class CDemuxStreamVideoFFmpeg
   : public CDemuxStreamVideo
@@ -111,6 +115,11 @@ public:
 
   bool Aborted();
 
+  /*!
+   \brief Whether a background job may be started to complete the keyframe index of the file
+   */
+  void SetKeyframeIndexJob(bool bEnable) { m_bKeyframeIndexJob = bEnable; }
+
   AVFormatContext* m_pFormatContext;
 
 protected:
@@ -123,6 +132,7 @@ protected:
 
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
+  void OpenKeyframeIndex();
 
   CCriticalSection m_critSection;
   #define MAX_STREAMS 100
@@ -141,6 +151,17 @@ protected:
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
 
+  boost::shared_ptr<CDVDDemuxKeyframeIndex> m_keyframeIndex;
+  int          m_iKeyframeStream;    // stream the keyframes are indexed of
+  double       m_fLastKeyframe;      // pts of the last keyframe read since the last seek
+  bool         m_bKeyframeIndexJob;
+  unsigned int m_iKeyframeIndexJob;
+  boost::shared_ptr<CEvent> m_keyframeIndexCancel; // set to stop the job once it runs
+
+  unsigned int m_iOpenStart;         // when Open() started, to log the time to the first frame
+  bool         m_bProbeCached;       // whether the stream info came from the probe cache
+  bool         m_bFirstPacket;       // whether the first packet still has to be logged
+
   CDVDInputStream* m_pInput;
 };
 
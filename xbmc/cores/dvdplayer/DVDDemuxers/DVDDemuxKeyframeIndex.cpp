@@ -0,0 +1,388 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDDemuxKeyframeIndex.h"
+#include "DVDClock.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <map>
+#include <boost/weak_ptr.hpp>
+
+using namespace std;
+using namespace XFILE;
+
+#define KEYFRAMEINDEX_FOLDER  "special://temp/keyframes/"
+#define KEYFRAMEINDEX_MAGIC   0x49424b58 // "XKBI"
+#define KEYFRAMEINDEX_VERSION 2
+
+// keyframes further apart than this are a timestamp discontinuity, not a gap in the index
+#define KEYFRAMEINDEX_MAX_GAP DVD_SEC_TO_TIME(60)
+
+typedef map<string, boost::weak_ptr<CDVDDemuxKeyframeIndex> > KeyframeIndexMap;
+
+static CCriticalSection g_keyframeIndexSection;
+static KeyframeIndexMap g_keyframeIndexes;
+
+/*!
+ \brief Whether the file an index was made of was replaced since
+ \param iIndexLength, iIndexMtime size and modification time of the file when it was indexed
+ \param bComplete whether the whole file was indexed
+ \param iLength, iMtime size and modification time of the file now
+ */
+static bool IsReplaced(int64_t iIndexLength, int64_t iIndexMtime, bool bComplete, int64_t iLength, int64_t iMtime)
+{
+  // a file that got smaller was replaced, one that got larger is still being recorded unless it was
+  // complete. A file that was modified without growing was replaced by one of the same size
+  if (iLength < iIndexLength || (iLength > iIndexLength && bComplete))
+    return true;
+  return iLength == iIndexLength && iMtime != iIndexMtime;
+}
+
+static bool SortByPts(const CDVDDemuxKeyframeIndex::Keyframe& left, const CDVDDemuxKeyframeIndex::Keyframe& right)
+{
+  return left.pts < right.pts;
+}
+
+static bool SortByPos(const CDVDDemuxKeyframeIndex::Keyframe& left, const CDVDDemuxKeyframeIndex::Keyframe& right)
+{
+  return left.pos < right.pos;
+}
+
+boost::shared_ptr<CDVDDemuxKeyframeIndex> CDVDDemuxKeyframeIndex::Get(const string& strFile, int64_t iLength)
+{
+  struct __stat64 st;
+  int64_t iMtime = 0;
+  if (CFile::Stat(strFile, &st) == 0)
+    iMtime = st.st_mtime;
+
+  CSingleLock lock(g_keyframeIndexSection);
+  boost::shared_ptr<CDVDDemuxKeyframeIndex> index;
+  KeyframeIndexMap::iterator it = g_keyframeIndexes.find(strFile);
+  if (it != g_keyframeIndexes.end())
+    index = it->second.lock();
+
+  if (index && IsReplaced(index->m_iLength, index->m_iMtime, index->IsComplete(), iLength, iMtime))
+    index.reset();
+
+  if (!index)
+  {
+    index.reset(new CDVDDemuxKeyframeIndex(strFile, iLength, iMtime));
+    index->Load();
+    g_keyframeIndexes[strFile] = index;
+  }
+  else if (index->m_iLength < iLength)
+  { // a recording that is still growing
+    CSingleLock indexLock(index->m_critSection);
+    index->m_iLength = iLength;
+    index->m_iMtime = iMtime;
+    index->m_bComplete = false;
+  }
+
+  return index;
+}
+
+CDVDDemuxKeyframeIndex::CDVDDemuxKeyframeIndex(const string& strFile, int64_t iLength, int64_t iMtime)
+  : m_strFile(strFile), m_iLength(iLength), m_iMtime(iMtime)
+{
+  m_bComplete = false;
+  m_bChanged  = false;
+}
+
+CDVDDemuxKeyframeIndex::~CDVDDemuxKeyframeIndex()
+{
+  CSingleLock lock(g_keyframeIndexSection);
+  KeyframeIndexMap::iterator it = g_keyframeIndexes.find(m_strFile);
+  if (it != g_keyframeIndexes.end() && it->second.expired())
+    g_keyframeIndexes.erase(it);
+}
+
+void CDVDDemuxKeyframeIndex::Add(const Keyframe& keyframe, double previous)
+{
+  CSingleLock lock(m_critSection);
+
+  vector<Keyframe>::iterator it = m_keyframes.end();
+  if (!m_keyframes.empty() && m_keyframes.back().pts >= keyframe.pts)
+    it = lower_bound(m_keyframes.begin(), m_keyframes.end(), keyframe, SortByPts);
+
+  if (it == m_keyframes.end() || it->pts != keyframe.pts)
+  {
+    m_keyframes.insert(it, keyframe);
+    if (!m_positions.empty() && m_positions.back().pos >= keyframe.pos)
+      m_positions.insert(lower_bound(m_positions.begin(), m_positions.end(), keyframe, SortByPos), keyframe);
+    else
+      m_positions.push_back(keyframe);
+    m_bChanged = true;
+  }
+
+  if (previous == DVD_NOPTS_VALUE || previous > keyframe.pts || keyframe.pts - previous > KEYFRAMEINDEX_MAX_GAP)
+    previous = keyframe.pts;
+  AddRange(previous, keyframe.pts);
+}
+
+void CDVDDemuxKeyframeIndex::AddRange(double start, double end)
+{
+  // first range that ends at or after start
+  vector<Range>::iterator it = m_ranges.begin();
+  while (it != m_ranges.end() && it->end < start)
+    ++it;
+
+  if (it != m_ranges.end() && it->start <= start && it->end >= end)
+    return;
+
+  Range range = { start, end };
+  while (it != m_ranges.end() && it->start <= end)
+  {
+    range.start = std::min(range.start, it->start);
+    range.end   = std::max(range.end, it->end);
+    it = m_ranges.erase(it);
+  }
+  m_ranges.insert(it, range);
+  m_bChanged = true;
+}
+
+bool CDVDDemuxKeyframeIndex::Find(double pts, bool backwards, Keyframe& keyframe) const
+{
+  CSingleLock lock(m_critSection);
+
+  vector<Range>::const_iterator range = m_ranges.begin();
+  while (range != m_ranges.end() && range->end < pts)
+    ++range;
+  if (range == m_ranges.end() || range->start > pts)
+    return false;
+
+  Keyframe key;
+  key.pts = pts;
+  key.pos = 0;
+  if (backwards)
+  {
+    vector<Keyframe>::const_iterator it = upper_bound(m_keyframes.begin(), m_keyframes.end(), key, SortByPts);
+    if (it == m_keyframes.begin())
+      return false;
+    keyframe = *(--it);
+  }
+  else
+  {
+    vector<Keyframe>::const_iterator it = lower_bound(m_keyframes.begin(), m_keyframes.end(), key, SortByPts);
+    if (it == m_keyframes.end() || it->pts > range->end)
+      return false;
+    keyframe = *it;
+  }
+  return true;
+}
+
+bool CDVDDemuxKeyframeIndex::FindByPosition(int64_t pos, Keyframe& keyframe) const
+{
+  CSingleLock lock(m_critSection);
+
+  Keyframe key;
+  key.pts = 0.0;
+  key.pos = pos;
+  vector<Keyframe>::const_iterator it = lower_bound(m_positions.begin(), m_positions.end(), key, SortByPos);
+  if (it == m_positions.end())
+    return false;
+
+  keyframe = *it;
+  return true;
+}
+
+bool CDVDDemuxKeyframeIndex::GetEndOfFirstRange(Keyframe& keyframe) const
+{
+  CSingleLock lock(m_critSection);
+  if (m_ranges.empty() || m_keyframes.empty() || m_ranges[0].start > m_keyframes[0].pts || m_ranges[0].start > DVD_TIME_BASE)
+    return false;
+
+  Keyframe key;
+  key.pts = m_ranges[0].end;
+  key.pos = 0;
+  vector<Keyframe>::const_iterator it = upper_bound(m_keyframes.begin(), m_keyframes.end(), key, SortByPts);
+  keyframe = *(--it);
+  return true;
+}
+
+bool CDVDDemuxKeyframeIndex::IsComplete() const
+{
+  CSingleLock lock(m_critSection);
+  return m_bComplete;
+}
+
+void CDVDDemuxKeyframeIndex::SetComplete()
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bComplete)
+  {
+    m_bComplete = true;
+    m_bChanged = true;
+  }
+}
+
+string CDVDDemuxKeyframeIndex::GetCacheFile() const
+{
+  Crc32 crc;
+  crc.Compute(m_strFile.c_str(), m_strFile.size());
+  CStdString strFile;
+  strFile.Format(KEYFRAMEINDEX_FOLDER "%08x.idx", (unsigned int)crc);
+  return strFile;
+}
+
+bool CDVDDemuxKeyframeIndex::Load()
+{
+  CFile file;
+  if (!file.Open(GetCacheFile()))
+    return false;
+
+  uint32_t header[2];
+  int64_t stamp[2]; // length, modification time
+  uint32_t counts[4]; // path length, complete, keyframes, ranges
+  if (file.Read(header, sizeof(header)) != sizeof(header) || header[0] != KEYFRAMEINDEX_MAGIC || header[1] != KEYFRAMEINDEX_VERSION ||
+      file.Read(stamp, sizeof(stamp)) != sizeof(stamp) ||
+      file.Read(counts, sizeof(counts)) != sizeof(counts) || counts[0] != m_strFile.size())
+    return false;
+
+  string strFile(counts[0], '\0');
+  if (counts[0] && file.Read(&strFile[0], counts[0]) != counts[0])
+    return false;
+
+  if (strFile != m_strFile || IsReplaced(stamp[0], stamp[1], counts[1] != 0, m_iLength, m_iMtime))
+    return false;
+
+  vector<Keyframe> keyframes(counts[2]);
+  vector<Range> ranges(counts[3]);
+  if ((counts[2] && file.Read(&keyframes[0], counts[2] * sizeof(Keyframe)) != counts[2] * sizeof(Keyframe)) ||
+      (counts[3] && file.Read(&ranges[0], counts[3] * sizeof(Range)) != counts[3] * sizeof(Range)))
+    return false;
+
+  // keyframes are sorted by time, which doesn't have to be the order they are stored in
+  vector<Keyframe> positions(keyframes);
+  sort(positions.begin(), positions.end(), SortByPos);
+
+  CSingleLock lock(m_critSection);
+  m_keyframes.swap(keyframes);
+  m_positions.swap(positions);
+  m_ranges.swap(ranges);
+  m_bComplete = counts[1] && stamp[0] == m_iLength;
+  m_bChanged = false;
+
+  CLog::Log(LOGDEBUG, "%s - loaded %u keyframes of %s", __FUNCTION__, (unsigned int)m_keyframes.size(), m_strFile.c_str());
+  return true;
+}
+
+void CDVDDemuxKeyframeIndex::Save()
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bChanged || m_keyframes.empty())
+    return;
+
+  if (!CDirectory::Exists(KEYFRAMEINDEX_FOLDER))
+    CDirectory::Create(KEYFRAMEINDEX_FOLDER);
+
+  CFile file;
+  if (!file.OpenForWrite(GetCacheFile(), true))
+  {
+    CLog::Log(LOGWARNING, "%s - unable to save keyframe index of %s", __FUNCTION__, m_strFile.c_str());
+    return;
+  }
+
+  uint32_t header[2] = { KEYFRAMEINDEX_MAGIC, KEYFRAMEINDEX_VERSION };
+  int64_t stamp[2] = { m_iLength, m_iMtime };
+  uint32_t counts[4] = { (uint32_t)m_strFile.size(), m_bComplete ? 1 : 0, (uint32_t)m_keyframes.size(), (uint32_t)m_ranges.size() };
+  file.Write(header, sizeof(header));
+  file.Write(stamp, sizeof(stamp));
+  file.Write(counts, sizeof(counts));
+  file.Write(m_strFile.c_str(), m_strFile.size());
+  file.Write(&m_keyframes[0], m_keyframes.size() * sizeof(Keyframe));
+  if (!m_ranges.empty())
+    file.Write(&m_ranges[0], m_ranges.size() * sizeof(Range));
+  file.Close();
+
+  m_bChanged = false;
+}
+
+CDVDDemuxKeyframeIndexJob::CDVDDemuxKeyframeIndexJob(const string& strFile, const boost::shared_ptr<CEvent>& cancelled, int64_t iRate)
+  : m_strFile(strFile), m_cancelled(cancelled), m_iRate(iRate)
+{
+}
+
+bool CDVDDemuxKeyframeIndexJob::operator==(const CJob *job) const
+{
+  if (strcmp(job->GetType(), GetType()) == 0)
+  {
+    const CDVDDemuxKeyframeIndexJob* indexJob = dynamic_cast<const CDVDDemuxKeyframeIndexJob*>(job);
+    if (indexJob && indexJob->m_strFile == m_strFile)
+      return true;
+  }
+  return false;
+}
+
+bool CDVDDemuxKeyframeIndexJob::DoWork()
+{
+  int64_t iLength = Open();
+  if (iLength <= 0)
+  {
+    Close();
+    return false;
+  }
+
+  boost::shared_ptr<CDVDDemuxKeyframeIndex> index = CDVDDemuxKeyframeIndex::Get(m_strFile, iLength);
+
+  // continue where the index ends
+  CDVDDemuxKeyframeIndex::Keyframe keyframe;
+  if (index->GetEndOfFirstRange(keyframe))
+    SeekByte(keyframe.pos);
+
+  CLog::Log(LOGDEBUG, "%s - indexing %s", __FUNCTION__, m_strFile.c_str());
+
+  int64_t iStartPos = GetPosition();
+  unsigned int iStartTime = XbmcThreads::SystemClockMillis();
+  bool bCancelled = false;
+  for (unsigned int iPackets = 0; ; iPackets++)
+  {
+    if (!Read())
+      break;
+
+    if (iPackets % 256)
+      continue;
+
+    // don't take the bandwidth away from playback
+    int64_t iPos = GetPosition();
+    unsigned int iElapsed  = XbmcThreads::SystemClockMillis() - iStartTime;
+    unsigned int iExpected = (unsigned int)((iPos - iStartPos) * 1000 / m_iRate);
+    if (m_cancelled->WaitMSec(iExpected > iElapsed ? iExpected - iElapsed : 0))
+    {
+      bCancelled = true;
+      break;
+    }
+  }
+
+  if (!bCancelled && IsEOF())
+    index->SetComplete();
+
+  Close();
+  index->Save();
+
+  CLog::Log(LOGDEBUG, "%s - %s indexing %s", __FUNCTION__, bCancelled ? "cancelled" : "finished", m_strFile.c_str());
+  return !bCancelled;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
+
+/*!
+ \brief Positions of the video keyframes of a file, by time.
+
+ Keyframes are added while a file is demuxed. As long as the demuxer reads
+ sequentially, no keyframe between two added ones can have been missed, so
+ the time between them is covered by the index. A seek to a covered time
+ goes straight to the byte offset of the keyframe, without the container
+ having to bisect the file.
+
+ The index of a file is shared by everyone who demuxes it, and is saved to
+ special://temp/keyframes/ so it is there again when the file is played
+ the next time.
+ */
+class CDVDDemuxKeyframeIndex
+{
+public:
+  struct Keyframe
+  {
+    double  pts; ///< in DVD_TIME_BASE, relative to the start of the file
+    int64_t pos; ///< byte offset of the packet
+  };
+
+  /*!
+   \brief Get the index of a file, loading it from disk if it was saved before
+   \param strFile path of the file
+   \param iLength size of the file, a saved index is discarded if the file got smaller
+   or was modified without growing
+   */
+  static boost::shared_ptr<CDVDDemuxKeyframeIndex> Get(const std::string& strFile, int64_t iLength);
+
+  ~CDVDDemuxKeyframeIndex();
+
+  /*!
+   \brief Add a keyframe
+   \param keyframe the keyframe
+   \param previous pts of the keyframe read before it, DVD_NOPTS_VALUE if the
+   demuxer didn't read sequentially up to this keyframe
+   */
+  void Add(const Keyframe& keyframe, double previous);
+
+  /*!
+   \brief Find the keyframe to seek to
+   \param pts the time to seek to
+   \param backwards true to find the last keyframe at or before pts, false
+   to find the first one at or after pts
+   \param keyframe the keyframe that was found
+   \return false if the index doesn't cover pts
+   */
+  bool Find(double pts, bool backwards, Keyframe& keyframe) const;
+
+  /*!
+   \brief Find the first keyframe at or after a byte offset
+   */
+  bool FindByPosition(int64_t pos, Keyframe& keyframe) const;
+
+  /*!
+   \brief Get the last keyframe of the covered range that starts at the beginning of the file
+   \return false if the beginning of the file isn't covered
+   */
+  bool GetEndOfFirstRange(Keyframe& keyframe) const;
+
+  /*!
+   \brief Whether the whole file is covered
+   */
+  bool IsComplete() const;
+  void SetComplete();
+
+  /*!
+   \brief Save the index if keyframes were added since it was loaded
+   */
+  void Save();
+
+private:
+  struct Range
+  {
+    double start;
+    double end;
+  };
+
+  CDVDDemuxKeyframeIndex(const std::string& strFile, int64_t iLength, int64_t iMtime);
+  void AddRange(double start, double end);
+  bool Load();
+  std::string GetCacheFile() const;
+
+  std::string           m_strFile;
+  int64_t               m_iLength;
+  int64_t               m_iMtime;    ///< modification time of the file, 0 if it's unknown
+  std::vector<Keyframe> m_keyframes; ///< sorted by pts
+  std::vector<Keyframe> m_positions; ///< the same keyframes sorted by pos
+  std::vector<Range>    m_ranges;    ///< covered ranges, sorted and not overlapping
+  bool                  m_bComplete;
+  bool                  m_bChanged;
+  CCriticalSection      m_critSection;
+};
+
+/*!
+ \brief Demuxes a file in the background to fill its keyframe index
+
+ The job is cancelled by setting the event it was created with, a job that
+ is already running doesn't notice CJobManager::CancelJob(). A subclass
+ opens the file with a demuxer that adds the keyframes it reads to the index.
+ The file is read no faster than the rate the job was created with, so it
+ doesn't compete with the playback of the file for the bandwidth.
+ */
+class CDVDDemuxKeyframeIndexJob : public CJob
+{
+public:
+  /*!
+   \param iRate maximum rate the file is read at, in bytes per second
+   */
+  CDVDDemuxKeyframeIndexJob(const std::string& strFile, const boost::shared_ptr<CEvent>& cancelled, int64_t iRate);
+
+  virtual const char *GetType() const { return "keyframeindex"; }
+  virtual bool operator==(const CJob *job) const;
+  virtual bool DoWork();
+
+protected:
+  /*!
+   \brief Open the file and the demuxer
+   \return size of the file, 0 if it can't be demuxed
+   */
+  virtual int64_t Open() = 0;
+
+  /*!
+   \brief Demux the next packet
+   \return false at the end of the file or on an error
+   */
+  virtual bool Read() = 0;
+
+  virtual void SeekByte(int64_t pos) = 0;
+
+  /*!
+   \brief Byte offset the file is read at
+   */
+  virtual int64_t GetPosition() = 0;
+
+  virtual bool IsEOF() = 0;
+  virtual void Close() = 0;
+
+  std::string m_strFile;
+
+private:
+  boost::shared_ptr<CEvent> m_cancelled;
+  int64_t                   m_iRate;
+};
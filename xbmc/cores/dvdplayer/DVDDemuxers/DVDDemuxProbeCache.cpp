@@ -0,0 +1,206 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDDemuxProbeCache.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/StdString.h"
+
+using namespace std;
+
+// number of files the stream info is kept of
+#define PROBECACHE_SIZE 256
+
+CDVDDemuxProbeCache& CDVDDemuxProbeCache::Get()
+{
+  static CDVDDemuxProbeCache cache;
+  return cache;
+}
+
+string CDVDDemuxProbeCache::GetKey(CDVDInputStream* pInput)
+{
+  if (!pInput || !pInput->IsStreamType(DVDSTREAM_TYPE_FILE))
+    return "";
+
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(pInput->GetFileName(), &st) != 0 || st.st_size <= 0)
+    return "";
+
+  CStdString strKey;
+  strKey.Format("%s|%"PRId64"|%"PRId64"|%s", pInput->GetFileName().c_str(), (int64_t)st.st_size, (int64_t)st.st_mtime, pInput->GetContent().c_str());
+  return strKey;
+}
+
+bool CDVDDemuxProbeCache::Lookup(const string& strKey, ProbeInfo& info)
+{
+  CSingleLock lock(m_critSection);
+  m_lookups++;
+  map<string, CacheEntry>::iterator it = m_cache.find(strKey);
+  if (it == m_cache.end())
+    return false;
+
+  m_hits++;
+  m_order.splice(m_order.begin(), m_order, it->second.order);
+  info = it->second.info;
+  return true;
+}
+
+void CDVDDemuxProbeCache::GetStats(unsigned int& hits, unsigned int& lookups)
+{
+  CSingleLock lock(m_critSection);
+  hits    = m_hits;
+  lookups = m_lookups;
+}
+
+void CDVDDemuxProbeCache::Store(const string& strKey, const AVFormatContext* pFormatContext)
+{
+  if (strKey.empty() || !pFormatContext->iformat || !pFormatContext->iformat->name)
+    return;
+
+  ProbeInfo info;
+  info.format     = pFormatContext->iformat->name;
+  info.start_time = pFormatContext->start_time;
+  info.duration   = pFormatContext->duration;
+  info.bit_rate   = pFormatContext->bit_rate;
+
+  for (unsigned int i = 0; i < pFormatContext->nb_streams; i++)
+  {
+    const AVStream* pStream = pFormatContext->streams[i];
+    const AVCodecContext* pCodec = pStream->codec;
+
+    StreamInfo stream;
+    stream.id                    = pStream->id;
+    stream.codec_type            = pCodec->codec_type;
+    stream.codec_id              = pCodec->codec_id;
+    stream.codec_tag             = pCodec->codec_tag;
+    if (pCodec->extradata && pCodec->extradata_size > 0)
+      stream.extradata.assign((const char*)pCodec->extradata, pCodec->extradata_size);
+    stream.time_base             = pCodec->time_base;
+    stream.width                 = pCodec->width;
+    stream.height                = pCodec->height;
+    stream.sample_aspect_ratio   = pCodec->sample_aspect_ratio;
+    stream.pix_fmt               = pCodec->pix_fmt;
+    stream.profile               = pCodec->profile;
+    stream.level                 = pCodec->level;
+    stream.channels              = pCodec->channels;
+    stream.sample_rate           = pCodec->sample_rate;
+    stream.sample_fmt            = pCodec->sample_fmt;
+    stream.channel_layout        = pCodec->channel_layout;
+    stream.block_align           = pCodec->block_align;
+    stream.bit_rate              = pCodec->bit_rate;
+    stream.bits_per_coded_sample = pCodec->bits_per_coded_sample;
+    stream.r_frame_rate          = pStream->r_frame_rate;
+    stream.avg_frame_rate        = pStream->avg_frame_rate;
+    stream.codec_info_nb_frames  = pStream->codec_info_nb_frames;
+    stream.has_b_frames          = pCodec->has_b_frames;
+    stream.ticks_per_frame       = pCodec->ticks_per_frame;
+    stream.need_parsing          = pStream->need_parsing;
+    stream.start_time            = pStream->start_time;
+    stream.duration              = pStream->duration;
+    info.streams.push_back(stream);
+  }
+
+  CSingleLock lock(m_critSection);
+  map<string, CacheEntry>::iterator it = m_cache.find(strKey);
+  if (it != m_cache.end())
+  {
+    m_order.splice(m_order.begin(), m_order, it->second.order);
+    it->second.info = info;
+    return;
+  }
+
+  if (m_cache.size() >= PROBECACHE_SIZE)
+  { // drop the entry that was used the longest time ago
+    m_cache.erase(m_order.back());
+    m_order.pop_back();
+  }
+  m_order.push_front(strKey);
+  CacheEntry& entry = m_cache[strKey];
+  entry.info  = info;
+  entry.order = m_order.begin();
+}
+
+bool CDVDDemuxProbeCache::Apply(const ProbeInfo& info, AVFormatContext* pFormatContext, DllAvUtil& dllAvUtil)
+{
+  if (pFormatContext->nb_streams != info.streams.size())
+    return false;
+
+  // the demuxer has to have found the same streams again
+  for (unsigned int i = 0; i < pFormatContext->nb_streams; i++)
+  {
+    const AVCodecContext* pCodec = pFormatContext->streams[i]->codec;
+    const StreamInfo& stream = info.streams[i];
+    if (pFormatContext->streams[i]->id != stream.id ||
+        (pCodec->codec_type != AVMEDIA_TYPE_UNKNOWN && pCodec->codec_type != stream.codec_type) ||
+        (pCodec->codec_id != CODEC_ID_NONE && pCodec->codec_id != CODEC_ID_PROBE && pCodec->codec_id != stream.codec_id))
+      return false;
+  }
+
+  for (unsigned int i = 0; i < pFormatContext->nb_streams; i++)
+  {
+    AVStream* pStream = pFormatContext->streams[i];
+    AVCodecContext* pCodec = pStream->codec;
+    const StreamInfo& stream = info.streams[i];
+
+    pCodec->codec_type = stream.codec_type;
+    pCodec->codec_id   = stream.codec_id;
+    pCodec->codec_tag  = stream.codec_tag;
+    if (!pCodec->extradata && !stream.extradata.empty())
+    {
+      pCodec->extradata = (uint8_t*)dllAvUtil.av_mallocz(stream.extradata.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      if (pCodec->extradata)
+      {
+        memcpy(pCodec->extradata, stream.extradata.c_str(), stream.extradata.size());
+        pCodec->extradata_size = stream.extradata.size();
+      }
+    }
+    pCodec->time_base             = stream.time_base;
+    pCodec->width                 = stream.width;
+    pCodec->height                = stream.height;
+    pCodec->sample_aspect_ratio   = stream.sample_aspect_ratio;
+    pCodec->pix_fmt               = (PixelFormat)stream.pix_fmt;
+    pCodec->profile               = stream.profile;
+    pCodec->level                 = stream.level;
+    pCodec->channels              = stream.channels;
+    pCodec->sample_rate           = stream.sample_rate;
+    pCodec->sample_fmt            = (AVSampleFormat)stream.sample_fmt;
+    pCodec->channel_layout        = stream.channel_layout;
+    pCodec->block_align           = stream.block_align;
+    pCodec->bit_rate              = stream.bit_rate;
+    pCodec->bits_per_coded_sample = stream.bits_per_coded_sample;
+    pStream->r_frame_rate         = stream.r_frame_rate;
+    pStream->avg_frame_rate       = stream.avg_frame_rate;
+    pStream->codec_info_nb_frames = stream.codec_info_nb_frames;
+    pCodec->has_b_frames          = stream.has_b_frames;
+    pCodec->ticks_per_frame       = stream.ticks_per_frame;
+    // find_stream_info() may have asked for a parser to split or complete the
+    // frames, read_frame() sets it up from this on the first packet
+    pStream->need_parsing         = (AVStreamParseType)stream.need_parsing;
+    pStream->start_time           = stream.start_time;
+    pStream->duration             = stream.duration;
+  }
+
+  pFormatContext->start_time = info.start_time;
+  pFormatContext->duration   = info.duration;
+  pFormatContext->bit_rate   = info.bit_rate;
+  return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DllAvFormat.h"
+#include "DllAvUtil.h"
+#include "threads/CriticalSection.h"
+
+class CDVDInputStream;
+
+/*!
+ \brief Cache of what avformat_find_stream_info() found out about a file.
+
+ Finding the stream info reads and decodes the start of a file, which can
+ take seconds over the network. The result is kept per file, identified by
+ its path, size and modification time, so the next time the file is opened
+ (by the player after the scanner, or when it is played again) the format
+ doesn't have to be probed and the stream info is filled in from the cache.
+ */
+class CDVDDemuxProbeCache
+{
+public:
+  struct StreamInfo
+  {
+    int            id;
+    AVMediaType    codec_type;
+    CodecID        codec_id;
+    unsigned int   codec_tag;
+    std::string    extradata;
+    AVRational     time_base;
+    int            width;
+    int            height;
+    AVRational     sample_aspect_ratio;
+    int            pix_fmt;
+    int            profile;
+    int            level;
+    int            channels;
+    int            sample_rate;
+    int            sample_fmt;
+    uint64_t       channel_layout;
+    int            block_align;
+    int            bit_rate;
+    int            bits_per_coded_sample;
+    AVRational     r_frame_rate;
+    AVRational     avg_frame_rate;
+    int            codec_info_nb_frames;
+    int            has_b_frames;
+    int            ticks_per_frame;
+    int            need_parsing;      ///< parser setup, the parser itself is created on the first packet
+    int64_t        start_time;
+    int64_t        duration;
+  };
+
+  struct ProbeInfo
+  {
+    std::string             format;
+    int64_t                 start_time;
+    int64_t                 duration;
+    int                     bit_rate;
+    std::vector<StreamInfo> streams;
+  };
+
+  static CDVDDemuxProbeCache& Get();
+
+  /*!
+   \brief Get the key to cache the probe info of an input stream under
+   \return an empty key if the input can't be cached
+   */
+  static std::string GetKey(CDVDInputStream* pInput);
+
+  /*!
+   \brief Get the probe info stored under a key, making it the most recently used one
+   */
+  bool Lookup(const std::string& strKey, ProbeInfo& info);
+
+  /*!
+   \brief Get how many of the lookups so far found the probe info in the cache
+   */
+  void GetStats(unsigned int& hits, unsigned int& lookups);
+
+  /*!
+   \brief Store the stream info of a format context after avformat_find_stream_info()
+   */
+  void Store(const std::string& strKey, const AVFormatContext* pFormatContext);
+
+  /*!
+   \brief Fill in the stream info of a format context that was just opened
+   \return false if the streams found when opening don't match the cached ones
+   */
+  static bool Apply(const ProbeInfo& info, AVFormatContext* pFormatContext, DllAvUtil& dllAvUtil);
+
+private:
+  CDVDDemuxProbeCache() : m_hits(0), m_lookups(0) {}
+
+  struct CacheEntry
+  {
+    ProbeInfo                        info;
+    std::list<std::string>::iterator order;
+  };
+
+  std::map<std::string, CacheEntry> m_cache;
+  std::list<std::string>            m_order;  ///< keys, the most recently used first
+  unsigned int                      m_hits;
+  unsigned int                      m_lookups;
+  CCriticalSection                  m_critSection;
+};
@@ -0,0 +1,159 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxKeyframeIndex.h"
+#include "DVDClock.h"
+#include "utils/JobManager.h"
+
+#include <stdlib.h>
+#include <set>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  const int64_t packetSize = 188;
+  const unsigned int packetCount = 10000;
+  const unsigned int keyframeInterval = 50;
+
+  /* reads a transport stream with a keyframe every 50 packets, one frame of 25fps each packet */
+  class CFakeKeyframeIndexJob : public CDVDDemuxKeyframeIndexJob
+  {
+  public:
+    CFakeKeyframeIndexJob(const std::string& strFile, const boost::shared_ptr<CEvent>& cancelled, CEvent& closed)
+      : CDVDDemuxKeyframeIndexJob(strFile, cancelled, packetSize * packetCount * 10), m_closed(closed)
+    {
+      m_iPacket = 0;
+      m_previous = DVD_NOPTS_VALUE;
+    }
+
+  protected:
+    virtual int64_t Open()
+    {
+      m_index = CDVDDemuxKeyframeIndex::Get(m_strFile, packetSize * packetCount);
+      return packetSize * packetCount;
+    }
+
+    virtual bool Read()
+    {
+      if (m_iPacket >= packetCount)
+        return false;
+      if (m_iPacket % keyframeInterval == 0)
+      {
+        CDVDDemuxKeyframeIndex::Keyframe keyframe;
+        keyframe.pts = m_iPacket * (DVD_TIME_BASE / 25);
+        keyframe.pos = m_iPacket * packetSize;
+        m_index->Add(keyframe, m_previous);
+        m_previous = keyframe.pts;
+      }
+      m_iPacket++;
+      return true;
+    }
+
+    virtual void SeekByte(int64_t pos)
+    {
+      m_iPacket = (unsigned int)(pos / packetSize);
+      m_previous = DVD_NOPTS_VALUE;
+    }
+
+    virtual int64_t GetPosition() { return m_iPacket * packetSize; }
+    virtual bool IsEOF() { return m_iPacket >= packetCount; }
+
+    virtual void Close()
+    {
+      m_index.reset();
+      m_closed.Set();
+    }
+
+  private:
+    boost::shared_ptr<CDVDDemuxKeyframeIndex> m_index;
+    unsigned int m_iPacket;
+    double m_previous;
+    CEvent& m_closed;
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(TestDVDDemuxKeyframeIndex)
+
+BOOST_AUTO_TEST_CASE(TestJobFillsIndex)
+{
+  // queued like the demuxer queues it, without a callback
+  boost::shared_ptr<CDVDDemuxKeyframeIndex> index = CDVDDemuxKeyframeIndex::Get("test://filled.ts", packetSize * packetCount);
+  boost::shared_ptr<CEvent> cancelled(new CEvent(true));
+  CEvent closed;
+  CJobManager::GetInstance().AddJob(new CFakeKeyframeIndexJob("test://filled.ts", cancelled, closed), NULL, CJob::PRIORITY_LOW);
+  BOOST_REQUIRE(closed.WaitMSec(10000));
+
+  CDVDDemuxKeyframeIndex::Keyframe keyframe;
+  BOOST_CHECK(index->IsComplete());
+  BOOST_CHECK(index->GetEndOfFirstRange(keyframe));
+  BOOST_CHECK_EQUAL(keyframe.pos, (int64_t)(packetCount - keyframeInterval) * packetSize);
+  BOOST_CHECK(index->Find(DVD_SEC_TO_TIME(100), true, keyframe));
+  BOOST_CHECK_EQUAL(keyframe.pos, (int64_t)2500 * packetSize);
+}
+
+BOOST_AUTO_TEST_CASE(TestJobCancelled)
+{
+  boost::shared_ptr<CDVDDemuxKeyframeIndex> index = CDVDDemuxKeyframeIndex::Get("test://cancelled.ts", packetSize * packetCount);
+  boost::shared_ptr<CEvent> cancelled(new CEvent(true));
+  CEvent closed;
+  CFakeKeyframeIndexJob job("test://cancelled.ts", cancelled, closed);
+  cancelled->Set();
+  BOOST_CHECK(!job.DoWork());
+  BOOST_CHECK(closed.WaitMSec(0));
+  BOOST_CHECK(!index->IsComplete());
+}
+
+BOOST_AUTO_TEST_CASE(TestFindByPosition)
+{
+  // timestamps don't have to increase with the byte offset, e.g. after a wrap
+  boost::shared_ptr<CDVDDemuxKeyframeIndex> index = CDVDDemuxKeyframeIndex::Get("test://positions.ts", 1 << 30);
+  std::vector<CDVDDemuxKeyframeIndex::Keyframe> keyframes;
+  std::set<double> pts;
+  srand(1);
+  for (unsigned int i = 0; i < 2000; i++)
+  {
+    CDVDDemuxKeyframeIndex::Keyframe keyframe;
+    keyframe.pts = (double)(rand() % 100000) * 1000;
+    keyframe.pos = (int64_t)(rand() % 100000) * 188;
+    index->Add(keyframe, DVD_NOPTS_VALUE);
+    if (pts.insert(keyframe.pts).second) // a duplicate pts isn't added again
+      keyframes.push_back(keyframe);
+  }
+
+  for (int64_t pos = 0; pos < (int64_t)100001 * 188; pos += 997 * 188 + 13)
+  {
+    const CDVDDemuxKeyframeIndex::Keyframe* expected = NULL;
+    for (std::vector<CDVDDemuxKeyframeIndex::Keyframe>::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it)
+    {
+      if (it->pos >= pos && (!expected || it->pos < expected->pos))
+        expected = &(*it);
+    }
+
+    CDVDDemuxKeyframeIndex::Keyframe keyframe;
+    BOOST_REQUIRE_EQUAL(index->FindByPosition(pos, keyframe), expected != NULL);
+    if (expected)
+      BOOST_CHECK_EQUAL(keyframe.pos, expected->pos);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxProbeCache.h"
+#include "threads/SystemClock.h"
+#include "utils/StdString.h"
+
+#include <string.h>
+
+#include <boost/test/unit_test.hpp>
+
+// number of files the cache keeps, PROBECACHE_SIZE
+#define CACHE_SIZE 256
+
+namespace
+{
+  /* the format context of a file with a video and an audio stream, as avformat_find_stream_info() leaves it */
+  class CFakeFormatContext
+  {
+  public:
+    CFakeFormatContext()
+    {
+      memset(&m_format, 0, sizeof(m_format));
+      memset(&m_context, 0, sizeof(m_context));
+      memset(m_streams, 0, sizeof(m_streams));
+      memset(m_codecs, 0, sizeof(m_codecs));
+
+      m_format.name = "mpegts";
+      m_context.iformat = &m_format;
+      m_context.nb_streams = 2;
+      m_context.streams = m_pStreams;
+      m_context.duration = 5400LL * AV_TIME_BASE;
+      for (unsigned int i = 0; i < 2; i++)
+      {
+        m_pStreams[i] = &m_streams[i];
+        m_streams[i].id = 0x100 + i;
+        m_streams[i].codec = &m_codecs[i];
+      }
+      m_codecs[0].codec_type = AVMEDIA_TYPE_VIDEO;
+      m_codecs[0].codec_id   = CODEC_ID_H264;
+      m_codecs[0].width      = 1920;
+      m_codecs[0].height     = 1080;
+      m_codecs[0].has_b_frames    = 2;
+      m_codecs[0].ticks_per_frame = 2;
+      m_streams[0].need_parsing   = AVSTREAM_PARSE_HEADERS;
+      m_codecs[0].extradata  = m_extradata;
+      m_codecs[0].extradata_size = sizeof(m_extradata);
+      m_codecs[1].codec_type = AVMEDIA_TYPE_AUDIO;
+      m_codecs[1].codec_id   = CODEC_ID_AC3;
+      m_codecs[1].channels   = 6;
+      memset(m_extradata, 0x42, sizeof(m_extradata));
+    }
+
+    const AVFormatContext* Get(int64_t duration)
+    {
+      m_context.duration = duration;
+      return &m_context;
+    }
+
+  private:
+    AVInputFormat   m_format;
+    AVFormatContext m_context;
+    AVStream*       m_pStreams[2];
+    AVStream        m_streams[2];
+    AVCodecContext  m_codecs[2];
+    uint8_t         m_extradata[64];
+  };
+
+  std::string GetKey(const char* prefix, int i)
+  {
+    CStdString strKey;
+    strKey.Format("smb://server/%s/%04i.ts|1073741824|1351000000|", prefix, i);
+    return strKey;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(TestDVDDemuxProbeCache)
+
+BOOST_AUTO_TEST_CASE(TestLookupKeepsEntry)
+{
+  CDVDDemuxProbeCache& cache = CDVDDemuxProbeCache::Get();
+  CFakeFormatContext context;
+  for (int i = 0; i < CACHE_SIZE; i++)
+    cache.Store(GetKey("lru", i), context.Get(i));
+
+  // the first file stored is the one used last, the second one is dropped instead
+  CDVDDemuxProbeCache::ProbeInfo info;
+  BOOST_REQUIRE(cache.Lookup(GetKey("lru", 0), info));
+  cache.Store(GetKey("lru", CACHE_SIZE), context.Get(CACHE_SIZE));
+
+  BOOST_CHECK(cache.Lookup(GetKey("lru", 0), info));
+  BOOST_CHECK_EQUAL(info.duration, 0);
+  BOOST_CHECK_EQUAL(info.format, "mpegts");
+  BOOST_REQUIRE_EQUAL(info.streams.size(), 2U);
+  BOOST_CHECK_EQUAL(info.streams[0].width, 1920);
+  BOOST_CHECK_EQUAL(info.streams[0].extradata.size(), 64U);
+  BOOST_CHECK_EQUAL(info.streams[0].has_b_frames, 2);
+  BOOST_CHECK_EQUAL(info.streams[0].ticks_per_frame, 2);
+  BOOST_CHECK_EQUAL(info.streams[0].need_parsing, (int)AVSTREAM_PARSE_HEADERS);
+  BOOST_CHECK_EQUAL(info.streams[1].need_parsing, (int)AVSTREAM_PARSE_NONE);
+  BOOST_CHECK_EQUAL(info.streams[1].channels, 6);
+  BOOST_CHECK(!cache.Lookup(GetKey("lru", 1), info));
+  for (int i = 2; i <= CACHE_SIZE; i++)
+    BOOST_CHECK(cache.Lookup(GetKey("lru", i), info));
+
+  // storing a file again makes it the most recently used one as well
+  cache.Store(GetKey("lru", 2), context.Get(-1));
+  for (int i = 3; i <= CACHE_SIZE; i++)
+    BOOST_CHECK(cache.Lookup(GetKey("lru", i), info));
+  cache.Store(GetKey("lru", CACHE_SIZE + 1), context.Get(CACHE_SIZE + 1));
+  BOOST_CHECK(!cache.Lookup(GetKey("lru", 0), info));
+  BOOST_REQUIRE(cache.Lookup(GetKey("lru", 2), info));
+  BOOST_CHECK_EQUAL(info.duration, -1);
+}
+
+BOOST_AUTO_TEST_CASE(TestLookupTime)
+{
+  // the scanner opens each file once, the player opens one of the files scanned a little earlier
+  CDVDDemuxProbeCache& cache = CDVDDemuxProbeCache::Get();
+  CFakeFormatContext context;
+  CDVDDemuxProbeCache::ProbeInfo info;
+  const int files = 20000;
+  unsigned int hits = 0;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < files; i++)
+  {
+    std::string strKey = GetKey("scan", i);
+    if (!cache.Lookup(strKey, info))
+      cache.Store(strKey, context.Get(i));
+    if (cache.Lookup(GetKey("scan", i >= 100 ? i - 100 : i), info))
+      hits++;
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  BOOST_TEST_MESSAGE("stored " << files << " files and looked up " << 2 * files << " in " << elapsed << " ms");
+  BOOST_CHECK_EQUAL(hits, (unsigned int)files);
+}
+
+BOOST_AUTO_TEST_CASE(TestStats)
+{
+  CDVDDemuxProbeCache& cache = CDVDDemuxProbeCache::Get();
+  CFakeFormatContext context;
+  unsigned int hits = 0, lookups = 0;
+  cache.GetStats(hits, lookups);
+
+  CDVDDemuxProbeCache::ProbeInfo info;
+  BOOST_CHECK(!cache.Lookup(GetKey("stats", 0), info));
+  cache.Store(GetKey("stats", 0), context.Get(0));
+  BOOST_CHECK(cache.Lookup(GetKey("stats", 0), info));
+
+  unsigned int hitsAfter = 0, lookupsAfter = 0;
+  cache.GetStats(hitsAfter, lookupsAfter);
+  BOOST_CHECK_EQUAL(hitsAfter - hits, 1U);
+  BOOST_CHECK_EQUAL(lookupsAfter - lookups, 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,15 +22,16 @@
 #include "DVDSubtitleLineCollection.h"
 #include "DVDClock.h"
 
+#include <algorithm>
+
+using namespace std;
 
 CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
 {
-  m_pHead = NULL;
-  m_pCurrent = NULL;
-  m_pTail = NULL;
-
-  m_iSize = 0;
+  m_iCurrent = 0;
+  m_bSorted = true;
   m_fLastPts = DVD_NOPTS_VALUE;
+  m_pParser = NULL;
 }
 
 CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
@@ -40,40 +41,88 @@ CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 
 void CDVDSubtitleLineCollection::Add(CDVDOverlay* pOverlay)
 {
-  ListElement* pElement = new ListElement;
-  pElement->pOverlay = pOverlay;
-  pElement->pNext = NULL;
+  Entry entry;
+  entry.iPTSStartTime = pOverlay->iPTSStartTime;
+  entry.iPTSStopTime  = pOverlay->iPTSStopTime;
+  entry.pOverlay      = pOverlay;
+  entry.bDeferred     = false;
+  m_entries.push_back(entry);
+
+  m_bSorted = false;
+}
+
+void CDVDSubtitleLineCollection::Add(double iPTSStartTime, double iPTSStopTime, const string& strText)
+{
+  Entry entry;
+  entry.iPTSStartTime = iPTSStartTime;
+  entry.iPTSStopTime  = iPTSStopTime;
+  entry.pOverlay      = NULL;
+  entry.strText       = strText;
+  entry.bDeferred     = true;
+  m_entries.push_back(entry);
+
+  m_bSorted = false;
+}
+
+bool CDVDSubtitleLineCollection::CompareStart(const Entry& left, const Entry& right)
+{
+  return left.iPTSStartTime < right.iPTSStartTime;
+}
 
-  if (!m_pHead)
+void CDVDSubtitleLineCollection::Sort()
+{
+  // parsers may still adjust the times of an overlay after adding it
+  for (vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
   {
-    m_pHead = m_pTail = pElement;
-    m_pCurrent = m_pHead;
+    if (!it->bDeferred)
+    {
+      it->iPTSStartTime = it->pOverlay->iPTSStartTime;
+      it->iPTSStopTime  = it->pOverlay->iPTSStopTime;
+    }
   }
-  else
+
+  stable_sort(m_entries.begin(), m_entries.end(), CompareStart);
+
+  m_maxStop.resize(m_entries.size());
+  for (unsigned int i = 0; i < m_entries.size(); i++)
   {
-    m_pTail->pNext = pElement;
-    m_pTail = pElement;
+    m_maxStop[i] = m_entries[i].iPTSStopTime;
+    if (i > 0 && m_maxStop[i - 1] > m_maxStop[i])
+      m_maxStop[i] = m_maxStop[i - 1];
   }
 
-  m_iSize++;
+  m_bSorted = true;
 }
 
-void CDVDSubtitleLineCollection::Sort()
+unsigned int CDVDSubtitleLineCollection::FindFirstEndingAfter(double iPts) const
+{
+  // every entry before the first one whose running maximum reaches iPts has ended
+  return lower_bound(m_maxStop.begin(), m_maxStop.end(), iPts) - m_maxStop.begin();
+}
+
+CDVDOverlay* CDVDSubtitleLineCollection::Materialize(unsigned int index)
 {
-  if (!m_pHead || !m_pHead->pNext)
-    return;
-  
-  for (ListElement* p1 = m_pHead; p1->pNext->pNext != NULL; p1 = p1->pNext)
+  Entry& entry = m_entries[index];
+  if (!entry.pOverlay && entry.bDeferred && m_pParser)
   {
-    for (ListElement* p2 = p1->pNext; p2->pNext != NULL; p2 = p2->pNext)
+    entry.pOverlay = m_pParser->ParseLine(entry.strText, entry.iPTSStartTime, entry.iPTSStopTime);
+    if (entry.pOverlay)
+      m_materialized.push_back(index);
+  }
+  return entry.pOverlay;
+}
+
+void CDVDSubtitleLineCollection::ReleaseMaterialized(unsigned int iBefore)
+{
+  while (!m_materialized.empty() && m_materialized.front() < iBefore)
+  {
+    Entry& entry = m_entries[m_materialized.front()];
+    if (entry.pOverlay)
     {
-      if (p1->pOverlay->iPTSStartTime > p2->pOverlay->iPTSStartTime)
-      {
-        CDVDOverlay* temp = p1->pOverlay;
-        p1->pOverlay = p2->pOverlay;
-        p2->pOverlay = temp;
-      }
+      entry.pOverlay->Release();
+      entry.pOverlay = NULL;
     }
+    m_materialized.pop_front();
   }
 }
 
@@ -81,49 +130,51 @@ CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
 {
   CDVDOverlay* pOverlay = NULL;
 
+  if (!m_bSorted)
+    Sort();
+
   if (iPts < m_fLastPts)
     Reset();
 
-  if (m_pCurrent)
+  if (m_iCurrent < m_entries.size() && m_entries[m_iCurrent].iPTSStopTime < iPts)
   {
-    while (m_pCurrent && m_pCurrent->pOverlay->iPTSStopTime < iPts)
-    {
-      m_pCurrent = m_pCurrent->pNext;
-    }
+    // skip the lines that have ended, without walking them after a seek
+    m_iCurrent = max(m_iCurrent, FindFirstEndingAfter(iPts));
+    while (m_iCurrent < m_entries.size() && m_entries[m_iCurrent].iPTSStopTime < iPts)
+      m_iCurrent++;
+  }
 
-    if (m_pCurrent)
-    {
-      pOverlay = m_pCurrent->pOverlay;
+  ReleaseMaterialized(m_iCurrent);
 
-      // advance to the next overlay
-      m_pCurrent = m_pCurrent->pNext;
-      m_fLastPts = iPts;
-    }
+  if (m_iCurrent < m_entries.size())
+  {
+    pOverlay = Materialize(m_iCurrent);
+
+    // advance to the next overlay
+    m_iCurrent++;
+    m_fLastPts = iPts;
   }
   return pOverlay;
 }
 
 void CDVDSubtitleLineCollection::Reset()
 {
-  m_pCurrent = m_pHead;
+  m_iCurrent = 0;
+  ReleaseMaterialized(m_entries.size());
 }
 
 void CDVDSubtitleLineCollection::Clear()
 {
-  ListElement* pElement = NULL;
-
-  while (m_pHead)
+  for (vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
   {
-    pElement = m_pHead;
-    m_pHead = pElement->pNext;
-
-    pElement->pOverlay->Release();
-    delete pElement;
+    if (it->pOverlay)
+      it->pOverlay->Release();
   }
 
-  m_pTail    = NULL;
-  m_pHead    = NULL;
-  m_pCurrent = NULL;
-  m_iSize    = 0;
+  m_entries.clear();
+  m_maxStop.clear();
+  m_materialized.clear();
+  m_iCurrent = 0;
+  m_bSorted  = true;
   m_fLastPts = DVD_NOPTS_VALUE;
 }
@@ -21,42 +21,77 @@
  *
  */
 
+#include <deque>
+#include <string>
+#include <vector>
+
 #include "../DVDCodecs/Overlay/DVDOverlay.h"
 
-typedef struct stListElement
+/*!
+ \brief Creates the overlay of a subtitle line that was added unparsed
+ */
+class IDVDSubtitleLineParser
 {
-  CDVDOverlay* pOverlay;
-  struct stListElement* pNext;
+public:
+  virtual ~IDVDSubtitleLineParser() {}
+  virtual CDVDOverlay* ParseLine(const std::string& strText, double iPTSStartTime, double iPTSStopTime) = 0;
+};
+
+/*!
+ \brief Timeline of the lines of a subtitle file
 
-} ListElement;
+ Lines are kept sorted by start time in a contiguous index, together with the
+ running maximum of their stop times, so the line to show at a given time is
+ found with a binary search after a seek and by advancing one entry during
+ playback.
 
+ Lines can be added unparsed. Their overlay is only created once the playhead
+ gets to them, and released again once it has moved on, so a long subtitle
+ file doesn't keep tens of thousands of overlays around.
+ */
 class CDVDSubtitleLineCollection
 {
 public:
   CDVDSubtitleLineCollection();
   virtual ~CDVDSubtitleLineCollection();
 
-  //void Lock()   { EnterCriticalSection(&m_critSection); }
-  //void Unlock() { LeaveCriticalSection(&m_critSection); }
+  void SetLineParser(IDVDSubtitleLineParser* pParser) { m_pParser = pParser; }
 
   void Add(CDVDOverlay* pSubtitle);
+
+  /*!
+   \brief Add a line whose overlay is created by the line parser when it is needed
+   */
+  void Add(double iPTSStartTime, double iPTSStopTime, const std::string& strText);
   void Sort();
 
   CDVDOverlay* Get(double iPts = 0LL); // get the first overlay in this fifo
 
   void Reset();
 
-  void Remove();
   void Clear();
-  int GetSize() { return m_iSize; }
+  int GetSize() { return m_entries.size(); }
 
 private:
-  ListElement* m_pHead;
-  ListElement* m_pCurrent;
-  ListElement* m_pTail;
+  struct Entry
+  {
+    double       iPTSStartTime;
+    double       iPTSStopTime;
+    CDVDOverlay* pOverlay;
+    std::string  strText;   ///< unparsed line, empty if the overlay was added parsed
+    bool         bDeferred;
+  };
 
-  int m_iSize;
+  static bool CompareStart(const Entry& left, const Entry& right);
+  unsigned int FindFirstEndingAfter(double iPts) const;
+  CDVDOverlay* Materialize(unsigned int index);
+  void ReleaseMaterialized(unsigned int iBefore);
+
+  std::vector<Entry>  m_entries;
+  std::vector<double> m_maxStop;       ///< maximum stop time of the entries up to and including each one
+  std::deque<unsigned int> m_materialized; ///< deferred entries that currently have an overlay, in order of creation
+  unsigned int m_iCurrent;
+  bool   m_bSorted;
   double m_fLastPts;
-  //CRITICAL_SECTION m_critSection;
+  IDVDSubtitleLineParser* m_pParser;
 };
-
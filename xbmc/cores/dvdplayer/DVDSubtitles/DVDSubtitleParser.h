@@ -41,17 +41,24 @@ public:
 
 class CDVDSubtitleParserCollection
   : public CDVDSubtitleParser
+  , public IDVDSubtitleLineParser
 {
 public:
   CDVDSubtitleParserCollection(const std::string& strFile)
   {
     m_filename = strFile;
+    m_collection.SetLineParser(this);
   }
   virtual ~CDVDSubtitleParserCollection() { }
   virtual CDVDOverlay* Parse(double iPts) { return m_collection.Get(iPts); }
   virtual void         Reset()            { m_collection.Reset(); }
   virtual void         Dispose()          { m_collection.Clear(); }
 
+  /*!
+   \brief Create the overlay of a line that was added to the collection unparsed
+   */
+  virtual CDVDOverlay* ParseLine(const std::string& strText, double iPTSStartTime, double iPTSStopTime) { return NULL; }
+
 protected:
   CDVDSubtitleLineCollection m_collection;
   std::string                m_filename;
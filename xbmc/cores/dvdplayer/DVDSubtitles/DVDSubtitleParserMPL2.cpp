@@ -53,7 +53,6 @@ bool CDVDSubtitleParserMPL2::Open(CDVDStreamInfo &hints)
   CRegExp reg;
   if (!reg.RegComp("\\[([0-9]+)\\]\\[([0-9]+)\\]"))
     return false;
-  CDVDSubtitleTagMicroDVD TagConv;
 
   while (m_pStream->ReadLine(line, sizeof(line)))
   {
@@ -66,21 +65,27 @@ bool CDVDSubtitleParserMPL2::Open(CDVDStreamInfo &hints)
       const char* text = line + pos + reg.GetFindLen();
       char* startFrame = reg.GetReplaceString("\\1");
       char* endFrame   = reg.GetReplaceString("\\2");
-      CDVDOverlayText* pOverlay = new CDVDOverlayText();
-      pOverlay->Acquire(); // increase ref count with one so that we can hold a handle to this overlay
-
-      pOverlay->iPTSStartTime = m_framerate * atoi(startFrame);
-      pOverlay->iPTSStopTime  = m_framerate * atoi(endFrame);
 
-      TagConv.ConvertLine(pOverlay, text, strlen(text));
+      // the text is converted once the line is about to be shown
+      m_collection.Add(m_framerate * atoi(startFrame), m_framerate * atoi(endFrame), text);
 
       free(startFrame);
       free(endFrame);
-
-      m_collection.Add(pOverlay);
     }
   }
 
   return true;
 }
 
+CDVDOverlay* CDVDSubtitleParserMPL2::ParseLine(const string& strText, double iPTSStartTime, double iPTSStopTime)
+{
+  CDVDOverlayText* pOverlay = new CDVDOverlayText();
+  pOverlay->Acquire(); // increase ref count with one so that we can hold a handle to this overlay
+
+  pOverlay->iPTSStartTime = iPTSStartTime;
+  pOverlay->iPTSStopTime  = iPTSStopTime;
+
+  CDVDSubtitleTagMicroDVD TagConv;
+  TagConv.ConvertLine(pOverlay, strText.c_str(), strText.length());
+  return pOverlay;
+}
@@ -31,6 +31,7 @@ public:
   virtual ~CDVDSubtitleParserMicroDVD();
 
   virtual bool Open(CDVDStreamInfo &hints);
+  virtual CDVDOverlay* ParseLine(const std::string& strText, double iPTSStartTime, double iPTSStopTime);
 private:
   double m_framerate;
 };
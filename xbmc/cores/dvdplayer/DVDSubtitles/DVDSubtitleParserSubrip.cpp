@@ -42,12 +42,12 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
   if (!CDVDSubtitleParserText::Open())
     return false;
 
-  CDVDSubtitleTagSami TagConv;
-  if (!TagConv.Init())
+  if (!m_TagConv.Init())
     return false;
 
   char line[1024];
   CStdString strLine;
+  string strText;
 
   while (m_pStream->ReadLine(line, sizeof(line)))
   {
@@ -68,12 +68,10 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
       }
       else if (c == 14) // time info
       {
-        CDVDOverlayText* pOverlay = new CDVDOverlayText();
-        pOverlay->Acquire(); // increase ref count with one so that we can hold a handle to this overlay
-
-        pOverlay->iPTSStartTime = ((double)(((hh1 * 60 + mm1) * 60) + ss1) * 1000 + ms1) * (DVD_TIME_BASE / 1000);
-        pOverlay->iPTSStopTime  = ((double)(((hh2 * 60 + mm2) * 60) + ss2) * 1000 + ms2) * (DVD_TIME_BASE / 1000);
+        double iPTSStartTime = ((double)(((hh1 * 60 + mm1) * 60) + ss1) * 1000 + ms1) * (DVD_TIME_BASE / 1000);
+        double iPTSStopTime  = ((double)(((hh2 * 60 + mm2) * 60) + ss2) * 1000 + ms2) * (DVD_TIME_BASE / 1000);
 
+        strText.clear();
         while (m_pStream->ReadLine(line, sizeof(line)))
         {
           strLine = line;
@@ -82,10 +80,12 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
           // empty line, next subtitle is about to start
           if (strLine.length() <= 0) break;
 
-          TagConv.ConvertLine(pOverlay, strLine.c_str(), strLine.length());
+          strText += strLine;
+          strText += '\n';
         }
-        TagConv.CloseTag(pOverlay);
-        m_collection.Add(pOverlay);
+
+        // the tags are converted once the subtitle is about to be shown
+        m_collection.Add(iPTSStartTime, iPTSStopTime, strText);
       }
     }
   }
@@ -93,3 +93,21 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
   return true;
 }
 
+CDVDOverlay* CDVDSubtitleParserSubrip::ParseLine(const string& strText, double iPTSStartTime, double iPTSStopTime)
+{
+  CDVDOverlayText* pOverlay = new CDVDOverlayText();
+  pOverlay->Acquire(); // increase ref count with one so that we can hold a handle to this overlay
+
+  pOverlay->iPTSStartTime = iPTSStartTime;
+  pOverlay->iPTSStopTime  = iPTSStopTime;
+
+  size_t start = 0;
+  size_t end;
+  while ((end = strText.find('\n', start)) != string::npos)
+  {
+    m_TagConv.ConvertLine(pOverlay, strText.c_str() + start, end - start);
+    start = end + 1;
+  }
+  m_TagConv.CloseTag(pOverlay);
+  return pOverlay;
+}
@@ -23,6 +23,7 @@
 
 #include "DVDSubtitleParser.h"
 #include "DVDSubtitleLineCollection.h"
+#include "DVDSubtitleTagSami.h"
 
 class CDVDSubtitleParserSubrip : public CDVDSubtitleParserText
 {
@@ -31,5 +32,7 @@ public:
   virtual ~CDVDSubtitleParserSubrip();
 
   virtual bool Open(CDVDStreamInfo &hints);
+  virtual CDVDOverlay* ParseLine(const std::string& strText, double iPTSStartTime, double iPTSStopTime);
 private:
+  CDVDSubtitleTagSami m_TagConv;
 };
@@ -414,7 +414,7 @@ bool CEpg::Load(void)
   return bReturn;
 }
 
-bool CEpg::UpdateEntries(const CEpg &epg, bool bStoreInDb /* = true */)
+bool CEpg::UpdateEntries(const CEpg &epg, bool bStoreInDb /* = true */, EpgUpdateStats *stats /* = NULL */)
 {
   bool bReturn(false);
   CEpgDatabase *database = g_EpgContainer.GetDatabase();
@@ -433,20 +433,114 @@ bool CEpg::UpdateEntries(const CEpg &epg, bool bStoreInDb /* = true */)
       database->BeginTransaction();
     }
     CLog::Log(LOGDEBUG, "%s - %u entries in memory before merging", __FUNCTION__, m_tags.size());
+
+    /* take out the tags in the updated time span that are not in the update anymore. the ones
+       that moved are found again by their unique broadcast ID, the others are removed */
+    map<int, CEpgInfoTag *> oldTags;
+    unsigned int iRemovedTags(0);
+    for (map<CDateTime, CEpgInfoTag *>::iterator it = m_tags.lower_bound(epg.m_tags.begin()->first);
+        it != m_tags.end() && it->first <= epg.m_tags.rbegin()->first;)
+    {
+      CEpgInfoTag *tag = it->second;
+      if (epg.m_tags.find(it->first) != epg.m_tags.end() || !IsRemovableTag(tag))
+      {
+        it++;
+        continue;
+      }
+
+      if (bStoreInDb)
+        database->Delete(*tag, true);
+      if (m_nowActiveStart == it->first)
+        m_nowActiveStart.SetValid(false);
+      m_tags.erase(it++);
+
+      if (tag->UniqueBroadcastID() > 0 && oldTags.find(tag->UniqueBroadcastID()) == oldTags.end())
+        oldTags.insert(make_pair(tag->UniqueBroadcastID(), tag));
+      else
+      {
+        delete tag;
+        ++iRemovedTags;
+      }
+    }
+
     /* copy over tags */
+    unsigned int iNewTags(0), iChangedTags(0), iUnchangedTags(0);
     for (map<CDateTime, CEpgInfoTag *>::const_iterator it = epg.m_tags.begin(); it != epg.m_tags.end(); it++)
-      UpdateEntry(*it->second, bStoreInDb, false);
+    {
+      CEpgInfoTag *infoTag(NULL);
+      bool bNewTag(false);
+      bool bMoved(false);
 
-    CLog::Log(LOGDEBUG, "%s - %u entries in memory after merging and before fixing", __FUNCTION__, m_tags.size());
+      map<CDateTime, CEpgInfoTag *>::iterator existingTag = m_tags.find(it->first);
+      if (existingTag != m_tags.end())
+      {
+        infoTag = existingTag->second;
+      }
+      else
+      {
+        map<int, CEpgInfoTag *>::iterator oldTag = oldTags.find(it->second->UniqueBroadcastID());
+        if (it->second->UniqueBroadcastID() > 0 && oldTag != oldTags.end())
+        {
+          /* the event moved. its database entry has been removed above and will be written again */
+          infoTag = oldTag->second;
+          oldTags.erase(oldTag);
+          bMoved = true;
+        }
+        else
+        {
+          infoTag = new CEpgInfoTag(m_iEpgID, m_iPVRChannelNumber, m_iPVRChannelId, m_strName);
+          infoTag->SetUniqueBroadcastID(it->second->UniqueBroadcastID());
+          bNewTag = true;
+        }
+        m_tags.insert(make_pair(it->first, infoTag));
+      }
+
+      bool bChanged = infoTag->Update(*it->second, bNewTag) || bMoved;
+      infoTag->m_iEpgId            = m_iEpgID;
+      infoTag->m_iPVRChannelNumber = m_iPVRChannelNumber;
+      infoTag->m_iPVRChannelID     = m_iPVRChannelId;
+      infoTag->m_strTableName      = m_strName;
+
+      /* only changed tags are written */
+      if (bStoreInDb)
+        infoTag->Persist(false);
+
+      if (bNewTag)
+        ++iNewTags;
+      else if (bChanged)
+        ++iChangedTags;
+      else
+        ++iUnchangedTags;
+    }
+
+    /* delete the tags that weren't found again */
+    for (map<int, CEpgInfoTag *>::iterator it = oldTags.begin(); it != oldTags.end(); it++)
+    {
+      delete it->second;
+      ++iRemovedTags;
+    }
+
+    CLog::Log(LOGDEBUG, "%s - %u entries in memory after merging and before fixing. %u new, %u changed, %u removed, %u unchanged",
+        __FUNCTION__, m_tags.size(), iNewTags, iChangedTags, iRemovedTags, iUnchangedTags);
     FixOverlappingEvents(bStoreInDb);
     CLog::Log(LOGDEBUG, "%s - %u entries in memory after fixing", __FUNCTION__, m_tags.size());
     /* update the last scan time of this table */
     m_lastScanTime = CDateTime::GetCurrentDateTime().GetAsUTCDateTime();
 
+    if (stats)
+    {
+      stats->iNewTags       += iNewTags;
+      stats->iChangedTags   += iChangedTags;
+      stats->iRemovedTags   += iRemovedTags;
+      stats->iUnchangedTags += iUnchangedTags;
+    }
+
     //m_bTagsChanged = true;
     /* persist changes */
     if (bStoreInDb)
     {
+      /* write all queued changes at once */
+      database->CommitInsertQueries();
       bReturn = database->CommitTransaction();
       if (bReturn)
         Persist(true);
@@ -496,7 +590,17 @@ CDateTime CEpg::GetLastScanTime(void)
 
 bool CEpg::Update(const time_t start, const time_t end, int iUpdateTime, bool bForceUpdate /* = false */)
 {
-  bool bGrabSuccess(true);
+  bool bFetch = PrepareUpdate(iUpdateTime, bForceUpdate);
+  CEpg *fetched = bFetch ? FetchFromClient(start, end) : NULL;
+
+  bool bGrabSuccess = FinishUpdate(bFetch, fetched);
+  delete fetched;
+
+  return bGrabSuccess;
+}
+
+bool CEpg::PrepareUpdate(int iUpdateTime, bool bForceUpdate /* = false */)
+{
   bool bUpdate(false);
 
   /* load the entries from the db first */
@@ -522,8 +626,33 @@ bool CEpg::Update(const time_t start, const time_t end, int iUpdateTime, bool bF
   else
     bUpdate = true;
 
-  if (bUpdate)
-    bGrabSuccess = LoadFromClients(start, end);
+  return bUpdate;
+}
+
+CEpg *CEpg::FetchFromClient(time_t start, time_t end) const
+{
+  CEpg *fetched(NULL);
+  CPVRChannel *channel = Channel();
+  if (channel)
+    fetched = new CEpg(channel);
+  else
+    fetched = new CEpg(m_iEpgID, m_strName, m_strScraperName);
+
+  if (!fetched->UpdateFromScraper(start, end))
+  {
+    delete fetched;
+    fetched = NULL;
+  }
+
+  return fetched;
+}
+
+bool CEpg::FinishUpdate(bool bFetched, const CEpg *fetched, EpgUpdateStats *stats /* = NULL */)
+{
+  bool bGrabSuccess(true);
+
+  if (bFetched)
+    bGrabSuccess = fetched && UpdateEntries(*fetched, !g_guiSettings.GetBool("epg.ignoredbforclient"), stats);
 
   if (bGrabSuccess)
   {
@@ -717,7 +846,7 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
     {
       // delete the current tag. it's completely overlapped
       if (bUpdateDb)
-        bReturn &= database->Delete(*currentTag);
+        bReturn &= database->Delete(*currentTag, true);
 
       if (m_nowActiveStart == it->first)
         m_nowActiveStart.SetValid(false);
@@ -727,9 +856,13 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
     {
+      // tags that don't have a database ID yet are stored by start time. remove the old entry before moving it
+      if (bUpdateDb && currentTag->BroadcastId() <= 0)
+        bReturn &= database->Delete(*currentTag, true);
+
       currentTag->SetStartFromUTC(previousTag->EndAsUTC());
       if (bUpdateDb)
-        bReturn &= currentTag->Persist();
+        bReturn &= currentTag->Persist(false);
 
       previousTag = it->second;
     }
@@ -741,6 +874,9 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
       middle = start + ((end - start) / 2);
       CDateTime newTime(middle);
 
+      if (bUpdateDb && currentTag->BroadcastId() <= 0)
+        bReturn &= database->Delete(*currentTag, true);
+
       currentTag->SetStartFromUTC(newTime);
       previousTag->SetEndFromUTC(newTime);
 
@@ -749,8 +885,8 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
 
       if (bUpdateDb)
       {
-        bReturn &= currentTag->Persist();
-        bReturn &= previousTag->Persist();
+        bReturn &= currentTag->Persist(false);
+        bReturn &= previousTag->Persist(false);
       }
 
       previousTag = it->second;
@@ -910,18 +1046,11 @@ bool CEpg::IsRemovableTag(const CEpgInfoTag *tag) const
 bool CEpg::LoadFromClients(time_t start, time_t end)
 {
   bool bReturn(false);
-  CPVRChannel *channel = Channel();
-  if (channel)
-  {
-    CEpg tmpEpg(channel);
-    if (tmpEpg.UpdateFromScraper(start, end))
-      bReturn = UpdateEntries(tmpEpg, !g_guiSettings.GetBool("epg.ignoredbforclient"));
-  }
-  else
+  CEpg *fetched = FetchFromClient(start, end);
+  if (fetched)
   {
-    CEpg tmpEpg(m_iEpgID, m_strName, m_strScraperName);
-    if (tmpEpg.UpdateFromScraper(start, end))
-      bReturn = UpdateEntries(tmpEpg, !g_guiSettings.GetBool("epg.ignoredbforclient"));
+    bReturn = UpdateEntries(*fetched, !g_guiSettings.GetBool("epg.ignoredbforclient"));
+    delete fetched;
   }
 
   return bReturn;
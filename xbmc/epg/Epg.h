@@ -37,9 +37,35 @@ namespace PVR
 /** EPG container for CEpgInfoTag instances */
 namespace EPG
 {
+  /*!
+   * @brief Statistics of an EPG update.
+   */
+  struct EpgUpdateStats
+  {
+    EpgUpdateStats(void) :
+      iTables(0),
+      iNewTags(0),
+      iChangedTags(0),
+      iRemovedTags(0),
+      iUnchangedTags(0),
+      iLoadTime(0),
+      iFetchTime(0),
+      iMergeTime(0) {}
+
+    unsigned int iTables;        /*!< the number of tables that were updated */
+    unsigned int iNewTags;       /*!< events that were added */
+    unsigned int iChangedTags;   /*!< existing events that changed or moved */
+    unsigned int iRemovedTags;   /*!< events that the client no longer provides and that were removed */
+    unsigned int iUnchangedTags; /*!< events that didn't change and were not written to the database */
+    unsigned int iLoadTime;      /*!< milliseconds spent loading tables from the database */
+    unsigned int iFetchTime;     /*!< milliseconds spent fetching events from the clients */
+    unsigned int iMergeTime;     /*!< milliseconds spent merging and persisting the fetched events */
+  };
+
   class CEpg : public Observable
   {
     friend class CEpgDatabase;
+    friend class CEpgIndex;
 
   public:
     /*!
@@ -228,6 +254,34 @@ namespace EPG
      */
     virtual bool Update(const time_t start, const time_t end, int iUpdateTime, bool bForceUpdate = false);
 
+    /*!
+     * @brief First step of an update: load the table from the database if needed and check whether it has to be updated.
+     * @param iUpdateTime Update the table after the given amount of time has passed.
+     * @param bForceUpdate Force update from client even if it's not the time to
+     * @return True if the events have to be fetched from the client, false otherwise.
+     */
+    virtual bool PrepareUpdate(int iUpdateTime, bool bForceUpdate = false);
+
+    /*!
+     * @brief Second step of an update: get the events from the client without changing this table.
+     *
+     * Doesn't access the database, so tables of different clients can be fetched at the same time.
+     *
+     * @param start Only get entries after this start time.
+     * @param end Only get entries before this end time.
+     * @return A new table with the events or NULL if they couldn't be fetched. Has to be deleted by the caller.
+     */
+    virtual CEpg *FetchFromClient(time_t start, time_t end) const;
+
+    /*!
+     * @brief Last step of an update: merge the fetched events into this table.
+     * @param bFetched True if PrepareUpdate() requested the events to be fetched.
+     * @param fetched The table returned by FetchFromClient(). Ignored if bFetched is false.
+     * @param stats Statistics to add the merged events to or NULL.
+     * @return True if the update was successful, false otherwise.
+     */
+    virtual bool FinishUpdate(bool bFetched, const CEpg *fetched, EpgUpdateStats *stats = NULL);
+
     /*!
      * @brief Get all EPG entries.
      * @param results The file list to store the results in.
@@ -318,7 +372,7 @@ namespace EPG
 
     /*!
      * @brief Fix overlapping events from the tables.
-     * @param bUpdateDb If set to yes, any changes to tags during fixing will be persisted to database
+     * @param bUpdateDb If set to yes, any changes to tags during fixing will be queued for writing to the database
      * @return True if anything changed, false otherwise.
      */
     virtual bool FixOverlappingEvents(bool bUpdateDb = false);
@@ -339,11 +393,17 @@ namespace EPG
 
     /*!
      * @brief Update the contents of this table with the contents provided in "epg"
+     *
+     * Events are matched by start time or, when they moved, by unique broadcast ID. Only the events that
+     * changed are written to the database, in a single transaction. Events in the time span covered by
+     * "epg" that it doesn't contain anymore are removed.
+     *
      * @param epg The updated contents.
      * @param bStoreInDb True to store the updated contents in the db, false otherwise.
+     * @param stats Statistics to add the merged events to or NULL.
      * @return True if the update was successful, false otherwise.
      */
-    virtual bool UpdateEntries(const CEpg &epg, bool bStoreInDb = true);
+    virtual bool UpdateEntries(const CEpg &epg, bool bStoreInDb = true, EpgUpdateStats *stats = NULL);
 
     virtual bool IsRemovableTag(const EPG::CEpgInfoTag *tag) const;
 
@@ -21,6 +21,7 @@
 
 #include "Application.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
 #include "dialogs/GUIDialogExtendedProgressBar.h"
@@ -43,6 +44,45 @@ using namespace PVR;
 
 typedef std::map<int, CEpg*>::iterator EPGITR;
 
+CEpgClientFetcher::CEpgClientFetcher(time_t start, time_t end) :
+    m_start(start),
+    m_end(end),
+    m_iProgress(0)
+{
+}
+
+CEpgClientFetcher::~CEpgClientFetcher(void)
+{
+  for (vector<CEpg *>::iterator it = m_fetched.begin(); it != m_fetched.end(); it++)
+    delete *it;
+}
+
+void CEpgClientFetcher::Add(CEpg *epg)
+{
+  m_tables.push_back(epg);
+  m_fetched.push_back(NULL);
+}
+
+void CEpgClientFetcher::Run(void)
+{
+  for (size_t iPtr = 0; iPtr < m_tables.size(); iPtr++)
+  {
+    if (g_EpgContainer.InterruptUpdate())
+      break;
+
+    m_fetched[iPtr] = m_tables[iPtr]->FetchFromClient(m_start, m_end);
+
+    CSingleLock lock(m_critSection);
+    ++m_iProgress;
+  }
+}
+
+unsigned int CEpgClientFetcher::Progress(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_iProgress;
+}
+
 CEpgContainer::CEpgContainer(void) :
     CThread("EPG updater")
 {
@@ -99,6 +139,7 @@ void CEpgContainer::Clear(bool bClearDb /* = false */)
     for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end(); it++)
       delete it->second;
     m_epgs.clear();
+    m_index.Clear();
     m_iNextEpgUpdate  = 0;
     m_bIsInitialising = true;
   }
@@ -167,6 +208,7 @@ void CEpgContainer::LoadFromDB(void)
       }
       UpdateProgressDialog(++iCounter, m_epgs.size(), it->second->Name());
       it->second->Load();
+      m_index.UpdateTable(*it->second);
     }
 
     CloseProgressDialog();
@@ -318,7 +360,10 @@ bool CEpgContainer::RemoveOldEntries(void)
 
   /* call Cleanup() on all known EPG tables */
   for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end(); it++)
+  {
     it->second->Cleanup(now);
+    m_index.UpdateTable(*it->second);
+  }
 
   /* remove the old entries from the database */
   if (!m_bIgnoreDbForClient && m_database.IsOpen())
@@ -361,6 +406,7 @@ bool CEpgContainer::DeleteEpg(const CEpg &epg, bool bDeleteFromDatabase /* = fal
   if (bDeleteFromDatabase && !m_bIgnoreDbForClient && m_database.IsOpen())
     m_database.Delete(*it->second);
 
+  m_index.RemoveTable(it->first);
   delete it->second;
   m_epgs.erase(it);
 
@@ -459,9 +505,14 @@ bool CEpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
     return false;
   }
 
-  /* load or update all EPG tables */
+  EpgUpdateStats stats;
+  unsigned int iPhaseStart = XbmcThreads::SystemClockMillis();
+
+  /* load all EPG tables from the database and check which ones have to be fetched */
   CEpg *epg;
   unsigned int iCounter(0);
+  vector<CEpg *> loadedTables;
+  map<int, CEpgClientFetcher *> fetchers;
   for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end(); it++)
   {
     if (InterruptUpdate())
@@ -471,15 +522,94 @@ bool CEpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
     }
 
     epg = it->second;
-    if (!epg)
+    if (!epg || (bOnlyPending && !epg->UpdatePending()))
       continue;
 
     if (bShowProgress && !bOnlyPending)
-          UpdateProgressDialog(++iCounter, m_epgs.size(), epg->Name());
+      UpdateProgressDialog(++iCounter, m_epgs.size(), epg->Name());
+
+    if (epg->PrepareUpdate(m_iUpdateTime, bOnlyPending))
+    {
+      /* tables without a channel are fetched from their scraper */
+      int iClientId = epg->Channel() ? epg->Channel()->ClientID() : -1;
+      map<int, CEpgClientFetcher *>::iterator fetcher = fetchers.find(iClientId);
+      if (fetcher == fetchers.end())
+        fetcher = fetchers.insert(make_pair(iClientId, new CEpgClientFetcher(start, end))).first;
+      fetcher->second->Add(epg);
+    }
+    else
+      loadedTables.push_back(epg);
+  }
+  stats.iLoadTime = XbmcThreads::SystemClockMillis() - iPhaseStart;
+
+  /* fetch the events of all clients at the same time */
+  iPhaseStart = XbmcThreads::SystemClockMillis();
+  if (!bInterrupted && !fetchers.empty())
+  {
+    unsigned int iTotal(0);
+    vector<CThread *> threads;
+    for (map<int, CEpgClientFetcher *>::iterator it = fetchers.begin(); it != fetchers.end(); it++)
+    {
+      iTotal += it->second->Size();
+      CThread *thread = new CThread(it->second, "EPG fetcher");
+      thread->Create();
+      threads.push_back(thread);
+    }
+
+    for (vector<CThread *>::iterator it = threads.begin(); it != threads.end(); it++)
+    {
+      while (!(*it)->WaitForThreadExit(100))
+      {
+        if (bShowProgress && !bOnlyPending)
+        {
+          unsigned int iProgress(0);
+          for (map<int, CEpgClientFetcher *>::iterator fetcher = fetchers.begin(); fetcher != fetchers.end(); fetcher++)
+            iProgress += fetcher->second->Progress();
+          UpdateProgressDialog(iProgress, iTotal, g_localizeStrings.Get(19004));
+        }
+      }
+      delete *it;
+    }
+
+    bInterrupted = InterruptUpdate();
+  }
+  stats.iFetchTime = XbmcThreads::SystemClockMillis() - iPhaseStart;
+
+  /* merge the fetched events into the tables. the database is only accessed from this thread */
+  iPhaseStart = XbmcThreads::SystemClockMillis();
+  if (!bInterrupted)
+  {
+    for (vector<CEpg *>::iterator it = loadedTables.begin(); it != loadedTables.end(); it++)
+    {
+      if ((*it)->FinishUpdate(false, NULL, &stats))
+      {
+        m_index.UpdateTable(**it);
+        ++iUpdatedTables;
+      }
+    }
 
-    if ((!bOnlyPending || epg->UpdatePending()) && epg->Update(start, end, m_iUpdateTime, bOnlyPending))
-      ++iUpdatedTables;
+    for (map<int, CEpgClientFetcher *>::iterator it = fetchers.begin(); it != fetchers.end(); it++)
+    {
+      CEpgClientFetcher *fetcher = it->second;
+      for (size_t iPtr = 0; iPtr < fetcher->Size(); iPtr++)
+      {
+        if (fetcher->GetTable(iPtr)->FinishUpdate(true, fetcher->GetFetched(iPtr), &stats))
+        {
+          m_index.UpdateTable(*fetcher->GetTable(iPtr));
+          ++iUpdatedTables;
+        }
+      }
+    }
   }
+  stats.iMergeTime = XbmcThreads::SystemClockMillis() - iPhaseStart;
+
+  for (map<int, CEpgClientFetcher *>::iterator it = fetchers.begin(); it != fetchers.end(); it++)
+    delete it->second;
+
+  stats.iTables = iUpdatedTables;
+  CLog::Log(LOGDEBUG, "EpgContainer - %s - updated %u tables in %u ms (load: %u ms, fetch: %u ms, merge: %u ms). %u new, %u changed, %u removed, %u unchanged events",
+      __FUNCTION__, stats.iTables, stats.iLoadTime + stats.iFetchTime + stats.iMergeTime, stats.iLoadTime, stats.iFetchTime, stats.iMergeTime,
+      stats.iNewTags, stats.iChangedTags, stats.iRemovedTags, stats.iUnchangedTags);
 
   if (!bInterrupted)
   {
@@ -509,12 +639,19 @@ bool CEpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
   }
 
   CSingleLock lock(m_critSection);
+  m_updateStats = stats;
   m_bIsUpdating = false;
   m_updateEvent.Set();
 
   return !bInterrupted;
 }
 
+EpgUpdateStats CEpgContainer::GetUpdateStats(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_updateStats;
+}
+
 int CEpgContainer::GetEPGAll(CFileItemList &results)
 {
   int iInitialSize = results.Size();
@@ -564,8 +701,36 @@ int CEpgContainer::GetEPGSearch(CFileItemList &results, const EpgSearchFilter &f
 {
   int iInitialSize = results.Size();
 
-  /* get filtered results from all tables */
+  vector<EpgIndexEntry> candidates;
+  if (!filter.m_strSearchTerm.IsEmpty() &&
+      m_index.GetSearchCandidates(filter.m_strSearchTerm, filter.m_bIsCaseSensitive, candidates))
+  {
+    /* only check the events that contain the search term */
+    CSingleLock lock(m_critSection);
+    CEpg *epg(NULL);
+    for (vector<EpgIndexEntry>::const_iterator it = candidates.begin(); it != candidates.end(); it++)
+    {
+      if (!epg || epg->EpgID() != it->iEpgId)
+        epg = GetById(it->iEpgId);
+      if (!epg || !epg->HasValidEntries())
+        continue;
+
+      CDateTime startTime(it->iStartTime);
+      const CEpgInfoTag *tag = epg->GetTag(it->iUniqueBroadcastId, startTime);
+      if (!tag || !filter.FilterEntry(*tag))
+        continue;
+
+      CDateTime localStartTime;
+      localStartTime.SetFromUTCDateTime(startTime);
+
+      CFileItemPtr entry(new CFileItem(*tag));
+      entry->SetLabel2(localStartTime.GetAsLocalizedDateTime(false, false));
+      results.Add(entry);
+    }
+  }
+  else
   {
+    /* get filtered results from all tables */
     CSingleLock lock(m_critSection);
     for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end(); it++)
       it->second->Get(results, filter);
@@ -28,8 +28,10 @@
 
 #include "Epg.h"
 #include "EpgDatabase.h"
+#include "EpgIndex.h"
 
 #include <map>
+#include <vector>
 
 class CFileItemList;
 class CGUIDialogExtendedProgressBar;
@@ -38,11 +40,67 @@ namespace EPG
 {
   #define g_EpgContainer CEpgContainer::Get()
 
+  /*!
+   * @brief Fetches the events of a set of EPG tables from their client, one table after the other.
+   *
+   * CEpgContainer runs one fetcher per PVR client, so slow clients don't hold up the others.
+   */
+  class CEpgClientFetcher : public IRunnable
+  {
+  public:
+    CEpgClientFetcher(time_t start, time_t end);
+    virtual ~CEpgClientFetcher(void);
+
+    /*!
+     * @brief Add a table to fetch the events for.
+     * @param epg The table.
+     */
+    void Add(CEpg *epg);
+
+    /*!
+     * @brief Fetch the events of all tables. Stops when the update is interrupted.
+     */
+    virtual void Run(void);
+
+    /*!
+     * @return The number of tables that have been handled.
+     */
+    unsigned int Progress(void) const;
+
+    /*!
+     * @return The number of tables in this fetcher.
+     */
+    size_t Size(void) const { return m_tables.size(); }
+
+    /*!
+     * @brief Get a table and the events that were fetched for it.
+     * @param iIndex The index of the table, in the order it was added in.
+     * @return The table.
+     */
+    CEpg *GetTable(size_t iIndex) const { return m_tables[iIndex]; }
+
+    /*!
+     * @brief Get the events that were fetched for a table.
+     * @param iIndex The index of the table, in the order it was added in.
+     * @return The fetched events or NULL if they couldn't be fetched.
+     */
+    const CEpg *GetFetched(size_t iIndex) const { return m_fetched[iIndex]; }
+
+  private:
+    time_t              m_start;       /*!< fetch events after this time */
+    time_t              m_end;         /*!< fetch events before this time */
+    std::vector<CEpg *> m_tables;      /*!< the tables to fetch the events for */
+    std::vector<CEpg *> m_fetched;     /*!< the fetched events, indexed like m_tables */
+    unsigned int        m_iProgress;   /*!< the number of tables that have been handled */
+    CCriticalSection    m_critSection;
+  };
+
   class CEpgContainer : public Observer,
     public Observable,
     private CThread
   {
     friend class CEpgDatabase;
+    friend class CEpgClientFetcher;
 
   public:
     /*!
@@ -61,6 +119,12 @@ namespace EPG
      */
     CEpgDatabase *GetDatabase(void) { return &m_database; }
 
+    /*!
+     * @brief Get the compact index of all EPG tables.
+     * @return The index.
+     */
+    const CEpgIndex &GetIndex(void) const { return m_index; }
+
     /*!
      * @brief Start the EPG update thread.
      */
@@ -219,6 +283,11 @@ namespace EPG
 
     bool PersistTables(void);
 
+    /*!
+     * @return The statistics of the last EPG update.
+     */
+    EpgUpdateStats GetUpdateStats(void) const;
+
   protected:
     /*!
      * @brief Load the EPG settings.
@@ -267,6 +336,7 @@ namespace EPG
     void LoadFromDB(void);
 
     CEpgDatabase m_database;           /*!< the EPG database */
+    CEpgIndex    m_index;              /*!< compact copy of all tables, used for time window queries */
 
     /** @name Configuration */
     //@{
@@ -287,6 +357,7 @@ namespace EPG
     time_t       m_iNextEpgActiveTagCheck; /*!< the time the EPG will be checked for active tag updates */
     unsigned int m_iNextEpgId;             /*!< the next epg ID that will be given to a new table when the db isn't being used */
     std::map<unsigned int, CEpg*> m_epgs;  /*!< the EPGs in this container */
+    EpgUpdateStats m_updateStats;          /*!< statistics of the last update */
     //@}
 
     CGUIDialogExtendedProgressBar *m_progressDialog; /*!< the progress dialog that is visible when updating the first time */
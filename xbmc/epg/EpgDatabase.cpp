@@ -201,15 +201,30 @@ bool CEpgDatabase::DeleteOldEpgEntries(void)
   return DeleteValues("epgtags", strWhereClause);
 }
 
-bool CEpgDatabase::Delete(const CEpgInfoTag &tag)
+bool CEpgDatabase::Delete(const CEpgInfoTag &tag, bool bQueueWrite /* = false */)
 {
-  /* tag without a database ID was not persisted */
-  if (tag.BroadcastId() <= 0)
+  CStdString strWhereClause;
+  if (tag.BroadcastId() > 0)
+  {
+    strWhereClause = FormatSQL("idBroadcast = %u", tag.BroadcastId());
+  }
+  else if (tag.EpgID() > 0)
+  {
+    /* tags that were queued for writing don't know their database ID. (idEpg, iStartTime) is unique too */
+    time_t iStartTime;
+    tag.StartAsUTC().GetAsTime(iStartTime);
+    strWhereClause = FormatSQL("idEpg = %u AND iStartTime = %u", tag.EpgID(), iStartTime);
+  }
+  else
+  {
+    /* tag was not persisted */
     return false;
-
-  CStdString strWhereClause = FormatSQL("idBroadcast = %u", tag.BroadcastId());
+  }
 
   CSingleLock lock(m_critSection);
+  if (bQueueWrite)
+    return QueueInsertQuery("DELETE FROM epgtags WHERE " + strWhereClause);
+
   return DeleteValues("epgtags", strWhereClause);
 }
 
@@ -409,7 +424,8 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
 
   if (iBroadcastId < 0)
   {
-    strQuery = FormatSQL("INSERT INTO epgtags (idEpg, iStartTime, "
+    /* (idEpg, iStartTime) is unique, so this replaces tags that were queued before and don't know their ID */
+    strQuery = FormatSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
         "iEndTime, sTitle, sPlotOutline, sPlot, iGenreType, iGenreSubType, sGenre, "
         "iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
         "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid) "
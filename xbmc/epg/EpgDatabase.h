@@ -89,10 +89,14 @@ namespace EPG
 
     /*!
      * @brief Remove a single EPG entry.
+     *
+     * Entries without a database ID are looked up by table and start time.
+     *
      * @param tag The entry to remove.
-     * @return True if it was removed successfully, false otherwise.
+     * @param bQueueWrite If true, don't execute the query yet but queue it. CommitInsertQueries() executes it.
+     * @return True if it was removed or queued successfully, false otherwise.
      */
-    virtual bool Delete(const CEpgInfoTag &tag);
+    virtual bool Delete(const CEpgInfoTag &tag, bool bQueueWrite = false);
 
     /*!
      * @brief Get all EPG tables from the database. Does not get the EPG tables' entries.
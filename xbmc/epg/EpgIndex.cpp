@@ -0,0 +1,317 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "EpgIndex.h"
+#include "Epg.h"
+#include "EpgInfoTag.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace EPG;
+
+/* rebuild the string pool when it holds this many times more strings than there are events */
+#define EPG_INDEX_STRINGPOOL_SLACK 4
+
+CEpgStringPool::CEpgStringPool(void)
+{
+  /* ID 0 is always the empty string */
+  Intern(StringUtils::EmptyString);
+}
+
+unsigned int CEpgStringPool::Intern(const CStdString &strValue)
+{
+  map<CStdString, unsigned int>::const_iterator it = m_lookup.find(strValue);
+  if (it != m_lookup.end())
+    return it->second;
+
+  unsigned int iStringId = (unsigned int) m_strings.size();
+  m_strings.push_back(strValue);
+  m_lookup.insert(make_pair(strValue, iStringId));
+
+  return iStringId;
+}
+
+const CStdString &CEpgStringPool::Get(unsigned int iStringId) const
+{
+  return iStringId < m_strings.size() ? m_strings[iStringId] : StringUtils::EmptyString;
+}
+
+void CEpgStringPool::Clear(void)
+{
+  m_strings.clear();
+  m_lookup.clear();
+  Intern(StringUtils::EmptyString);
+}
+
+CEpgIndex::CEpgIndex(void) :
+    m_iEntries(0)
+{
+}
+
+CEpgIndex::~CEpgIndex(void)
+{
+  Clear();
+}
+
+bool CEpgIndex::SortByChannel(const EpgIndexTable *left, const EpgIndexTable *right)
+{
+  if (left->iChannelNumber != right->iChannelNumber)
+    return left->iChannelNumber < right->iChannelNumber;
+
+  return left->iEpgId < right->iEpgId;
+}
+
+bool CEpgIndex::SortByStartTime(const EpgIndexEntry &left, const EpgIndexEntry &right)
+{
+  return left.iStartTime < right.iStartTime;
+}
+
+CTextSearchIndex::DocumentId CEpgIndex::GetDocumentId(int iEpgId, time_t iStartTime)
+{
+  return ((CTextSearchIndex::DocumentId)(uint32_t) iEpgId << 32) | (uint32_t) iStartTime;
+}
+
+void CEpgIndex::UpdateTable(const CEpg &epg)
+{
+  EpgIndexTable *table = new EpgIndexTable;
+  table->iEpgId         = epg.EpgID();
+  table->iChannelNumber = epg.ChannelNumber();
+
+  CSingleLock lock(m_critSection);
+
+  /* the words of the events are patched rather than rebuilt, most of the events don't change between updates */
+  const EpgIndexTable *oldTable = GetTable(table->iEpgId);
+  vector<EpgIndexEntry>::const_iterator oldEntry;
+  if (oldTable)
+    oldEntry = oldTable->entries.begin();
+
+  {
+    CSingleLock epgLock(epg.m_critSection);
+    table->entries.reserve(epg.m_tags.size());
+    table->maxEnd.reserve(epg.m_tags.size());
+
+    /* m_tags is sorted by start time already */
+    time_t iMaxEnd(0);
+    for (map<CDateTime, CEpgInfoTag *>::const_iterator it = epg.m_tags.begin(); it != epg.m_tags.end(); it++)
+    {
+      const CEpgInfoTag *tag = it->second;
+      EpgIndexEntry entry;
+      tag->StartAsUTC().GetAsTime(entry.iStartTime);
+      tag->EndAsUTC().GetAsTime(entry.iEndTime);
+      entry.iEpgId             = table->iEpgId;
+      entry.iUniqueBroadcastId = tag->UniqueBroadcastID();
+      entry.iGenreType         = tag->GenreType();
+      entry.iTitleId           = m_strings.Intern(tag->Title());
+
+      /* drop the words of the old events that were removed before this one */
+      for (; oldTable && oldEntry != oldTable->entries.end() && oldEntry->iStartTime < entry.iStartTime; oldEntry++)
+        m_words.Remove(GetDocumentId(oldEntry->iEpgId, oldEntry->iStartTime));
+      if (oldTable && oldEntry != oldTable->entries.end() && oldEntry->iStartTime == entry.iStartTime)
+        oldEntry++;
+
+      m_words.Update(GetDocumentId(entry.iEpgId, entry.iStartTime), tag->Title() + " " + tag->PlotOutline());
+
+      if (entry.iEndTime > iMaxEnd)
+        iMaxEnd = entry.iEndTime;
+
+      table->entries.push_back(entry);
+      table->maxEnd.push_back(iMaxEnd);
+    }
+  }
+
+  for (; oldTable && oldEntry != oldTable->entries.end(); oldEntry++)
+    m_words.Remove(GetDocumentId(oldEntry->iEpgId, oldEntry->iStartTime));
+
+  RemoveTableUnlocked(table->iEpgId, false);
+  m_iEntries += table->entries.size();
+  m_tables.insert(upper_bound(m_tables.begin(), m_tables.end(), table, SortByChannel), table);
+  m_tablesById[table->iEpgId] = table;
+
+  if (m_strings.Size() > EPG_INDEX_STRINGPOOL_SLACK * m_iEntries + 1024)
+    CompactStrings();
+}
+
+void CEpgIndex::RemoveTable(int iEpgId)
+{
+  CSingleLock lock(m_critSection);
+  RemoveTableUnlocked(iEpgId, true);
+}
+
+void CEpgIndex::RemoveTableUnlocked(int iEpgId, bool bRemoveWords)
+{
+  map<int, EpgIndexTable *>::iterator byId = m_tablesById.find(iEpgId);
+  if (byId == m_tablesById.end())
+    return;
+
+  EpgIndexTable *table = byId->second;
+  m_tablesById.erase(byId);
+  m_tables.erase(find(m_tables.begin(), m_tables.end(), table));
+
+  m_iEntries -= table->entries.size();
+  if (bRemoveWords)
+    m_words.RemoveRange(GetDocumentId(iEpgId, 0), GetDocumentId(iEpgId, (time_t) 0xFFFFFFFF));
+  delete table;
+}
+
+void CEpgIndex::Clear(void)
+{
+  CSingleLock lock(m_critSection);
+  for (vector<EpgIndexTable *>::iterator it = m_tables.begin(); it != m_tables.end(); it++)
+    delete *it;
+  m_tables.clear();
+  m_tablesById.clear();
+  m_strings.Clear();
+  m_words.Clear();
+  m_iEntries = 0;
+}
+
+void CEpgIndex::CompactStrings(void)
+{
+  /* titles of removed events are never released from the pool. re-intern the ones that are still in use */
+  CEpgStringPool strings;
+  for (vector<EpgIndexTable *>::iterator it = m_tables.begin(); it != m_tables.end(); it++)
+  {
+    vector<EpgIndexEntry> &entries = (*it)->entries;
+    for (vector<EpgIndexEntry>::iterator entryIt = entries.begin(); entryIt != entries.end(); entryIt++)
+      entryIt->iTitleId = strings.Intern(m_strings.Get(entryIt->iTitleId));
+  }
+
+  m_strings = strings;
+}
+
+int CEpgIndex::GetTableRange(const EpgIndexTable &table, time_t start, time_t end, vector<EpgIndexEntry> &results)
+{
+  int iInitialSize = (int) results.size();
+
+  /* maxEnd is sorted, so this finds the first event that could still be running at 'start'.
+     the entries are sorted by start time, so the last one that starts before 'end' is found the same way */
+  EpgIndexEntry last;
+  last.iStartTime = end;
+  vector<EpgIndexEntry>::const_iterator first = table.entries.begin() +
+      (upper_bound(table.maxEnd.begin(), table.maxEnd.end(), start) - table.maxEnd.begin());
+  vector<EpgIndexEntry>::const_iterator stop = lower_bound(first, table.entries.end(), last, SortByStartTime);
+
+  for (vector<EpgIndexEntry>::const_iterator it = first; it < stop; it++)
+  {
+    if (it->iEndTime > start)
+      results.push_back(*it);
+  }
+
+  return (int) results.size() - iInitialSize;
+}
+
+int CEpgIndex::GetRange(time_t start, time_t end, int iFirstChannel, int iLastChannel, vector<EpgIndexEntry> &results) const
+{
+  int iInitialSize = (int) results.size();
+
+  EpgIndexTable first;
+  first.iChannelNumber = iFirstChannel;
+  first.iEpgId         = -1;
+
+  CSingleLock lock(m_critSection);
+  for (vector<EpgIndexTable *>::const_iterator it = lower_bound(m_tables.begin(), m_tables.end(), &first, SortByChannel);
+      it != m_tables.end() && (iLastChannel < 0 || (*it)->iChannelNumber <= iLastChannel); it++)
+    GetTableRange(**it, start, end, results);
+
+  return (int) results.size() - iInitialSize;
+}
+
+int CEpgIndex::GetTableRange(int iEpgId, time_t start, time_t end, vector<EpgIndexEntry> &results) const
+{
+  CSingleLock lock(m_critSection);
+  const EpgIndexTable *table = GetTable(iEpgId);
+
+  return table ? GetTableRange(*table, start, end, results) : 0;
+}
+
+const CEpgIndex::EpgIndexTable *CEpgIndex::GetTable(int iEpgId) const
+{
+  map<int, EpgIndexTable *>::const_iterator it = m_tablesById.find(iEpgId);
+  return it != m_tablesById.end() ? it->second : NULL;
+}
+
+bool CEpgIndex::GetSearchCandidates(const CStdString &strSearchTerm, bool bCaseSensitive, vector<EpgIndexEntry> &results) const
+{
+  CTextSearch search(strSearchTerm, bCaseSensitive, SEARCH_DEFAULT_OR);
+
+  /* all AND terms have to match, so the first one narrows the search down enough. otherwise one
+     of the OR terms has to match. searches that only have NOT terms can't use the index */
+  vector<CStdString> terms;
+  if (!search.GetANDTerms().empty())
+    terms.push_back(search.GetANDTerms().front());
+  else
+    terms = search.GetORTerms();
+
+  if (terms.empty())
+    return false;
+
+  CSingleLock lock(m_critSection);
+  vector<CTextSearchIndex::DocumentId> documents;
+  for (vector<CStdString>::const_iterator it = terms.begin(); it != terms.end(); it++)
+  {
+    /* a term without words can match events that have none */
+    if (it->find_first_not_of(" \t\r\n") == CStdString::npos)
+      return false;
+
+    vector<CTextSearchIndex::DocumentId> found;
+    m_words.FindSubstring(*it, found);
+    documents.insert(documents.end(), found.begin(), found.end());
+  }
+
+  sort(documents.begin(), documents.end());
+  documents.erase(unique(documents.begin(), documents.end()), documents.end());
+
+  const EpgIndexTable *table = NULL;
+  for (vector<CTextSearchIndex::DocumentId>::const_iterator it = documents.begin(); it != documents.end(); it++)
+  {
+    EpgIndexEntry key;
+    key.iEpgId     = (int)(uint32_t)(*it >> 32);
+    key.iStartTime = (time_t)(uint32_t)(*it & 0xFFFFFFFF);
+
+    /* documents are sorted by table */
+    if (!table || table->iEpgId != key.iEpgId)
+      table = GetTable(key.iEpgId);
+    if (!table)
+      continue;
+
+    vector<EpgIndexEntry>::const_iterator entry = lower_bound(table->entries.begin(), table->entries.end(), key, SortByStartTime);
+    if (entry != table->entries.end() && entry->iStartTime == key.iStartTime)
+      results.push_back(*entry);
+  }
+
+  return true;
+}
+
+CStdString CEpgIndex::GetString(unsigned int iStringId) const
+{
+  CSingleLock lock(m_critSection);
+  return m_strings.Get(iStringId);
+}
+
+size_t CEpgIndex::Size(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_iEntries;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+#include "utils/TextSearchIndex.h"
+#include "threads/CriticalSection.h"
+
+#include <map>
+#include <vector>
+#include <time.h>
+
+namespace EPG
+{
+  class CEpg;
+
+  /*!
+   * @brief Fixed size record of an EPG event, as stored in CEpgIndex.
+   */
+  struct EpgIndexEntry
+  {
+    time_t       iStartTime;         /*!< start time in UTC */
+    time_t       iEndTime;           /*!< end time in UTC */
+    int          iEpgId;             /*!< the table this event belongs to */
+    int          iUniqueBroadcastId; /*!< the unique broadcast ID of this event */
+    int          iGenreType;         /*!< genre type */
+    unsigned int iTitleId;           /*!< the title, interned in the index' string pool */
+  };
+
+  /*!
+   * @brief Pool of interned strings. Each distinct string is stored once and referred to by ID.
+   */
+  class CEpgStringPool
+  {
+  public:
+    CEpgStringPool(void);
+
+    /*!
+     * @brief Get the ID of a string, adding it to the pool if it wasn't added before.
+     * @param strValue The string to intern.
+     * @return The ID of the string.
+     */
+    unsigned int Intern(const CStdString &strValue);
+
+    /*!
+     * @brief Get a string given it's ID.
+     * @param iStringId The ID returned by Intern().
+     * @return The string or an empty string if the ID is unknown.
+     */
+    const CStdString &Get(unsigned int iStringId) const;
+
+    /*!
+     * @return The number of distinct strings in this pool.
+     */
+    size_t Size(void) const { return m_strings.size(); }
+
+    /*!
+     * @brief Remove all strings from this pool.
+     */
+    void Clear(void);
+
+  private:
+    std::vector<CStdString>             m_strings; /*!< the strings, indexed by ID */
+    std::map<CStdString, unsigned int>  m_lookup;  /*!< string to ID lookup table */
+  };
+
+  /*!
+   * @brief Compact, read-optimised copy of all EPG tables.
+   *
+   * Events are kept per channel in arrays sorted by start time, together with a running maximum
+   * of the end times, so all events overlapping a time window can be found with a binary search
+   * instead of walking every CEpgInfoTag. The words in the titles and plot outlines are kept in
+   * a CTextSearchIndex, so searches only have to look at the events that can match.
+   */
+  class CEpgIndex
+  {
+  public:
+    CEpgIndex(void);
+    virtual ~CEpgIndex(void);
+
+    /*!
+     * @brief (Re)create the entries of an EPG table.
+     * @param epg The table to copy the events from.
+     */
+    void UpdateTable(const CEpg &epg);
+
+    /*!
+     * @brief Remove the entries of an EPG table.
+     * @param iEpgId The ID of the table.
+     */
+    void RemoveTable(int iEpgId);
+
+    /*!
+     * @brief Remove all entries.
+     */
+    void Clear(void);
+
+    /*!
+     * @brief Get all events that overlap the given time window on the given channels.
+     * @param start The start of the window in UTC.
+     * @param end The end of the window in UTC.
+     * @param iFirstChannel The first channel number to return events for.
+     * @param iLastChannel The last channel number to return events for, or -1 for all channels after iFirstChannel.
+     * @param results The events that were found, sorted by channel number and start time.
+     * @return The amount of events that were added.
+     */
+    int GetRange(time_t start, time_t end, int iFirstChannel, int iLastChannel, std::vector<EpgIndexEntry> &results) const;
+
+    /*!
+     * @brief Get all events of an EPG table that overlap the given time window.
+     * @param iEpgId The ID of the table.
+     * @param start The start of the window in UTC.
+     * @param end The end of the window in UTC.
+     * @param results The events that were found, sorted by start time.
+     * @return The amount of events that were added.
+     */
+    int GetTableRange(int iEpgId, time_t start, time_t end, std::vector<EpgIndexEntry> &results) const;
+
+    /*!
+     * @brief Get the events that can match the given search term.
+     *
+     * The results are a superset of the events for which EpgSearchFilter::MatchSearchTerm() is true,
+     * so the filter still has to be applied to each of them.
+     *
+     * @param strSearchTerm The search term, in CTextSearch syntax.
+     * @param bCaseSensitive True if the search is case sensitive.
+     * @param results The events that were found, sorted by table ID and start time.
+     * @return False if the index can't narrow down this search term and all events have to be checked.
+     */
+    bool GetSearchCandidates(const CStdString &strSearchTerm, bool bCaseSensitive, std::vector<EpgIndexEntry> &results) const;
+
+    /*!
+     * @brief Get an interned string.
+     * @param iStringId The ID of the string.
+     * @return The string.
+     */
+    CStdString GetString(unsigned int iStringId) const;
+
+    /*!
+     * @return The total number of events in this index.
+     */
+    size_t Size(void) const;
+
+  private:
+    struct EpgIndexTable
+    {
+      int                        iEpgId;
+      int                        iChannelNumber;
+      std::vector<EpgIndexEntry> entries; /*!< the events, sorted by start time */
+      std::vector<time_t>        maxEnd;  /*!< maxEnd[i] is the latest end time of entries[0..i] */
+    };
+
+    static bool SortByChannel(const EpgIndexTable *left, const EpgIndexTable *right);
+    static bool SortByStartTime(const EpgIndexEntry &left, const EpgIndexEntry &right);
+    static int GetTableRange(const EpgIndexTable &table, time_t start, time_t end, std::vector<EpgIndexEntry> &results);
+
+    static CTextSearchIndex::DocumentId GetDocumentId(int iEpgId, time_t iStartTime);
+    const EpgIndexTable *GetTable(int iEpgId) const;
+    void RemoveTableUnlocked(int iEpgId, bool bRemoveWords);
+    void CompactStrings(void);
+
+    std::vector<EpgIndexTable *> m_tables;      /*!< the tables, sorted by channel number */
+    std::map<int, EpgIndexTable *> m_tablesById; /*!< the same tables, by EPG ID */
+    CEpgStringPool               m_strings;     /*!< interned titles */
+    CTextSearchIndex             m_words;       /*!< the words in the titles and plot outlines */
+    size_t                       m_iEntries;    /*!< total number of events */
+    CCriticalSection             m_critSection;
+  };
+}
@@ -952,6 +952,11 @@ bool CEpgInfoTag::Persist(bool bSingleUpdate /* = true */)
       m_iBroadcastId = iId;
       m_bChanged = false;
     }
+    else if (!bSingleUpdate)
+    {
+      /* the write was queued and is committed by the caller */
+      m_bChanged = false;
+    }
   }
 
   return bReturn;
@@ -31,6 +31,7 @@
 #include "threads/SystemClock.h"
 #include "GUIInfoManager.h"
 
+#include "epg/EpgContainer.h"
 #include "epg/EpgInfoTag.h"
 #include "pvr/channels/PVRChannel.h"
 
@@ -92,6 +93,10 @@ CGUIEPGGridContainer::CGUIEPGGridContainer(int parentID, int controlID, float po
   m_cacheRulerItems       = preloadItems;
   m_cacheProgrammeItems   = preloadItems;
   m_gridIndex             = NULL;
+  m_iGridIndexRows        = 0;
+  m_boundItems            = NULL;
+  m_bUseEpgIndex          = false;
+  m_iProgrammeItemsOffset = 0;
 }
 
 CGUIEPGGridContainer::~CGUIEPGGridContainer(void)
@@ -318,12 +323,12 @@ void CGUIEPGGridContainer::Render()
     int block = blockOffset;
     float posA2 = posA;
 
-    CGUIListItemPtr item = m_gridIndex[channel][block].item;
-    if (blockOffset > 0 && item == m_gridIndex[channel][blockOffset-1].item)
+    CGUIListItemPtr item = GetGridRow(channel)[block].item;
+    if (blockOffset > 0 && item == GetGridRow(channel)[blockOffset-1].item)
     {
       /* first program starts before current view */
       int startBlock = blockOffset - 1;
-      while (m_gridIndex[channel][startBlock].item == item)
+      while (GetGridRow(channel)[startBlock].item == item)
         startBlock--;
 
       block = startBlock + 1;
@@ -333,11 +338,11 @@ void CGUIEPGGridContainer::Render()
 
     while (posA2 < endA && m_programmeItems.size())   // FOR EACH ITEM ///////////////
     {
-      item = m_gridIndex[channel][block].item;
+      item = GetGridRow(channel)[block].item;
       if (!item || !item.get()->IsFileItem())
         break;
 
-      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == m_gridIndex[m_channelOffset + m_channelCursor][m_blockOffset + m_blockCursor].item);
+      bool focused = (channel == m_channelOffset + m_channelCursor) && (item == GetGridRow(m_channelOffset + m_channelCursor)[m_blockOffset + m_blockCursor].item);
 
       // render our item
       if (focused)
@@ -353,27 +358,27 @@ void CGUIEPGGridContainer::Render()
           focusedPosY = posA2;
         }
         focusedItem = item;
-        focusedwidth = m_gridIndex[channel][block].width;
-        focusedheight = m_gridIndex[channel][block].height;
+        focusedwidth = GetGridRow(channel)[block].width;
+        focusedheight = GetGridRow(channel)[block].height;
       }
       else
       {
         if (m_orientation == VERTICAL)
-          RenderProgrammeItem(posA2, posB, m_gridIndex[channel][block].width, m_gridIndex[channel][block].height, item.get(), focused);
+          RenderProgrammeItem(posA2, posB, GetGridRow(channel)[block].width, GetGridRow(channel)[block].height, item.get(), focused);
         else
-          RenderProgrammeItem(posB, posA2, m_gridIndex[channel][block].width, m_gridIndex[channel][block].height, item.get(), focused);
+          RenderProgrammeItem(posB, posA2, GetGridRow(channel)[block].width, GetGridRow(channel)[block].height, item.get(), focused);
       }
 
       // increment our X position
       if (m_orientation == VERTICAL)
       {
-        posA2 += m_gridIndex[channel][block].width; // assumes focused & unfocused layouts have equal length
-        block += (int)(m_gridIndex[channel][block].width / m_blockSize);
+        posA2 += GetGridRow(channel)[block].width; // assumes focused & unfocused layouts have equal length
+        block += (int)(GetGridRow(channel)[block].width / m_blockSize);
       }
       else
       {
-        posA2 += m_gridIndex[channel][block].height; // assumes focused & unfocused layouts have equal length
-        block += (int)(m_gridIndex[channel][block].height / m_blockSize);
+        posA2 += GetGridRow(channel)[block].height; // assumes focused & unfocused layouts have equal length
+        block += (int)(GetGridRow(channel)[block].height / m_blockSize);
       }
     }
 
@@ -674,54 +679,74 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
       Reset();
       CFileItemList *items = (CFileItemList *)message.GetPointer();
 
-      /* Create Channel items */
-      int iLastChannelNumber = -1;
-      ItemsPtr itemsPointer;
-      itemsPointer.start = 0;
-      for (int i = 0; i < items->Size(); ++i)
+      /* a list of channels is bound when the programmes should be loaded from the epg index */
+      m_bUseEpgIndex = items->Size() > 0 && items->Get(0)->HasPVRChannelInfoTag();
+      if (m_bUseEpgIndex)
       {
-        const CEpgInfoTag* tag = items->Get(i)->GetEPGInfoTag();
-        if (!tag || !tag->HasPVRChannel())
-          continue;
+        for (int i = 0; i < items->Size(); ++i)
+        {
+          if (items->Get(i)->HasPVRChannelInfoTag())
+            m_channelItems.push_back(items->Get(i));
+        }
 
-        int iCurrentChannelNumber = tag->PVRChannelNumber();
-        if (iCurrentChannelNumber != iLastChannelNumber)
+        /* programme items are appended to the bound list as they are loaded, so the
+           selected item's index still refers to an item in that list */
+        m_boundItems = items;
+        m_iProgrammeItemsOffset = items->Size();
+
+        ItemsPtr itemsPointer;
+        itemsPointer.start = 0;
+        itemsPointer.stop  = 0;
+        m_epgItemsPtr.resize(m_channelItems.size(), itemsPointer);
+      }
+      else
+      {
+        /* Create Channel items */
+        int iLastChannelNumber = -1;
+        ItemsPtr itemsPointer;
+        itemsPointer.start = 0;
+        for (int i = 0; i < items->Size(); ++i)
         {
-          const CPVRChannel *channel = tag->ChannelTag();
-          if (!channel)
+          const CEpgInfoTag* tag = items->Get(i)->GetEPGInfoTag();
+          if (!tag || !tag->HasPVRChannel())
             continue;
 
-          if (i > 0)
+          int iCurrentChannelNumber = tag->PVRChannelNumber();
+          if (iCurrentChannelNumber != iLastChannelNumber)
           {
-            itemsPointer.stop = i-1;
-            m_epgItemsPtr.push_back(itemsPointer);
-            itemsPointer.start = i;
+            const CPVRChannel *channel = tag->ChannelTag();
+            if (!channel)
+              continue;
+
+            if (i > 0)
+            {
+              itemsPointer.stop = i-1;
+              m_epgItemsPtr.push_back(itemsPointer);
+              itemsPointer.start = i;
+            }
+            iLastChannelNumber = iCurrentChannelNumber;
+            CGUIListItemPtr item(new CFileItem(*channel));
+            m_channelItems.push_back(item);
           }
-          iLastChannelNumber = iCurrentChannelNumber;
-          CGUIListItemPtr item(new CFileItem(*channel));
-          m_channelItems.push_back(item);
         }
-      }
-      if (m_epgItemsPtr.size() > 0)
-      {
-        itemsPointer.stop = items->Size()-1;
-        m_epgItemsPtr.push_back(itemsPointer);
-      }
-
-      /* Create programme items */
-      for (int i = 0; i < items->Size(); i++)
-        m_programmeItems.push_back(items->Get(i));
-
-      ClearGridIndex();
-      m_gridIndex = (struct GridItemsPtr **) calloc(1,m_channelItems.size()*sizeof(struct GridItemsPtr));
-      if (m_gridIndex != NULL)
-      {
-        for (unsigned int i = 0; i < m_channelItems.size(); i++)
+        if (m_epgItemsPtr.size() > 0)
         {
-          m_gridIndex[i] = (struct GridItemsPtr*) calloc(1,MAXBLOCKS*sizeof(struct GridItemsPtr));
+          itemsPointer.stop = items->Size()-1;
+          m_epgItemsPtr.push_back(itemsPointer);
         }
+
+        /* Create programme items */
+        for (int i = 0; i < items->Size(); i++)
+          m_programmeItems.push_back(items->Get(i));
       }
 
+      /* rows of the grid are filled when they're accessed for the first time */
+      ClearGridIndex();
+      m_gridIndex = new GridItemsPtr *[m_channelItems.size()];
+      for (unsigned int i = 0; i < m_channelItems.size(); i++)
+        m_gridIndex[i] = NULL;
+      m_iGridIndexRows = m_channelItems.size();
+
       UpdateLayout(true); // true to refresh all items
 
       /* Create Ruler items */
@@ -742,6 +767,12 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
       //SelectItem(message.GetParam1());
       return true;
     }
+    else if (message.GetMessage() == GUI_MSG_LABEL_RESET)
+    {
+      /* the bound list is about to be cleared or refilled, don't append to it anymore */
+      Reset();
+      return true;
+    }
     else if (message.GetMessage() == GUI_MSG_REFRESH_LIST)
     { // update our list contents
       for (unsigned int i = 0; i < m_channelItems.size(); ++i)
@@ -758,7 +789,7 @@ bool CGUIEPGGridContainer::OnMessage(CGUIMessage& message)
 
 void CGUIEPGGridContainer::UpdateItems()
 {
-  CDateTimeSpan blockDuration, gridDuration;
+  CDateTimeSpan gridDuration;
 
   /* check for invalid start and end time */
   if (m_gridStart >= m_gridEnd)
@@ -784,106 +815,158 @@ void CGUIEPGGridContainer::UpdateItems()
     return;
   }
 
-  blockDuration.SetDateTimeSpan(0, 0, MINSPERBLOCK, 0);
+  m_channels = (int)m_channelItems.size();
+  m_item = GetItem(m_channelCursor);
+  if (m_item)
+    m_blockCursor = GetBlock(m_item->item, m_channelCursor);
 
-  long tick(XbmcThreads::SystemClockMillis());
+  SetInvalid();
+}
+
+GridItemsPtr *CGUIEPGGridContainer::GetGridRow(int row)
+{
+  if (!m_gridIndex[row])
+    LoadGridRow(row);
 
-  for (unsigned int row = 0; row < m_channelItems.size(); ++row)
+  return m_gridIndex[row];
+}
+
+void CGUIEPGGridContainer::LoadProgrammeItems(int row)
+{
+  ItemsPtr &itemsPointer = m_epgItemsPtr[row];
+  itemsPointer.start = (long) m_programmeItems.size();
+  itemsPointer.stop  = itemsPointer.start - 1;
+
+  if (!m_boundItems)
+    return;
+
+  const CFileItem *channelItem = (const CFileItem *) m_channelItems[row].get();
+  const CPVRChannel *channel = channelItem->GetPVRChannelInfoTag();
+  CEpg *epg = g_EpgContainer.GetById(channel->EpgID());
+  if (!epg)
+    return;
+
+  time_t gridStart, gridEnd;
+  m_gridStart.GetAsUTCDateTime().GetAsTime(gridStart);
+  m_gridEnd.GetAsUTCDateTime().GetAsTime(gridEnd);
+
+  vector<EpgIndexEntry> entries;
+  g_EpgContainer.GetIndex().GetTableRange(epg->EpgID(), gridStart, gridEnd, entries);
+
+  for (vector<EpgIndexEntry>::const_iterator it = entries.begin(); it != entries.end(); it++)
   {
-    CDateTime gridCursor  = m_gridStart; //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[row].start;
-    unsigned long lastIdx = m_epgItemsPtr[row].stop;
-    int channelnum        = ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag()->PVRChannelNumber();
+    const CEpgInfoTag *tag = epg->GetTag(it->iUniqueBroadcastId, CDateTime(it->iStartTime));
+    if (!tag)
+      continue;
 
-    /** FOR EACH BLOCK **********************************************************************/
+    CFileItemPtr item(new CFileItem(*tag));
+    m_boundItems->Add(item);
+    m_programmeItems.push_back(item);
+  }
 
-    for (int block = 0; block < m_blocks; block++)
+  itemsPointer.stop = (long) m_programmeItems.size() - 1;
+}
+
+void CGUIEPGGridContainer::LoadGridRow(int row)
+{
+  m_gridIndex[row] = new GridItemsPtr[MAXBLOCKS + 1];
+  for (int block = 0; block <= MAXBLOCKS; block++)
+  {
+    m_gridIndex[row][block].width  = 0;
+    m_gridIndex[row][block].height = 0;
+  }
+
+  if (m_bUseEpgIndex)
+    LoadProgrammeItems(row);
+
+  CDateTimeSpan blockDuration;
+  blockDuration.SetDateTimeSpan(0, 0, MINSPERBLOCK, 0);
+
+  CDateTime gridCursor = m_gridStart;
+  long progIdx         = m_epgItemsPtr[row].start;
+  long lastIdx         = m_epgItemsPtr[row].stop;
+  int channelnum       = progIdx <= lastIdx ? ((CFileItem *)m_programmeItems[progIdx].get())->GetEPGInfoTag()->PVRChannelNumber() : -1;
+
+  /** FOR EACH BLOCK **********************************************************************/
+
+  for (int block = 0; block < m_blocks; block++)
+  {
+    while (progIdx <= lastIdx)
     {
-      while (progIdx <= lastIdx)
+      CGUIListItemPtr item = m_programmeItems[progIdx];
+      const CEpgInfoTag* tag = ((CFileItem *)item.get())->GetEPGInfoTag();
+      if (tag == NULL)
       {
-        CGUIListItemPtr item = m_programmeItems[progIdx];
-        const CEpgInfoTag* tag = ((CFileItem *)item.get())->GetEPGInfoTag();
-        if (tag == NULL)
-          progIdx++;
+        progIdx++;
+        continue;
+      }
 
-        if (tag->PVRChannelNumber() != channelnum)
-          break;
+      if (tag->PVRChannelNumber() != channelnum)
+        break;
 
-        if (m_gridEnd <= tag->StartAsLocalTime())
-        {
-          break;
-        }
-        else if (gridCursor >= tag->EndAsLocalTime())
-        {
-          progIdx++;
-        }
-        else if (gridCursor < tag->EndAsLocalTime())
-        {
-          m_gridIndex[row][block].item = item;
-          break;
-        }
-        else
-        {
-          progIdx++;
-        }
+      if (m_gridEnd <= tag->StartAsLocalTime())
+      {
+        break;
+      }
+      else if (gridCursor >= tag->EndAsLocalTime())
+      {
+        progIdx++;
+      }
+      else if (gridCursor < tag->EndAsLocalTime())
+      {
+        m_gridIndex[row][block].item = item;
+        break;
+      }
+      else
+      {
+        progIdx++;
       }
-
-      gridCursor += blockDuration;
     }
 
-    /** FOR EACH BLOCK **********************************************************************/
-    int itemSize = 1; // size of the programme in blocks
-    int savedBlock = 0;
+    gridCursor += blockDuration;
+  }
+
+  /** FOR EACH BLOCK **********************************************************************/
+  int itemSize = 1; // size of the programme in blocks
+  int savedBlock = 0;
 
-    for (int block = 0; block < m_blocks; block++)
+  for (int block = 0; block < m_blocks; block++)
+  {
+    if (m_gridIndex[row][block].item != m_gridIndex[row][block+1].item)
     {
-      if (m_gridIndex[row][block].item != m_gridIndex[row][block+1].item)
+      if (!m_gridIndex[row][block].item)
       {
-        if (!m_gridIndex[row][block].item)
+        CEpgInfoTag broadcast;
+        CFileItemPtr unknown(new CFileItem(broadcast));
+        for (int i = block ; i > block - itemSize; i--)
         {
-          CEpgInfoTag broadcast;
-          CFileItemPtr unknown(new CFileItem(broadcast));
-          for (int i = block ; i > block - itemSize; i--)
-          {
-            m_gridIndex[row][i].item = unknown;
-          }
+          m_gridIndex[row][i].item = unknown;
         }
+      }
 
-        CGUIListItemPtr item = m_gridIndex[row][block].item;
-        CFileItem *fileItem = (CFileItem *)item.get();
-
-        m_gridIndex[row][savedBlock].item->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
-        if (m_orientation == VERTICAL)
-        {
-          m_gridIndex[row][savedBlock].width   = itemSize*m_blockSize;
-          m_gridIndex[row][savedBlock].height  = m_channelHeight;
-        }
-        else
-        {
-          m_gridIndex[row][savedBlock].width   = m_channelWidth;
-          m_gridIndex[row][savedBlock].height  = itemSize*m_blockSize;
-        }
+      CGUIListItemPtr item = m_gridIndex[row][block].item;
+      CFileItem *fileItem = (CFileItem *)item.get();
 
-        itemSize = 1;
-        savedBlock = block+1;
+      m_gridIndex[row][savedBlock].item->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
+      if (m_orientation == VERTICAL)
+      {
+        m_gridIndex[row][savedBlock].width   = itemSize*m_blockSize;
+        m_gridIndex[row][savedBlock].height  = m_channelHeight;
       }
       else
       {
-        itemSize++;
+        m_gridIndex[row][savedBlock].width   = m_channelWidth;
+        m_gridIndex[row][savedBlock].height  = itemSize*m_blockSize;
       }
+
+      itemSize = 1;
+      savedBlock = block+1;
+    }
+    else
+    {
+      itemSize++;
     }
   }
-
-  /******************************************* END ******************************************/
-
-  CLog::Log(LOGDEBUG, "%s completed successfully in %u ms", __FUNCTION__, (unsigned int)(XbmcThreads::SystemClockMillis()-tick));
-
-  m_channels = (int)m_epgItemsPtr.size();
-  m_item = GetItem(m_channelCursor);
-  if (m_item)
-    m_blockCursor = GetBlock(m_item->item, m_channelCursor);
-
-  SetInvalid();
 }
 
 void CGUIEPGGridContainer::ChannelScroll(int amount)
@@ -977,7 +1060,7 @@ bool CGUIEPGGridContainer::MoveProgrammes(bool direction)
     if (m_channelCursor + m_channelOffset < 0 || m_blockOffset < 0)
       return false;
 
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blockOffset].item)
+    if (m_item->item != GetGridRow(m_channelCursor + m_channelOffset)[m_blockOffset].item)
     {
       // this is not first item on page
       m_item = GetPrevItem(m_channelCursor);
@@ -1026,7 +1109,7 @@ bool CGUIEPGGridContainer::MoveProgrammes(bool direction)
   }
   else
   {
-    if (m_item->item != m_gridIndex[m_channelCursor + m_channelOffset][m_blocksPerPage + m_blockOffset - 1].item)
+    if (m_item->item != GetGridRow(m_channelCursor + m_channelOffset)[m_blocksPerPage + m_blockOffset - 1].item)
     {
       // this is not last item on page
       m_item = GetNextItem(m_channelCursor);
@@ -1310,14 +1393,16 @@ int CGUIEPGGridContainer::GetSelectedItem() const
   if (!m_gridIndex || !m_epgItemsPtr.size())
     return 0;
 
-  CGUIListItemPtr currentItem = m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item;
+  /* the row of the cursor is always loaded */
+  CGUIListItemPtr currentItem = m_gridIndex[m_channelCursor + m_channelOffset] ?
+      m_gridIndex[m_channelCursor + m_channelOffset][m_blockCursor + m_blockOffset].item : CGUIListItemPtr();
   if (!currentItem)
     return 0;
 
   for (int i = 0; i < (int)m_programmeItems.size(); i++)
   {
     if (currentItem == m_programmeItems[i])
-      return i;
+      return i + m_iProgrammeItemsOffset;
   }
   return 0;
 }
@@ -1359,9 +1444,9 @@ GridItemsPtr *CGUIEPGGridContainer::GetClosestItem(const int &channel)
   }
 
   if (right <= SHORTGAP && right <= left && m_blockCursor + right < m_blocksPerPage)
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + right + m_blockOffset];
+    return &GetGridRow(channel + m_channelOffset)[m_blockCursor + right + m_blockOffset];
 
-  return &m_gridIndex[channel + m_channelOffset][m_blockCursor - left  + m_blockOffset];
+  return &GetGridRow(channel + m_channelOffset)[m_blockCursor - left  + m_blockOffset];
 }
 
 int CGUIEPGGridContainer::GetItemSize(GridItemsPtr *item)
@@ -1384,7 +1469,7 @@ int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, const int &c
 {
   int block = 0;
 
-  while (m_gridIndex[channel + m_channelOffset][block].item != item && block < m_blocks)
+  while (GetGridRow(channel + m_channelOffset)[block].item != item && block < m_blocks)
     block++;
 
   return block;
@@ -1394,28 +1479,28 @@ GridItemsPtr *CGUIEPGGridContainer::GetNextItem(const int &channel)
 {
   int i = m_blockCursor;
 
-  while (m_gridIndex[channel + m_channelOffset][i + m_blockOffset].item == m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset].item && i < m_blocksPerPage)
+  while (GetGridRow(channel + m_channelOffset)[i + m_blockOffset].item == GetGridRow(channel + m_channelOffset)[m_blockCursor + m_blockOffset].item && i < m_blocksPerPage)
     i++;
 
-  return &m_gridIndex[channel + m_channelOffset][i + m_blockOffset];
+  return &GetGridRow(channel + m_channelOffset)[i + m_blockOffset];
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetPrevItem(const int &channel)
 {
   int i = m_blockCursor;
 
-  while (m_gridIndex[channel + m_channelOffset][i + m_blockOffset].item == m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset].item && i > 0)
+  while (GetGridRow(channel + m_channelOffset)[i + m_blockOffset].item == GetGridRow(channel + m_channelOffset)[m_blockCursor + m_blockOffset].item && i > 0)
     i--;
 
-  return &m_gridIndex[channel + m_channelOffset][i + m_blockOffset];
+  return &GetGridRow(channel + m_channelOffset)[i + m_blockOffset];
 
-//  return &m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset - 1];
+//  return &GetGridRow(channel + m_channelOffset)[m_blockCursor + m_blockOffset - 1];
 }
 
 GridItemsPtr *CGUIEPGGridContainer::GetItem(const int &channel)
 {
   if ( (channel >= 0) && (channel < m_channels) )
-    return &m_gridIndex[channel + m_channelOffset][m_blockCursor + m_blockOffset];
+    return &GetGridRow(channel + m_channelOffset)[m_blockCursor + m_blockOffset];
   else
     return NULL;
 }
@@ -1582,7 +1667,7 @@ void CGUIEPGGridContainer::UpdateLayout(bool updateAllItems)
 CStdString CGUIEPGGridContainer::GetDescription() const
 {
   CStdString strLabel;
-  int item = GetSelectedItem();
+  int item = GetSelectedItem() - m_iProgrammeItemsOffset;
   if (item >= 0 && item < (int)m_programmeItems.size())
   {
     CGUIListItemPtr pItem = m_programmeItems[item];
@@ -1595,17 +1680,22 @@ void CGUIEPGGridContainer::ClearGridIndex(void)
 {
   if (m_gridIndex)
   {
-    for (unsigned int i = 0; i < m_channelItems.size(); i++)
+    for (unsigned int i = 0; i < m_iGridIndexRows; i++)
     {
+      if (!m_gridIndex[i])
+        continue;
+
       for (int block = 0; block < m_blocks; block++)
       {
         if (m_gridIndex[i][block].item)
           m_gridIndex[i][block].item.get()->ClearProperties();
       }
-      free(m_gridIndex[i]);
+      delete[] m_gridIndex[i];
     }
-    free(m_gridIndex);
+    delete[] m_gridIndex;
+    m_gridIndex = NULL;
   }
+  m_iGridIndexRows = 0;
 }
 
 void CGUIEPGGridContainer::Reset()
@@ -1618,9 +1708,11 @@ void CGUIEPGGridContainer::Reset()
   m_rulerItems.clear();
   m_epgItemsPtr.clear();
 
-  m_lastItem    = NULL;
-  m_lastChannel = NULL;
-  m_gridIndex   = NULL;
+  m_lastItem              = NULL;
+  m_lastChannel           = NULL;
+  m_boundItems            = NULL;
+  m_bUseEpgIndex          = false;
+  m_iProgrammeItemsOffset = 0;
 }
 
 void CGUIEPGGridContainer::GoToBegin()
@@ -1815,6 +1907,9 @@ void CGUIEPGGridContainer::FreeProgrammeMemory(int keepStart, int keepEnd)
   { // remove before keepStart and after keepEnd
     for (unsigned int i = 0; i < m_epgItemsPtr.size(); i++)
     {
+      if (m_epgItemsPtr[i].stop < m_epgItemsPtr[i].start)
+        continue;
+
       unsigned long progIdx = m_epgItemsPtr[i].start;
       unsigned long lastIdx = m_epgItemsPtr[i].stop;
 
@@ -1828,6 +1923,9 @@ void CGUIEPGGridContainer::FreeProgrammeMemory(int keepStart, int keepEnd)
   { // wrapping
     for (unsigned int i = 0; i < m_epgItemsPtr.size(); i++)
     {
+      if (m_epgItemsPtr[i].stop < m_epgItemsPtr[i].start)
+        continue;
+
       unsigned long progIdx = m_epgItemsPtr[i].start;
       unsigned long lastIdx = m_epgItemsPtr[i].stop;
 
@@ -95,6 +95,15 @@ namespace EPG
 
     void UpdateItems();
 
+    /*!
+     * @brief Get a row of the grid, filling it first if it wasn't accessed before.
+     * @param row The channel row.
+     * @return The blocks of the row.
+     */
+    GridItemsPtr *GetGridRow(int row);
+    void LoadGridRow(int row);
+    void LoadProgrammeItems(int row);
+
     void SetChannel(int channel);
     void SetBlock(int block);
     void ChannelScroll(int amount);
@@ -200,6 +209,10 @@ namespace EPG
     CDateTime m_gridEnd;
 
     struct GridItemsPtr **m_gridIndex;
+    unsigned int m_iGridIndexRows;
+    CFileItemList *m_boundItems;        //! the list that was bound when loading programmes from the epg index, NULL once it is reset
+    bool m_bUseEpgIndex;                //! true to load the programmes of a row from the epg index when it's accessed
+    int m_iProgrammeItemsOffset;        //! the index of the first programme item in the bound list
     GridItemsPtr *m_item;
     CGUIListItem *m_lastItem;
     CGUIListItem *m_lastChannel;
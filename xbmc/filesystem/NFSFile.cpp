@@ -32,12 +32,19 @@
 #include "utils/URIUtils.h"
 #include "network/DNSNameCache.h"
 #include "threads/SystemClock.h"
+#include "settings/AdvancedSettings.h"
 
 #include <nfsc/libnfs-raw-mount.h>
 
+#include <algorithm>
+#include <errno.h>
+
 #ifdef TARGET_WINDOWS
 #include <fcntl.h>
 #include <sys\stat.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
 #endif
 
 //KEEP_ALIVE_TIMEOUT is decremented every half a second
@@ -49,6 +56,10 @@
 //4 mins cached context timeout
 #define CONTEXT_TIMEOUT 240000
 
+//a pipelined read which isn't answered within 30s
+//gives up the connection of the file context
+#define READ_REQUEST_TIMEOUT 30000
+
 //return codes for getContextForExport
 #define CONTEXT_INVALID  0    //getcontext failed
 #define CONTEXT_NEW      1    //new context created
@@ -136,6 +147,15 @@ void CNfsConnection::destroyOpenContexts()
     m_pLibNfs->nfs_destroy_context(it->second.pContext);
   }
   m_openContextMap.clear();
+
+  for(tFileContextMap::iterator it = m_idleFileContexts.begin();it!=m_idleFileContexts.end();it++)
+  {
+    for(std::list<struct contextTimeout>::iterator ctx = it->second.begin();ctx!=it->second.end();ctx++)
+    {
+      m_pLibNfs->nfs_destroy_context(ctx->pContext);
+    }
+  }
+  m_idleFileContexts.clear();
 }
 
 struct nfs_context *CNfsConnection::getContextFromMap(const CStdString &exportname)
@@ -303,7 +323,9 @@ bool CNfsConnection::Connect(const CURL& url, CStdString &relativePath)
 
 void CNfsConnection::Deinit()
 {
-  if(m_pNfsContext && m_pLibNfs->IsLoaded())
+  //files which were opened with a context of their own
+  //might have left only idle file contexts behind
+  if((m_pNfsContext || !m_idleFileContexts.empty()) && m_pLibNfs->IsLoaded())
   {
     destroyOpenContexts();
     m_pNfsContext = NULL;
@@ -317,7 +339,7 @@ void CNfsConnection::CheckIfIdle()
 {
   /* We check if there are open connections. This is done without a lock to not halt the mainthread. It should be thread safe as
    worst case scenario is that m_OpenConnections could read 0 and then changed to 1 if this happens it will enter the if wich will lead to another check, wich is locked.  */
-  if (m_OpenConnections == 0 && m_pNfsContext != NULL)
+  if (m_OpenConnections == 0 && (m_pNfsContext != NULL || !m_idleFileContexts.empty()))
   { /* I've set the the maxiumum IDLE time to be 1 min and 30 sec. */
     CSingleLock lock(*this);
     if (m_OpenConnections == 0 /* check again - when locked */)
@@ -334,22 +356,23 @@ void CNfsConnection::CheckIfIdle()
     }
   }
   
-  if( m_pNfsContext != NULL )
+  if( !m_KeepAliveTimeouts.empty() )
   {
     //handle keep alive on opened files
+    //the list lock is held while keeping alive - files remove themselves
+    //from the list before they take their context lock on close
+    CSingleLock lock(keepAliveLock);
     for( tFileKeepAliveMap::iterator it = m_KeepAliveTimeouts.begin();it!=m_KeepAliveTimeouts.end();it++)
     {
-      CSingleLock lock(keepAliveLock);
-      if(it->second > 0)
+      if(it->second.timeout > 0)
       {
-        it->second--;
+        it->second.timeout--;
       }
       else
       {
-        lock.Leave();
-        keepAlive(it->first);
+        keepAlive(it->first, it->second);
         //reset timeout
-        resetKeepAlive(it->first);
+        it->second.timeout = KEEP_ALIVE_TIMEOUT;
       }
     }
   }
@@ -363,25 +386,28 @@ void CNfsConnection::removeFromKeepAliveList(struct nfsfh  *_pFileHandle)
 }
 
 //reset timeouts on read
-void CNfsConnection::resetKeepAlive(struct nfsfh  *_pFileHandle)
+void CNfsConnection::resetKeepAlive(struct nfsfh  *_pFileHandle, struct nfs_context *pContext, CCriticalSection &contextLock)
 {
   CSingleLock lock(keepAliveLock);
   //adds new keys - refreshs existing ones  
-  m_KeepAliveTimeouts[_pFileHandle] = KEEP_ALIVE_TIMEOUT;
+  struct keepAliveTimeout &info = m_KeepAliveTimeouts[_pFileHandle];
+  info.timeout = KEEP_ALIVE_TIMEOUT;
+  info.pContext = pContext;
+  info.pLock = &contextLock;
 }
 
 //keep alive the filehandles nfs connection
 //by blindly doing a read 32bytes - seek back to where
 //we were before
-void CNfsConnection::keepAlive(struct nfsfh  *_pFileHandle)
+void CNfsConnection::keepAlive(struct nfsfh  *_pFileHandle, const struct keepAliveTimeout &info)
 {
   off64_t offset = 0;
   char buffer[32];
   CLog::Log(LOGNOTICE, "NFS: sending keep alive after %i s.",KEEP_ALIVE_TIMEOUT/2);
-  CSingleLock lock(*this);
-  m_pLibNfs->nfs_lseek(m_pNfsContext, _pFileHandle, 0, SEEK_CUR, &offset);
-  m_pLibNfs->nfs_read(m_pNfsContext, _pFileHandle, 32, buffer);
-  m_pLibNfs->nfs_lseek(m_pNfsContext, _pFileHandle, offset, SEEK_SET, &offset);
+  CSingleLock lock(*info.pLock);
+  m_pLibNfs->nfs_lseek(info.pContext, _pFileHandle, 0, SEEK_CUR, &offset);
+  m_pLibNfs->nfs_read(info.pContext, _pFileHandle, 32, buffer);
+  m_pLibNfs->nfs_lseek(info.pContext, _pFileHandle, offset, SEEK_SET, &offset);
 }
 
 int CNfsConnection::stat(const CURL &url, struct stat *statbuff)
@@ -425,6 +451,92 @@ int CNfsConnection::stat(const CURL &url, struct stat *statbuff)
   return nfsRet;
 }
 
+struct nfs_context *CNfsConnection::AcquireFileContext(const CURL &url, CStdString &relativePath, CStdString &contextKey)
+{
+  CStdString exportPath;
+  CStdString resolvedHostName;
+  {
+    CSingleLock lock(*this);
+
+    if(g_advancedSettings.m_nfsFileContexts <= 0 || !HandleDyLoad())
+      return NULL;
+
+    resolveHost(url);
+    if(!splitUrlIntoExportAndPath(url, exportPath, relativePath))
+      return NULL;
+
+    resolvedHostName = m_resolvedHostName;
+    contextKey = url.GetHostName() + exportPath;
+
+    int &busy = m_busyFileContexts[contextKey];
+    if(busy >= g_advancedSettings.m_nfsFileContexts)
+      return NULL;
+
+    //reuse a context the last file on this export left behind
+    std::list<struct contextTimeout> &idle = m_idleFileContexts[contextKey];
+    uint64_t now = XbmcThreads::SystemClockMillis();
+    while(!idle.empty())
+    {
+      struct contextTimeout tmp = idle.front();
+      idle.pop_front();
+
+      if((now - tmp.lastAccessedTime) < CONTEXT_TIMEOUT)
+      {
+        busy++;
+        return tmp.pContext;
+      }
+      CLog::Log(LOGDEBUG, "NFS: Old file context timed out - destroying it");
+      m_pLibNfs->nfs_destroy_context(tmp.pContext);
+    }
+    busy++;
+  }
+
+  //mounting takes a few roundtrips - don't keep the users
+  //of the shared context waiting meanwhile
+  struct nfs_context *pContext = m_pLibNfs->nfs_init_context();
+
+  if(!pContext)
+  {
+    CLog::Log(LOGERROR,"NFS: Error initcontext in AcquireFileContext.");
+  }
+  else if(m_pLibNfs->nfs_mount(pContext, resolvedHostName.c_str(), exportPath.c_str()) != 0)
+  {
+    CLog::Log(LOGERROR,"NFS: Failed to mount nfs share: %s (%s)\n", exportPath.c_str(), m_pLibNfs->nfs_get_error(pContext));
+    m_pLibNfs->nfs_destroy_context(pContext);
+    pContext = NULL;
+  }
+  else
+  {
+    CLog::Log(LOGDEBUG,"NFS: Connected to server %s and export %s in file context\n", url.GetHostName().c_str(), exportPath.c_str());
+  }
+
+  if(!pContext)
+  {
+    CSingleLock lock(*this);
+    m_busyFileContexts[contextKey]--;
+  }
+  return pContext;
+}
+
+void CNfsConnection::ReleaseFileContext(const CStdString &contextKey, struct nfs_context *pContext, bool reuse)
+{
+  CSingleLock lock(*this);
+  m_busyFileContexts[contextKey]--;
+
+  std::list<struct contextTimeout> &idle = m_idleFileContexts[contextKey];
+  if(reuse && (int)idle.size() < g_advancedSettings.m_nfsFileContexts)
+  {
+    struct contextTimeout tmp;
+    tmp.pContext = pContext;
+    tmp.lastAccessedTime = XbmcThreads::SystemClockMillis();
+    idle.push_back(tmp);
+  }
+  else
+  {
+    m_pLibNfs->nfs_destroy_context(pContext);
+  }
+}
+
 /* The following two function is used to keep track on how many Opened files/directories there are.
 needed for unloading the dylib*/
 void CNfsConnection::AddActiveConnection()
@@ -444,10 +556,34 @@ void CNfsConnection::AddIdleConnection()
 
 CNfsConnection gNfsConnection;
 
+//one pipelined read - filled in by ReadCallback when the reply arrives
+struct CNFSFile::ReadRequest
+{
+  int64_t offset;
+  size_t size;
+  int result;//bytes read or error
+  bool done;
+  std::vector<char> data;
+};
+
+void CNFSFile::ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data)
+{
+  struct ReadRequest *request = (struct ReadRequest *)private_data;
+  request->result = err;
+  if (err > 0)
+    memcpy(&request->data[0], data, std::min((size_t)err, request->size));
+  request->done = true;
+}
+
 CNFSFile::CNFSFile()
 : m_fileSize(0)
 , m_pFileHandle(NULL)
 , m_pNfsContext(NULL)
+, m_bOwnContext(false)
+, m_bContextBroken(false)
+, m_readPos(0)
+, m_readChunkSize(0)
+, m_readAheadDepth(1)
 {
   gNfsConnection.AddActiveConnection();
 }
@@ -462,6 +598,13 @@ int64_t CNFSFile::GetPosition()
 {
   int ret = 0;
   off64_t offset = 0;
+
+  if (m_bOwnContext)
+  {
+    CSingleLock lock(m_contextLock);
+    return m_pFileHandle ? m_readPos : 0;
+  }
+
   CSingleLock lock(gNfsConnection);
   
   if (gNfsConnection.GetNfsContext() == NULL || m_pFileHandle == NULL) return 0;
@@ -493,6 +636,9 @@ bool CNFSFile::Open(const CURL& url)
     return false;
   }
   
+  if (OpenWithOwnContext(url))
+    return true;
+
   CStdString filename = "";
    
   CSingleLock lock(gNfsConnection);
@@ -527,6 +673,50 @@ bool CNFSFile::Open(const CURL& url)
   return true;
 }
 
+bool CNFSFile::OpenWithOwnContext(const CURL& url)
+{
+  CStdString filename = "";
+  struct nfs_context *pContext = gNfsConnection.AcquireFileContext(url, filename, m_contextKey);
+
+  if (pContext == NULL)
+    return false;
+
+  CSingleLock lock(m_contextLock);
+  m_pNfsContext = pContext;
+  m_bOwnContext = true;
+  m_bContextBroken = false;
+
+  if (gNfsConnection.GetImpl()->nfs_open(m_pNfsContext, filename.c_str(), O_RDONLY, &m_pFileHandle) != 0)
+  {
+    //might be a symlink to another volume - let the shared context sort that out
+    CLog::Log(LOGDEBUG, "CNFSFile::Open: Unable to open file in own context: '%s'  error : '%s'", url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    m_pFileHandle = NULL;
+    lock.Leave();
+    Close();
+    return false;
+  }
+
+  struct stat tmpBuffer = {0};
+  if (gNfsConnection.GetImpl()->nfs_fstat(m_pNfsContext, m_pFileHandle, &tmpBuffer) != 0)
+  {
+    CLog::Log(LOGERROR, "NFS: Failed to fstat(%s) %s\n", url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    lock.Leave();
+    Close();
+    return false;
+  }
+
+  m_url = url;
+  m_fileSize = tmpBuffer.st_size;//cache the size of this file
+  m_readPos = 0;
+  m_readAheadDepth = 1;
+  m_readChunkSize = gNfsConnection.GetImpl()->nfs_get_readmax(m_pNfsContext);
+  if (m_readChunkSize == 0)
+    m_readChunkSize = 32768;
+
+  CLog::Log(LOGDEBUG,"CNFSFile::Open - opened %s in own context",url.GetFileName().c_str());
+  return true;
+}
+
 
 bool CNFSFile::Exists(const CURL& url)
 {
@@ -582,6 +772,9 @@ int CNFSFile::Stat(const CURL& url, struct __stat64* buffer)
 
 unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
 {
+  if (m_bOwnContext)
+    return ReadPipelined(lpBuf, uiBufSize);
+
   int numberOfBytesRead = 0;
   CSingleLock lock(gNfsConnection);
   
@@ -591,7 +784,7 @@ unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
 
   lock.Leave();//no need to keep the connection lock after that
   
-  gNfsConnection.resetKeepAlive(m_pFileHandle);//triggers keep alive timer reset for this filehandle
+  gNfsConnection.resetKeepAlive(m_pFileHandle, m_pNfsContext, gNfsConnection);//triggers keep alive timer reset for this filehandle
   
   //something went wrong ...
   if (numberOfBytesRead < 0) 
@@ -602,11 +795,192 @@ unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
   return (unsigned int)numberOfBytesRead;
 }
 
+unsigned int CNFSFile::ReadPipelined(void *lpBuf, int64_t uiBufSize)
+{
+  CSingleLock lock(m_contextLock);
+
+  if (m_pFileHandle == NULL || m_pNfsContext == NULL || m_bContextBroken || uiBufSize <= 0) return 0;
+
+  //the requests in flight are for another position - we were seeked
+  if (!m_readAhead.empty() &&
+      (m_readPos < m_readAhead.front()->offset ||
+       m_readPos >= m_readAhead.front()->offset + (int64_t)m_readAhead.front()->size))
+  {
+    DrainReadAhead();
+    m_readAheadDepth = 1;
+  }
+
+  FillReadAhead();
+  if (m_readAhead.empty())
+    return 0;
+
+  struct ReadRequest *request = m_readAhead.front();
+  if (!WaitForRequest(request))
+    return 0;
+
+  //something went wrong ...
+  if (request->result < 0)
+  {
+    CLog::Log(LOGERROR, "%s - Error( %d, %s )", __FUNCTION__, request->result, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    DrainReadAhead();
+    return 0;
+  }
+
+  int64_t available = request->offset + request->result - m_readPos;
+  if (available <= 0)
+  {
+    //eof - drop what was requested beyond it
+    DrainReadAhead();
+    return 0;
+  }
+
+  unsigned int numberOfBytesRead = (unsigned int)std::min(uiBufSize, available);
+  memcpy(lpBuf, &request->data[m_readPos - request->offset], numberOfBytesRead);
+  m_readPos += numberOfBytesRead;
+
+  if (m_readPos >= request->offset + request->result)
+  {
+    bool shortRead = (size_t)request->result < request->size;
+    m_readAhead.pop_front();
+    m_spareRequests.push_back(request);
+
+    if (shortRead)
+      DrainReadAhead();//eof - or the file is still growing, request again on the next read
+    else if (m_readAheadDepth < (unsigned int)g_advancedSettings.m_nfsReadAhead)
+      m_readAheadDepth++;//read sequentially - read further ahead
+  }
+
+  //keep the pipeline full while the caller is busy with the data
+  FillReadAhead();
+
+  struct nfs_context *pContext = m_pNfsContext;
+  lock.Leave();//the keep alive takes the locks in the other order
+
+  gNfsConnection.resetKeepAlive(m_pFileHandle, pContext, m_contextLock);//triggers keep alive timer reset for this filehandle
+  return numberOfBytesRead;
+}
+
+void CNFSFile::FillReadAhead()
+{
+  int64_t next = m_readAhead.empty() ? m_readPos : m_readAhead.back()->offset + m_readAhead.back()->size;
+
+  //beyond the known end of file only one request is sent,
+  //it tells whether the file has grown since it was opened
+  while (!m_bContextBroken && m_readAhead.size() < m_readAheadDepth && (m_readAhead.empty() || next < m_fileSize))
+  {
+    struct ReadRequest *request;
+    if (m_spareRequests.empty())
+    {
+      request = new struct ReadRequest;
+    }
+    else
+    {
+      request = m_spareRequests.back();
+      m_spareRequests.pop_back();
+    }
+    request->offset = next;
+    request->size = m_readChunkSize;
+    request->result = 0;
+    request->done = false;
+    request->data.resize(m_readChunkSize);
+
+    if (gNfsConnection.GetImpl()->nfs_pread_async(m_pNfsContext, m_pFileHandle, next, m_readChunkSize, ReadCallback, request) != 0)
+    {
+      CLog::Log(LOGERROR, "%s - Error( %s )", __FUNCTION__, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      m_spareRequests.push_back(request);
+      break;
+    }
+    m_readAhead.push_back(request);
+    next += m_readChunkSize;
+  }
+}
+
+bool CNFSFile::WaitForRequest(struct ReadRequest *request)
+{
+  DllLibNfs *pLibNfs = gNfsConnection.GetImpl();
+
+  while (!request->done && !m_bContextBroken)
+  {
+    struct pollfd pfd;
+    pfd.fd = pLibNfs->nfs_get_fd(m_pNfsContext);
+    pfd.events = pLibNfs->nfs_which_events(m_pNfsContext);
+    pfd.revents = 0;
+
+    int ret = poll(&pfd, 1, READ_REQUEST_TIMEOUT);
+    if (ret < 0 && errno == EINTR)
+      continue;
+
+    if (ret <= 0)
+    {
+      CLog::Log(LOGERROR, "%s - %s waiting for a read of %s", __FUNCTION__, ret == 0 ? "Timeout" : "Error", m_url.GetFileName().c_str());
+      m_bContextBroken = true;
+    }
+    else if (pLibNfs->nfs_service(m_pNfsContext, pfd.revents) < 0)
+    {
+      CLog::Log(LOGERROR, "%s - Error( %s )", __FUNCTION__, pLibNfs->nfs_get_error(m_pNfsContext));
+      m_bContextBroken = true;
+    }
+  }
+  return request->done;
+}
+
+void CNFSFile::DrainReadAhead()
+{
+  //the replies have to be taken off the connection before the requests can go
+  while (!m_readAhead.empty())
+  {
+    if (!WaitForRequest(m_readAhead.front()))
+      return;//broken - they are freed after the context is destroyed
+    m_spareRequests.push_back(m_readAhead.front());
+    m_readAhead.pop_front();
+  }
+}
+
+void CNFSFile::FreeRequests()
+{
+  for (std::deque<struct ReadRequest *>::iterator it = m_readAhead.begin(); it != m_readAhead.end(); it++)
+    delete *it;
+  m_readAhead.clear();
+
+  for (std::vector<struct ReadRequest *>::iterator it = m_spareRequests.begin(); it != m_spareRequests.end(); it++)
+    delete *it;
+  m_spareRequests.clear();
+}
+
 int64_t CNFSFile::Seek(int64_t iFilePosition, int iWhence)
 {
   int ret = 0;
   off64_t offset = 0;
 
+  if (m_bOwnContext)
+  {
+    //the position is ours - the requests in flight are dropped on the next read if they don't fit
+    CSingleLock lock(m_contextLock);
+    if (m_pFileHandle == NULL) return -1;
+
+    int64_t newPos = -1;
+    switch (iWhence)
+    {
+    case SEEK_SET:
+      newPos = iFilePosition;
+      break;
+    case SEEK_CUR:
+      newPos = m_readPos + iFilePosition;
+      break;
+    case SEEK_END:
+      newPos = m_fileSize + iFilePosition;
+      break;
+    }
+
+    if (newPos < 0)
+    {
+      CLog::Log(LOGERROR, "%s - Error( seekpos: %"PRId64", whence: %i, fsize: %"PRId64")", __FUNCTION__, iFilePosition, iWhence, m_fileSize);
+      return -1;
+    }
+    m_readPos = newPos;
+    return m_readPos;
+  }
+
   CSingleLock lock(gNfsConnection);  
   if (m_pFileHandle == NULL || m_pNfsContext == NULL) return -1;
   
@@ -622,23 +996,45 @@ int64_t CNFSFile::Seek(int64_t iFilePosition, int iWhence)
 
 void CNFSFile::Close()
 {
-  CSingleLock lock(gNfsConnection);
+  //before the context lock - the keep alive takes them in that order
+  if (m_pFileHandle != NULL)
+    gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
+
+  CSingleLock lock(GetContextLock());
+  bool reuseContext = !m_bContextBroken;
   
   if (m_pFileHandle != NULL && m_pNfsContext != NULL)
   {
     int ret = 0;
     CLog::Log(LOGDEBUG,"CNFSFile::Close closing file %s", m_url.GetFileName().c_str());
-    ret = gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle);
-    gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
+
+    if (m_bOwnContext)
+      DrainReadAhead();
+
+    if (!m_bContextBroken)
+      ret = gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle);
         
 	  if (ret < 0) 
     {
       CLog::Log(LOGERROR, "Failed to close(%s) - %s\n", m_url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      reuseContext = false;
     }
     m_pFileHandle = NULL;
-    m_pNfsContext = NULL;    
     m_fileSize = 0;
   }
+
+  if (m_bOwnContext)
+  {
+    //a broken context is destroyed with the requests still queued
+    //on it - they can only be freed after that
+    if (m_pNfsContext != NULL)
+      gNfsConnection.ReleaseFileContext(m_contextKey, m_pNfsContext, reuseContext);
+    FreeRequests();
+    m_bOwnContext = false;
+    m_bContextBroken = false;
+    m_readPos = 0;
+  }
+  m_pNfsContext = NULL;
 }
 
 //this was a bitch!
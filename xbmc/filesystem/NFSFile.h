@@ -29,6 +29,8 @@
 #include <list>
 #include "SectionLoader.h"
 #include <map>
+#include <deque>
+#include <vector>
 
 #ifdef TARGET_WINDOWS
 #define S_IRGRP 0
@@ -51,7 +53,14 @@ class DllLibNfs;
 class CNfsConnection : public CCriticalSection
 {     
 public:
-  typedef std::map<struct nfsfh  *, unsigned int> tFileKeepAliveMap;  
+  struct keepAliveTimeout
+  {
+    unsigned int timeout;
+    struct nfs_context *pContext;//the context the filehandle belongs to
+    CCriticalSection *pLock;//the lock that guards pContext
+  };
+
+  typedef std::map<struct nfsfh  *, struct keepAliveTimeout> tFileKeepAliveMap;  
 
   struct contextTimeout
   {
@@ -60,6 +69,8 @@ public:
   };
 
   typedef std::map<std::string, struct contextTimeout> tOpenContextMap;    
+  typedef std::map<std::string, std::list<struct contextTimeout> > tFileContextMap;
+  typedef std::map<std::string, int> tFileContextCountMap;
   
   CNfsConnection();
   ~CNfsConnection();
@@ -77,6 +88,15 @@ public:
   //needed for getting intervolume symlinks to work
   int stat(const CURL &url, struct stat *statbuff);
 
+  //gets a context of its own for a file which is opened for reading, mounted
+  //on the export of url - so that reads of different files don't queue up behind
+  //each other. Returns NULL if the contexts for that export are used up
+  //(advancedsetting nfsfilecontexts) - the file has to use the shared context then.
+  struct nfs_context *AcquireFileContext(const CURL &url, CStdString &relativePath, CStdString &contextKey);
+  //hands a context from AcquireFileContext back - it is kept for the next file
+  //on that export if reuse is true, destroyed otherwise
+  void ReleaseFileContext(const CStdString &contextKey, struct nfs_context *pContext, bool reuse);
+
   void AddActiveConnection();
   void AddIdleConnection();
   void CheckIfIdle();
@@ -84,7 +104,7 @@ public:
   bool HandleDyLoad();//loads the lib if needed
   //adds the filehandle to the keep alive list or resets
   //the timeout for this filehandle if already in list
-  void resetKeepAlive(struct nfsfh  *_pFileHandle);
+  void resetKeepAlive(struct nfsfh  *_pFileHandle, struct nfs_context *pContext, CCriticalSection &contextLock);
   //removes file handle from keep alive list
   void removeFromKeepAliveList(struct nfsfh  *_pFileHandle);  
   
@@ -102,6 +122,8 @@ private:
   unsigned int m_IdleTimeout;//timeout for idle connection close and dyunload
   tFileKeepAliveMap m_KeepAliveTimeouts;//mapping filehandles to its idle timeout
   tOpenContextMap m_openContextMap;//unique map for tracking all open contexts
+  tFileContextMap m_idleFileContexts;//mounted file contexts which are free for reuse - per export
+  tFileContextCountMap m_busyFileContexts;//number of file contexts in use - per export
   uint64_t m_lastAccessedTime;//last access time for m_pNfsContext
   DllLibNfs *m_pLibNfs;//the lib
   std::list<CStdString> m_exportList;//list of exported pathes of current connected servers
@@ -112,7 +134,7 @@ private:
   int  getContextForExport(const CStdString &exportname);//get context for given export and add to open contexts map - sets m_pNfsContext (my return a already mounted cached context)
   void destroyOpenContexts();
   void resolveHost(const CURL &url);//resolve hostname by dnslookup
-  void keepAlive(struct nfsfh  *_pFileHandle);
+  void keepAlive(struct nfsfh  *_pFileHandle, const struct keepAliveTimeout &info);
 };
 
 extern CNfsConnection gNfsConnection;
@@ -143,11 +165,35 @@ namespace XFILE
     virtual bool Delete(const CURL& url);
     virtual bool Rename(const CURL& url, const CURL& urlnew);    
   protected:
+    struct ReadRequest;
+
     CURL m_url;
     bool IsValidFile(const CStdString& strFileName);
     int64_t m_fileSize;
     struct nfsfh  *m_pFileHandle;
     struct nfs_context *m_pNfsContext;//current nfs context    
+
+    //files opened for reading get a context of their own if possible, reads
+    //on it are pipelined - several async reads are kept in flight ahead of
+    //the read position while the file is read sequentially
+    bool m_bOwnContext;//m_pNfsContext is ours - not the shared one of gNfsConnection
+    bool m_bContextBroken;//the connection of our context failed - it can't be used anymore
+    CStdString m_contextKey;//export our context is mounted on
+    CCriticalSection m_contextLock;//guards our context
+    int64_t m_readPos;//read position - only tracked when we have our own context
+    size_t m_readChunkSize;//size of one read request
+    unsigned int m_readAheadDepth;//number of read requests to keep in flight
+    std::deque<struct ReadRequest *> m_readAhead;//requests in flight - in file order
+    std::vector<struct ReadRequest *> m_spareRequests;//finished requests for reuse
+
+    CCriticalSection &GetContextLock() { return m_bOwnContext ? m_contextLock : gNfsConnection; }
+    bool OpenWithOwnContext(const CURL& url);
+    unsigned int ReadPipelined(void* lpBuf, int64_t uiBufSize);
+    void FillReadAhead();
+    bool WaitForRequest(struct ReadRequest *request);
+    void DrainReadAhead();
+    void FreeRequests();
+    static void ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data);
   };
 }
 #endif // FILENFS_H_
@@ -43,6 +43,8 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 #include "PasswordManager.h"
 
 #include <libsmbclient.h>
@@ -53,15 +55,149 @@
 #define XBMC_SMB_MOUNT_PATH "/media/xbmc/smb/"
 #endif
 
+#ifdef TARGET_WINDOWS
+typedef struct __stat64 SMBStatInfo;
+#else
+typedef struct stat SMBStatInfo;
+#endif
+
+/* stat'ing is spread over the worker contexts only for listings with
+   at least this many entries per thread */
+#define MIN_STATS_PER_THREAD 8
+
 struct CachedDirEntry
 {
   unsigned int type;
   CStdString name;
+
+  /* filled in by the stat */
+  bool stat;
+  bool hidden;
+  bool isDir;
+  int64_t size;
+  int64_t timeDate;
 };
 
 using namespace XFILE;
 using namespace std;
 
+/* takes the result of a stat into the entry, returns whether the hidden
+   attribute has to be asked for with the extended attributes */
+static bool SetStatInfo(CachedDirEntry &entry, const SMBStatInfo &info)
+{
+  entry.isDir = (info.st_mode & S_IFDIR) ? true : false;
+  entry.timeDate = info.st_mtime;
+  if (entry.timeDate == 0) // if modification date is missing, use create date
+    entry.timeDate = info.st_ctime;
+  entry.size = info.st_size;
+
+#ifdef TARGET_WINDOWS
+  entry.hidden = (info.st_mode & S_IXOTH) ? true : false;
+  return false;
+#else
+  /* libsmbclient maps the dos hidden attribute of a file to S_IXOTH, this spares
+     us another roundtrip for each file. Directories always have S_IXOTH set */
+  if (S_ISREG(info.st_mode))
+  {
+    entry.hidden = (info.st_mode & S_IXOTH) ? true : false;
+    return false;
+  }
+  return true;
+#endif
+}
+
+#ifndef TARGET_WINDOWS
+/* takes the result of getting the extended attribute system.dos_attr.mode into the entry */
+static void SetDosMode(CachedDirEntry &entry, int result, const char *value, const CStdString &strFullName)
+{
+  // We poll for extended attributes which symbolizes bits but split up into a string. Where 0x02 is hidden and 0x12 is hidden directory.
+  // According to the libsmbclient.h it's supposed to return 0 if ok, or the length of the string. It seems always to return the length wich is 4
+  if (result > 0)
+    entry.hidden = (strtol(value, NULL, 16) & SMBC_DOS_MODE_HIDDEN) ? true : false;
+  else
+    CLog::Log(LOGERROR, "Getting extended attributes for the share: '%s'\nunix_err:'%x' error: '%s'", strFullName.c_str(), errno, strerror(errno));
+}
+#endif
+
+#if defined(TARGET_POSIX) && defined(HAVE_SMBC_THREAD_POSIX)
+/* the entries of a listing that are left to stat, shared by the workers */
+class CSMBStatQueue
+{
+public:
+  CSMBStatQueue(vector<CachedDirEntry> &entries, const CStdString &strAuth)
+    : m_entries(entries), m_strAuth(strAuth), m_next(0) {}
+
+  CachedDirEntry *Next()
+  {
+    CSingleLock lock(m_lock);
+    while (m_next < m_entries.size())
+    {
+      CachedDirEntry &entry = m_entries[m_next++];
+      if (entry.stat)
+        return &entry;
+    }
+    return NULL;
+  }
+
+  const CStdString &GetAuthPath() const { return m_strAuth; }
+
+private:
+  vector<CachedDirEntry> &m_entries;
+  CStdString m_strAuth;
+  size_t m_next;
+  CCriticalSection m_lock;
+};
+
+/* stats entries of the queue with a samba context of its own, so the
+   stats of one listing are in flight concurrently and need no global lock */
+class CSMBStatWorker : public CThread
+{
+public:
+  CSMBStatWorker(SMBCCTX *context, CSMBStatQueue &queue)
+    : CThread("CSMBStatWorker"), m_context(context), m_queue(queue) {}
+
+  SMBCCTX *GetContext() const { return m_context; }
+
+protected:
+  virtual void Process()
+  {
+    CachedDirEntry *entry;
+    while (!m_bStop && (entry = m_queue.Next()) != NULL)
+    {
+      // make sure we use the authenticated path wich contains any default username
+      CStdString strFullName = m_queue.GetAuthPath() + smb.URLEncode(entry->name);
+      SMBStatInfo info = {0};
+
+#ifdef DEPRECATED_SMBC_INTERFACE
+      int result = smbc_getFunctionStat(m_context)(m_context, strFullName.c_str(), &info);
+#else
+      int result = m_context->stat(m_context, strFullName.c_str(), &info);
+#endif
+      if (result != 0)
+      {
+        CLog::Log(LOGERROR, "%s - Failed to stat file %s", __FUNCTION__, strFullName.c_str());
+        continue;
+      }
+
+      if (SetStatInfo(*entry, info))
+      {
+        char value[20] = {0};
+#ifdef DEPRECATED_SMBC_INTERFACE
+        result = smbc_getFunctionGetxattr(m_context)(m_context, strFullName.c_str(), "system.dos_attr.mode", value, sizeof(value));
+#else
+        result = m_context->getxattr(m_context, strFullName.c_str(), "system.dos_attr.mode", value, sizeof(value));
+#endif
+        SetDosMode(*entry, result, value, strFullName);
+      }
+    }
+  }
+
+private:
+  SMBCCTX *m_context;
+  CSMBStatQueue &m_queue;
+};
+#endif
+
 CSMBDirectory::CSMBDirectory(void)
 {
 #ifdef _LINUX
@@ -92,6 +228,8 @@ bool CSMBDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
   CStdString strRoot = strPath;
   CStdString strAuth;
 
+  unsigned int startTime = XbmcThreads::SystemClockMillis();
+
   lock.Leave(); // OpenDir is locked
   int fd = OpenDir(url, strAuth);
   if (fd < 0)
@@ -107,6 +245,8 @@ bool CSMBDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
   // "stat" is locked each time. that way the lock is freed between stat requests
   vector<CachedDirEntry> vecEntries;
   struct smbc_dirent* dirEnt;
+  bool statFiles = (m_flags & DIR_FLAG_NO_FILE_INFO)==0 && g_advancedSettings.m_sambastatfiles;
+  size_t statCount = 0;
 
   lock.Enter();
   while ((dirEnt = smbc_readdir(fd)))
@@ -114,126 +254,145 @@ bool CSMBDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
     CachedDirEntry aDir;
     aDir.type = dirEnt->smbc_type;
     aDir.name = dirEnt->name;
+
+    // We use UTF-8 internally, as does SMB
+    if (aDir.name.Equals(".") || aDir.name.Equals("..") || aDir.name.Equals("lost+found") ||
+        aDir.type == SMBC_PRINTER_SHARE || aDir.type == SMBC_IPC_SHARE)
+      continue;
+
+    if (aDir.name.Right(1).Equals("$") && aDir.type == SMBC_FILE_SHARE)
+      continue;
+
+    // only stat files that can give proper responses
+    // set the defaults here to if the stat should fail
+    aDir.stat = statFiles && (aDir.type == SMBC_FILE || aDir.type == SMBC_DIR);
+    aDir.isDir = aDir.type != SMBC_FILE;
+    aDir.hidden = false;
+    aDir.size = 0;
+    aDir.timeDate = 0;
+    if (aDir.stat)
+      statCount++;
+
     vecEntries.push_back(aDir);
   }
   smbc_closedir(fd);
   lock.Leave();
 
-  for (size_t i=0; i<vecEntries.size(); i++)
-  {
-    CachedDirEntry aDir = vecEntries[i];
-
-    // We use UTF-8 internally, as does SMB
-    strFile = aDir.name;
+  unsigned int readdirTime = XbmcThreads::SystemClockMillis();
+  unsigned int statThreads = 0;
 
-    if (!strFile.Equals(".") && !strFile.Equals("..")
-      && !strFile.Equals("lost+found")
-      && aDir.type != SMBC_PRINTER_SHARE && aDir.type != SMBC_IPC_SHARE)
+#if defined(TARGET_POSIX) && defined(HAVE_SMBC_THREAD_POSIX)
+  // stat with several contexts at once, the roundtrips of a large directory add up.
+  // libsmbclient only allows that with its thread support, set up in CSMB::Init()
+  unsigned int maxThreads = std::min((size_t)std::max(g_advancedSettings.m_sambastatthreads, 0), statCount / MIN_STATS_PER_THREAD);
+  if (maxThreads > 1)
+  {
+    CSMBStatQueue queue(vecEntries, strAuth);
+    vector<CSMBStatWorker *> workers;
+    for (unsigned int i = 0; i < maxThreads; i++)
     {
-     int64_t iSize = 0;
-      bool bIsDir = true;
-      int64_t lTimeDate = 0;
-      bool hidden = false;
-
-      if(strFile.Right(1).Equals("$") && aDir.type == SMBC_FILE_SHARE )
-        continue;
+      SMBCCTX *context = smb.GetWorkerContext();
+      if (!context)
+        break;
+      CSMBStatWorker *worker = new CSMBStatWorker(context, queue);
+      worker->Create();
+      workers.push_back(worker);
+    }
 
-      // only stat files that can give proper responses
-      if ( aDir.type == SMBC_FILE ||
-           aDir.type == SMBC_DIR )
-      {
-        // set this here to if the stat should fail
-        bIsDir = (aDir.type == SMBC_DIR);
+    for (vector<CSMBStatWorker *>::iterator it = workers.begin(); it != workers.end(); ++it)
+    {
+      (*it)->WaitForThreadExit(0xFFFFFFFF);
+      smb.ReleaseWorkerContext((*it)->GetContext());
+      delete *it;
+    }
 
-#ifdef TARGET_WINDOWS
-        struct __stat64 info = {0};
-#else
-        struct stat info = {0};
+    statThreads = workers.size();
+    if (statThreads > 0)
+      statCount = 0; // all done
+  }
 #endif
-        if ((m_flags & DIR_FLAG_NO_FILE_INFO)==0 && g_advancedSettings.m_sambastatfiles)
-        {
-          // make sure we use the authenticated path wich contains any default username
-          CStdString strFullName = strAuth + smb.URLEncode(strFile);
 
-          lock.Enter();
+  // without workers stat one by one with the global context
+  for (size_t i = 0; statCount > 0 && i < vecEntries.size(); i++)
+  {
+    CachedDirEntry &aDir = vecEntries[i];
+    if (!aDir.stat)
+      continue;
 
-          if( smbc_stat(strFullName.c_str(), &info) == 0 )
-          {
+    // make sure we use the authenticated path wich contains any default username
+    CStdString strFullName = strAuth + smb.URLEncode(aDir.name);
+    SMBStatInfo info = {0};
 
+    lock.Enter();
+    if( smbc_stat(strFullName.c_str(), &info) == 0 )
+    {
 #ifdef TARGET_WINDOWS
-            if ((info.st_mode & S_IXOTH))
-              hidden = true;
+      SetStatInfo(aDir, info);
 #else
-            char value[20];
-            // We poll for extended attributes which symbolizes bits but split up into a string. Where 0x02 is hidden and 0x12 is hidden directory.
-            // According to the libsmbclient.h it's supposed to return 0 if ok, or the length of the string. It seems always to return the length wich is 4
-            if (smbc_getxattr(strFullName, "system.dos_attr.mode", value, sizeof(value)) > 0)
-            {
-              long longvalue = strtol(value, NULL, 16);
-              if (longvalue & SMBC_DOS_MODE_HIDDEN)
-                hidden = true;
-            }
-            else
-              CLog::Log(LOGERROR, "Getting extended attributes for the share: '%s'\nunix_err:'%x' error: '%s'", strFullName.c_str(), errno, strerror(errno));
+      char value[20] = {0};
+      if (SetStatInfo(aDir, info))
+        SetDosMode(aDir, smbc_getxattr(strFullName, "system.dos_attr.mode", value, sizeof(value)), value, strFullName);
 #endif
+    }
+    else
+      CLog::Log(LOGERROR, "%s - Failed to stat file %s", __FUNCTION__, strFullName.c_str());
+    lock.Leave();
+  }
 
-            bIsDir = (info.st_mode & S_IFDIR) ? true : false;
-            lTimeDate = info.st_mtime;
-            if(lTimeDate == 0) // if modification date is missing, use create date
-              lTimeDate = info.st_ctime;
-            iSize = info.st_size;
-          }
-          else
-            CLog::Log(LOGERROR, "%s - Failed to stat file %s", __FUNCTION__, strFullName.c_str());
-
-          lock.Leave();
-        }
-      }
+  unsigned int endTime = XbmcThreads::SystemClockMillis();
+
+  for (size_t i=0; i<vecEntries.size(); i++)
+  {
+    CachedDirEntry &aDir = vecEntries[i];
+    strFile = aDir.name;
 
-      FILETIME fileTime, localTime;
-      LONGLONG ll = Int32x32To64(lTimeDate & 0xffffffff, 10000000) + 116444736000000000ll;
-      fileTime.dwLowDateTime = (DWORD) (ll & 0xffffffff);
-      fileTime.dwHighDateTime = (DWORD)(ll >> 32);
-      FileTimeToLocalFileTime(&fileTime, &localTime);
+    FILETIME fileTime, localTime;
+    LONGLONG ll = Int32x32To64(aDir.timeDate & 0xffffffff, 10000000) + 116444736000000000ll;
+    fileTime.dwLowDateTime = (DWORD) (ll & 0xffffffff);
+    fileTime.dwHighDateTime = (DWORD)(ll >> 32);
+    FileTimeToLocalFileTime(&fileTime, &localTime);
 
-      if (bIsDir)
-      {
-        CFileItemPtr pItem(new CFileItem(strFile));
-        CStdString path(strRoot);
-
-        // needed for network / workgroup browsing
-        // skip if root if we are given a server
-        if (aDir.type == SMBC_SERVER)
-        {
-          /* create url with same options, user, pass.. but no filename or host*/
-          CURL rooturl(strRoot);
-          rooturl.SetFileName("");
-          rooturl.SetHostName("");
-          path = smb.URLEncode(rooturl);
-        }
-        path = URIUtils::AddFileToFolder(path,aDir.name);
-        URIUtils::AddSlashAtEnd(path);
-        pItem->SetPath(path);
-        pItem->m_bIsFolder = true;
-        pItem->m_dateTime=localTime;
-        if (hidden)
-          pItem->SetProperty("file:hidden", true);
-        items.Add(pItem);
-      }
-      else
+    if (aDir.isDir)
+    {
+      CFileItemPtr pItem(new CFileItem(strFile));
+      CStdString path(strRoot);
+
+      // needed for network / workgroup browsing
+      // skip if root if we are given a server
+      if (aDir.type == SMBC_SERVER)
       {
-        CFileItemPtr pItem(new CFileItem(strFile));
-        pItem->SetPath(strRoot + aDir.name);
-        pItem->m_bIsFolder = false;
-        pItem->m_dwSize = iSize;
-        pItem->m_dateTime=localTime;
-        if (hidden)
-          pItem->SetProperty("file:hidden", true);
-        items.Add(pItem);
+        /* create url with same options, user, pass.. but no filename or host*/
+        CURL rooturl(strRoot);
+        rooturl.SetFileName("");
+        rooturl.SetHostName("");
+        path = smb.URLEncode(rooturl);
       }
+      path = URIUtils::AddFileToFolder(path,aDir.name);
+      URIUtils::AddSlashAtEnd(path);
+      pItem->SetPath(path);
+      pItem->m_bIsFolder = true;
+      pItem->m_dateTime=localTime;
+      if (aDir.hidden)
+        pItem->SetProperty("file:hidden", true);
+      items.Add(pItem);
+    }
+    else
+    {
+      CFileItemPtr pItem(new CFileItem(strFile));
+      pItem->SetPath(strRoot + aDir.name);
+      pItem->m_bIsFolder = false;
+      pItem->m_dwSize = aDir.size;
+      pItem->m_dateTime=localTime;
+      if (aDir.hidden)
+        pItem->SetProperty("file:hidden", true);
+      items.Add(pItem);
     }
   }
 
+  CLog::Log(LOGDEBUG, "%s - listed %s in %u ms: %u entries, readdir %u ms, stat %u ms on %u thread(s)", __FUNCTION__,
+            url.GetWithoutUserDetails().c_str(), endTime - startTime, (unsigned int)vecEntries.size(),
+            readdirTime - startTime, endTime - readdirTime, statThreads ? statThreads : 1);
+
   return true;
 }
 
@@ -94,6 +94,12 @@ void CSMB::Deinit()
 #endif
     m_context = NULL;
   }
+
+#ifdef TARGET_POSIX
+  for (std::vector<SMBCCTX *>::iterator it = m_workerContexts.begin(); it != m_workerContexts.end(); ++it)
+    smbc_free_context(*it, 1);
+  m_workerContexts.clear();
+#endif
 }
 
 void CSMB::Init()
@@ -148,6 +154,11 @@ void CSMB::Init()
     }
 #endif
 
+#ifdef HAVE_SMBC_THREAD_POSIX
+    // the directory stat workers use their own contexts on their own threads
+    smbc_thread_posix();
+#endif
+
     // reads smb.conf so this MUST be after we create smb.conf
     // multiple smbc_init calls are ignored by libsmbclient.
     smbc_init(xb_smbc_auth, 0);
@@ -158,29 +169,10 @@ void CSMB::Init()
 #endif
 
     // setup our context
-    m_context = smbc_new_context();
-#ifdef DEPRECATED_SMBC_INTERFACE
-    smbc_setDebug(m_context, g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0);
-    smbc_setFunctionAuthData(m_context, xb_smbc_auth);
-    orig_cache = smbc_getFunctionGetCachedServer(m_context);
-    smbc_setFunctionGetCachedServer(m_context, xb_smbc_cache);
-    smbc_setOptionOneSharePerServer(m_context, false);
-    smbc_setOptionBrowseMaxLmbCount(m_context, 0);
-    smbc_setTimeout(m_context, g_advancedSettings.m_sambaclienttimeout * 1000);
-    smbc_setUser(m_context, strdup("guest"));
-#else
-    m_context->debug = g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0;
-    m_context->callbacks.auth_fn = xb_smbc_auth;
-    orig_cache = m_context->callbacks.get_cached_srv_fn;
-    m_context->callbacks.get_cached_srv_fn = xb_smbc_cache;
-    m_context->options.one_share_per_server = false;
-    m_context->options.browse_max_lmb_count = 0;
-    m_context->timeout = g_advancedSettings.m_sambaclienttimeout * 1000;
-    m_context->user = strdup("guest");
-#endif
+    m_context = NewContext();
 
     // initialize samba and do some hacking into the settings
-    if (smbc_init_context(m_context))
+    if (m_context)
     {
       /* setup old interface to use this context */
       smbc_set_context(m_context);
@@ -201,17 +193,72 @@ void CSMB::Init()
         lp_do_parameter( -1, "dos charset", "CP850");
 #endif
     }
-    else
-    {
-      smbc_free_context(m_context, 1);
-      m_context = NULL;
-    }
   }
 #ifdef TARGET_POSIX
   m_IdleTimeout = 180;
 #endif
 }
 
+SMBCCTX *CSMB::NewContext()
+{
+  SMBCCTX *context = smbc_new_context();
+  if (!context)
+    return NULL;
+
+#ifdef DEPRECATED_SMBC_INTERFACE
+  smbc_setDebug(context, g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0);
+  smbc_setFunctionAuthData(context, xb_smbc_auth);
+  orig_cache = smbc_getFunctionGetCachedServer(context);
+  smbc_setFunctionGetCachedServer(context, xb_smbc_cache);
+  smbc_setOptionOneSharePerServer(context, false);
+  smbc_setOptionBrowseMaxLmbCount(context, 0);
+  smbc_setTimeout(context, g_advancedSettings.m_sambaclienttimeout * 1000);
+  smbc_setUser(context, strdup("guest"));
+#else
+  context->debug = g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0;
+  context->callbacks.auth_fn = xb_smbc_auth;
+  orig_cache = context->callbacks.get_cached_srv_fn;
+  context->callbacks.get_cached_srv_fn = xb_smbc_cache;
+  context->options.one_share_per_server = false;
+  context->options.browse_max_lmb_count = 0;
+  context->timeout = g_advancedSettings.m_sambaclienttimeout * 1000;
+  context->user = strdup("guest");
+#endif
+
+  if (!smbc_init_context(context))
+  {
+    smbc_free_context(context, 1);
+    return NULL;
+  }
+  return context;
+}
+
+#ifdef TARGET_POSIX
+SMBCCTX *CSMB::GetWorkerContext()
+{
+  CSingleLock lock(*this);
+  if (!m_context)
+    return NULL;
+
+  if (!m_workerContexts.empty())
+  {
+    SMBCCTX *context = m_workerContexts.back();
+    m_workerContexts.pop_back();
+    return context;
+  }
+  return NewContext();
+}
+
+void CSMB::ReleaseWorkerContext(SMBCCTX *context)
+{
+  CSingleLock lock(*this);
+  if (m_context)
+    m_workerContexts.push_back(context);
+  else
+    smbc_free_context(context, 1); // we were deinited meanwhile
+}
+#endif
+
 void CSMB::Purge()
 {
 #ifdef TARGET_WINDOWS
@@ -41,6 +41,7 @@
 #include "IFile.h"
 #include "URL.h"
 #include "threads/CriticalSection.h"
+#include <vector>
 
 #define NT_STATUS_CONNECTION_REFUSED long(0xC0000000 | 0x0236)
 #define NT_STATUS_INVALID_HANDLE long(0xC0000000 | 0x0008)
@@ -72,8 +73,19 @@ public:
   CStdString URLEncode(const CURL &url);
 
   DWORD ConvertUnixToNT(int error);
+#ifdef TARGET_POSIX
+  /* contexts of their own for threads that use the context functions
+     concurrently, without the lock. They are kept until Deinit. */
+  SMBCCTX *GetWorkerContext();
+  void ReleaseWorkerContext(SMBCCTX *context);
+#endif
 private:
+  SMBCCTX *NewContext();
+
   SMBCCTX *m_context;
+#ifdef TARGET_POSIX
+  std::vector<SMBCCTX *> m_workerContexts;
+#endif
   CStdString m_strLastHost;
   CStdString m_strLastShare;
 #ifdef _LINUX
@@ -0,0 +1,218 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "AdaptiveDirtyRegionSolver.h"
+
+// the model starts from 1 ms per pass and 1 ms per megapixel until passes are measured
+#define DEFAULT_PASS_COST   1.0
+#define DEFAULT_PIXEL_COST  0.000001
+#define PRIOR_AREA          1000000.0
+#define PRIOR_WEIGHT        1.0
+
+// weight of the older samples per new sample, about the last 50 passes count
+#define SAMPLE_DECAY        0.98
+#define VIEWPORT_SMOOTHING  0.1f
+
+CAdaptiveDirtyRegionSolver::CAdaptiveDirtyRegionSolver()
+{
+  m_strategy     = STRATEGY_NONE;
+  m_passCost     = DEFAULT_PASS_COST;
+  m_pixelCost    = DEFAULT_PIXEL_COST;
+  m_viewportCost = -1.0f;
+  m_sumWeight    = 0.0;
+  m_sumArea      = 0.0;
+  m_sumArea2     = 0.0;
+  m_sumTime      = 0.0;
+  m_sumAreaTime  = 0.0;
+
+  AddSample(0.0, DEFAULT_PASS_COST, PRIOR_WEIGHT);
+  AddSample(PRIOR_AREA, DEFAULT_PASS_COST + DEFAULT_PIXEL_COST * PRIOR_AREA, PRIOR_WEIGHT);
+}
+
+void CAdaptiveDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  m_strategy = STRATEGY_NONE;
+  if (input.empty())
+    return;
+
+  CDirtyRegionList split;
+  Split(input, split);
+  float cost = EstimateCost(split);
+  m_strategy = STRATEGY_SPLIT;
+
+  CDirtyRegion merged;
+  for (unsigned int i = 0; i < input.size(); i++)
+    merged.Union(input[i]);
+
+  float mergedCost = EstimatePass(merged);
+  if (mergedCost <= cost)
+  {
+    cost = mergedCost;
+    m_strategy = STRATEGY_MERGE;
+  }
+
+  // on a tie the viewport wins, it is drawn without clipping
+  if (!m_viewport.IsEmpty() && EstimateViewport() <= cost)
+    m_strategy = STRATEGY_VIEWPORT;
+
+  switch (m_strategy)
+  {
+    case STRATEGY_VIEWPORT:
+      output.push_back(CDirtyRegion(m_viewport));
+      break;
+    case STRATEGY_MERGE:
+      output.push_back(merged);
+      break;
+    default:
+      output.insert(output.end(), split.begin(), split.end());
+      break;
+  }
+}
+
+void CAdaptiveDirtyRegionSolver::Split(const CDirtyRegionList &input, CDirtyRegionList &output) const
+{
+  // add each region to the pass it enlarges the least, unless a pass of its own is cheaper
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    int   bestPass = -1;
+    float bestCost = 0.0f;
+    for (unsigned int j = 0; j < output.size(); j++)
+    {
+      CDirtyRegion temporaryUnion = output[j];
+      temporaryUnion.Union(input[i]);
+      float cost = m_pixelCost * (ClippedArea(temporaryUnion) - ClippedArea(output[j]));
+      if (bestPass < 0 || cost < bestCost)
+      {
+        bestPass = j;
+        bestCost = cost;
+      }
+    }
+
+    if (bestPass >= 0 && bestCost < EstimatePass(input[i]))
+      output[bestPass].Union(input[i]);
+    else
+      output.push_back(input[i]);
+  }
+
+  // passes that grew may now overlap, merge any pair that is cheaper to draw as one
+  bool merged = true;
+  while (merged)
+  {
+    merged = false;
+    for (unsigned int i = 0; i < output.size() && !merged; i++)
+    {
+      for (unsigned int j = i + 1; j < output.size() && !merged; j++)
+      {
+        CDirtyRegion temporaryUnion = output[i];
+        temporaryUnion.Union(output[j]);
+        if (EstimatePass(temporaryUnion) < EstimatePass(output[i]) + EstimatePass(output[j]))
+        {
+          output[i] = temporaryUnion;
+          output.erase(output.begin() + j);
+          merged = true;
+        }
+      }
+    }
+  }
+}
+
+void CAdaptiveDirtyRegionSolver::PassRendered(const CDirtyRegion &pass, float time)
+{
+  float area = ClippedArea(pass);
+  if (!m_viewport.IsEmpty() && area >= m_viewport.Area())
+  {
+    if (m_viewportCost < 0.0f)
+      m_viewportCost = time;
+    else
+      m_viewportCost += VIEWPORT_SMOOTHING * (time - m_viewportCost);
+  }
+
+  m_sumWeight   *= SAMPLE_DECAY;
+  m_sumArea     *= SAMPLE_DECAY;
+  m_sumArea2    *= SAMPLE_DECAY;
+  m_sumTime     *= SAMPLE_DECAY;
+  m_sumAreaTime *= SAMPLE_DECAY;
+  AddSample(area, time, 1.0);
+}
+
+void CAdaptiveDirtyRegionSolver::AddSample(double area, double time, double weight)
+{
+  m_sumWeight   += weight;
+  m_sumArea     += weight * area;
+  m_sumArea2    += weight * area * area;
+  m_sumTime     += weight * time;
+  m_sumAreaTime += weight * area * time;
+  Fit();
+}
+
+void CAdaptiveDirtyRegionSolver::Fit()
+{
+  // least squares fit of time = passCost + pixelCost * area. When the recent passes
+  // are all about the same size the slope can't be told apart, so only the
+  // intercept follows the measurements.
+  double det = m_sumWeight * m_sumArea2 - m_sumArea * m_sumArea;
+  double pixelCost = m_pixelCost;
+  if (det > 1e-6 * m_sumWeight * m_sumArea2)
+    pixelCost = (m_sumWeight * m_sumAreaTime - m_sumArea * m_sumTime) / det;
+  if (pixelCost < 0.0)
+    pixelCost = 0.0;
+
+  double passCost = (m_sumTime - pixelCost * m_sumArea) / m_sumWeight;
+  if (passCost < 0.0)
+  {
+    // all the time goes with the pixels, fit through the origin
+    passCost  = 0.0;
+    pixelCost = m_sumArea2 > 0.0 ? m_sumAreaTime / m_sumArea2 : m_pixelCost;
+  }
+
+  m_passCost  = (float)passCost;
+  m_pixelCost = (float)pixelCost;
+}
+
+float CAdaptiveDirtyRegionSolver::ClippedArea(const CRect &rect) const
+{
+  if (m_viewport.IsEmpty())
+    return rect.Area();
+
+  CRect clipped(rect);
+  clipped.Intersect(m_viewport);
+  return clipped.Area();
+}
+
+float CAdaptiveDirtyRegionSolver::EstimatePass(const CRect &pass) const
+{
+  return m_passCost + m_pixelCost * ClippedArea(pass);
+}
+
+float CAdaptiveDirtyRegionSolver::EstimateViewport() const
+{
+  if (m_viewportCost >= 0.0f)
+    return m_viewportCost;
+  return EstimatePass(m_viewport);
+}
+
+float CAdaptiveDirtyRegionSolver::EstimateCost(const CDirtyRegionList &passes) const
+{
+  float cost = 0.0f;
+  for (unsigned int i = 0; i < passes.size(); i++)
+    cost += EstimatePass(passes[i]);
+  return cost;
+}
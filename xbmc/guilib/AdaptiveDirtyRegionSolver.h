@@ -0,0 +1,83 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "IDirtyRegionSolver.h"
+
+/*!
+ \brief Chooses per frame between separate passes, one merged pass and a full viewport pass.
+
+ A rendering pass is modelled to cost a fixed time, as the whole window is traversed once
+ per pass, plus a time per redrawn pixel. Both are fitted by least squares to the measured
+ render times of the recent passes as they are fed back through PassRendered(). The full
+ viewport is estimated from its own measurements, as it is drawn without clipping.
+
+ The solver doesn't use the graphics context, the caller sets the viewport, so it can be
+ driven headless by recorded traces (see CDirtyRegionTrace).
+ */
+class CAdaptiveDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  enum Strategy
+  {
+    STRATEGY_NONE = 0, ///< nothing to redraw
+    STRATEGY_SPLIT,    ///< the regions merged as long as that reduces the cost
+    STRATEGY_MERGE,    ///< one pass for the union of the regions
+    STRATEGY_VIEWPORT  ///< one pass for the whole viewport
+  };
+
+  CAdaptiveDirtyRegionSolver();
+
+  /*! \brief Set the viewport the passes are clipped to, an empty viewport disables clipping
+   and full viewport passes */
+  void SetViewport(const CRect &viewport) { m_viewport = viewport; }
+
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+  virtual void PassRendered(const CDirtyRegion &pass, float time);
+
+  /*! \brief Estimated time in milliseconds to render the passes with the current cost model */
+  float EstimateCost(const CDirtyRegionList &passes) const;
+
+  Strategy GetStrategy() const { return m_strategy; }
+  float GetPassCost() const { return m_passCost; }
+  float GetPixelCost() const { return m_pixelCost; }
+
+private:
+  void Split(const CDirtyRegionList &input, CDirtyRegionList &output) const;
+  float ClippedArea(const CRect &rect) const;
+  float EstimatePass(const CRect &pass) const;
+  float EstimateViewport() const;
+  void AddSample(double area, double time, double weight);
+  void Fit();
+
+  CRect    m_viewport;
+  Strategy m_strategy;
+  float    m_passCost;     ///< ms per pass
+  float    m_pixelCost;    ///< ms per redrawn pixel
+  float    m_viewportCost; ///< ms per full viewport pass, negative until one is measured
+
+  // exponentially weighted sums over the (area, time) samples of the fit
+  double   m_sumWeight;
+  double   m_sumArea;
+  double   m_sumArea2;
+  double   m_sumTime;
+  double   m_sumAreaTime;
+};
@@ -0,0 +1,95 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DirtyRegionTrace.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+  void PutRect(ostringstream &out, const CRect &rect)
+  {
+    out << ' ' << rect.x1 << ' ' << rect.y1 << ' ' << rect.x2 << ' ' << rect.y2;
+  }
+
+  bool GetRect(istringstream &in, CRect &rect)
+  {
+    return !!(in >> rect.x1 >> rect.y1 >> rect.x2 >> rect.y2);
+  }
+}
+
+string CDirtyRegionTrace::Format(const Frame &frame)
+{
+  ostringstream out;
+  out << "frame";
+  PutRect(out, frame.viewport);
+  out << '\n';
+  for (CDirtyRegionList::const_iterator it = frame.regions.begin(); it != frame.regions.end(); ++it)
+  {
+    out << "region";
+    PutRect(out, *it);
+    out << '\n';
+  }
+  for (vector<Pass>::const_iterator it = frame.passes.begin(); it != frame.passes.end(); ++it)
+  {
+    out << "pass";
+    PutRect(out, it->region);
+    out << ' ' << it->time << '\n';
+  }
+  return out.str();
+}
+
+bool CDirtyRegionTrace::Parse(const string &text, vector<Frame> &frames)
+{
+  istringstream lines(text);
+  string line;
+  bool inFrame = false;
+  while (getline(lines, line))
+  {
+    istringstream in(line);
+    string record;
+    if (!(in >> record) || record[0] == '#')
+      continue;
+
+    CRect rect;
+    if (record == "frame" && GetRect(in, rect))
+    {
+      frames.push_back(Frame());
+      frames.back().viewport = rect;
+      inFrame = true;
+    }
+    else if (record == "region" && inFrame && GetRect(in, rect))
+      frames.back().regions.push_back(CDirtyRegion(rect));
+    else if (record == "pass" && inFrame && GetRect(in, rect))
+    {
+      Pass pass;
+      pass.region = CDirtyRegion(rect);
+      if (!(in >> pass.time))
+        return false;
+      frames.back().passes.push_back(pass);
+    }
+    else
+      return false;
+  }
+  return true;
+}
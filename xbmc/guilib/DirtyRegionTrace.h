@@ -0,0 +1,64 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DirtyRegion.h"
+
+#include <string>
+#include <vector>
+
+/*!
+ \brief Dirty regions and rendering passes of a number of frames, as recorded by CDirtyRegionTracker.
+
+ A trace is a text file with one record per line:
+ \verbatim
+ frame <viewport x1> <y1> <x2> <y2>
+ region <x1> <y1> <x2> <y2>
+ pass <x1> <y1> <x2> <y2> <render time in ms>
+ \endverbatim
+ The regions and passes belong to the frame before them. Empty lines and lines
+ starting with # are skipped.
+ */
+class CDirtyRegionTrace
+{
+public:
+  struct Pass
+  {
+    CDirtyRegion region;
+    float        time;
+  };
+
+  struct Frame
+  {
+    CRect             viewport;
+    CDirtyRegionList  regions; ///< the marked dirty regions
+    std::vector<Pass> passes;  ///< the rendered passes
+  };
+
+  static std::string Format(const Frame &frame);
+
+  /*! \brief Parse the frames of a trace
+   \param text the trace
+   \param frames the frames are appended to
+   \return false if a line couldn't be parsed, the frames before it are kept
+   */
+  static bool Parse(const std::string &text, std::vector<Frame> &frames);
+};
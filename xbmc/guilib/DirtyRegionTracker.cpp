@@ -20,24 +20,38 @@
  */
 
 #include "DirtyRegionTracker.h"
+#include "AdaptiveDirtyRegionSolver.h"
+#include "GraphicContext.h"
+#include "filesystem/File.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/TimeUtils.h"
 #include "utils/log.h"
 #include <stdio.h>
 
+#define TRACE_FILE "special://temp/dirtyregions.trace"
+
 CDirtyRegionTracker::CDirtyRegionTracker(int buffering)
 {
   m_buffering = buffering;
   m_solver = NULL;
+  m_adaptiveSolver = NULL;
+  m_frames = 0;
+  m_statsTime = 0;
+  m_traceFile = NULL;
+  m_traceFailed = false;
 }
 
 CDirtyRegionTracker::~CDirtyRegionTracker()
 {
   delete m_solver;
+  delete m_traceFile;
 }
 
 void CDirtyRegionTracker::SelectAlgorithm()
 {
   delete m_solver;
+  m_adaptiveSolver = NULL;
 
   switch (g_advancedSettings.m_guiAlgorithmDirtyRegions)
   {
@@ -49,6 +63,11 @@ void CDirtyRegionTracker::SelectAlgorithm()
       CLog::Log(LOGDEBUG, "guilib: Cost reduction as algorithm for solving rendering passes");
       m_solver = new CGreedyDirtyRegionSolver();
       break;
+    case DIRTYREGION_SOLVER_ADAPTIVE:
+      CLog::Log(LOGDEBUG, "guilib: Adaptive cost model as algorithm for solving rendering passes");
+      m_adaptiveSolver = new CAdaptiveDirtyRegionSolver();
+      m_solver = m_adaptiveSolver;
+      break;
     case DIRTYREGION_SOLVER_UNION:
       m_solver = new CUnionDirtyRegionSolver();
       CLog::Log(LOGDEBUG, "guilib: Union as algorithm for solving rendering passes");
@@ -76,12 +95,84 @@ CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
 {
   CDirtyRegionList output;
 
+  if (m_adaptiveSolver)
+    m_adaptiveSolver->SetViewport(g_graphicsContext.GetViewWindow());
+
+  int64_t start = CurrentHostCounter();
   if (m_solver)
     m_solver->Solve(m_markedRegions, output);
+  float solveTime = 1000.0f * (CurrentHostCounter() - start) / CurrentHostFrequency();
+
+  // the solution is asked for more than once per frame, the last one is rendered
+  m_frame.regions = m_markedRegions;
+  m_frame.passes.clear();
+  m_frameStats.solveTime += solveTime;
 
   return output;
 }
 
+void CDirtyRegionTracker::PassRendered(const CDirtyRegion &pass, float time)
+{
+  if (m_solver)
+    m_solver->PassRendered(pass, time);
+
+  CRect clipped(pass);
+  clipped.Intersect(g_graphicsContext.GetViewWindow());
+
+  m_frameStats.passes++;
+  m_frameStats.pixels += clipped.Area();
+  m_frameStats.renderTime += time;
+
+  CDirtyRegionTrace::Pass renderedPass;
+  renderedPass.region = pass;
+  renderedPass.time   = time;
+  m_frame.passes.push_back(renderedPass);
+}
+
+void CDirtyRegionTracker::FrameDone()
+{
+  m_frameStats.regions += m_frame.regions.size();
+  m_frames++;
+
+  if (g_advancedSettings.m_guiTraceDirtyRegions)
+    TraceFrame();
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now - m_statsTime >= 1000)
+  {
+    m_stats.regions    = m_frameStats.regions / m_frames;
+    m_stats.passes     = m_frameStats.passes / m_frames;
+    m_stats.pixels     = m_frameStats.pixels / m_frames;
+    m_stats.solveTime  = m_frameStats.solveTime / m_frames;
+    m_stats.renderTime = m_frameStats.renderTime / m_frames;
+    m_frameStats = CDirtyRegionStats();
+    m_frames = 0;
+    m_statsTime = now;
+  }
+}
+
+void CDirtyRegionTracker::TraceFrame()
+{
+  if (m_traceFailed)
+    return;
+
+  if (!m_traceFile)
+  {
+    m_traceFile = new XFILE::CFile();
+    if (!m_traceFile->OpenForWrite(TRACE_FILE, true))
+    {
+      CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, TRACE_FILE);
+      m_traceFailed = true;
+      return;
+    }
+    CLog::Log(LOGNOTICE, "guilib: Recording the dirty regions to %s", TRACE_FILE);
+  }
+
+  m_frame.viewport = g_graphicsContext.GetViewWindow();
+  std::string frame = CDirtyRegionTrace::Format(m_frame);
+  m_traceFile->Write(frame.c_str(), frame.size());
+}
+
 void CDirtyRegionTracker::CleanMarkedRegions()
 {
   int buffering = g_advancedSettings.m_guiVisualizeDirtyRegions ? 20 : m_buffering;
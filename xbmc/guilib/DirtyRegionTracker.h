@@ -22,6 +22,12 @@
 
 #include "IDirtyRegionSolver.h"
 #include "DirtyRegionSolvers.h"
+#include "DirtyRegionTrace.h"
+
+namespace XFILE
+{
+  class CFile;
+}
 
 #if defined(TARGET_DARWIN_IOS)
 #define DEFAULT_BUFFERING 4
@@ -29,6 +35,22 @@
 #define DEFAULT_BUFFERING 3
 #endif
 
+class CAdaptiveDirtyRegionSolver;
+
+/*!
+ \brief Rendering statistics, averaged per frame
+ */
+struct CDirtyRegionStats
+{
+  CDirtyRegionStats() : regions(0), passes(0), pixels(0), solveTime(0), renderTime(0) {}
+
+  float regions;    ///< marked dirty regions
+  float passes;     ///< rendered passes
+  float pixels;     ///< redrawn pixels
+  float solveTime;  ///< ms spent in the solver
+  float renderTime; ///< ms spent rendering the passes
+};
+
 class CDirtyRegionTracker
 {
 public:
@@ -41,8 +63,33 @@ public:
   CDirtyRegionList GetDirtyRegions();
   void CleanMarkedRegions();
 
+  /*! \brief Report a rendered pass of the last solution to the solver and the statistics
+   \param pass the region that was rendered
+   \param time the time it took to render in milliseconds
+   */
+  void PassRendered(const CDirtyRegion &pass, float time);
+
+  /*! \brief Called once per rendered frame, after the passes, to update the statistics
+   and record the frame if <gui><tracedirtyregions> is enabled in advancedsettings.xml
+   */
+  void FrameDone();
+
+  /*! \brief Statistics per frame, averaged over the last second */
+  const CDirtyRegionStats &GetStats() const { return m_stats; }
+
 private:
+  void TraceFrame();
+
   CDirtyRegionList m_markedRegions;
   int m_buffering;
   IDirtyRegionSolver *m_solver;
+  CAdaptiveDirtyRegionSolver *m_adaptiveSolver; ///< m_solver if it is the adaptive solver
+
+  CDirtyRegionTrace::Frame m_frame;      ///< the regions and passes of the current frame
+  CDirtyRegionStats        m_frameStats; ///< totals of the frames since m_statsTime
+  unsigned int             m_frames;
+  unsigned int             m_statsTime;
+  CDirtyRegionStats        m_stats;
+  XFILE::CFile            *m_traceFile;
+  bool                     m_traceFailed;
 };
@@ -59,6 +59,7 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_layout = NULL;
   m_focusedLayout = NULL;
   m_cacheItems = preloadItems;
+  m_prewarmStart = -1;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
@@ -127,11 +128,33 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     current++;
   }
 
+  // the page after the processed items in the direction we scroll
+  if (ScrollingUp())
+    PrewarmItems(CorrectOffset(offset - cacheBefore - m_itemsPerPage, 0), m_itemsPerPage);
+  else
+    PrewarmItems(CorrectOffset(current, 0), m_itemsPerPage);
+
   UpdatePageControl(offset);
 
   CGUIControl::Process(currentTime, dirtyregions);
 }
 
+void CGUIBaseContainer::PrewarmItems(int start, int count)
+{
+  // rasterize the glyphs of the labels of items that are about to scroll in, in the
+  // background, so the frames that bring them into view don't have to
+  if (start == m_prewarmStart || !m_layout || m_items.empty())
+    return;
+  m_prewarmStart = start;
+
+  for (int i = 0; i < count; i++)
+  {
+    int itemNo = start + i;
+    if (itemNo >= 0 && itemNo < (int)m_items.size())
+      m_layout->Prewarm(m_items[itemNo].get());
+  }
+}
+
 void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItem *item, bool focused, unsigned int currentTime, CDirtyRegionList &dirtyregions)
 {
   if (!m_focusedLayout || !m_layout) return;
@@ -129,6 +129,7 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void PrewarmItems(int start, int count);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -200,6 +201,7 @@ private:
   int m_cursor;
   int m_offset;
   int m_cacheItems;
+  int m_prewarmStart;  ///< first item of the labels prewarmed last
   CStopWatch m_scrollTimer;
   CStopWatch m_lastScrollStartTimer;
   CStopWatch m_pageChangeTimer;
@@ -26,6 +26,7 @@
 #include "LocalizeStrings.h"
 #include "GUIWindowManager.h"
 #include "GUIControlProfiler.h"
+#include "RenderScheduler.h"
 #include "input/MouseStat.h"
 #include "Key.h"
 
@@ -444,6 +445,13 @@ float CGUIControl::GetHeight() const
 void CGUIControl::MarkDirtyRegion()
 {
   m_controlIsDirty = true;
+  g_renderScheduler.Wake();
+}
+
+void CGUIControl::SetInvalid()
+{
+  m_bInvalidated = true;
+  g_renderScheduler.Wake();
 }
 
 CRect CGUIControl::CalcRenderRegion() const
@@ -21,10 +21,12 @@
 
 #include "GUIDialog.h"
 #include "GUIWindowManager.h"
+#include "RenderScheduler.h"
 #include "GUILabelControl.h"
 #include "GUIAudioManager.h"
 #include "GUIInfoManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/TimeUtils.h"
 #include "Application.h"
 
@@ -276,5 +278,9 @@ void CGUIDialog::SetAutoClose(unsigned int timeoutMs)
 void CGUIDialog::ResetAutoClose(void)
 {
   if (m_autoClosing && m_active)
+  {
     m_showStartTime = CTimeUtils::GetFrameTime();
+    // make sure we get to close even if the render loop is idle by then
+    g_renderScheduler.ScheduleWakeup(XbmcThreads::SystemClockMillis() + m_showDuration + 1);
+  }
 }
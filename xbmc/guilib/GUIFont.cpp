@@ -268,9 +268,17 @@ float CGUIFont::GetScaleFactor() const
   return m_font->GetFontHeight() / m_origHeight;
 }
 
+void CGUIFont::Prewarm(const vecText &text)
+{
+  if (!m_font) return;
+  CSingleLock lock(g_graphicsContext);
+  m_font->Prewarm(text);
+}
+
 void CGUIFont::Begin()
 {
   if (!m_font) return;
+  m_font->AddPrewarmedCharacters();
   m_font->Begin();
 }
 
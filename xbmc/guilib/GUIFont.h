@@ -138,6 +138,11 @@ public:
   //! get font scale factor (rendered height / original height)
   float GetScaleFactor() const;
 
+  /*! \brief Rasterize the glyphs of text in the background before it is drawn
+   \param text the text, with the style of each character as from CGUITextLayout
+   */
+  void Prewarm(const vecText &text);
+
   void Begin();
   void End();
 
@@ -0,0 +1,78 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "GUIFontCharacterIndex.h"
+
+#include <algorithm>
+
+static inline unsigned int HashCharacter(uint32_t letterAndStyle)
+{
+  uint32_t hash = letterAndStyle * 2654435761U;
+  return hash ^ (hash >> 16);
+}
+
+int CGUIFontCharacterIndex::Find(uint32_t letterAndStyle) const
+{
+  if (m_slots.empty())
+    return -1;
+
+  unsigned int mask = m_slots.size() - 1;
+  for (unsigned int slot = HashCharacter(letterAndStyle) & mask; ; slot = (slot + 1) & mask)
+  {
+    const Slot &entry = m_slots[slot];
+    if (entry.index < 0 || entry.letterAndStyle == letterAndStyle)
+      return entry.index;
+  }
+}
+
+void CGUIFontCharacterIndex::Add(uint32_t letterAndStyle, int index)
+{
+  if (2 * (m_count + 1) > m_slots.size())
+  { // grow the hash and add all characters again
+    Slot empty = { 0, -1 };
+    std::vector<Slot> slots(std::max<size_t>(CHAR_INDEX_SIZE, 2 * m_slots.size()), empty);
+    m_slots.swap(slots);
+    for (std::vector<Slot>::const_iterator it = slots.begin(); it != slots.end(); ++it)
+    {
+      if (it->index >= 0)
+        Insert(*it);
+    }
+  }
+
+  Slot entry = { letterAndStyle, index };
+  Insert(entry);
+  m_count++;
+}
+
+void CGUIFontCharacterIndex::Clear()
+{
+  m_slots.clear();
+  m_count = 0;
+}
+
+void CGUIFontCharacterIndex::Insert(const Slot &entry)
+{
+  unsigned int mask = m_slots.size() - 1;
+  unsigned int slot = HashCharacter(entry.letterAndStyle) & mask;
+  while (m_slots[slot].index >= 0)
+    slot = (slot + 1) & mask;
+  m_slots[slot] = entry;
+}
@@ -0,0 +1,65 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#define CHAR_INDEX_SIZE 128   // initial size of the character hash, grows when half full
+
+/*!
+ \ingroup textures
+ \brief Hash of the characters cached by a font, from letterAndStyle to their index.
+
+ Open addressing, the hash is never more than half full so a lookup always ends
+ at an empty slot. It is made with CHAR_INDEX_SIZE slots when the first character
+ is added, and doubled and refilled when it gets half full.
+ */
+class CGUIFontCharacterIndex
+{
+public:
+  CGUIFontCharacterIndex() : m_count(0) {}
+
+  /*! \brief Find a character
+   \return the index it was added with, -1 if it isn't in the hash
+   */
+  int Find(uint32_t letterAndStyle) const;
+
+  /*! \brief Add a character that isn't in the hash yet */
+  void Add(uint32_t letterAndStyle, int index);
+
+  void Clear();
+
+  unsigned int GetCount() const { return m_count; }
+  unsigned int GetSize() const { return m_slots.size(); }
+
+private:
+  struct Slot
+  {
+    uint32_t letterAndStyle;
+    int      index;           ///< -1 if the slot is empty
+  };
+
+  void Insert(const Slot &entry);
+
+  std::vector<Slot> m_slots;
+  unsigned int      m_count;
+};
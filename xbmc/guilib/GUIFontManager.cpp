@@ -25,6 +25,7 @@
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
 #include "GUIFont.h"
+#include "GUITextLayoutCache.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
 #include "filesystem/File.h"
@@ -32,6 +33,7 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "windowing/WindowingFactory.h"
+#include "threads/SystemClock.h"
 
 using namespace std;
 
@@ -41,6 +43,12 @@ GUIFontManager::GUIFontManager(void)
 {
   m_fontsetUnicode=false;
   m_canReload = true;
+  m_glyphsRasterized = 0;
+  m_glyphsPrewarmed = 0;
+  m_glyphsPeak = 0;
+  m_glyphStatsTime = 0;
+  m_peakGlyphsPerFrame = 0;
+  m_prewarmedGlyphsPerSecond = 0;
 }
 
 GUIFontManager::~GUIFontManager(void)
@@ -246,11 +254,31 @@ void GUIFontManager::Unload(const CStdString& strFontName)
     {
       delete (*iFont);
       m_vecFonts.erase(iFont);
+      g_textLayoutCache.Clear();
       return;
     }
   }
 }
 
+void GUIFontManager::FrameDone()
+{
+  // a frame that rasterizes many glyphs is late, log the ones that stand out
+  if (m_glyphsRasterized >= 32)
+    CLog::Log(LOGDEBUG, "%s - rasterized %u glyphs in one frame", __FUNCTION__, m_glyphsRasterized);
+  m_glyphsPeak = std::max(m_glyphsPeak, m_glyphsRasterized);
+  m_glyphsRasterized = 0;
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now - m_glyphStatsTime >= 1000)
+  {
+    m_peakGlyphsPerFrame = m_glyphsPeak;
+    m_prewarmedGlyphsPerSecond = m_glyphsPrewarmed * 1000 / (now - m_glyphStatsTime);
+    m_glyphsPeak = 0;
+    m_glyphsPrewarmed = 0;
+    m_glyphStatsTime = now;
+  }
+}
+
 void GUIFontManager::FreeFontFile(CGUIFontTTFBase *pFont)
 {
   for (vector<CGUIFontTTFBase*>::iterator it = m_vecFontFiles.begin(); it != m_vecFontFiles.end(); ++it)
@@ -259,6 +287,7 @@ void GUIFontManager::FreeFontFile(CGUIFontTTFBase *pFont)
     {
       m_vecFontFiles.erase(it);
       delete pFont;
+      g_textLayoutCache.Clear();
       return;
     }
   }
@@ -335,6 +364,7 @@ void GUIFontManager::Clear()
   m_vecFontFiles.clear();
   m_vecFontInfo.clear();
   m_fontsetUnicode=false;
+  g_textLayoutCache.Clear();
 }
 
 void GUIFontManager::LoadFonts(const CStdString& strFontSet)
@@ -75,6 +75,17 @@ public:
   void Clear();
   void FreeFontFile(CGUIFontTTFBase *pFont);
 
+  /*! \brief Count a glyph rasterized on the render thread, i.e. one that wasn't prewarmed */
+  void GlyphRasterized() { m_glyphsRasterized++; }
+  /*! \brief Count a prewarmed glyph copied to its font texture */
+  void GlyphPrewarmed() { m_glyphsPrewarmed++; }
+  /*! \brief Update the glyph statistics at the end of a processed frame */
+  void FrameDone();
+  /*! \brief Most glyphs rasterized on the render thread in a frame during the last second */
+  unsigned int GetPeakGlyphsPerFrame() const { return m_peakGlyphsPerFrame; }
+  /*! \brief Prewarmed glyphs copied to their font texture per second */
+  unsigned int GetPrewarmedGlyphsPerSecond() const { return m_prewarmedGlyphsPerSecond; }
+
   bool IsFontSetUnicode() { return m_fontsetUnicode; }
   bool IsFontSetUnicode(const CStdString& strFontSet);
   bool GetFirstFontSetUnicode(CStdString& strFontSet);
@@ -92,6 +103,14 @@ protected:
   bool m_fontsetUnicode;
   RESOLUTION_INFO m_skinResolution;
   bool m_canReload;
+
+  // glyph statistics, only touched by the render thread
+  unsigned int m_glyphsRasterized;          ///< in the current frame
+  unsigned int m_glyphsPrewarmed;           ///< since m_glyphStatsTime
+  unsigned int m_glyphsPeak;                ///< since m_glyphStatsTime
+  unsigned int m_glyphStatsTime;
+  unsigned int m_peakGlyphsPerFrame;
+  unsigned int m_prewarmedGlyphsPerSecond;
 };
 
 /*!
@@ -22,14 +22,19 @@
 #include "GUIFont.h"
 #include "GUIFontTTF.h"
 #include "GUIFontManager.h"
+#include "GlyphPrewarmer.h"
 #include "Texture.h"
 #include "GraphicContext.h"
 #include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/MathUtils.h"
 #include "utils/log.h"
 #include "windowing/WindowingFactory.h"
 
 #include <math.h>
+#include <map>
+#include <set>
 
 // stuff for freetype
 #include <ft2build.h>
@@ -37,6 +42,7 @@
 #include FT_GLYPH_H
 #include FT_OUTLINE_H
 #include FT_STROKER_H
+#include FT_SIZES_H
 
 #define USE_RELEASE_LIBS
 
@@ -48,7 +54,6 @@ using namespace std;
 
 
 #define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
-#define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
 
 int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing over letter spacing when justifying.
                                                   // A larger number means more of the "dead space" is placed between
@@ -68,7 +73,11 @@ public:
       FT_Done_FreeType(m_library);
   }
 
-  FT_Face GetFont(const CStdString &filename, float size, float aspect)
+  /*! \brief Get a size of a font file
+   The face of a file is loaded once and shared by all its sizes, the face of
+   the size returned is size->face.
+   */
+  FT_Size GetFont(const CStdString &filename, float size, float aspect)
   {
     // don't have it yet - create it
     if (!m_library)
@@ -79,11 +88,26 @@ public:
       return NULL;
     }
 
-    FT_Face face;
+    FaceMap::iterator it = m_faces.find(filename);
+    if (it == m_faces.end())
+    {
+      FT_Face face;
+
+      // ok, now load the font face
+      if (FT_New_Face( m_library, CSpecialProtocol::TranslatePath(filename).c_str(), 0, &face ))
+        return NULL;
+
+      it = m_faces.insert(make_pair(filename, SharedFace(face))).first;
+    }
 
-    // ok, now load the font face
-    if (FT_New_Face( m_library, CSpecialProtocol::TranslatePath(filename).c_str(), 0, &face ))
+    FT_Face face = it->second.face;
+    FT_Size ftSize;
+    if (FT_New_Size(face, &ftSize))
+    {
+      ReleaseFace(it);
       return NULL;
+    }
+    FT_Activate_Size(ftSize);
 
     unsigned int ydpi = GetDPI();
     unsigned int xdpi = (unsigned int)MathUtils::round_int(ydpi * aspect);
@@ -94,11 +118,13 @@ public:
     // scaling to pixel ratio on screen perhaps?
     if (FT_Set_Char_Size( face, 0, (int)(size*64 + 0.5f), xdpi, ydpi ))
     {
-      FT_Done_Face(face);
+      FT_Done_Size(ftSize);
+      ReleaseFace(it);
       return NULL;
     }
 
-    return face;
+    it->second.references++;
+    return ftSize;
   };
   
   FT_Stroker GetStroker()
@@ -113,10 +139,20 @@ public:
     return stroker;
   };
 
-  void ReleaseFont(FT_Face face)
+  void ReleaseFont(FT_Size size)
   {
-    assert(face);
-    FT_Done_Face(face);
+    assert(size);
+    FT_Face face = size->face;
+    FT_Done_Size(size);
+    for (FaceMap::iterator it = m_faces.begin(); it != m_faces.end(); ++it)
+    {
+      if (it->second.face == face)
+      {
+        it->second.references--;
+        ReleaseFace(it);
+        break;
+      }
+    }
   };
   
   void ReleaseStroker(FT_Stroker stroker)
@@ -131,16 +167,135 @@ public:
   };
 
 private:
+  struct SharedFace
+  {
+    SharedFace(FT_Face f) : face(f), references(0) {}
+    FT_Face      face;
+    unsigned int references; ///< number of sizes handed out
+  };
+  typedef std::map<CStdString, SharedFace> FaceMap;
+
+  void ReleaseFace(FaceMap::iterator it)
+  {
+    if (it->second.references == 0)
+    {
+      FT_Done_Face(it->second.face);
+      m_faces.erase(it);
+    }
+  }
+
   FT_Library   m_library;
+  FaceMap      m_faces;
 };
 
 CFreeTypeLibrary g_freeTypeLibrary; // our freetype library
 
+// freetype isn't thread safe, the glyph prewarmers have a library of their own
+CFreeTypeLibrary g_freeTypeWorkerLibrary;
+CCriticalSection g_freeTypeWorkerSection;
+
+static FT_Pos GetBorderStrength(FT_Size size)
+{
+  FT_Pos strength = FT_MulFix( size->face->units_per_EM, size->metrics.y_scale) / 12;
+  if (strength < 128)
+    strength = 128;
+  return strength;
+}
+
+/*!
+ \brief Rasterizes the glyphs of a font with FreeType on a job worker.
+
+ Each prewarmer renders with a size and stroker of its own from g_freeTypeWorkerLibrary,
+ the render thread only has to copy the bitmaps into the font's texture.
+ */
+class CFreeTypeGlyphPrewarmer : public CGlyphPrewarmer
+{
+public:
+  CFreeTypeGlyphPrewarmer(const CStdString &filename, float height, float aspect, bool border)
+    : m_filename(filename), m_height(height), m_aspect(aspect), m_border(border)
+  {
+    m_opened  = false;
+    m_size    = NULL;
+    m_stroker = NULL;
+  }
+
+  virtual ~CFreeTypeGlyphPrewarmer()
+  {
+    CSingleLock lock(g_freeTypeWorkerSection);
+    if (m_stroker)
+      g_freeTypeWorkerLibrary.ReleaseStroker(m_stroker);
+    if (m_size)
+      g_freeTypeWorkerLibrary.ReleaseFont(m_size);
+  }
+
+protected:
+  virtual bool Rasterize(uint32_t letterAndStyle, Glyph &glyph)
+  {
+    CSingleLock lock(g_freeTypeWorkerSection);
+    if (!m_opened)
+    {
+      m_opened = true;
+      m_size = g_freeTypeWorkerLibrary.GetFont(m_filename, m_height, m_aspect);
+      if (m_size && m_border)
+      {
+        m_stroker = g_freeTypeWorkerLibrary.GetStroker();
+        if (m_stroker)
+          FT_Stroker_Set(m_stroker, GetBorderStrength(m_size), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+      }
+    }
+    if (!m_size)
+      return false;
+
+    FT_Glyph rendered = CGUIFontTTFBase::RenderGlyph(m_size, m_stroker, (wchar_t)(letterAndStyle & 0xffff),
+                                                     letterAndStyle >> 16, glyph.advance);
+    if (!rendered)
+      return false;
+
+    FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)rendered;
+    const FT_Bitmap &bitmap = bitGlyph->bitmap;
+    glyph.left  = bitGlyph->left;
+    glyph.top   = bitGlyph->top;
+    glyph.width = bitmap.width;
+    glyph.rows  = bitmap.rows;
+    glyph.pixels.resize(bitmap.width * bitmap.rows);
+    for (int y = 0; y < bitmap.rows; y++)
+      memcpy(&glyph.pixels[y * bitmap.width], bitmap.buffer + y * bitmap.pitch, bitmap.width);
+    FT_Done_Glyph(rendered);
+    return true;
+  }
+
+private:
+  CStdString m_filename;
+  float      m_height;
+  float      m_aspect;
+  bool       m_border;
+
+  // only used with g_freeTypeWorkerSection held
+  bool       m_opened;
+  FT_Size    m_size;
+  FT_Stroker m_stroker;
+};
+
+class CGlyphPrewarmJob : public CJob
+{
+public:
+  CGlyphPrewarmJob(const boost::shared_ptr<CGlyphPrewarmer> &prewarmer) : m_prewarmer(prewarmer) {}
+
+  virtual bool DoWork()
+  {
+    m_prewarmer->Run();
+    return true;
+  }
+
+  virtual const char *GetType() const { return "glyphprewarm"; }
+
+private:
+  boost::shared_ptr<CGlyphPrewarmer> m_prewarmer;
+};
+
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
   m_texture = NULL;
-  m_char = NULL;
-  m_maxChars = 0;
   m_nestedBeginCount = 0;
 
   m_bTextureLoaded = false;
@@ -148,13 +303,16 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_vertex        = (SVertex*)malloc(m_vertex_size * sizeof(SVertex));
 
   m_face = NULL;
+  m_size = NULL;
   m_stroker = NULL;
+  m_aspect = 1.0f;
+  m_border = false;
   memset(m_charquick, 0, sizeof(m_charquick));
   m_strFileName = strFileName;
   m_referenceCount = 0;
+  m_cacheClears = 0;
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
-  m_numChars = 0;
   m_posX = m_posY = 0;
   m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
@@ -190,11 +348,12 @@ void CGUIFontTTFBase::ClearCharacterCache()
   DeleteHardwareTexture();
 
   m_texture = NULL;
-  delete[] m_char;
-  m_char = new Character[CHAR_CHUNK];
+  m_char.clear();
+  m_charIndex.Clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_numChars = 0;
-  m_maxChars = CHAR_CHUNK;
+  m_cacheClears++;
+  if (m_prewarmer)
+    m_prewarmer->Cancel();
   // set the posX and posY so that our texture will be created on first character write.
   m_posX = m_textureWidth;
   m_posY = -(int)m_cellHeight;
@@ -205,17 +364,21 @@ void CGUIFontTTFBase::Clear()
 {
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
+  m_char.clear();
+  m_charIndex.Clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_char = NULL;
-  m_maxChars = 0;
-  m_numChars = 0;
   m_posX = 0;
   m_posY = 0;
   m_nestedBeginCount = 0;
 
-  if (m_face)
-    g_freeTypeLibrary.ReleaseFont(m_face);
+  // a running job keeps the prewarmer alive until it is done
+  if (m_prewarmer)
+    m_prewarmer->Cancel();
+  m_prewarmer.reset();
+
+  if (m_size)
+    g_freeTypeLibrary.ReleaseFont(m_size);
+  m_size = NULL;
   m_face = NULL;
   if (m_stroker)
     g_freeTypeLibrary.ReleaseStroker(m_stroker);
@@ -230,10 +393,13 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 {
   // we now know that this object is unique - only the GUIFont objects are non-unique, so no need
   // for reference tracking these fonts
-  m_face = g_freeTypeLibrary.GetFont(strFilename, height, aspect);
+  m_size = g_freeTypeLibrary.GetFont(strFilename, height, aspect);
 
-  if (!m_face)
+  if (!m_size)
     return false;
+  m_face = m_size->face;
+  m_aspect = aspect;
+  m_border = border;
 
   // grab the maximum cell height and width
   unsigned int m_cellWidth = m_face->bbox.xMax - m_face->bbox.xMin;
@@ -244,9 +410,7 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
   {
     m_stroker = g_freeTypeLibrary.GetStroker();
 
-    FT_Pos strength = FT_MulFix( m_face->units_per_EM, m_face->size->metrics.y_scale) / 12;
-    if (strength < 128)
-      strength = 128;
+    FT_Pos strength = GetBorderStrength(m_size);
     m_cellHeight += 2*strength;
 
     if (m_stroker)
@@ -278,11 +442,8 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
-  m_char = NULL;
-
-  m_maxChars = 0;
-  m_numChars = 0;
+  m_char.clear();
+  m_charIndex.Clear();
 
   m_strFilename = strFilename;
 
@@ -307,6 +468,7 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
 void CGUIFontTTFBase::DrawTextInternal(float x, float y, const vecColors &colors, const vecText &text, uint32_t alignment, float maxPixelWidth, bool scrolling)
 {
+  AddPrewarmedCharacters();
   Begin();
 
   // save the origin, which is scaled separately
@@ -439,8 +601,8 @@ float CGUIFontTTFBase::GetTextHeight(float lineSpacing, int numLines) const
 
 float CGUIFontTTFBase::GetLineHeight(float lineSpacing) const
 {
-  if (m_face)
-    return lineSpacing * m_face->size->metrics.height / 64.0f;
+  if (m_size)
+    return lineSpacing * m_size->metrics.height / 64.0f;
   return 0.0f;
 }
 
@@ -462,52 +624,26 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   }
 
   // letters are stored based on style and letter
-  character_t ch = (style << 16) | letter;
-
-  int low = 0;
-  int high = m_numChars - 1;
-  int mid;
-  while (low <= high)
-  {
-    mid = (low + high) >> 1;
-    if (ch > m_char[mid].letterAndStyle)
-      low = mid + 1;
-    else if (ch < m_char[mid].letterAndStyle)
-      high = mid - 1;
-    else
-      return &m_char[mid];
-  }
-  // if we get to here, then low is where we should insert the new character
+  int index = m_charIndex.Find((style << 16) | letter);
+  if (index >= 0)
+    return &m_char[index];
 
-  // increase the size of the buffer if we need it
-  if (m_numChars >= m_maxChars)
-  { // need to increase the size of the buffer
-    Character *newTable = new Character[m_maxChars + CHAR_CHUNK];
-    if (m_char)
-    {
-      memcpy(newTable, m_char, low * sizeof(Character));
-      memcpy(newTable + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-      delete[] m_char;
-    }
-    m_char = newTable;
-    m_maxChars += CHAR_CHUNK;
+  return AddCharacter(letter, style);
+}
 
-  }
-  else
-  { // just move the data along as necessary
-    memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-  }
+CGUIFontTTFBase::Character* CGUIFontTTFBase::AddCharacter(wchar_t letter, character_t style)
+{
   // render the character to our texture
   // must End() as we can't render text to our texture during a Begin(), End() block
+  Character ch;
   unsigned int nestedBeginCount = m_nestedBeginCount;
   m_nestedBeginCount = 1;
   if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
+  if (!CacheCharacter(letter, style, &ch))
   { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "GUIFontTTF::GetCharacter: Unable to cache character.  Clearing character cache of %i characters", m_numChars);
+    CLog::Log(LOGDEBUG, "GUIFontTTF::GetCharacter: Unable to cache character.  Clearing character cache of %i characters", (int)m_char.size());
     ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+    if (!CacheCharacter(letter, style, &ch))
     {
       CLog::Log(LOGERROR, "GUIFontTTF::GetCharacter: Unable to cache character (out of memory?)");
       if (nestedBeginCount) Begin();
@@ -518,51 +654,134 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   if (nestedBeginCount) Begin();
   m_nestedBeginCount = nestedBeginCount;
 
-  // fixup quick access
-  memset(m_charquick, 0, sizeof(m_charquick));
-  for(int i=0;i<m_numChars;i++)
+  // characters are appended, so pointers to the cached ones stay valid
+  m_char.push_back(ch);
+  m_charIndex.Add(ch.letterAndStyle, m_char.size() - 1);
+
+  Character *cached = &m_char.back();
+  if (letter < 255)
+    m_charquick[(style << 8) | letter] = cached;
+
+  return cached;
+}
+
+void CGUIFontTTFBase::Prewarm(const vecText &text)
+{
+  vector<character_t> missing;
+  for (vecText::const_iterator it = text.begin(); it != text.end(); ++it)
   {
-    if ((m_char[i].letterAndStyle & 0xffff) < 255)
-    {
-      character_t ch = ((m_char[i].letterAndStyle & 0xffff0000) >> 8) | (m_char[i].letterAndStyle & 0xff);
-      m_charquick[ch] = m_char+i;
-    }
+    wchar_t letter = (wchar_t)(*it & 0xffff);
+    character_t style = (*it & 0x3000000) >> 24;
+    if (letter == L'\r' || (letter < 255 && m_charquick[(style << 8) | letter]))
+      continue;
+    if (m_charIndex.Find((style << 16) | letter) < 0)
+      missing.push_back((style << 16) | letter);
   }
+  if (missing.empty())
+    return;
 
-  return m_char + low;
+  if (!m_prewarmer)
+    m_prewarmer.reset(new CFreeTypeGlyphPrewarmer(m_strFilename, m_height, m_aspect, m_border));
+  if (m_prewarmer->Queue(missing))
+    CJobManager::GetInstance().AddJob(new CGlyphPrewarmJob(m_prewarmer), NULL);
+}
+
+void CGUIFontTTFBase::AddPrewarmedCharacters()
+{
+  // characters can only be added to the texture outside of a Begin(), End() block,
+  // adding them at once saves uploading the texture for each of them
+  if (!m_prewarmer || m_nestedBeginCount)
+    return;
+
+  vector<character_t> ready;
+  m_prewarmer->GetReady(ready);
+  unsigned int cacheClears = m_cacheClears;
+  for (vector<character_t>::const_iterator it = ready.begin(); it != ready.end(); ++it)
+  {
+    // once the cache was full and cleared the other glyphs were dropped with it,
+    // they would all be rasterized here instead of when they are needed
+    if (!GetCharacter(((*it & 0xffff0000) << 8) | (*it & 0xffff)) || m_cacheClears != cacheClears)
+      break;
+  }
 }
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
 {
-  int glyph_index = FT_Get_Char_Index( m_face, letter );
+  character_t letterAndStyle = (style << 16) | letter;
+
+  // a glyph that was prewarmed only has to be copied to the texture
+  CGlyphPrewarmer::Glyph prewarmed;
+  if (m_prewarmer && m_prewarmer->Take(letterAndStyle, prewarmed))
+  {
+    FT_BitmapGlyphRec bitGlyph;
+    memset(&bitGlyph, 0, sizeof(bitGlyph));
+    bitGlyph.left = prewarmed.left;
+    bitGlyph.top = prewarmed.top;
+    bitGlyph.bitmap.width = prewarmed.width;
+    bitGlyph.bitmap.rows = prewarmed.rows;
+    bitGlyph.bitmap.pitch = prewarmed.width;
+    bitGlyph.bitmap.buffer = prewarmed.pixels.empty() ? NULL : &prewarmed.pixels[0];
+    bitGlyph.bitmap.num_grays = 256;
+    bitGlyph.bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+    g_fontManager.GlyphPrewarmed();
+    return PlaceCharacter(&bitGlyph, prewarmed.advance, letterAndStyle, ch);
+  }
+
+  float advance;
+  FT_Glyph glyph = RenderGlyph(m_size, m_stroker, letter, style, advance);
+  if (!glyph)
+    return false;
+  g_fontManager.GlyphRasterized();
+
+  bool placed = PlaceCharacter((FT_BitmapGlyph)glyph, advance, letterAndStyle, ch);
+
+  // free the glyph
+  FT_Done_Glyph(glyph);
+
+  return placed;
+}
+
+FT_Glyph CGUIFontTTFBase::RenderGlyph(FT_Size size, FT_Stroker stroker, wchar_t letter, uint32_t style, float &advance)
+{
+  // the face is shared by all sizes of the font
+  FT_Face face = size->face;
+  FT_Activate_Size(size);
+
+  int glyph_index = FT_Get_Char_Index( face, letter );
 
   FT_Glyph glyph = NULL;
-  if (FT_Load_Glyph( m_face, glyph_index, FT_LOAD_TARGET_LIGHT ))
+  if (FT_Load_Glyph( face, glyph_index, FT_LOAD_TARGET_LIGHT ))
   {
     CLog::Log(LOGDEBUG, "%s Failed to load glyph %x", __FUNCTION__, letter);
-    return false;
+    return NULL;
   }
   // make bold if applicable
   if (style & FONT_STYLE_BOLD)
-    EmboldenGlyph(m_face->glyph);
+    EmboldenGlyph(face->glyph);
   // and italics if applicable
   if (style & FONT_STYLE_ITALICS)
-    ObliqueGlyph(m_face->glyph);
+    ObliqueGlyph(face->glyph);
   // grab the glyph
-  if (FT_Get_Glyph(m_face->glyph, &glyph))
+  if (FT_Get_Glyph(face->glyph, &glyph))
   {
     CLog::Log(LOGDEBUG, "%s Failed to get glyph %x", __FUNCTION__, letter);
-    return false;
+    return NULL;
   }
-  if (m_stroker)
-    FT_Glyph_StrokeBorder(&glyph, m_stroker, 0, 1);
+  if (stroker)
+    FT_Glyph_StrokeBorder(&glyph, stroker, 0, 1);
   // render the glyph
   if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, NULL, 1))
   {
     CLog::Log(LOGDEBUG, "%s Failed to render glyph %x to a bitmap", __FUNCTION__, letter);
-    return false;
+    FT_Done_Glyph(glyph);
+    return NULL;
   }
-  FT_BitmapGlyph bitGlyph = (FT_BitmapGlyph)glyph;
+  advance = (float)MathUtils::round_int( (float)face->glyph->advance.x / 64 );
+  return glyph;
+}
+
+bool CGUIFontTTFBase::PlaceCharacter(FT_BitmapGlyph bitGlyph, float advance, character_t letterAndStyle, Character *ch)
+{
   FT_Bitmap bitmap = bitGlyph->bitmap;
   if (bitGlyph->left < 0)
     m_posX += -bitGlyph->left;
@@ -583,7 +802,6 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
       if (newHeight > g_Windowing.GetMaxTextureSize())
       {
         CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: New cache texture is too large (%u > %u pixels long)", newHeight, g_Windowing.GetMaxTextureSize());
-        FT_Done_Glyph(glyph);
         return false;
       }
 
@@ -591,7 +809,6 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
       newTexture = ReallocTexture(newHeight);
       if(newTexture == NULL)
       {
-        FT_Done_Glyph(glyph);
         CLog::Log(LOGDEBUG, "GUIFontTTF::CacheCharacter: Failed to allocate new texture of height %u", newHeight);
         return false;
       }
@@ -606,14 +823,14 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   }
 
   // set the character in our table
-  ch->letterAndStyle = (style << 16) | letter;
+  ch->letterAndStyle = letterAndStyle;
   ch->offsetX = (short)bitGlyph->left;
   ch->offsetY = (short)max((short)m_cellBaseLine - bitGlyph->top, 0);
   ch->left = (float)m_posX + ch->offsetX;
   ch->top = (float)m_posY + ch->offsetY;
   ch->right = ch->left + bitmap.width;
   ch->bottom = ch->top + bitmap.rows;
-  ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->advance = advance;
 
   // we need only render if we actually have some pixels
   if (bitmap.width * bitmap.rows)
@@ -621,14 +838,10 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
     CopyCharToTexture(bitGlyph, ch);
   }
   m_posX += 1 + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
-  m_numChars++;
 
   m_textureScaleX = 1.0f / m_textureWidth;
   m_textureScaleY = 1.0f / m_textureHeight;
 
-  // free the glyph
-  FT_Done_Glyph(glyph);
-
   return true;
 }
 
@@ -798,8 +1011,8 @@ void CGUIFontTTFBase::EmboldenGlyph(FT_GlyphSlot slot)
     return;
 
   /* some reasonable strength */
-  FT_Pos strength = FT_MulFix( m_face->units_per_EM,
-                    m_face->size->metrics.y_scale ) / 24;
+  FT_Pos strength = FT_MulFix( slot->face->units_per_EM,
+                    slot->face->size->metrics.y_scale ) / 24;
 
   FT_BBox bbox_before, bbox_after;
   FT_Outline_Get_CBox( &slot->outline, &bbox_before );
@@ -28,20 +28,31 @@
  *
  */
 
+#include "GUIFontCharacterIndex.h"
+
+#include <deque>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
 // forward definition
 class CBaseTexture;
+class CGlyphPrewarmer;
+class CFreeTypeGlyphPrewarmer;
 
 struct FT_FaceRec_;
 struct FT_LibraryRec_;
 struct FT_GlyphSlotRec_;
 struct FT_BitmapGlyphRec_;
 struct FT_StrokerRec_;
+struct FT_SizeRec_;
 
 typedef struct FT_FaceRec_ *FT_Face;
 typedef struct FT_LibraryRec_ *FT_Library;
 typedef struct FT_GlyphSlotRec_ *FT_GlyphSlot;
 typedef struct FT_BitmapGlyphRec_ *FT_BitmapGlyph;
 typedef struct FT_StrokerRec_ *FT_Stroker;
+typedef struct FT_SizeRec_ *FT_Size;
+typedef struct FT_GlyphRec_ *FT_Glyph;
 
 typedef uint32_t character_t;
 typedef uint32_t color_t;
@@ -68,6 +79,7 @@ struct SVertex
 class CGUIFontTTFBase
 {
   friend class CGUIFont;
+  friend class CFreeTypeGlyphPrewarmer;
 
 public:
 
@@ -103,12 +115,21 @@ protected:
   void DrawTextInternal(float x, float y, const vecColors &colors, const vecText &text,
                             uint32_t alignment, float maxPixelWidth, bool scrolling);
 
+  /*! \brief Rasterize the glyphs of text that is about to be drawn in the background
+   Glyphs that aren't cached yet are rendered by a job, the next draw or measure of
+   the text only has to copy them into the texture.
+   */
+  void Prewarm(const vecText &text);
+  void AddPrewarmedCharacters();
+
   float m_height;
   CStdString m_strFilename;
 
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
+  Character *AddCharacter(wchar_t letter, character_t style);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
+  bool PlaceCharacter(FT_BitmapGlyph bitGlyph, float advance, character_t letterAndStyle, Character *ch);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
   void ClearCharacterCache();
 
@@ -116,9 +137,14 @@ protected:
   virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, Character *ch) = 0;
   virtual void DeleteHardwareTexture() = 0;
 
+  /*! \brief Render a glyph of a face at a size to a bitmap
+   \return the bitmap glyph to be freed with FT_Done_Glyph(), NULL on failure
+   */
+  static FT_Glyph RenderGlyph(FT_Size size, FT_Stroker stroker, wchar_t letter, uint32_t style, float &advance);
+
   // modifying glyphs
-  void EmboldenGlyph(FT_GlyphSlot slot);
-  void ObliqueGlyph(FT_GlyphSlot slot);
+  static void EmboldenGlyph(FT_GlyphSlot slot);
+  static void ObliqueGlyph(FT_GlyphSlot slot);
 
   CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
 
@@ -129,10 +155,10 @@ protected:
 
   color_t m_color;
 
-  Character *m_char;                 // our characters
+  std::deque<Character> m_char;      // our characters, in the order they were cached
+  CGUIFontCharacterIndex m_charIndex; // letterAndStyle -> index into m_char
+  unsigned int m_cacheClears;        // times the character cache was cleared
   Character *m_charquick[256*4];     // ascii chars (4 styles) here
-  int m_maxChars;                    // size of character array (can be incremented)
-  int m_numChars;                    // the current number of cached characters
 
   float m_ellipsesWidth;               // this is used every character (width of '.')
 
@@ -142,8 +168,13 @@ protected:
   unsigned int m_nestedBeginCount;             // speedups
 
   // freetype stuff
-  FT_Face    m_face;
+  FT_Face    m_face;                 // shared by the fonts of all sizes of the file
+  FT_Size    m_size;
   FT_Stroker m_stroker;
+  float      m_aspect;
+  bool       m_border;
+
+  boost::shared_ptr<CGlyphPrewarmer> m_prewarmer;
 
   float m_originX;
   float m_originY;
@@ -46,6 +46,11 @@ public:
   virtual void ResetAnimation(ANIMATION_TYPE type);
   virtual void UpdateVisibility(const CGUIListItem *item = NULL);
   virtual void UpdateInfo(const CGUIListItem *item);
+
+  /*! \brief Rasterize the glyphs of the labels of an item in the background
+   Used for items that are about to scroll into view.
+   */
+  void Prewarm(const CGUIListItem *item) const;
   virtual void SetInvalid();
 
   void EnlargeWidth(float difference);
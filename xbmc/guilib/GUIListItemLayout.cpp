@@ -96,6 +96,13 @@ void CGUIListItemLayout::Render(CGUIListItem *item, int parentID)
   m_group.DoRender();
 }
 
+void CGUIListItemLayout::Prewarm(const CGUIListItem *item) const
+{
+  // labels are only evaluated for file items, see Process()
+  if (item->IsFileItem())
+    m_group.Prewarm(item);
+}
+
 void CGUIListItemLayout::SetFocusedItem(unsigned int focus)
 {
   m_group.SetFocusedItem(focus);
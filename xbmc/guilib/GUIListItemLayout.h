@@ -38,6 +38,7 @@ public:
   void LoadLayout(TiXmlElement *layout, int context, bool focused);
   void Process(CGUIListItem *item, int parentID, unsigned int currentTime, CDirtyRegionList &dirtyregions);
   void Render(CGUIListItem *item, int parentID);
+  void Prewarm(const CGUIListItem *item) const;
   float Size(ORIENTATION orientation) const;
   unsigned int GetFocusedItem() const;
   void SetFocusedItem(unsigned int focus);
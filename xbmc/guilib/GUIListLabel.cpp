@@ -99,6 +99,11 @@ void CGUIListLabel::UpdateInfo(const CGUIListItem *item)
     SetLabel(m_info.GetLabel(m_parentID, true));
 }
 
+void CGUIListLabel::Prewarm(const CGUIListItem *item) const
+{
+  CGUITextLayout::Prewarm(m_label.GetLabelInfo().font, m_info.GetItemLabel(item));
+}
+
 void CGUIListLabel::SetInvalid()
 {
   m_label.SetInvalid();
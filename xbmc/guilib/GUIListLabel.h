@@ -50,6 +50,11 @@ public:
   virtual void SetWidth(float width);
 
   void SetLabel(const CStdString &label);
+
+  /*! \brief Rasterize the glyphs of the label of an item in the background
+   \sa CGUITextLayout::Prewarm
+   */
+  void Prewarm(const CGUIListItem *item) const;
   void SetSelected(bool selected);
   void SetScrolling(bool scrolling);
 
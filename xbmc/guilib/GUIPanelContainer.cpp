@@ -90,6 +90,12 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
     current++;
   }
 
+  // the page after the processed rows in the direction we scroll
+  if (ScrollingUp())
+    PrewarmItems((offset - cacheBefore - m_itemsPerPage) * m_itemsPerRow, m_itemsPerPage * m_itemsPerRow);
+  else
+    PrewarmItems((current + m_itemsPerRow - 1) / m_itemsPerRow * m_itemsPerRow, m_itemsPerPage * m_itemsPerRow);
+
   UpdatePageControl(offset);
 
   CGUIControl::Process(currentTime, dirtyregions);
@@ -20,11 +20,13 @@
  */
 
 #include "GUITextLayout.h"
+#include "GUITextLayoutCache.h"
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 
 using namespace std;
 
@@ -208,6 +210,29 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   if (text.Equals(m_lastText) && !forceUpdate)
     return false;
 
+  // the same text may have been laid out with the same font before, by this or another control
+  CGUITextLayoutCache::Key key;
+  key.font      = m_font;
+  key.fontFile  = m_font ? m_font->GetFont() : NULL;
+  key.scaleX    = g_graphicsContext.GetGUIScaleX();
+  key.scaleY    = g_graphicsContext.GetGUIScaleY();
+  key.maxWidth  = (m_wrap && maxWidth > 0) ? maxWidth : 0;
+  key.maxHeight = m_maxHeight;
+  key.forceLTR  = forceLTRReadingOrder;
+  key.text      = text;
+
+  CGUITextLayoutCache::Layout layout;
+  if (g_textLayoutCache.Get(key, m_textColor, layout))
+  {
+    m_lines.swap(layout.lines);
+    m_colors.swap(layout.colors);
+    m_textWidth = layout.width;
+    m_textHeight = layout.height;
+    m_lastText = text;
+    return true;
+  }
+
+  int64_t start = CurrentHostCounter();
   vecText parsedText;
 
   // empty out our previous string
@@ -236,6 +261,12 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   // and cache the width and height for later reading
   CalcTextExtent();
 
+  layout.lines = m_lines;
+  layout.colors = m_colors;
+  layout.width = m_textWidth;
+  layout.height = m_textHeight;
+  g_textLayoutCache.Add(key, layout, CurrentHostCounter() - start);
+
   m_lastText = text;
   return true;
 }
@@ -589,6 +620,17 @@ void CGUITextLayout::DrawText(CGUIFont *font, float x, float y, color_t color, c
   font->DrawText(x, y, color, shadowColor, utf32, align, 0);
 }
 
+void CGUITextLayout::Prewarm(CGUIFont *font, const CStdString &text)
+{
+  if (!font || text.IsEmpty()) return;
+  CStdStringW utf16;
+  utf8ToW(text, utf16);
+  vecColors colors;
+  vecText parsedText;
+  ParseText(utf16, font->GetStyle(), colors, parsedText);
+  font->Prewarm(parsedText);
+}
+
 void CGUITextLayout::AppendToUTF32(const CStdStringW &utf16, character_t colStyle, vecText &utf32)
 {
   // NOTE: Assumes a single line of text
@@ -98,6 +98,13 @@ public:
 
 
   static void DrawText(CGUIFont *font, float x, float y, color_t color, color_t shadowColor, const CStdString &text, uint32_t align);
+
+  /*! \brief Rasterize the glyphs of a label in the background before it is laid out or drawn
+   \param font the font the label will be drawn with
+   \param text the label, may contain formatting
+   \sa CGUIFont::Prewarm
+   */
+  static void Prewarm(CGUIFont *font, const CStdString &text);
   static void Filter(CStdString &text);
 
 protected:
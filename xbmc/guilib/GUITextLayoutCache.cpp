@@ -0,0 +1,128 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "GUITextLayoutCache.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/TimeUtils.h"
+
+bool CGUITextLayoutCache::Key::operator<(const Key &right) const
+{
+  if (font != right.font)           return font < right.font;
+  if (fontFile != right.fontFile)   return fontFile < right.fontFile;
+  if (scaleX != right.scaleX)       return scaleX < right.scaleX;
+  if (scaleY != right.scaleY)       return scaleY < right.scaleY;
+  if (maxWidth != right.maxWidth)   return maxWidth < right.maxWidth;
+  if (maxHeight != right.maxHeight) return maxHeight < right.maxHeight;
+  if (forceLTR != right.forceLTR)   return forceLTR < right.forceLTR;
+  return text.compare(right.text) < 0;
+}
+
+CGUITextLayoutCache::CGUITextLayoutCache()
+{
+  m_hits = 0;
+  m_misses = 0;
+  m_layoutTime = 0;
+  m_frames = 0;
+  m_statsTime = 0;
+  m_hitRate = 0.0f;
+  m_frameLayoutTime = 0.0f;
+}
+
+bool CGUITextLayoutCache::Get(const Key &key, color_t textColor, Layout &layout)
+{
+  if (key.text.size() > TEXT_LAYOUT_MAX_LENGTH)
+    return false;
+
+  CSingleLock lock(m_critSection);
+  EntryMap::iterator it = m_index.find(key);
+  if (it == m_index.end())
+  {
+    m_misses++;
+    return false;
+  }
+
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  layout = it->second->layout;
+  if (layout.colors.size())
+    layout.colors[0] = textColor;
+  m_hits++;
+  return true;
+}
+
+void CGUITextLayoutCache::Add(const Key &key, const Layout &layout, int64_t time)
+{
+  CSingleLock lock(m_critSection);
+  m_layoutTime += time;
+
+  if (key.text.size() > TEXT_LAYOUT_MAX_LENGTH || m_index.find(key) != m_index.end())
+    return;
+
+  if (m_entries.size() >= TEXT_LAYOUT_CACHE_SIZE)
+  {
+    m_index.erase(m_entries.back().key);
+    m_entries.pop_back();
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.layout = layout;
+  m_entries.push_front(entry);
+  m_index[key] = m_entries.begin();
+}
+
+void CGUITextLayoutCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+  m_index.clear();
+  m_entries.clear();
+}
+
+void CGUITextLayoutCache::FrameDone()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+
+  CSingleLock lock(m_critSection);
+  m_frames++;
+  if (now - m_statsTime >= 1000)
+  {
+    unsigned int lookups = m_hits + m_misses;
+    m_hitRate = lookups ? 100.0f * m_hits / lookups : 0.0f;
+    m_frameLayoutTime = 1000.0f * m_layoutTime / CurrentHostFrequency() / m_frames;
+    m_hits = 0;
+    m_misses = 0;
+    m_layoutTime = 0;
+    m_frames = 0;
+    m_statsTime = now;
+  }
+}
+
+float CGUITextLayoutCache::GetHitRate() const
+{
+  CSingleLock lock(m_critSection);
+  return m_hitRate;
+}
+
+float CGUITextLayoutCache::GetLayoutTime() const
+{
+  CSingleLock lock(m_critSection);
+  return m_frameLayoutTime;
+}
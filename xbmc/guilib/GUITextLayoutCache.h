@@ -0,0 +1,120 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "GUITextLayout.h"
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <map>
+
+#define TEXT_LAYOUT_CACHE_SIZE 1024 // layouts
+#define TEXT_LAYOUT_MAX_LENGTH 1024 // longer texts, like plots in text boxes, are not cached
+
+class CGUIFontTTFBase;
+
+/*!
+ \brief Bounded LRU cache of laid out text, shared by all CGUITextLayouts.
+
+ Parsing, bidi flipping and wrapping a label is redone whenever its text changes,
+ which for list items happens each time an item scrolls into view. The cache keeps
+ the lines of the most recently laid out texts, keyed by everything the layout
+ depends on, so scrolling back and forth and labels repeated across controls reuse
+ them.
+
+ Layouts refer to fonts by pointer, so the cache is cleared whenever a font is
+ freed. The hit rate and the time spent laying out text are shown through the
+ system.textlayouthitrate and system.textlayouttime info labels.
+ */
+class CGUITextLayoutCache
+{
+public:
+  struct Key
+  {
+    const CGUIFont        *font;
+    const CGUIFontTTFBase *fontFile;  ///< changes when the fonts are rescaled
+    float                  scaleX;    ///< GUI scale the text was measured at
+    float                  scaleY;
+    float                  maxWidth;  ///< 0 if not wrapped
+    float                  maxHeight;
+    bool                   forceLTR;
+    CStdStringW            text;
+
+    bool operator<(const Key &right) const;
+  };
+
+  struct Layout
+  {
+    std::vector<CGUIString> lines;
+    vecColors               colors;
+    float                   width;
+    float                   height;
+  };
+
+  CGUITextLayoutCache();
+
+  /*! \brief Get a cached layout
+   Texts longer than TEXT_LAYOUT_MAX_LENGTH are never cached, so they aren't looked up.
+   \param textColor colour of the layout getting it, the cached one is of the layout that added it
+   \return true if the layout was cached, false if it has to be laid out and Add()ed
+   */
+  bool Get(const Key &key, color_t textColor, Layout &layout);
+
+  /*! \brief Add a layout to the cache, dropping the least recently used one when full
+   \param time host counter ticks it took to lay the text out
+   */
+  void Add(const Key &key, const Layout &layout, int64_t time);
+
+  /*! \brief Drop all layouts, as a font they refer to is freed */
+  void Clear();
+
+  /*! \brief Update the statistics at the end of a processed frame */
+  void FrameDone();
+
+  /*! \brief Percentage of the layouts found in the cache during the last second */
+  float GetHitRate() const;
+
+  /*! \brief Average time spent laying out text per frame during the last second, in ms */
+  float GetLayoutTime() const;
+
+private:
+  struct Entry
+  {
+    Key    key;
+    Layout layout;
+  };
+  typedef std::list<Entry> EntryList;
+  typedef std::map<Key, EntryList::iterator> EntryMap;
+
+  mutable CCriticalSection m_critSection;
+  EntryList    m_entries;     ///< most recently used first
+  EntryMap     m_index;
+
+  unsigned int m_hits;        ///< since m_statsTime
+  unsigned int m_misses;
+  int64_t      m_layoutTime;
+  unsigned int m_frames;
+  unsigned int m_statsTime;
+  float        m_hitRate;
+  float        m_frameLayoutTime;
+};
+
+extern CGUITextLayoutCache g_textLayoutCache;
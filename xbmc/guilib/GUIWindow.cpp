@@ -27,6 +27,7 @@
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "GUIWindowCache.h"
 #include "settings/Settings.h"
 #ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
 #include "GUIEditControl.h"
@@ -115,20 +116,50 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
   CXBMCTinyXML xmlDoc;
-  if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
+
+  // a window that was loaded before comes compiled, with its includes resolved.
+  // The include files it pulled in are loaded again, other windows may use their includes
+  vector<CStdString> includeFiles;
+  if (g_windowCache.Get(strPath, xmlDoc, includeFiles))
   {
-    CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
-    SetID(WINDOW_INVALID);
-    return false;
+    for (vector<CStdString>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+      g_SkinInfo->LoadIncludeFile(*it);
+    return Load(xmlDoc, false);
+  }
+
+  CStdString loadedPath = strPath;
+  if (!xmlDoc.LoadFile(loadedPath))
+  {
+    loadedPath = CStdString(strPath).ToLower();
+    if (!xmlDoc.LoadFile(loadedPath))
+    {
+      loadedPath = strLowerPath;
+      if (!xmlDoc.LoadFile(loadedPath))
+      {
+        CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
+        SetID(WINDOW_INVALID);
+        return false;
+      }
+    }
+  }
+
+  TiXmlElement* pRootElement = xmlDoc.RootElement();
+  if (pRootElement && strcmpi(pRootElement->Value(), "window") == 0)
+  {
+    // Resolve any includes that may be present
+    CGUIWindowCache::Conditions xmlIncludeConditions;
+    g_SkinInfo->ResolveIncludes(pRootElement, &xmlIncludeConditions);
+    g_windowCache.Add(strPath, loadedPath, pRootElement, xmlIncludeConditions, g_SkinInfo->GetIncludeFiles());
+    return Load(xmlDoc, false);
   }
 
   return Load(xmlDoc);
 }
 
-bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc)
+bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc, bool resolveIncludes /* = true */)
 {
   TiXmlElement* pRootElement = xmlDoc.RootElement();
-  if (strcmpi(pRootElement->Value(), "window"))
+  if (!pRootElement || strcmpi(pRootElement->Value(), "window"))
   {
     CLog::Log(LOGERROR, "file : XML file doesnt contain <window>");
     return false;
@@ -139,7 +170,8 @@ bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc)
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
   // Resolve any includes that may be present
-  g_SkinInfo->ResolveIncludes(pRootElement);
+  if (resolveIncludes)
+    g_SkinInfo->ResolveIncludes(pRootElement);
   // now load in the skin file
   SetDefaults();
 
@@ -0,0 +1,476 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+#include "GUIWindowCache.h"
+#include "GUIInfoManager.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+using namespace std;
+using namespace XFILE;
+
+#define CACHE_PATH     "special://temp/skincache/"
+#define CACHE_MAGIC    0x43574258 // "XBWC"
+#define CACHE_VERSION  1
+
+// compiled windows kept in memory, the least recently used are dropped beyond this
+#define MAX_MEMORY     (4 * 1024 * 1024)
+
+// deeper trees are taken as corrupt
+#define MAX_DEPTH      256
+
+#define NODE_ELEMENT   'E'
+#define NODE_TEXT      'T'
+
+namespace
+{
+  void PutInt(string &out, uint32_t value)
+  {
+    out.append((const char *)&value, sizeof(value));
+  }
+
+  void PutInt64(string &out, int64_t value)
+  {
+    out.append((const char *)&value, sizeof(value));
+  }
+
+  void PutString(string &out, const string &value)
+  {
+    PutInt(out, value.size());
+    out.append(value);
+  }
+
+  class CReader
+  {
+  public:
+    CReader(const char *data, size_t size) : m_pos(data), m_end(data + size), m_ok(true) {}
+
+    uint32_t GetInt()
+    {
+      uint32_t value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    int64_t GetInt64()
+    {
+      int64_t value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    char GetChar()
+    {
+      char value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    string GetString()
+    {
+      uint32_t size = GetInt();
+      if (!m_ok || size > (size_t)(m_end - m_pos))
+      {
+        m_ok = false;
+        return "";
+      }
+      string value(m_pos, size);
+      m_pos += size;
+      return value;
+    }
+
+    bool IsOK() const { return m_ok; }
+
+  private:
+    void GetBytes(void *value, size_t size)
+    {
+      if (!m_ok || size > (size_t)(m_end - m_pos))
+      {
+        m_ok = false;
+        return;
+      }
+      memcpy(value, m_pos, size);
+      m_pos += size;
+    }
+
+    const char *m_pos;
+    const char *m_end;
+    bool        m_ok;
+  };
+
+  class CTreeWriter
+  {
+  public:
+    void WriteElement(const TiXmlElement *element)
+    {
+      m_nodes += NODE_ELEMENT;
+      PutInt(m_nodes, GetString(element->ValueStr()));
+
+      uint32_t attributes = 0;
+      for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+        attributes++;
+      PutInt(m_nodes, attributes);
+      for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+      {
+        PutInt(m_nodes, GetString(attribute->NameTStr()));
+        PutInt(m_nodes, GetString(attribute->ValueStr()));
+      }
+
+      // comments and the like are of no use to anyone
+      uint32_t children = 0;
+      for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+      {
+        if (child->ToElement() || child->ToText())
+          children++;
+      }
+      PutInt(m_nodes, children);
+      for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+      {
+        if (child->ToElement())
+          WriteElement(child->ToElement());
+        else if (child->ToText())
+        {
+          m_nodes += NODE_TEXT;
+          PutInt(m_nodes, GetString(child->ValueStr()));
+        }
+      }
+    }
+
+    void GetTree(string &tree) const
+    {
+      tree.clear();
+      PutInt(tree, m_strings.size());
+      for (vector<string>::const_iterator it = m_strings.begin(); it != m_strings.end(); ++it)
+        PutString(tree, *it);
+      tree.append(m_nodes);
+    }
+
+  private:
+    uint32_t GetString(const string &value)
+    {
+      map<string, uint32_t>::const_iterator it = m_stringIndex.find(value);
+      if (it != m_stringIndex.end())
+        return it->second;
+      uint32_t index = m_strings.size();
+      m_strings.push_back(value);
+      m_stringIndex.insert(make_pair(value, index));
+      return index;
+    }
+
+    map<string, uint32_t> m_stringIndex;
+    vector<string>        m_strings;
+    string                m_nodes;
+  };
+
+  bool ReadNode(CReader &reader, const vector<string> &strings, TiXmlNode *parent, unsigned int depth)
+  {
+    char type = reader.GetChar();
+    uint32_t value = reader.GetInt();
+    if (!reader.IsOK() || value >= strings.size() || depth > MAX_DEPTH)
+      return false;
+
+    if (type == NODE_TEXT)
+    {
+      parent->LinkEndChild(new TiXmlText(strings[value]));
+      return true;
+    }
+    if (type != NODE_ELEMENT)
+      return false;
+
+    TiXmlElement *element = new TiXmlElement(strings[value]);
+    parent->LinkEndChild(element);
+
+    uint32_t attributes = reader.GetInt();
+    for (uint32_t i = 0; i < attributes && reader.IsOK(); i++)
+    {
+      uint32_t name = reader.GetInt();
+      uint32_t attribute = reader.GetInt();
+      if (name >= strings.size() || attribute >= strings.size())
+        return false;
+      element->SetAttribute(strings[name], strings[attribute]);
+    }
+
+    uint32_t children = reader.GetInt();
+    for (uint32_t i = 0; i < children && reader.IsOK(); i++)
+    {
+      if (!ReadNode(reader, strings, element, depth + 1))
+        return false;
+    }
+    return reader.IsOK();
+  }
+}
+
+CGUIWindowCache::CGUIWindowCache()
+{
+  m_memory = 0;
+}
+
+CGUIWindowCache::~CGUIWindowCache()
+{
+}
+
+bool CGUIWindowCache::Get(const CStdString &path, CXBMCTinyXML &xmlDoc, vector<CStdString> &includeFiles)
+{
+  CSingleLock lock(m_critSection);
+
+  WindowMap::iterator it = m_windows.find(path);
+  if (it == m_windows.end())
+  {
+    CompiledWindow window;
+    if (!Read(path, window))
+      return false;
+    Store(path, window);
+    it = m_windows.find(path);
+  }
+
+  if (!IsValid(it->second) || !Decompile(it->second.tree, xmlDoc))
+  {
+    CLog::Log(LOGDEBUG, "%s - compiled window for %s is outdated", __FUNCTION__, path.c_str());
+    m_memory -= it->second.tree.size();
+    m_windows.erase(it);
+    m_lru.remove(path);
+    return false;
+  }
+
+  // the first dependency is the window file itself
+  includeFiles.clear();
+  const vector<Dependency> &dependencies = it->second.dependencies;
+  for (size_t i = 1; i < dependencies.size(); i++)
+    includeFiles.push_back(dependencies[i].path);
+
+  Touch(path);
+  return true;
+}
+
+void CGUIWindowCache::Add(const CStdString &path, const CStdString &loadedPath, const TiXmlElement *root,
+                          const Conditions &conditions, const vector<CStdString> &includeFiles)
+{
+  CompiledWindow window;
+  Dependency dependency;
+
+  if (!GetFileInfo(loadedPath, dependency))
+    return;
+  window.dependencies.push_back(dependency);
+
+  for (vector<CStdString>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+  {
+    if (!GetFileInfo(*it, dependency))
+      return;
+    window.dependencies.push_back(dependency);
+  }
+
+  window.conditions = conditions;
+  Compile(root, window.tree);
+
+  CSingleLock lock(m_critSection);
+  Store(path, window);
+  Write(path, window);
+}
+
+void CGUIWindowCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+  m_windows.clear();
+  m_lru.clear();
+  m_memory = 0;
+}
+
+bool CGUIWindowCache::IsValid(const CompiledWindow &window) const
+{
+  for (vector<Dependency>::const_iterator it = window.dependencies.begin(); it != window.dependencies.end(); ++it)
+  {
+    Dependency current;
+    if (!GetFileInfo(it->path, current) || current.mtime != it->mtime || current.size != it->size)
+      return false;
+  }
+
+  // skin settings and the like may pick other includes now
+  for (Conditions::const_iterator it = window.conditions.begin(); it != window.conditions.end(); ++it)
+  {
+    if (g_infoManager.EvaluateBool(it->first) != it->second)
+      return false;
+  }
+  return true;
+}
+
+void CGUIWindowCache::Touch(const CStdString &path)
+{
+  m_lru.remove(path);
+  m_lru.push_back(path);
+}
+
+void CGUIWindowCache::Store(const CStdString &path, const CompiledWindow &window)
+{
+  WindowMap::iterator it = m_windows.find(path);
+  if (it != m_windows.end())
+  {
+    m_memory -= it->second.tree.size();
+    it->second = window;
+  }
+  else
+    m_windows.insert(make_pair(path, window));
+  m_memory += window.tree.size();
+  Touch(path);
+
+  // drop the least recently used, they are still on disk
+  while (m_memory > MAX_MEMORY && m_lru.size() > 1)
+  {
+    it = m_windows.find(m_lru.front());
+    if (it != m_windows.end())
+    {
+      m_memory -= it->second.tree.size();
+      m_windows.erase(it);
+    }
+    m_lru.pop_front();
+  }
+}
+
+CStdString CGUIWindowCache::GetCacheFile(const CStdString &path)
+{
+  Crc32 crc;
+  crc.Compute(path);
+  CStdString file;
+  file.Format("%s%08x.bin", CACHE_PATH, (unsigned int)crc);
+  return file;
+}
+
+bool CGUIWindowCache::Read(const CStdString &path, CompiledWindow &window) const
+{
+  CFile file;
+  if (!file.Open(GetCacheFile(path)))
+    return false;
+
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > 64 * 1024 * 1024)
+    return false;
+
+  string data((size_t)length, '\0');
+  if (file.Read(&data[0], length) != length)
+    return false;
+  file.Close();
+
+  CReader reader(data.c_str(), data.size());
+  if (reader.GetInt() != CACHE_MAGIC || reader.GetInt() != CACHE_VERSION)
+    return false;
+
+  // another window with the same crc
+  if (reader.GetString() != path)
+    return false;
+
+  uint32_t dependencies = reader.GetInt();
+  for (uint32_t i = 0; i < dependencies && reader.IsOK(); i++)
+  {
+    Dependency dependency;
+    dependency.path  = reader.GetString();
+    dependency.mtime = reader.GetInt64();
+    dependency.size  = reader.GetInt64();
+    window.dependencies.push_back(dependency);
+  }
+
+  uint32_t conditions = reader.GetInt();
+  for (uint32_t i = 0; i < conditions && reader.IsOK(); i++)
+  {
+    CStdString condition = reader.GetString();
+    window.conditions[condition] = reader.GetChar() != 0;
+  }
+
+  window.tree = reader.GetString();
+  return reader.IsOK();
+}
+
+void CGUIWindowCache::Write(const CStdString &path, const CompiledWindow &window) const
+{
+  string data;
+  PutInt(data, CACHE_MAGIC);
+  PutInt(data, CACHE_VERSION);
+  PutString(data, path);
+
+  PutInt(data, window.dependencies.size());
+  for (vector<Dependency>::const_iterator it = window.dependencies.begin(); it != window.dependencies.end(); ++it)
+  {
+    PutString(data, it->path);
+    PutInt64(data, it->mtime);
+    PutInt64(data, it->size);
+  }
+
+  PutInt(data, window.conditions.size());
+  for (Conditions::const_iterator it = window.conditions.begin(); it != window.conditions.end(); ++it)
+  {
+    PutString(data, it->first);
+    data += it->second ? (char)1 : (char)0;
+  }
+
+  PutString(data, window.tree);
+
+  if (!CDirectory::Exists(CACHE_PATH))
+    CDirectory::Create(CACHE_PATH);
+
+  CFile file;
+  if (!file.OpenForWrite(GetCacheFile(path), true) || file.Write(data.c_str(), data.size()) != (int)data.size())
+    CLog::Log(LOGWARNING, "%s - unable to write the compiled window for %s", __FUNCTION__, path.c_str());
+}
+
+bool CGUIWindowCache::GetFileInfo(const CStdString &path, Dependency &dependency)
+{
+  struct __stat64 info;
+  if (CFile::Stat(path, &info) != 0)
+    return false;
+
+  dependency.path  = path;
+  dependency.mtime = info.st_mtime;
+  dependency.size  = info.st_size;
+  return true;
+}
+
+void CGUIWindowCache::Compile(const TiXmlElement *root, string &tree)
+{
+  CTreeWriter writer;
+  writer.WriteElement(root);
+  writer.GetTree(tree);
+}
+
+bool CGUIWindowCache::Decompile(const string &tree, CXBMCTinyXML &xmlDoc)
+{
+  CReader reader(tree.c_str(), tree.size());
+
+  uint32_t count = reader.GetInt();
+  if (!reader.IsOK() || count > tree.size())
+    return false;
+
+  vector<string> strings;
+  strings.reserve(count);
+  for (uint32_t i = 0; i < count && reader.IsOK(); i++)
+    strings.push_back(reader.GetString());
+
+  xmlDoc.Clear();
+  if (!ReadNode(reader, strings, &xmlDoc, 0))
+  {
+    xmlDoc.Clear();
+    return false;
+  }
+  return true;
+}
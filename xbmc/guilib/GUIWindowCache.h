@@ -0,0 +1,115 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+class TiXmlElement;
+class CXBMCTinyXML;
+
+/*!
+ \ingroup windows
+ \brief Cache of compiled skin windows.
+
+ A compiled window is the window XML with all includes, defaults and constants
+ resolved, stored as a compact binary tree with a string table. Loading a window
+ from it skips reading and parsing the XML text and resolving the includes.
+
+ A compiled window is valid as long as the window file and the include files have
+ the same modification time and size as when it was compiled, and the conditions
+ of the conditional includes evaluate the same. Compiled windows are kept in memory
+ and in special://temp/skincache so they survive a restart.
+ */
+class CGUIWindowCache
+{
+public:
+  /*! \brief conditions of conditional includes and what they evaluated to
+   */
+  typedef std::map<CStdString, bool> Conditions;
+
+  CGUIWindowCache();
+  ~CGUIWindowCache();
+
+  /*! \brief Load the compiled window for a window file
+   \param path the path of the window file
+   \param xmlDoc [out] the document to fill with the resolved window
+   \param includeFiles [out] the include files that were loaded when the window was compiled
+   \return true if a valid compiled window was found, false otherwise
+   */
+  bool Get(const CStdString &path, CXBMCTinyXML &xmlDoc, std::vector<CStdString> &includeFiles);
+
+  /*! \brief Store a window after its includes were resolved
+   \param path the path of the window file, as passed to Get()
+   \param loadedPath the path the window file was actually loaded from
+   \param root the window element with its includes resolved
+   \param conditions the conditional includes evaluated during the resolve
+   \param includeFiles the include files of the skin
+   */
+  void Add(const CStdString &path, const CStdString &loadedPath, const TiXmlElement *root,
+           const Conditions &conditions, const std::vector<CStdString> &includeFiles);
+
+  /*! \brief Drop the windows in memory, eg. when the skin is reloaded
+   */
+  void Clear();
+
+private:
+  struct Dependency
+  {
+    CStdString path;
+    int64_t    mtime;
+    int64_t    size;
+  };
+
+  struct CompiledWindow
+  {
+    std::vector<Dependency> dependencies;
+    Conditions              conditions;
+    std::string             tree;  ///< string table and nodes
+  };
+
+  typedef std::map<CStdString, CompiledWindow> WindowMap;
+
+  bool IsValid(const CompiledWindow &window) const;
+  void Touch(const CStdString &path);
+  void Store(const CStdString &path, const CompiledWindow &window);
+
+  bool Read(const CStdString &path, CompiledWindow &window) const;
+  void Write(const CStdString &path, const CompiledWindow &window) const;
+  static CStdString GetCacheFile(const CStdString &path);
+
+  static bool GetFileInfo(const CStdString &path, Dependency &dependency);
+  static void Compile(const TiXmlElement *root, std::string &tree);
+  static bool Decompile(const std::string &tree, CXBMCTinyXML &xmlDoc);
+
+  CCriticalSection      m_critSection;
+  WindowMap             m_windows;
+  std::list<CStdString> m_lru;    ///< most recently used last
+  size_t                m_memory; ///< bytes of compiled trees in m_windows
+};
+
+extern CGUIWindowCache g_windowCache;
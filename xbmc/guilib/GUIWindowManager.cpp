@@ -22,10 +22,12 @@
 #include "GUIWindowManager.h"
 #include "GUIAudioManager.h"
 #include "GUIDialog.h"
+#include "RenderScheduler.h"
 #include "Application.h"
 #include "GUIPassword.h"
 #include "GUIInfoManager.h"
 #include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
 #include "utils/URIUtils.h"
 #include "settings/GUISettings.h"
 #include "settings/Settings.h"
@@ -518,6 +520,7 @@ void CGUIWindowManager::Process(unsigned int currentTime)
 void CGUIWindowManager::MarkDirty()
 {
   m_tracker.MarkDirtyRegion(CRect(0, 0, (float)g_graphicsContext.GetWidth(), (float)g_graphicsContext.GetHeight()));
+  g_renderScheduler.Wake();
 }
 
 void CGUIWindowManager::RenderPass()
@@ -540,6 +543,14 @@ void CGUIWindowManager::RenderPass()
   }
 }
 
+void CGUIWindowManager::RenderPass(const CDirtyRegion &pass)
+{
+  // as CGUIControlProfiler, this is the time spent to submit the pass, not GPU time
+  int64_t start = CurrentHostCounter();
+  RenderPass();
+  m_tracker.PassRendered(pass, 1000.0f * (CurrentHostCounter() - start) / CurrentHostFrequency());
+}
+
 bool CGUIWindowManager::Render()
 {
   assert(g_application.IsCurrentThread());
@@ -551,14 +562,14 @@ bool CGUIWindowManager::Render()
   // If we visualize the regions we will always render the entire viewport
   if (g_advancedSettings.m_guiVisualizeDirtyRegions || g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_FILL_VIEWPORT_ALWAYS)
   {
-    RenderPass();
+    RenderPass(g_graphicsContext.GetViewWindow());
     hasRendered = true;
   }
   else if (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE)
   {
     if (dirtyRegions.size() > 0)
     {
-      RenderPass();
+      RenderPass(g_graphicsContext.GetViewWindow());
       hasRendered = true;
     }
   }
@@ -570,7 +581,7 @@ bool CGUIWindowManager::Render()
         continue;
 
       g_graphicsContext.SetScissors(*i);
-      RenderPass();
+      RenderPass(*i);
       hasRendered = true;
     }
     g_graphicsContext.ResetScissors();
@@ -586,6 +597,7 @@ bool CGUIWindowManager::Render()
       CGUITexture::DrawQuad(*i, 0x4c00ff00);
   }
 
+  m_tracker.FrameDone();
   m_tracker.CleanMarkedRegions();
 
   return hasRendered;
@@ -752,6 +764,7 @@ void CGUIWindowManager::SendThreadMessage(CGUIMessage& message)
 
   CGUIMessage* msg = new CGUIMessage(message);
   m_vecThreadMessages.push_back( pair<CGUIMessage*,int>(msg,0) );
+  g_renderScheduler.Wake();
 }
 
 void CGUIWindowManager::SendThreadMessage(CGUIMessage& message, int window)
@@ -760,6 +773,7 @@ void CGUIWindowManager::SendThreadMessage(CGUIMessage& message, int window)
 
   CGUIMessage* msg = new CGUIMessage(message);
   m_vecThreadMessages.push_back( pair<CGUIMessage*,int>(msg,window) );
+  g_renderScheduler.Wake();
 }
 
 void CGUIWindowManager::DispatchThreadMessages()
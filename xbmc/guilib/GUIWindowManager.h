@@ -79,6 +79,7 @@ public:
   /*! \brief Get the current dirty region
    */
   CDirtyRegionList GetDirty() { return m_tracker.GetDirtyRegions(); }
+  const CDirtyRegionStats &GetDirtyRegionStats() const { return m_tracker.GetStats(); }
 
   /*! \brief Rendering of the current window and any dialogs
    Render is called every frame to draw the current window and any dialogs.
@@ -132,6 +133,7 @@ public:
 #endif
 private:
   void RenderPass();
+  void RenderPass(const CDirtyRegion &pass); ///< render and report the time it took to the tracker
 
   void LoadNotOnDemandWindows();
   void UnloadNotOnDemandWindows();
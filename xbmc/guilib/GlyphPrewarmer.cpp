@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "GlyphPrewarmer.h"
+#include "threads/SingleLock.h"
+
+using namespace std;
+
+bool CGlyphPrewarmer::Queue(const vector<uint32_t> &glyphs)
+{
+  CSingleLock lock(m_critSection);
+  for (vector<uint32_t>::const_iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+  {
+    if (m_requested.insert(*it).second)
+      m_queue.push_back(*it);
+  }
+  if (m_running || m_queue.empty())
+    return false;
+  m_running = true;
+  return true;
+}
+
+void CGlyphPrewarmer::Cancel()
+{
+  CSingleLock lock(m_critSection);
+  m_queue.clear();
+  m_ready.clear();
+  m_requested.clear();
+}
+
+bool CGlyphPrewarmer::Take(uint32_t letterAndStyle, Glyph &glyph)
+{
+  CSingleLock lock(m_critSection);
+  map<uint32_t, Glyph>::iterator it = m_ready.find(letterAndStyle);
+  if (it == m_ready.end())
+    return false;
+  glyph.pixels.swap(it->second.pixels);
+  glyph.left    = it->second.left;
+  glyph.top     = it->second.top;
+  glyph.width   = it->second.width;
+  glyph.rows    = it->second.rows;
+  glyph.advance = it->second.advance;
+  m_ready.erase(it);
+  m_requested.erase(letterAndStyle);
+  return true;
+}
+
+void CGlyphPrewarmer::GetReady(vector<uint32_t> &glyphs)
+{
+  CSingleLock lock(m_critSection);
+  for (map<uint32_t, Glyph>::const_iterator it = m_ready.begin(); it != m_ready.end(); ++it)
+    glyphs.push_back(it->first);
+}
+
+void CGlyphPrewarmer::Run()
+{
+  while (true)
+  {
+    uint32_t letterAndStyle;
+    {
+      CSingleLock lock(m_critSection);
+      if (m_queue.empty())
+      {
+        m_running = false;
+        return;
+      }
+      letterAndStyle = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    // failures stay requested, the render thread tries again when it needs the glyph
+    Glyph glyph;
+    if (Rasterize(letterAndStyle, glyph))
+    {
+      // dropped if it was cancelled meanwhile
+      CSingleLock lock(m_critSection);
+      if (m_requested.find(letterAndStyle) != m_requested.end())
+        m_ready[letterAndStyle] = glyph;
+    }
+  }
+}
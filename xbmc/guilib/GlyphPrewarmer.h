@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+/*!
+ \ingroup textures
+ \brief Rasterizes glyphs of a font on a job worker before they are drawn.
+
+ The render thread queues the glyphs it is about to need, a job rasterizes them
+ with Run() and the render thread takes the bitmaps to copy them into the font's
+ texture. The prewarmer is shared by the font and its running job, so it outlives
+ a font freed during a job. How a glyph is rasterized is up to the derived class.
+ */
+class CGlyphPrewarmer
+{
+public:
+  struct Glyph
+  {
+    int left;
+    int top;
+    unsigned int width;
+    unsigned int rows;
+    float advance;
+    std::vector<unsigned char> pixels; ///< width x rows
+  };
+
+  CGlyphPrewarmer() : m_running(false) {}
+  virtual ~CGlyphPrewarmer() {}
+
+  /*! \brief Queue glyphs (style << 16 | letter) to rasterize
+   \return true if a job has to be started to rasterize them
+   */
+  bool Queue(const std::vector<uint32_t> &glyphs);
+
+  /*! \brief Drop the queued and rasterized glyphs, the font is going away or its cache is cleared.
+   A glyph that is being rasterized meanwhile is dropped when it is done.
+   */
+  void Cancel();
+
+  /*! \brief Take a rasterized glyph
+   \return true if the glyph was rasterized, false if it isn't or not yet
+   */
+  bool Take(uint32_t letterAndStyle, Glyph &glyph);
+
+  /*! \brief Get the glyphs that are rasterized and can be taken */
+  void GetReady(std::vector<uint32_t> &glyphs);
+
+  /*! \brief Rasterize the queued glyphs, runs on a job worker */
+  void Run();
+
+protected:
+  /*! \brief Rasterize a glyph, called by Run() without any lock of the prewarmer held */
+  virtual bool Rasterize(uint32_t letterAndStyle, Glyph &glyph) = 0;
+
+private:
+  CCriticalSection              m_critSection;
+  std::deque<uint32_t>          m_queue;
+  std::set<uint32_t>            m_requested; ///< queued or ready
+  std::map<uint32_t, Glyph>     m_ready;
+  bool                          m_running;
+};
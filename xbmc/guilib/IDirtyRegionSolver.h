@@ -26,6 +26,7 @@
 #define DIRTYREGION_SOLVER_UNION 1
 #define DIRTYREGION_SOLVER_COST_REDUCTION 2
 #define DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE 3
+#define DIRTYREGION_SOLVER_ADAPTIVE 4
 
 class IDirtyRegionSolver
 {
@@ -34,4 +35,7 @@ public:
 
   // Takes a number of dirty regions which will become a number of needed rendering passes.
   virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output) = 0;
+
+  // Called for each rendered pass of the last solution with the time it took to render in milliseconds.
+  virtual void PassRendered(const CDirtyRegion &pass, float time) { }
 };
@@ -27,7 +27,326 @@
 #include "utils/XMLUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/POUtils.h"
+#include "utils/Crc32.h"
 #include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define STRINGS_CACHE_PATH     "special://temp/stringcache/"
+#define STRINGS_CACHE_MAGIC    0x54534258 // "XBST"
+#define STRINGS_CACHE_VERSION  1
+
+namespace
+{
+  void PutInt(std::string &out, uint32_t value)
+  {
+    out.append((const char *)&value, sizeof(value));
+  }
+
+  void PutInt64(std::string &out, int64_t value)
+  {
+    out.append((const char *)&value, sizeof(value));
+  }
+
+  void PutString(std::string &out, const std::string &value)
+  {
+    PutInt(out, value.size());
+    out.append(value);
+    // keep the ids and offsets that follow aligned
+    out.append((4 - value.size() % 4) % 4, '\0');
+  }
+
+  class CReader
+  {
+  public:
+    CReader(const uint8_t *data, size_t size) : m_pos(data), m_end(data + size), m_ok(true) {}
+
+    uint32_t GetInt()
+    {
+      uint32_t value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    int64_t GetInt64()
+    {
+      int64_t value = 0;
+      GetBytes(&value, sizeof(value));
+      return value;
+    }
+
+    std::string GetString()
+    {
+      uint32_t size = GetInt();
+      const uint8_t *value = Skip(size);
+      Skip((4 - size % 4) % 4);
+      return m_ok ? std::string((const char *)value, size) : "";
+    }
+
+    /* returns where the skipped bytes are */
+    const uint8_t *Skip(size_t size)
+    {
+      if (!m_ok || size > (size_t)(m_end - m_pos))
+      {
+        m_ok = false;
+        return NULL;
+      }
+      const uint8_t *data = m_pos;
+      m_pos += size;
+      return data;
+    }
+
+    bool IsOK() const { return m_ok; }
+
+  private:
+    void GetBytes(void *value, size_t size)
+    {
+      const uint8_t *data = Skip(size);
+      if (data)
+        memcpy(value, data, size);
+    }
+
+    const uint8_t *m_pos;
+    const uint8_t *m_end;
+    bool           m_ok;
+  };
+}
+
+CStringTable::CStringTable()
+{
+  m_data    = NULL;
+  m_size    = 0;
+#ifdef _WIN32
+  m_mapping = NULL;
+#endif
+  m_ids     = NULL;
+  m_offsets = NULL;
+  m_blob    = NULL;
+  m_count   = 0;
+}
+
+CStringTable::~CStringTable()
+{
+  Close();
+}
+
+bool CStringTable::Map(const CStdString &file)
+{
+  CStdString path = CSpecialProtocol::TranslatePath(file);
+#ifdef _WIN32
+  CStdStringW pathW;
+  g_charsetConverter.utf8ToW(path, pathW, false);
+  HANDLE handle = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (handle == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0 || size.HighPart != 0)
+  {
+    CloseHandle(handle);
+    return false;
+  }
+
+  m_mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(handle);
+  if (!m_mapping)
+    return false;
+
+  m_data = (const uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!m_data)
+  {
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+    return false;
+  }
+  m_size = size.LowPart;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data = (const uint8_t *)data;
+  m_size = st.st_size;
+#endif
+  return true;
+}
+
+void CStringTable::Close()
+{
+  if (m_data)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+#else
+    munmap((void *)m_data, m_size);
+#endif
+  }
+  m_data    = NULL;
+  m_size    = 0;
+  m_ids     = NULL;
+  m_offsets = NULL;
+  m_blob    = NULL;
+  m_count   = 0;
+  CSingleLock lock(m_critSection);
+  m_strings.clear();
+}
+
+bool CStringTable::Open(const CStdString &file, const CStdString &key, const std::vector<Dependency> &dependencies)
+{
+  Close();
+  if (!Map(file))
+    return false;
+
+  CReader reader(m_data, m_size);
+  bool valid = reader.GetInt() == STRINGS_CACHE_MAGIC && reader.GetInt() == STRINGS_CACHE_VERSION &&
+               reader.GetString() == key && reader.GetInt() == dependencies.size();
+  for (unsigned int i = 0; valid && i < dependencies.size(); i++)
+  {
+    valid = reader.GetString() == dependencies[i].path &&
+            reader.GetInt64() == dependencies[i].mtime &&
+            reader.GetInt64() == dependencies[i].size;
+  }
+
+  uint32_t count = reader.GetInt();
+  uint32_t blobSize = reader.GetInt();
+  valid = valid && count < m_size / sizeof(uint32_t);
+  const uint32_t *ids     = valid ? (const uint32_t *)reader.Skip(count * sizeof(uint32_t)) : NULL;
+  const uint32_t *offsets = valid ? (const uint32_t *)reader.Skip((count + 1) * sizeof(uint32_t)) : NULL;
+  const char     *blob    = valid ? (const char *)reader.Skip(blobSize) : NULL;
+  if (!valid || !reader.IsOK())
+  {
+    Close();
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (offsets[i] > offsets[i + 1] || offsets[i + 1] > blobSize || (i > 0 && ids[i - 1] >= ids[i]))
+    {
+      CLog::Log(LOGWARNING, "%s - %s is corrupt", __FUNCTION__, file.c_str());
+      Close();
+      return false;
+    }
+  }
+
+  m_ids     = ids;
+  m_offsets = offsets;
+  m_blob    = blob;
+  m_count   = count;
+  return true;
+}
+
+const CStdString *CStringTable::Find(uint32_t id) const
+{
+  const uint32_t *end = m_ids + m_count;
+  const uint32_t *it  = std::lower_bound(m_ids, end, id);
+  if (it == end || *it != id)
+    return NULL;
+
+  // the strings are handed out by reference, each is made once when it is first used
+  uint32_t index = it - m_ids;
+  CSingleLock lock(m_critSection);
+  std::map<uint32_t, CStdString>::iterator str = m_strings.find(index);
+  if (str == m_strings.end())
+  {
+    str = m_strings.insert(std::make_pair(index, CStdString())).first;
+    str->second.assign(m_blob + m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+  }
+  return &str->second;
+}
+
+bool CStringTable::Write(const CStdString &file, const CStdString &key, const std::vector<Dependency> &dependencies,
+                         const std::map<uint32_t, LocStr> &strings)
+{
+  std::string data;
+  PutInt(data, STRINGS_CACHE_MAGIC);
+  PutInt(data, STRINGS_CACHE_VERSION);
+  PutString(data, key);
+  PutInt(data, dependencies.size());
+  for (std::vector<Dependency>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it)
+  {
+    PutString(data, it->path);
+    PutInt64(data, it->mtime);
+    PutInt64(data, it->size);
+  }
+
+  // the map is sorted by id already
+  std::string ids, offsets, blob;
+  for (std::map<uint32_t, LocStr>::const_iterator it = strings.begin(); it != strings.end(); ++it)
+  {
+    PutInt(ids, it->first);
+    PutInt(offsets, blob.size());
+    blob.append(it->second.strTranslated);
+  }
+  PutInt(offsets, blob.size());
+
+  PutInt(data, strings.size());
+  PutInt(data, blob.size());
+  data += ids;
+  data += offsets;
+  data += blob;
+
+  if (!XFILE::CDirectory::Exists(STRINGS_CACHE_PATH))
+    XFILE::CDirectory::Create(STRINGS_CACHE_PATH);
+
+  // the file may be mapped by another instance, replace it rather than writing into it
+  CStdString temp = file + ".tmp";
+  XFILE::CFile out;
+  if (!out.OpenForWrite(temp, true) || out.Write(data.c_str(), data.size()) != (int)data.size())
+  {
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, temp.c_str());
+    out.Close();
+    XFILE::CFile::Delete(temp);
+    return false;
+  }
+  out.Close();
+
+  if (!XFILE::CFile::Rename(temp, file))
+  {
+    XFILE::CFile::Delete(temp);
+    return false;
+  }
+  return true;
+}
+
+void CStringTable::GetDependency(const CStdString &path, Dependency &dependency)
+{
+  struct __stat64 info;
+  dependency.path = path;
+  if (XFILE::CFile::Stat(path, &info) == 0)
+  {
+    dependency.mtime = info.st_mtime;
+    dependency.size  = info.st_size;
+  }
+  else
+  {
+    dependency.mtime = 0;
+    dependency.size  = -1;
+  }
+}
 
 CLocalizeStrings::CLocalizeStrings(void)
 {
@@ -52,6 +371,8 @@ CStdString CLocalizeStrings::ToUTF8(const CStdString& strEncoding, const CStdStr
 void CLocalizeStrings::ClearSkinStrings()
 {
   // clear the skin strings
+  CSingleLock lock(m_critSection);
+  m_skinTable.reset();
   Clear(31000, 31999);
 }
 
@@ -59,22 +380,69 @@ bool CLocalizeStrings::LoadSkinStrings(const CStdString& path, const CStdString&
 {
   ClearSkinStrings();
   // load the skin strings in.
-  CStdString encoding;
-  if (!LoadStr2Mem(path, language, encoding))
+  StringTablePtr table;
+  bool loaded = LoadTable(table, path, language, std::map<uint32_t, LocStr>());
+  {
+    CSingleLock lock(m_critSection);
+    m_skinTable = table;
+  }
+
+  if (!loaded)
   {
     if (language.Equals(SOURCE_LANGUAGE)) // no fallback, nothing to do
       return false;
   }
 
+  return true;
+}
+
+bool CLocalizeStrings::LoadTable(StringTablePtr &table, const CStdString &pathname, const CStdString &language,
+                                 const std::map<uint32_t, LocStr> &constants, uint32_t offset /* = 0 */)
+{
+  table.reset();
+
+  // map the compiled strings if the language files didn't change since they were compiled
+  std::vector<CStringTable::Dependency> dependencies;
+  GetDependencies(pathname, language, dependencies);
+  CStdString key = CSpecialProtocol::TranslatePath(pathname) + "|" + language;
+  CStdString cacheFile = GetCacheFile(key);
+  StringTablePtr mapped(new CStringTable);
+  if (mapped->Open(cacheFile, key, dependencies))
+  {
+    CLog::Log(LOGDEBUG, "LocalizeStrings: mapped the compiled %s strings of %s", language.c_str(), pathname.c_str());
+    table = mapped;
+    return true;
+  }
+
+  std::map<uint32_t, LocStr> strings;
+  CStdString encoding;
+  bool loaded = LoadStr2Mem(strings, pathname, language, encoding);
+
   // load the fallback
   if (!language.Equals(SOURCE_LANGUAGE))
-    LoadStr2Mem(path, SOURCE_LANGUAGE, encoding);
+    loaded |= LoadStr2Mem(strings, pathname, SOURCE_LANGUAGE, encoding);
 
+  if (!loaded)
+    return false;
+
+  for (ciStrings it = constants.begin(); it != constants.end(); ++it)
+    strings[it->first] = it->second;
+
+  // compile the strings so the next load of this language can map them
+  if (CStringTable::Write(cacheFile, key, dependencies, strings) && mapped->Open(cacheFile, key, dependencies))
+  {
+    table = mapped;
+    return true;
+  }
+
+  CSingleLock lock(m_critSection);
+  for (ciStrings it = strings.begin(); it != strings.end(); ++it)
+    m_strings[it->first + offset] = it->second;
   return true;
 }
 
-bool CLocalizeStrings::LoadStr2Mem(const CStdString &pathname_in, const CStdString &language,
-                                   CStdString &encoding, uint32_t offset /* = 0 */)
+bool CLocalizeStrings::LoadStr2Mem(std::map<uint32_t, LocStr> &strings, const CStdString &pathname_in,
+                                   const CStdString &language, CStdString &encoding)
 {
   CStdString pathname = CSpecialProtocol::TranslatePathConvertCase(pathname_in + language);
   if (!XFILE::CDirectory::Exists(pathname))
@@ -85,17 +453,17 @@ bool CLocalizeStrings::LoadStr2Mem(const CStdString &pathname_in, const CStdStri
     return false;
   }
 
-  if (LoadPO(URIUtils::AddFileToFolder(pathname, "strings.po"), encoding, offset,
+  if (LoadPO(strings, URIUtils::AddFileToFolder(pathname, "strings.po"), encoding,
       language.Equals(SOURCE_LANGUAGE)))
     return true;
 
   CLog::Log(LOGDEBUG, "LocalizeStrings: no strings.po file exist at %s, fallback to strings.xml",
             pathname.c_str());
-  return LoadXML(URIUtils::AddFileToFolder(pathname, "strings.xml"), encoding, offset);
+  return LoadXML(strings, URIUtils::AddFileToFolder(pathname, "strings.xml"), encoding);
 }
 
-bool CLocalizeStrings::LoadPO(const CStdString &filename, CStdString &encoding,
-                              uint32_t offset /* = 0 */, bool bSourceLanguage)
+bool CLocalizeStrings::LoadPO(std::map<uint32_t, LocStr> &strings, const CStdString &filename,
+                              CStdString &encoding, bool bSourceLanguage)
 {
   CPODocument PODoc;
   if (!PODoc.LoadFile(filename))
@@ -108,25 +476,25 @@ bool CLocalizeStrings::LoadPO(const CStdString &filename, CStdString &encoding,
     uint32_t id;
     if (PODoc.GetEntryType() == ID_FOUND)
     {
-      bool bStrInMem = m_strings.find((id = PODoc.GetEntryID()) + offset) != m_strings.end();
+      bool bStrInMem = strings.find(id = PODoc.GetEntryID()) != strings.end();
       PODoc.ParseEntry(bSourceLanguage);
 
       if (bSourceLanguage && !PODoc.GetMsgid().empty())
       {
-        if (bStrInMem && (m_strings[id + offset].strOriginal.IsEmpty() ||
-            PODoc.GetMsgid() == m_strings[id + offset].strOriginal))
+        if (bStrInMem && (strings[id].strOriginal.IsEmpty() ||
+            PODoc.GetMsgid() == strings[id].strOriginal))
           continue;
         else if (bStrInMem)
           CLog::Log(LOGDEBUG,
                     "POParser: id:%i was recently re-used in the English string file, which is not yet "
                     "changed in the translated file. Using the English string instead", id);
-        m_strings[id + offset].strTranslated = PODoc.GetMsgid();
+        strings[id].strTranslated = PODoc.GetMsgid();
         counter++;
       }
       else if (!bSourceLanguage && !bStrInMem && !PODoc.GetMsgstr().empty())
       {
-        m_strings[id + offset].strTranslated = PODoc.GetMsgstr();
-        m_strings[id + offset].strOriginal = PODoc.GetMsgid();
+        strings[id].strTranslated = PODoc.GetMsgstr();
+        strings[id].strOriginal = PODoc.GetMsgid();
         counter++;
       }
     }
@@ -149,7 +517,7 @@ bool CLocalizeStrings::LoadPO(const CStdString &filename, CStdString &encoding,
   return true;
 }
 
-bool CLocalizeStrings::LoadXML(const CStdString &filename, CStdString &encoding, uint32_t offset /* = 0 */)
+bool CLocalizeStrings::LoadXML(std::map<uint32_t, LocStr> &strings, const CStdString &filename, CStdString &encoding)
 {
   CXBMCTinyXML xmlDoc;
   if (!xmlDoc.LoadFile(filename))
@@ -175,69 +543,116 @@ bool CLocalizeStrings::LoadXML(const CStdString &filename, CStdString &encoding,
     const char* attrId=pChild->Attribute("id");
     if (attrId && !pChild->NoChildren())
     {
-      int id = atoi(attrId) + offset;
-      if (m_strings.find(id) == m_strings.end())
-        m_strings[id].strTranslated = ToUTF8(encoding, pChild->FirstChild()->Value());
+      int id = atoi(attrId);
+      if (strings.find(id) == strings.end())
+        strings[id].strTranslated = ToUTF8(encoding, pChild->FirstChild()->Value());
     }
     pChild = pChild->NextSiblingElement("string");
   }
   return true;
 }
 
-bool CLocalizeStrings::Load(const CStdString& strPathName, const CStdString& strLanguage)
+void CLocalizeStrings::GetDependencies(const CStdString &path, const CStdString &language,
+                                       std::vector<CStringTable::Dependency> &dependencies)
 {
-  bool bLoadFallback = !strLanguage.Equals(SOURCE_LANGUAGE);
-
-  CStdString encoding;
-  Clear();
-
-  if (!LoadStr2Mem(strPathName, strLanguage, encoding))
+  // what LoadStr2Mem() may load for the language and the fallback
+  const CStdString languages[] = { language, SOURCE_LANGUAGE };
+  for (unsigned int i = 0; i < (language.Equals(SOURCE_LANGUAGE) ? 1U : 2U); i++)
   {
-    // try loading the fallback
-    if (!bLoadFallback || !LoadStr2Mem(strPathName, SOURCE_LANGUAGE, encoding))
-      return false;
-
-    bLoadFallback = false;
+    CStdString pathname = CSpecialProtocol::TranslatePathConvertCase(path + languages[i]);
+    CStringTable::Dependency dependency;
+    CStringTable::GetDependency(URIUtils::AddFileToFolder(pathname, "strings.po"), dependency);
+    dependencies.push_back(dependency);
+    CStringTable::GetDependency(URIUtils::AddFileToFolder(pathname, "strings.xml"), dependency);
+    dependencies.push_back(dependency);
   }
+}
 
-  if (bLoadFallback)
-    LoadStr2Mem(strPathName, SOURCE_LANGUAGE, encoding);
+CStdString CLocalizeStrings::GetCacheFile(const CStdString &key)
+{
+  Crc32 crc;
+  crc.Compute(key);
+  CStdString file;
+  file.Format("%s%08x.bin", STRINGS_CACHE_PATH, (unsigned int)crc);
+  return file;
+}
 
+bool CLocalizeStrings::Load(const CStdString& strPathName, const CStdString& strLanguage)
+{
+  Clear();
+
+  std::map<uint32_t, LocStr> constants;
   CStdString encoding_thisfile = "ISO-8859-1";
   // we have ANSI encoding for LocalizeStrings.cpp therefore we need to use this encoding
   // when we add the degree strings
 
   // fill in the constant strings
-  m_strings[20022].strTranslated = "";
-  m_strings[20027].strTranslated = ToUTF8(encoding_thisfile, "F");
-  m_strings[20028].strTranslated = ToUTF8(encoding_thisfile, "K");
-  m_strings[20029].strTranslated = ToUTF8(encoding_thisfile, "C");
-  m_strings[20030].strTranslated = ToUTF8(encoding_thisfile, "R");
-  m_strings[20031].strTranslated = ToUTF8(encoding_thisfile, "Ra");
-  m_strings[20032].strTranslated = ToUTF8(encoding_thisfile, "R");
-  m_strings[20033].strTranslated = ToUTF8(encoding_thisfile, "De");
-  m_strings[20034].strTranslated = ToUTF8(encoding_thisfile, "N");
-
-  m_strings[20200].strTranslated = ToUTF8(encoding_thisfile, "km/h");
-  m_strings[20201].strTranslated = ToUTF8(encoding_thisfile, "m/min");
-  m_strings[20202].strTranslated = ToUTF8(encoding_thisfile, "m/s");
-  m_strings[20203].strTranslated = ToUTF8(encoding_thisfile, "ft/h");
-  m_strings[20204].strTranslated = ToUTF8(encoding_thisfile, "ft/min");
-  m_strings[20205].strTranslated = ToUTF8(encoding_thisfile, "ft/s");
-  m_strings[20206].strTranslated = ToUTF8(encoding_thisfile, "mph");
-  m_strings[20207].strTranslated = ToUTF8(encoding_thisfile, "kts");
-  m_strings[20208].strTranslated = ToUTF8(encoding_thisfile, "Beaufort");
-  m_strings[20209].strTranslated = ToUTF8(encoding_thisfile, "inch/s");
-  m_strings[20210].strTranslated = ToUTF8(encoding_thisfile, "yard/s");
-  m_strings[20211].strTranslated = ToUTF8(encoding_thisfile, "Furlong/Fortnight");
-
-  return true;
+  constants[20022].strTranslated = "";
+  constants[20027].strTranslated = ToUTF8(encoding_thisfile, "F");
+  constants[20028].strTranslated = ToUTF8(encoding_thisfile, "K");
+  constants[20029].strTranslated = ToUTF8(encoding_thisfile, "C");
+  constants[20030].strTranslated = ToUTF8(encoding_thisfile, "R");
+  constants[20031].strTranslated = ToUTF8(encoding_thisfile, "Ra");
+  constants[20032].strTranslated = ToUTF8(encoding_thisfile, "R");
+  constants[20033].strTranslated = ToUTF8(encoding_thisfile, "De");
+  constants[20034].strTranslated = ToUTF8(encoding_thisfile, "N");
+
+  constants[20200].strTranslated = ToUTF8(encoding_thisfile, "km/h");
+  constants[20201].strTranslated = ToUTF8(encoding_thisfile, "m/min");
+  constants[20202].strTranslated = ToUTF8(encoding_thisfile, "m/s");
+  constants[20203].strTranslated = ToUTF8(encoding_thisfile, "ft/h");
+  constants[20204].strTranslated = ToUTF8(encoding_thisfile, "ft/min");
+  constants[20205].strTranslated = ToUTF8(encoding_thisfile, "ft/s");
+  constants[20206].strTranslated = ToUTF8(encoding_thisfile, "mph");
+  constants[20207].strTranslated = ToUTF8(encoding_thisfile, "kts");
+  constants[20208].strTranslated = ToUTF8(encoding_thisfile, "Beaufort");
+  constants[20209].strTranslated = ToUTF8(encoding_thisfile, "inch/s");
+  constants[20210].strTranslated = ToUTF8(encoding_thisfile, "yard/s");
+  constants[20211].strTranslated = ToUTF8(encoding_thisfile, "Furlong/Fortnight");
+
+  StringTablePtr table;
+  bool loaded = LoadTable(table, strPathName, strLanguage, constants);
+
+  CSingleLock lock(m_critSection);
+  m_table = table;
+  return loaded;
 }
 
 static CStdString szEmptyString = "";
 
 const CStdString& CLocalizeStrings::Get(uint32_t dwCode) const
 {
+  // the tables are looked up in references of our own, they may be replaced meanwhile
+  StringTablePtr table, skinTable;
+  uint32_t id = dwCode;
+  {
+    CSingleLock lock(m_critSection);
+    if (dwCode >= block_start)
+    {
+      ciBlockTables it = m_blockTables.find(dwCode - (dwCode - block_start) % block_size);
+      if (it != m_blockTables.end())
+      {
+        table = it->second;
+        id    = dwCode - it->first;
+      }
+    }
+    else
+    {
+      if (dwCode >= 31000 && dwCode <= 31999)
+        skinTable = m_skinTable;
+      table = m_table;
+    }
+  }
+
+  const CStdString *str = NULL;
+  if (skinTable)
+    str = skinTable->Find(id);
+  if (!str && table)
+    str = table->Find(id);
+  if (str)
+    return *str;
+
+  CSingleLock lock(m_critSection);
   ciStrings i = m_strings.find(dwCode);
   if (i == m_strings.end())
   {
@@ -248,11 +663,16 @@ const CStdString& CLocalizeStrings::Get(uint32_t dwCode) const
 
 void CLocalizeStrings::Clear()
 {
+  CSingleLock lock(m_critSection);
+  m_table.reset();
+  m_skinTable.reset();
+  m_blockTables.clear();
   m_strings.clear();
 }
 
 void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
 {
+  CSingleLock lock(m_critSection);
   iStrings it = m_strings.begin();
   while (it != m_strings.end())
   {
@@ -265,32 +685,34 @@ void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
 
 uint32_t CLocalizeStrings::LoadBlock(const CStdString &id, const CStdString &path, const CStdString &language)
 {
-  iBlocks it = m_blocks.find(id);
-  if (it != m_blocks.end())
-    return it->second;  // already loaded
-
-  // grab a new block
-  uint32_t offset = block_start + m_blocks.size()*block_size;
-  m_blocks.insert(make_pair(id, offset));
-
-  // load the strings
-  CStdString encoding;
-  bool success = LoadStr2Mem(path, language, encoding, offset);
-  if (!success)
+  uint32_t offset;
   {
-    if (language.Equals(SOURCE_LANGUAGE)) // no fallback, nothing to do
-      return 0;
+    CSingleLock lock(m_critSection);
+    iBlocks it = m_blocks.find(id);
+    if (it != m_blocks.end())
+      return it->second;  // already loaded
+
+    // grab a new block
+    offset = block_start + m_blocks.size()*block_size;
+    m_blocks.insert(make_pair(id, offset));
   }
 
-  // load the fallback
-  if (!language.Equals(SOURCE_LANGUAGE))
-    success |= LoadStr2Mem(path, SOURCE_LANGUAGE, encoding, offset);
+  // load the strings
+  StringTablePtr table;
+  if (!LoadTable(table, path, language, std::map<uint32_t, LocStr>(), offset))
+    return 0;
 
-  return success ? offset : 0;
+  if (table)
+  {
+    CSingleLock lock(m_critSection);
+    m_blockTables[offset] = table;
+  }
+  return offset;
 }
 
 void CLocalizeStrings::ClearBlock(const CStdString &id)
 {
+  CSingleLock lock(m_critSection);
   iBlocks it = m_blocks.find(id);
   if (it == m_blocks.end())
   {
@@ -299,6 +721,7 @@ void CLocalizeStrings::ClearBlock(const CStdString &id)
   }
 
   // clear our block
+  m_blockTables.erase(it->second);
   Clear(it->second, it->second + block_size);
   m_blocks.erase(it);
 }
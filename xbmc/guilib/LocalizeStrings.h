@@ -30,8 +30,12 @@
  */
 
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
 
 #include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
 
 /*!
  \ingroup strings
@@ -47,6 +51,72 @@ CStdString strOriginal;   // the original English string, the tranlsation is bas
 // The default fallback language is fixed to be English
 const CStdString SOURCE_LANGUAGE = "English";
 
+/*!
+ \ingroup strings
+ \brief The strings of a language compiled to a file that is mapped into memory.
+
+ The file holds the ids sorted, so a lookup is a binary search over the mapped
+ ids, and the UTF-8 strings in one blob. It records the language files it was
+ compiled from and is only used as long as none of them changed. The strings stay
+ in the mapping until they are asked for, only those are made into a CStdString.
+ */
+class CStringTable
+{
+public:
+  struct Dependency
+  {
+    CStdString path;
+    int64_t    mtime;
+    int64_t    size;  ///< -1 if the file doesn't exist
+  };
+
+  CStringTable();
+  ~CStringTable();
+
+  /*! \brief Map a compiled string table
+   \param file the compiled string table
+   \param key what the table was compiled from, eg. the language path and name
+   \param dependencies the current state of the files the table was compiled from
+   \return true if the table was mapped, false if it doesn't exist or is outdated
+   */
+  bool Open(const CStdString &file, const CStdString &key, const std::vector<Dependency> &dependencies);
+
+  /*! \brief Unmap the table, it mustn't be in use by another thread
+   */
+  void Close();
+  bool IsOpen() const { return m_data != NULL; }
+
+  /*! \brief Find a string
+   The string is made from the mapped one the first time it is asked for, and is
+   valid until the table is closed.
+   \return the string or NULL if the table has no string with this id
+   */
+  const CStdString *Find(uint32_t id) const;
+
+  static bool Write(const CStdString &file, const CStdString &key, const std::vector<Dependency> &dependencies,
+                    const std::map<uint32_t, LocStr> &strings);
+  static void GetDependency(const CStdString &path, Dependency &dependency);
+
+private:
+  CStringTable(const CStringTable&);
+  CStringTable const& operator=(CStringTable const&);
+
+  bool Map(const CStdString &file);
+
+  const uint8_t          *m_data;
+  size_t                  m_size;
+#ifdef _WIN32
+  void                   *m_mapping;
+#endif
+  const uint32_t         *m_ids;     ///< sorted, in the mapped file
+  const uint32_t         *m_offsets; ///< of the strings in m_blob, by index into m_ids
+  const char             *m_blob;    ///< in the mapped file
+  uint32_t                m_count;
+
+  mutable CCriticalSection               m_critSection;
+  mutable std::map<uint32_t, CStdString> m_strings;  ///< the strings asked for, by index into m_ids
+};
+
 class CLocalizeStrings
 {
 public:
@@ -60,41 +130,65 @@ public:
   uint32_t LoadBlock(const CStdString &id, const CStdString &path, const CStdString &language);
   void ClearBlock(const CStdString &id);
 protected:
+  typedef boost::shared_ptr<CStringTable> StringTablePtr;
+
   void Clear(uint32_t start, uint32_t end);
 
-  /*! \brief Loads language ids and strings to memory map m_strings.
+  /*! \brief Map the compiled strings of a language directory.
+   * The strings are loaded with LoadStr2Mem() and compiled first if the language files changed
+   * since they were compiled. If they can't be compiled they are kept in m_strings instead.
+   \param table Set to a new table with the mapped strings, or to none if they are kept in m_strings.
+   \param pathname The directory name, where we look for the language directories.
+   \param language We load the strings for this language. Fallback language is always English.
+   \param constants Strings that replace the loaded ones.
+   \param offset An offset value to place strings from the id value, if they are kept in m_strings.
+   \return false if no strings.po or strings.xml file was loaded.
+   */
+  bool LoadTable(StringTablePtr &table, const CStdString &pathname, const CStdString &language,
+                 const std::map<uint32_t, LocStr> &constants, uint32_t offset = 0);
+
+  /*! \brief Loads language ids and strings to a memory map.
    * It tries to load a strings.po file first. If doesn't exist, it loads a strings.xml file instead.
+   \param strings The memory map to load the strings to.
    \param pathname The directory name, where we look for the strings file.
    \param language We load the strings for this language. Fallback language is always English.
    \param encoding Encoding of the strings. For PO files we only use utf-8.
-   \param offset An offset value to place strings from the id value.
    \return false if no strings.po or strings.xml file was loaded.
    */
-  bool LoadStr2Mem(const CStdString &pathname, const CStdString &language,
-                   CStdString &encoding, uint32_t offset = 0);
+  bool LoadStr2Mem(std::map<uint32_t, LocStr> &strings, const CStdString &pathname,
+                   const CStdString &language, CStdString &encoding);
 
-  /*! \brief Tries to load ids and strings from a strings.po file to m_strings map.
+  /*! \brief Tries to load ids and strings from a strings.po file to a memory map.
    * It should only be called from the LoadStr2Mem function to have a fallback.
+   \param strings The memory map to load the strings to.
    \param pathname The directory name, where we look for the strings file.
    \param encoding Encoding of the strings. For PO files we only use utf-8.
-   \param offset An offset value to place strings from the id value.
    \param bSourceLanguage If we are loading the source English strings.po.
    \return false if no strings.po file was loaded.
    */
-  bool LoadPO(const CStdString &filename, CStdString &encoding, uint32_t offset = 0,
+  bool LoadPO(std::map<uint32_t, LocStr> &strings, const CStdString &filename, CStdString &encoding,
               bool bSourceLanguage = false);
 
-  /*! \brief Tries to load ids and strings from a strings.xml file to m_strings map.
+  /*! \brief Tries to load ids and strings from a strings.xml file to a memory map.
    * It should only be called from the LoadStr2Mem function to try a PO file first.
+   \param strings The memory map to load the strings to.
    \param pathname The directory name, where we look for the strings file.
    \param encoding Encoding of the strings.
-   \param offset An offset value to place strings from the id value.
    \return false if no strings.xml file was loaded.
    */
-  bool LoadXML(const CStdString &filename, CStdString &encoding, uint32_t offset = 0);
+  bool LoadXML(std::map<uint32_t, LocStr> &strings, const CStdString &filename, CStdString &encoding);
 
   CStdString ToUTF8(const CStdString &encoding, const CStdString &str);
-  std::map<uint32_t, LocStr> m_strings;
+
+  static void GetDependencies(const CStdString &path, const CStdString &language,
+                              std::vector<CStringTable::Dependency> &dependencies);
+  static CStdString GetCacheFile(const CStdString &key);
+
+  /* The tables are replaced rather than reopened, and Get() looks up its strings in a
+     reference of its own. A table is unmapped once the last thread using it is done. */
+  StringTablePtr m_table;               ///< the strings of Load()
+  StringTablePtr m_skinTable;           ///< the strings of LoadSkinStrings()
+  std::map<uint32_t, LocStr> m_strings; ///< the strings that couldn't be compiled
   typedef std::map<uint32_t, LocStr>::const_iterator ciStrings;
   typedef std::map<uint32_t, LocStr>::iterator       iStrings;
 
@@ -102,6 +196,10 @@ protected:
   static const uint32_t block_size = 4096;
   std::map<CStdString, uint32_t> m_blocks;
   typedef std::map<CStdString, uint32_t>::iterator iBlocks;
+  std::map<uint32_t, StringTablePtr> m_blockTables; ///< the strings of LoadBlock(), by block offset
+  typedef std::map<uint32_t, StringTablePtr>::const_iterator ciBlockTables;
+
+  mutable CCriticalSection m_critSection; ///< guards the tables, m_strings and the blocks
 };
 
 /*!
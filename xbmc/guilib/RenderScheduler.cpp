@@ -0,0 +1,153 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "RenderScheduler.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+// how much earlier than expected to look for the next second of the clock,
+// and how often to look again until it is seen
+#define CLOCK_TICK_MARGIN 50
+#define CLOCK_TICK_POLL   25
+
+CRenderScheduler::CRenderScheduler()
+{
+  m_bPending = true;
+  m_bScheduled = false;
+  m_nextWakeup = 0;
+  m_clockSecond = 0;
+  m_clockChanged = 0;
+  m_frameTime = 0.0f;
+  m_wakeups = 0.0f;
+  m_wakeupCounter = 0;
+  m_lastStatsTime = 0;
+}
+
+void CRenderScheduler::Wake()
+{
+  // controls wake the loop every time they change, the event is only set once until it's taken
+  CSingleLock lock(m_critSection);
+  if (m_bPending)
+    return;
+  m_bPending = true;
+  lock.Leave();
+  m_event.Set();
+}
+
+void CRenderScheduler::ScheduleWakeup(unsigned int time)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bScheduled || (int)(time - m_nextWakeup) < 0)
+  {
+    m_nextWakeup = time;
+    m_bScheduled = true;
+  }
+}
+
+void CRenderScheduler::ScheduleClockTick(bool seconds)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  time_t second = time(NULL);
+
+  CSingleLock lock(m_critSection);
+  if (second != m_clockSecond)
+  {
+    m_clockSecond = second;
+    m_clockChanged = now;
+  }
+
+  // the next second is expected a second after the last change was seen, the next
+  // minute once the rest of its seconds have passed. Wake up a bit before that and
+  // keep looking until it's there, so a change that was seen late gets corrected
+  unsigned int next = seconds ? 1000 : (60 - (unsigned int)(m_clockSecond % 60)) * 1000;
+  unsigned int elapsed = now - m_clockChanged;
+  if (elapsed < next - CLOCK_TICK_MARGIN)
+    ScheduleWakeup(m_clockChanged + next - CLOCK_TICK_MARGIN);
+  else
+    ScheduleWakeup(now + CLOCK_TICK_POLL);
+}
+
+bool CRenderScheduler::IsDue(unsigned int now) const
+{
+  return m_bPending || (m_bScheduled && (int)(now - m_nextWakeup) >= 0);
+}
+
+bool CRenderScheduler::Wait(unsigned int timeout)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  {
+    CSingleLock lock(m_critSection);
+    if (IsDue(now))
+      return true;
+    if (m_bScheduled && m_nextWakeup - now < timeout)
+      timeout = m_nextWakeup - now;
+  }
+
+  m_event.WaitMSec(timeout);
+
+  CSingleLock lock(m_critSection);
+  return IsDue(XbmcThreads::SystemClockMillis());
+}
+
+bool CRenderScheduler::TakePending(unsigned int now)
+{
+  CSingleLock lock(m_critSection);
+  if (!IsDue(now))
+    return false;
+
+  m_bPending = false;
+  if (m_bScheduled && (int)(now - m_nextWakeup) >= 0)
+    m_bScheduled = false;
+  m_event.Reset();
+  return true;
+}
+
+void CRenderScheduler::FrameDone(unsigned int busyTime, bool processed, bool idle)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+
+  CSingleLock lock(m_critSection);
+  if (processed)
+  {
+    m_frameTime = m_frameTime * 0.9f + busyTime * 0.1f;
+    if (idle)
+      m_wakeupCounter++;
+  }
+
+  if (now - m_lastStatsTime >= 1000)
+  {
+    m_wakeups = m_wakeupCounter * 1000.0f / (now - m_lastStatsTime);
+    m_wakeupCounter = 0;
+    m_lastStatsTime = now;
+  }
+}
+
+float CRenderScheduler::GetFrameTime() const
+{
+  CSingleLock lock(m_critSection);
+  return m_frameTime;
+}
+
+float CRenderScheduler::GetWakeupsPerSecond() const
+{
+  CSingleLock lock(m_critSection);
+  return m_wakeups;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <time.h>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+/*!
+ \brief Decides when the render loop has to process and draw the GUI again.
+
+ Once nothing has been drawn for a while, the render loop only polls input
+ and otherwise blocks in Wait(). It goes back to processing the GUI when it
+ is woken (input, messages, a video frame), when a scheduled wakeup is due
+ (an animation or a label that ticks, like the clock), or when the idle
+ refresh interval has passed, for anything that changes without telling.
+
+ The scheduler also keeps the frame time and wakeup statistics that are
+ shown through the system.frametime and system.renderwakeups info labels.
+ */
+class CRenderScheduler
+{
+public:
+  CRenderScheduler();
+
+  /*!
+   \brief Something needs to be processed or drawn, wake the render loop
+   */
+  void Wake();
+
+  /*!
+   \brief Make sure the GUI is processed again at the given time
+   \param time system clock time in ms, see XbmcThreads::SystemClockMillis()
+   */
+  void ScheduleWakeup(unsigned int time);
+
+  /*!
+   \brief Schedule a wakeup for when the time shown by a clock label changes
+   \param seconds whether the label shows the seconds, or only changes with the minute
+   */
+  void ScheduleClockTick(bool seconds);
+
+  /*!
+   \brief Block until woken, a scheduled wakeup is due or timeout ms have passed
+   \return true if woken or a scheduled wakeup is due
+   */
+  bool Wait(unsigned int timeout);
+
+  /*!
+   \brief Check whether the GUI has to be processed, and reset the wakeup if so
+   \param now the current system clock time in ms
+   */
+  bool TakePending(unsigned int now);
+
+  /*!
+   \brief Account a run of the render loop
+   \param busyTime time spent processing and drawing, in ms
+   \param processed whether the GUI was processed or only input was polled
+   \param idle whether the render loop was idle when it processed the GUI
+   */
+  void FrameDone(unsigned int busyTime, bool processed, bool idle);
+
+  /*!
+   \brief Average time spent on a processed frame, in ms
+   */
+  float GetFrameTime() const;
+
+  /*!
+   \brief Number of times per second the GUI was processed while idle
+   */
+  float GetWakeupsPerSecond() const;
+
+private:
+  bool IsDue(unsigned int now) const;
+
+  CEvent           m_event;
+  mutable CCriticalSection m_critSection;
+  bool             m_bPending;
+  bool             m_bScheduled;
+  unsigned int     m_nextWakeup;
+
+  time_t           m_clockSecond;  ///< second of the wall clock when it was last looked at
+  unsigned int     m_clockChanged; ///< system clock time the second was seen to change
+
+  float            m_frameTime;
+  float            m_wakeups;
+  unsigned int     m_wakeupCounter;
+  unsigned int     m_lastStatsTime;
+};
+
+extern CRenderScheduler g_renderScheduler;
@@ -0,0 +1,344 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "guilib/AdaptiveDirtyRegionSolver.h"
+#include "guilib/DirtyRegionTrace.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  /* the render time the replay pretends each pass takes */
+  struct RenderModel
+  {
+    double passCost;
+    double pixelCost;
+    double noise;    ///< relative, uniformly distributed
+  };
+
+  float Clipped(const CRect &rect, const CRect &viewport)
+  {
+    CRect clipped(rect);
+    clipped.Intersect(viewport);
+    return clipped.Area();
+  }
+
+  class CRenderer
+  {
+  public:
+    CRenderer(const RenderModel &model) : m_model(model), m_seed(1) {}
+
+    float Cost(const CRect &pass, const CRect &viewport) const
+    {
+      return (float)(m_model.passCost + m_model.pixelCost * Clipped(pass, viewport));
+    }
+
+    float Cost(const CDirtyRegionList &passes, const CRect &viewport) const
+    {
+      float cost = 0.0f;
+      for (unsigned int i = 0; i < passes.size(); i++)
+        cost += Cost(passes[i], viewport);
+      return cost;
+    }
+
+    /* the "measured" time of a pass */
+    float Render(const CRect &pass, const CRect &viewport)
+    {
+      m_seed = m_seed * 1103515245 + 12345;
+      double jitter = ((m_seed >> 16) & 0x7fff) / 32767.0 * 2.0 - 1.0;
+      return Cost(pass, viewport) * (float)(1.0 + m_model.noise * jitter);
+    }
+
+  private:
+    RenderModel  m_model;
+    unsigned int m_seed;
+  };
+
+  /* a home screen: an idle clock and two tiny far apart tickers, a scrolling list
+     with its scrollbar and poster, and a dialog fading in */
+  std::vector<CDirtyRegionTrace::Frame> RecordedFrames()
+  {
+    std::vector<CDirtyRegionTrace::Frame> frames;
+    for (unsigned int i = 0; i < 600; i++)
+    {
+      CDirtyRegionTrace::Frame frame;
+      frame.viewport = CRect(0, 0, 1920, 1080);
+      if (i % 25 < 3)
+        frame.regions.push_back(CDirtyRegion(1700, 20, 1880, 60));
+      if (i < 200)
+      {
+        if (i % 7 < 3)
+        {
+          frame.regions.push_back(CDirtyRegion(10, 10, 40, 40));
+          frame.regions.push_back(CDirtyRegion(1880, 1040, 1910, 1070));
+        }
+      }
+      else if (i < 400)
+      {
+        frame.regions.push_back(CDirtyRegion(100, 200, 700, 1000));
+        frame.regions.push_back(CDirtyRegion(720, 200, 740, 1000));
+        frame.regions.push_back(CDirtyRegion(1200, 200, 1800, 900));
+      }
+      else
+        frame.regions.push_back(CDirtyRegion(200, 100, 1720, 980));
+      frames.push_back(frame);
+    }
+    return frames;
+  }
+
+  /* replay the frames through the solver, feeding back the render time of its passes.
+     Returns the render time from frame warmup on and checks that every dirty region is redrawn. */
+  float Replay(CAdaptiveDirtyRegionSolver &solver, const std::vector<CDirtyRegionTrace::Frame> &frames,
+               CRenderer &renderer, unsigned int warmup)
+  {
+    float total = 0.0f;
+    for (unsigned int i = 0; i < frames.size(); i++)
+    {
+      const CDirtyRegionTrace::Frame &frame = frames[i];
+      solver.SetViewport(frame.viewport);
+
+      CDirtyRegionList passes;
+      solver.Solve(frame.regions, passes);
+      BOOST_CHECK_EQUAL(passes.empty(), frame.regions.empty());
+
+      for (unsigned int r = 0; r < frame.regions.size(); r++)
+      {
+        CRect region(frame.regions[r]);
+        region.Intersect(frame.viewport);
+        bool covered = false;
+        for (unsigned int p = 0; p < passes.size() && !covered; p++)
+          covered = passes[p].x1 <= region.x1 && passes[p].y1 <= region.y1 &&
+                    passes[p].x2 >= region.x2 && passes[p].y2 >= region.y2;
+        BOOST_CHECK_MESSAGE(covered, "frame " << i << " region " << r << " isn't redrawn");
+      }
+
+      for (unsigned int p = 0; p < passes.size(); p++)
+      {
+        float time = renderer.Render(passes[p], frame.viewport);
+        solver.PassRendered(passes[p], time);
+        if (i >= warmup)
+          total += time;
+      }
+    }
+    return total;
+  }
+
+  /* the cheapest of one pass per region, their union and the viewport, chosen per frame */
+  float BestFixed(const std::vector<CDirtyRegionTrace::Frame> &frames, const CRenderer &renderer, unsigned int warmup)
+  {
+    float total = 0.0f;
+    for (unsigned int i = warmup; i < frames.size(); i++)
+    {
+      const CDirtyRegionTrace::Frame &frame = frames[i];
+      if (frame.regions.empty())
+        continue;
+
+      CDirtyRegion merged;
+      for (unsigned int r = 0; r < frame.regions.size(); r++)
+        merged.Union(frame.regions[r]);
+
+      float split = renderer.Cost(frame.regions, frame.viewport);
+      total += std::min(split, std::min(renderer.Cost(merged, frame.viewport), renderer.Cost(frame.viewport, frame.viewport)));
+    }
+    return total;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestDirtyRegionTraceRoundTrip)
+{
+  CDirtyRegionTrace::Frame frame;
+  frame.viewport = CRect(0, 0, 1280, 720);
+  frame.regions.push_back(CDirtyRegion(10.5f, 20, 30, 40));
+  frame.regions.push_back(CDirtyRegion(100, 200, 300, 400));
+  CDirtyRegionTrace::Pass pass;
+  pass.region = CDirtyRegion(10.5f, 20, 300, 400);
+  pass.time   = 1.25f;
+  frame.passes.push_back(pass);
+
+  std::string text = "# recorded on the test box\n" + CDirtyRegionTrace::Format(frame) + "\nframe 0 0 1280 720\n";
+
+  std::vector<CDirtyRegionTrace::Frame> frames;
+  BOOST_REQUIRE(CDirtyRegionTrace::Parse(text, frames));
+  BOOST_REQUIRE_EQUAL(frames.size(), 2U);
+  BOOST_CHECK(!(frames[0].viewport != frame.viewport));
+  BOOST_REQUIRE_EQUAL(frames[0].regions.size(), 2U);
+  BOOST_CHECK(!(frames[0].regions[0] != frame.regions[0]));
+  BOOST_CHECK(!(frames[0].regions[1] != frame.regions[1]));
+  BOOST_REQUIRE_EQUAL(frames[0].passes.size(), 1U);
+  BOOST_CHECK(!(frames[0].passes[0].region != pass.region));
+  BOOST_CHECK_EQUAL(frames[0].passes[0].time, pass.time);
+  BOOST_CHECK(frames[1].regions.empty());
+
+  frames.clear();
+  BOOST_CHECK(!CDirtyRegionTrace::Parse("region 0 0 1 1\n", frames));
+  BOOST_CHECK(!CDirtyRegionTrace::Parse("frame 0 0 1280 720\npass 0 0 1 1\n", frames));
+}
+
+BOOST_AUTO_TEST_CASE(TestAdaptiveDirtyRegionCostModel)
+{
+  /* the model converges to the measured cost of a pass and of a pixel */
+  RenderModel model = { 2.0, 0.000004, 0.0 };
+  CRenderer renderer(model);
+  CRect viewport(0, 0, 1920, 1080);
+
+  CAdaptiveDirtyRegionSolver solver;
+  solver.SetViewport(viewport);
+  for (unsigned int i = 0; i < 200; i++)
+  {
+    CDirtyRegion pass(0, 0, 100 + (i * 37) % 1800, 50 + (i * 53) % 1000);
+    solver.PassRendered(pass, renderer.Render(pass, viewport));
+  }
+
+  BOOST_CHECK_CLOSE(solver.GetPassCost(), 2.0f, 1.0f);
+  BOOST_CHECK_CLOSE(solver.GetPixelCost(), 0.000004f, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(TestAdaptiveDirtyRegionStrategy)
+{
+  CRect viewport(0, 0, 1920, 1080);
+  CDirtyRegionList corners;
+  corners.push_back(CDirtyRegion(10, 10, 40, 40));
+  corners.push_back(CDirtyRegion(1880, 1040, 1910, 1070));
+
+  /* expensive pixels, two small passes beat a pass over the whole screen */
+  {
+    RenderModel model = { 0.5, 0.00001, 0.0 };
+    CRenderer renderer(model);
+    CAdaptiveDirtyRegionSolver solver;
+    solver.SetViewport(viewport);
+    for (unsigned int i = 0; i < 100; i++)
+    {
+      CDirtyRegion pass(0, 0, 20 * i, 10 * i);
+      solver.PassRendered(pass, renderer.Render(pass, viewport));
+    }
+
+    CDirtyRegionList passes;
+    solver.Solve(corners, passes);
+    BOOST_CHECK_EQUAL(solver.GetStrategy(), CAdaptiveDirtyRegionSolver::STRATEGY_SPLIT);
+    BOOST_CHECK_EQUAL(passes.size(), 2U);
+  }
+
+  /* expensive passes, traversing the window twice costs more than the pixels saved */
+  {
+    RenderModel model = { 20.0, 0.000001, 0.0 };
+    CRenderer renderer(model);
+    CAdaptiveDirtyRegionSolver solver;
+    solver.SetViewport(viewport);
+    for (unsigned int i = 0; i < 100; i++)
+    {
+      CDirtyRegion pass(0, 0, 20 * i, 10 * i);
+      solver.PassRendered(pass, renderer.Render(pass, viewport));
+    }
+
+    CDirtyRegionList passes;
+    solver.Solve(corners, passes);
+    BOOST_CHECK_EQUAL(passes.size(), 1U);
+    BOOST_CHECK(solver.GetStrategy() == CAdaptiveDirtyRegionSolver::STRATEGY_MERGE ||
+                solver.GetStrategy() == CAdaptiveDirtyRegionSolver::STRATEGY_VIEWPORT);
+
+    /* once the unclipped viewport is measured cheaper, it is preferred to a merged pass */
+    solver.PassRendered(CDirtyRegion(viewport), 1.0f);
+    passes.clear();
+    solver.Solve(corners, passes);
+    BOOST_CHECK_EQUAL(solver.GetStrategy(), CAdaptiveDirtyRegionSolver::STRATEGY_VIEWPORT);
+    BOOST_REQUIRE_EQUAL(passes.size(), 1U);
+    BOOST_CHECK(!(passes[0] != viewport));
+  }
+
+  /* nothing dirty, nothing to render */
+  CAdaptiveDirtyRegionSolver solver;
+  CDirtyRegionList passes;
+  solver.Solve(CDirtyRegionList(), passes);
+  BOOST_CHECK(passes.empty());
+  BOOST_CHECK_EQUAL(solver.GetStrategy(), CAdaptiveDirtyRegionSolver::STRATEGY_NONE);
+}
+
+BOOST_AUTO_TEST_CASE(TestAdaptiveDirtyRegionReplay)
+{
+  /* once the model is learned the solver renders about as cheap as the best
+     fixed choice for each frame */
+  RenderModel model = { 2.0, 0.000004, 0.05 };
+  std::vector<CDirtyRegionTrace::Frame> frames = RecordedFrames();
+
+  CRenderer renderer(model);
+  CAdaptiveDirtyRegionSolver solver;
+  float adaptive = Replay(solver, frames, renderer, 50);
+  float best     = BestFixed(frames, renderer, 50);
+
+  BOOST_TEST_MESSAGE("adaptive " << adaptive << " ms, best fixed " << best << " ms");
+  BOOST_CHECK(adaptive <= best * 1.05f);
+}
+
+BOOST_AUTO_TEST_CASE(TestAdaptiveDirtyRegionRecordedTrace)
+{
+  /* replay a trace recorded with <gui><tracedirtyregions> set in advancedsettings.xml:
+       XBMC_DIRTYREGION_TRACE=dirtyregions.trace ./testMain --log_level=message
+     The render time of a pass is the least squares fit over the recorded passes. */
+  const char *path = getenv("XBMC_DIRTYREGION_TRACE");
+  if (!path)
+    return;
+
+  std::ifstream file(path);
+  BOOST_REQUIRE_MESSAGE(file, "unable to open " << path);
+  std::stringstream text;
+  text << file.rdbuf();
+
+  std::vector<CDirtyRegionTrace::Frame> frames;
+  BOOST_REQUIRE(CDirtyRegionTrace::Parse(text.str(), frames));
+
+  double n = 0, sumArea = 0, sumArea2 = 0, sumTime = 0, sumAreaTime = 0;
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    for (unsigned int p = 0; p < frames[i].passes.size(); p++)
+    {
+      double area = Clipped(frames[i].passes[p].region, frames[i].viewport);
+      double time = frames[i].passes[p].time;
+      n++;
+      sumArea     += area;
+      sumArea2    += area * area;
+      sumTime     += time;
+      sumAreaTime += area * time;
+    }
+  }
+  BOOST_REQUIRE_MESSAGE(n > 1, "the trace holds no rendered passes");
+
+  RenderModel model = { 0.0, 0.0, 0.0 };
+  double det = n * sumArea2 - sumArea * sumArea;
+  if (det > 0)
+    model.pixelCost = std::max(0.0, (n * sumAreaTime - sumArea * sumTime) / det);
+  model.passCost = std::max(0.0, (sumTime - model.pixelCost * sumArea) / n);
+
+  CRenderer renderer(model);
+  CAdaptiveDirtyRegionSolver solver;
+  float adaptive = Replay(solver, frames, renderer, 0);
+  float best     = BestFixed(frames, renderer, 0);
+
+  BOOST_TEST_MESSAGE(frames.size() << " frames, " << model.passCost << " ms per pass, "
+                     << model.pixelCost * 1000000.0 << " ms per megapixel");
+  BOOST_TEST_MESSAGE("adaptive " << adaptive << " ms, best fixed " << best << " ms");
+  BOOST_CHECK(adaptive <= best * 1.1f);
+}
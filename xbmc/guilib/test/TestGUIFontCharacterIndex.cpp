@@ -0,0 +1,70 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "guilib/LocalizeStrings.h"
+#include "guilib/GUIFontCharacterIndex.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(TestGUIFontCharacterIndex)
+
+BOOST_AUTO_TEST_CASE(TestEmpty)
+{
+  CGUIFontCharacterIndex index;
+  BOOST_CHECK_EQUAL(index.GetSize(), 0U);
+  BOOST_CHECK_EQUAL(index.Find('a'), -1);
+
+  index.Add('a', 0);
+  BOOST_CHECK_EQUAL(index.GetSize(), (unsigned int)CHAR_INDEX_SIZE);
+  BOOST_CHECK_EQUAL(index.Find('a'), 0);
+
+  index.Clear();
+  BOOST_CHECK_EQUAL(index.GetCount(), 0U);
+  BOOST_CHECK_EQUAL(index.Find('a'), -1);
+}
+
+BOOST_AUTO_TEST_CASE(TestGrowth)
+{
+  CGUIFontCharacterIndex index;
+  const unsigned int count = 4 * CHAR_INDEX_SIZE;
+
+  // letters of every style, so that characters with the same letter collide
+  for (unsigned int i = 0; i < count; i++)
+  {
+    uint32_t letterAndStyle = ((i % 4) << 16) | (0x20 + i / 4);
+    index.Add(letterAndStyle, i);
+    BOOST_REQUIRE_EQUAL(index.GetCount(), i + 1);
+    BOOST_REQUIRE(2 * index.GetCount() <= index.GetSize());
+    if (i == CHAR_INDEX_SIZE / 2 - 1)
+      BOOST_CHECK_EQUAL(index.GetSize(), (unsigned int)CHAR_INDEX_SIZE);
+    if (i == CHAR_INDEX_SIZE / 2)
+      BOOST_CHECK_EQUAL(index.GetSize(), 2U * CHAR_INDEX_SIZE);
+  }
+  BOOST_CHECK_EQUAL(index.GetSize(), 8U * CHAR_INDEX_SIZE);
+
+  // everything added before the hash grew is still found
+  for (unsigned int i = 0; i < count; i++)
+    BOOST_CHECK_EQUAL(index.Find(((i % 4) << 16) | (0x20 + i / 4)), (int)i);
+  BOOST_CHECK_EQUAL(index.Find(0x20 + count), -1);
+  BOOST_CHECK_EQUAL(index.Find((4 << 16) | 0x20), -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "guilib/LocalizeStrings.h"
+#include "guilib/GUITextLayoutCache.h"
+#include "utils/TimeUtils.h"
+
+#include <boost/test/unit_test.hpp>
+
+/* only the layout time statistics use the host clock */
+int64_t CurrentHostFrequency(void)
+{
+  return 1000;
+}
+
+namespace
+{
+  /* the cache only compares fonts by pointer */
+  const CGUIFont *Font(int font)
+  {
+    return reinterpret_cast<const CGUIFont *>(font);
+  }
+
+  CGUITextLayoutCache::Key MakeKey(int font, float maxWidth, bool forceLTR, const CStdStringW &text)
+  {
+    CGUITextLayoutCache::Key key;
+    key.font      = Font(font);
+    key.fontFile  = NULL;
+    key.scaleX    = 1.0f;
+    key.scaleY    = 1.0f;
+    key.maxWidth  = maxWidth;
+    key.maxHeight = 0;
+    key.forceLTR  = forceLTR;
+    key.text      = text;
+    return key;
+  }
+
+  CStdStringW Text(unsigned int number)
+  {
+    CStdStringW text;
+    text.Format(L"label %u", number);
+    return text;
+  }
+
+  /* layouts are told apart by their width */
+  CGUITextLayoutCache::Layout MakeLayout(float width)
+  {
+    CGUITextLayoutCache::Layout layout;
+    layout.colors.push_back(0xffffffff);
+    layout.colors.push_back(0xff00ff00);
+    layout.width  = width;
+    layout.height = 10.0f;
+    return layout;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(TestGUITextLayoutCache)
+
+BOOST_AUTO_TEST_CASE(TestEviction)
+{
+  CGUITextLayoutCache cache;
+  CGUITextLayoutCache::Layout layout;
+  for (unsigned int i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++)
+    cache.Add(MakeKey(1, 0, false, Text(i)), MakeLayout((float)i), 0);
+
+  // the first one is used again, so the second one is the least recently used
+  BOOST_REQUIRE(cache.Get(MakeKey(1, 0, false, Text(0)), 0, layout));
+  cache.Add(MakeKey(1, 0, false, Text(TEXT_LAYOUT_CACHE_SIZE)), MakeLayout(-1.0f), 0);
+
+  BOOST_CHECK(!cache.Get(MakeKey(1, 0, false, Text(1)), 0, layout));
+  BOOST_CHECK(cache.Get(MakeKey(1, 0, false, Text(0)), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, 0.0f);
+  BOOST_CHECK(cache.Get(MakeKey(1, 0, false, Text(2)), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, 2.0f);
+  BOOST_CHECK(cache.Get(MakeKey(1, 0, false, Text(TEXT_LAYOUT_CACHE_SIZE)), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, -1.0f);
+
+  cache.Clear();
+  BOOST_CHECK(!cache.Get(MakeKey(1, 0, false, Text(0)), 0, layout));
+}
+
+BOOST_AUTO_TEST_CASE(TestKeySeparation)
+{
+  CGUITextLayoutCache cache;
+  CGUITextLayoutCache::Layout layout;
+  cache.Add(MakeKey(1, 0, false, L"label"), MakeLayout(1.0f), 0);
+  cache.Add(MakeKey(2, 0, false, L"label"), MakeLayout(2.0f), 0);
+  cache.Add(MakeKey(1, 100.0f, false, L"label"), MakeLayout(3.0f), 0);
+  cache.Add(MakeKey(1, 0, true, L"label"), MakeLayout(4.0f), 0);
+
+  BOOST_REQUIRE(cache.Get(MakeKey(1, 0, false, L"label"), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, 1.0f);
+  BOOST_REQUIRE(cache.Get(MakeKey(2, 0, false, L"label"), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, 2.0f);
+  BOOST_REQUIRE(cache.Get(MakeKey(1, 100.0f, false, L"label"), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, 3.0f);
+  BOOST_REQUIRE(cache.Get(MakeKey(1, 0, true, L"label"), 0, layout));
+  BOOST_CHECK_EQUAL(layout.width, 4.0f);
+
+  BOOST_CHECK(!cache.Get(MakeKey(3, 0, false, L"label"), 0, layout));
+  BOOST_CHECK(!cache.Get(MakeKey(1, 50.0f, false, L"label"), 0, layout));
+  BOOST_CHECK(!cache.Get(MakeKey(1, 0, false, L"other"), 0, layout));
+}
+
+BOOST_AUTO_TEST_CASE(TestColorOverride)
+{
+  CGUITextLayoutCache cache;
+  CGUITextLayoutCache::Layout layout;
+  cache.Add(MakeKey(1, 0, false, L"[COLOR green]label[/COLOR]"), MakeLayout(1.0f), 0);
+
+  // the text colour is of the label getting the layout, the colours of the text are cached
+  BOOST_REQUIRE(cache.Get(MakeKey(1, 0, false, L"[COLOR green]label[/COLOR]"), 0xffff0000, layout));
+  BOOST_REQUIRE_EQUAL(layout.colors.size(), 2U);
+  BOOST_CHECK_EQUAL(layout.colors[0], 0xffff0000);
+  BOOST_CHECK_EQUAL(layout.colors[1], 0xff00ff00);
+
+  BOOST_REQUIRE(cache.Get(MakeKey(1, 0, false, L"[COLOR green]label[/COLOR]"), 0xff0000ff, layout));
+  BOOST_CHECK_EQUAL(layout.colors[0], 0xff0000ff);
+}
+
+BOOST_AUTO_TEST_CASE(TestLongText)
+{
+  CGUITextLayoutCache cache;
+  CGUITextLayoutCache::Layout layout;
+  CStdStringW text(TEXT_LAYOUT_MAX_LENGTH + 1, L'x');
+  cache.Add(MakeKey(1, 0, false, text), MakeLayout(1.0f), 0);
+  BOOST_CHECK(!cache.Get(MakeKey(1, 0, false, text), 0, layout));
+
+  text.resize(TEXT_LAYOUT_MAX_LENGTH);
+  cache.Add(MakeKey(1, 0, false, text), MakeLayout(1.0f), 0);
+  BOOST_CHECK(cache.Get(MakeKey(1, 0, false, text), 0, layout));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
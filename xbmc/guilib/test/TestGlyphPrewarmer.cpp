@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "guilib/LocalizeStrings.h"
+#include "guilib/GlyphPrewarmer.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  /* rasterizes a glyph of one pixel, the letter, and can hold Run() in Rasterize() */
+  class CTestGlyphPrewarmer : public CGlyphPrewarmer, public IRunnable
+  {
+  public:
+    CTestGlyphPrewarmer(bool block) : m_block(block), m_rasterizing(true), m_release(true) {}
+
+    virtual void Run() { CGlyphPrewarmer::Run(); }
+
+    CEvent m_rasterizing;
+    CEvent m_release;
+
+  protected:
+    virtual bool Rasterize(uint32_t letterAndStyle, Glyph &glyph)
+    {
+      if (m_block)
+      {
+        m_rasterizing.Set();
+        m_release.Wait();
+      }
+      glyph.left = glyph.top = 0;
+      glyph.width = glyph.rows = 1;
+      glyph.advance = 1.0f;
+      glyph.pixels.assign(1, (unsigned char)letterAndStyle);
+      return true;
+    }
+
+  private:
+    bool m_block;
+  };
+
+  std::vector<uint32_t> Letters(uint32_t first, uint32_t count)
+  {
+    std::vector<uint32_t> letters;
+    for (uint32_t letter = first; letter < first + count; letter++)
+      letters.push_back(letter);
+    return letters;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(TestGlyphPrewarmer)
+
+BOOST_AUTO_TEST_CASE(TestQueueAndTake)
+{
+  CTestGlyphPrewarmer prewarmer(false);
+  BOOST_CHECK(prewarmer.Queue(Letters('a', 3)));
+  BOOST_CHECK(!prewarmer.Queue(Letters('a', 5)));
+  prewarmer.Run();
+
+  std::vector<uint32_t> ready;
+  prewarmer.GetReady(ready);
+  BOOST_CHECK_EQUAL(ready.size(), 5U);
+
+  CGlyphPrewarmer::Glyph glyph;
+  BOOST_REQUIRE(prewarmer.Take('b', glyph));
+  BOOST_CHECK_EQUAL(glyph.pixels.size(), 1U);
+  BOOST_CHECK_EQUAL(glyph.pixels[0], 'b');
+  BOOST_CHECK(!prewarmer.Take('b', glyph));
+
+  // a glyph that was taken is rasterized again when it is queued again
+  BOOST_CHECK(prewarmer.Queue(Letters('b', 1)));
+}
+
+BOOST_AUTO_TEST_CASE(TestCancelDuringRasterize)
+{
+  CTestGlyphPrewarmer prewarmer(true);
+  BOOST_REQUIRE(prewarmer.Queue(Letters('a', 3)));
+  CThread thread(&prewarmer, "TestGlyphPrewarmer");
+  thread.Create();
+
+  // the glyph being rasterized while the prewarmer is cancelled is dropped
+  BOOST_REQUIRE(prewarmer.m_rasterizing.WaitMSec(10000));
+  prewarmer.Cancel();
+  prewarmer.m_release.Set();
+  thread.StopThread();
+
+  CGlyphPrewarmer::Glyph glyph;
+  BOOST_CHECK(!prewarmer.Take('a', glyph));
+  BOOST_CHECK(!prewarmer.Take('b', glyph));
+  std::vector<uint32_t> ready;
+  prewarmer.GetReady(ready);
+  BOOST_CHECK(ready.empty());
+
+  // Run() is done, so the next glyphs need another job
+  BOOST_CHECK(prewarmer.Queue(Letters('a', 1)));
+}
+
+BOOST_AUTO_TEST_CASE(TestCancelRacingRun)
+{
+  CTestGlyphPrewarmer prewarmer(false);
+  for (int round = 0; round < 200; round++)
+  {
+    BOOST_REQUIRE(prewarmer.Queue(Letters(round * 64, 64)));
+    CThread thread(&prewarmer, "TestGlyphPrewarmer");
+    thread.Create();
+
+    // cancel and queue while Run() rasterizes, no job is asked for while it runs
+    for (int i = 0; i < 8; i++)
+    {
+      prewarmer.Cancel();
+      if (prewarmer.Queue(Letters(round * 64 + i, 4)))
+        prewarmer.Run();
+    }
+    thread.StopThread();
+
+    // only the glyphs queued after the last cancel are ready, and nothing is left running
+    std::vector<uint32_t> ready;
+    prewarmer.GetReady(ready);
+    BOOST_REQUIRE(ready == Letters(round * 64 + 7, 4));
+    BOOST_REQUIRE(prewarmer.Queue(Letters(round * 64 + 11, 1)));
+    prewarmer.Run();
+    prewarmer.Cancel();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,298 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "guilib/LocalizeStrings.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "test/TestStubs.h"
+#include "utils/CharsetConverter.h"
+#include "utils/URIUtils.h"
+#include "utils/XMLUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+/* the compiled tables are mapped from disk, everything else is in g_testFiles.
+   special://temp/ is a directory made for the test, other paths aren't translated */
+namespace
+{
+  std::string g_tempPath;
+}
+
+CStdString CSpecialProtocol::TranslatePath(const CStdString &path)
+{
+  if (path.Left(15) == "special://temp/")
+    return g_tempPath + path.Mid(15);
+  return path;
+}
+
+CStdString CSpecialProtocol::TranslatePathConvertCase(const CStdString &path)
+{
+  return path;
+}
+
+void URIUtils::AddFileToFolder(const CStdString& strFolder, const CStdString& strFile, CStdString& strResult)
+{
+  strResult = strFolder;
+  if (strResult.Right(1) != "/")
+    strResult += "/";
+  strResult += strFile;
+}
+
+namespace XFILE
+{
+  /* the compiled table is renamed into place, that is when it is written to disk for mapping */
+  bool CFile::Rename(const CStdString& strFileName, const CStdString& strNewFileName)
+  {
+    std::map<std::string, std::string>::iterator it = g_testFiles.find(strFileName);
+    if (it == g_testFiles.end())
+      return false;
+    std::string data = it->second;
+    g_testFiles.erase(it);
+    g_testFiles[strNewFileName] = data;
+
+    FILE *file = fopen(CSpecialProtocol::TranslatePath(strNewFileName).c_str(), "wb");
+    if (!file)
+      return false;
+    bool written = fwrite(data.c_str(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return written;
+  }
+
+  bool CFile::Delete(const CStdString& strFileName)
+  {
+    return g_testFiles.erase(strFileName) > 0;
+  }
+}
+
+/* only strings.po files are loaded, the strings are UTF-8 already */
+CCharsetConverter::CCharsetConverter() { }
+
+void CCharsetConverter::stringCharsetToUtf8(const CStdStringA& strSourceCharset, const CStdStringA& strSource, CStdStringA& strDest)
+{
+  strDest = strSource;
+}
+
+bool XMLUtils::GetEncoding(const CXBMCTinyXML* pDoc, CStdString& strEncoding)
+{
+  return false;
+}
+
+CXBMCTinyXML::CXBMCTinyXML() { }
+
+bool CXBMCTinyXML::LoadFile(const CStdString& filename, TiXmlEncoding encoding)
+{
+  return false;
+}
+
+const char *CXBMCTinyXML::Parse(const char *data, TiXmlParsingData *prevData, TiXmlEncoding encoding)
+{
+  return TiXmlDocument::Parse(data, prevData, encoding);
+}
+
+namespace
+{
+  class CTempDirectory
+  {
+  public:
+    CTempDirectory()
+    {
+      char path[] = "/tmp/TestLocalizeStringsXXXXXX";
+      if (mkdtemp(path))
+        g_tempPath = std::string(path) + "/";
+      m_path = g_tempPath;
+      mkdir((m_path + "stringcache").c_str(), 0755);
+      g_testFiles.clear();
+    }
+
+    ~CTempDirectory()
+    {
+      std::string command = "rm -rf " + m_path;
+      if (!m_path.empty())
+        system(command.c_str());
+    }
+
+  private:
+    std::string m_path;
+  };
+
+  /* a strings.po of the given ids, the source language takes the msgid */
+  void AddPOFile(const std::string &path, uint32_t first, uint32_t count, const char *text)
+  {
+    CStdString file = "msgid \"\"\nmsgstr \"\"\n\"Language: en\\n\"\n";
+    for (uint32_t id = first; id < first + count; id++)
+    {
+      CStdString entry;
+      entry.Format("\nmsgctxt \"#%u\"\nmsgid \"%s %u\"\nmsgstr \"\"\n", id, text, id);
+      file += entry;
+    }
+    g_testFiles[path] = file;
+  }
+
+  /* has access to the tables that are handed out */
+  class CTestLocalizeStrings : public CLocalizeStrings
+  {
+  public:
+    boost::shared_ptr<CStringTable> GetSkinTable() const { return m_skinTable; }
+  };
+
+  std::vector<CStringTable::Dependency> GetDependencies(int64_t mtime)
+  {
+    std::vector<CStringTable::Dependency> dependencies(2);
+    dependencies[0].path  = "/language/English/strings.po";
+    dependencies[0].mtime = mtime;
+    dependencies[0].size  = 1000;
+    dependencies[1].path  = "/language/English/strings.xml";
+    dependencies[1].mtime = 0;
+    dependencies[1].size  = -1;
+    return dependencies;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(TestLocalizeStrings)
+
+BOOST_AUTO_TEST_CASE(TestTableFormat)
+{
+  CTempDirectory temp;
+  std::map<uint32_t, LocStr> strings;
+  for (uint32_t id = 0; id < 5000; id += 3)
+    strings[id].strTranslated.Format("string %u", id);
+  strings[7].strTranslated = "";
+  strings[8].strTranslated = "caf\xc3\xa9";
+
+  std::vector<CStringTable::Dependency> dependencies = GetDependencies(5);
+  CStdString file = "special://temp/stringcache/table.bin";
+  BOOST_REQUIRE(CStringTable::Write(file, "key", dependencies, strings));
+
+  // only used as long as it is of the same key and the language files didn't change
+  CStringTable table;
+  BOOST_CHECK(!table.Open(file, "other", dependencies));
+  BOOST_CHECK(!table.Open(file, "key", GetDependencies(6)));
+  BOOST_CHECK(!table.Open("special://temp/stringcache/missing.bin", "key", dependencies));
+  BOOST_REQUIRE(table.Open(file, "key", dependencies));
+  BOOST_CHECK(table.IsOpen());
+
+  for (uint32_t id = 0; id < 5002; id++)
+  {
+    const CStdString *str = table.Find(id);
+    std::map<uint32_t, LocStr>::const_iterator it = strings.find(id);
+    BOOST_REQUIRE_EQUAL(str != NULL, it != strings.end());
+    if (str)
+      BOOST_CHECK_EQUAL(*str, it->second.strTranslated);
+  }
+
+  table.Close();
+  BOOST_CHECK(!table.IsOpen());
+  BOOST_CHECK(table.Find(3) == NULL);
+
+  // a table cut short is rejected
+  std::string data = g_testFiles[file];
+  g_testFiles["special://temp/stringcache/short.bin.tmp"] = data.substr(0, data.size() / 2);
+  BOOST_REQUIRE(XFILE::CFile::Rename("special://temp/stringcache/short.bin.tmp", "special://temp/stringcache/short.bin"));
+  BOOST_CHECK(!table.Open("special://temp/stringcache/short.bin", "key", dependencies));
+}
+
+BOOST_AUTO_TEST_CASE(TestLazyLookup)
+{
+  CTempDirectory temp;
+  std::map<uint32_t, LocStr> strings;
+  strings[1].strTranslated = "one";
+  strings[2].strTranslated = "two";
+
+  std::vector<CStringTable::Dependency> dependencies = GetDependencies(5);
+  CStdString file = "special://temp/stringcache/lazy.bin";
+  BOOST_REQUIRE(CStringTable::Write(file, "key", dependencies, strings));
+  CStringTable table;
+  BOOST_REQUIRE(table.Open(file, "key", dependencies));
+
+  // a string is made once, when it is first asked for, and then handed out by reference
+  const CStdString *one = table.Find(1);
+  BOOST_REQUIRE(one != NULL);
+  BOOST_CHECK_EQUAL(*one, "one");
+  BOOST_CHECK(table.Find(1) == one);
+  BOOST_CHECK(table.Find(2) != one);
+  BOOST_CHECK(table.Find(3) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadAndCompile)
+{
+  CTempDirectory temp;
+  AddPOFile("/language/English/strings.po", 0, 100, "English");
+  AddPOFile("/skin/language/English/strings.po", 31000, 10, "Skin");
+
+  CTestLocalizeStrings strings;
+  BOOST_REQUIRE(strings.Load("/language/", "English"));
+  BOOST_REQUIRE(strings.LoadSkinStrings("/skin/language/", "English"));
+  BOOST_CHECK_EQUAL(strings.Get(42), "English 42");
+  BOOST_CHECK_EQUAL(strings.Get(31005), "Skin 31005");
+  BOOST_CHECK_EQUAL(strings.Get(20029), "\xb0""C");
+  BOOST_CHECK_EQUAL(strings.Get(100), "");
+
+  // the second load maps what the first one compiled, as long as the file looks unchanged
+  AddPOFile("/language/English/strings.po", 0, 100, "Changed");
+  CLocalizeStrings mapped;
+  BOOST_REQUIRE(mapped.Load("/language/", "English"));
+  BOOST_CHECK_EQUAL(mapped.Get(42), "English 42");
+  AddPOFile("/language/English/strings.po", 0, 101, "Changed");
+  BOOST_REQUIRE(mapped.Load("/language/", "English"));
+  BOOST_CHECK_EQUAL(mapped.Get(42), "Changed 42");
+
+  // a table handed out stays mapped while the skin strings are replaced
+  boost::shared_ptr<CStringTable> table = strings.GetSkinTable();
+  BOOST_REQUIRE(table);
+  strings.ClearSkinStrings();
+  BOOST_CHECK_EQUAL(strings.Get(31005), "");
+  const CStdString *str = table->Find(31005);
+  BOOST_REQUIRE(str != NULL);
+  BOOST_CHECK_EQUAL(*str, "Skin 31005");
+}
+
+BOOST_AUTO_TEST_CASE(TestBlockTables)
+{
+  CTempDirectory temp;
+  AddPOFile("/addons/first/language/English/strings.po", 0, 50, "First");
+  AddPOFile("/addons/second/language/English/strings.po", 0, 50, "Second");
+
+  CLocalizeStrings strings;
+  uint32_t first = strings.LoadBlock("first", "/addons/first/language/", "English");
+  uint32_t second = strings.LoadBlock("second", "/addons/second/language/", "English");
+  BOOST_REQUIRE(first != 0);
+  BOOST_REQUIRE(second != 0);
+  BOOST_CHECK(first != second);
+  BOOST_CHECK_EQUAL(strings.LoadBlock("first", "/addons/first/language/", "English"), first);
+
+  BOOST_CHECK_EQUAL(strings.Get(first + 7), "First 7");
+  BOOST_CHECK_EQUAL(strings.Get(second + 7), "Second 7");
+  BOOST_CHECK_EQUAL(strings.Get(first + 50), "");
+  BOOST_CHECK_EQUAL(strings.Get(7), "");
+
+  strings.ClearBlock("first");
+  BOOST_CHECK_EQUAL(strings.Get(first + 7), "");
+  BOOST_CHECK_EQUAL(strings.Get(second + 7), "Second 7");
+
+  strings.Clear();
+  BOOST_CHECK_EQUAL(strings.Get(second + 7), "");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
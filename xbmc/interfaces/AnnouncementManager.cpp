@@ -20,7 +20,9 @@
  */
 
 #include "AnnouncementManager.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include <stdio.h>
 #include "utils/log.h"
 #include "utils/Variant.h"
@@ -32,12 +34,22 @@
 
 #define LOOKUP_PROPERTY "database-lookup"
 
+// interval of the statistics in the debug log while announcements are delivered asynchronously
+#define STATS_LOG_INTERVAL 60000
+
 using namespace std;
 using namespace ANNOUNCEMENT;
 
 CCriticalSection CAnnouncementManager::m_critSection;
 vector<IAnnouncer *> CAnnouncementManager::m_announcers;
 
+deque<CAnnouncementManager::Announcement> CAnnouncementManager::m_queue;
+CCriticalSection CAnnouncementManager::m_queueSection;
+CEvent CAnnouncementManager::m_queueEvent;
+CAnnouncementManager::CDispatcher *CAnnouncementManager::m_dispatcher = NULL;
+bool CAnnouncementManager::m_stopped = false;
+AnnouncementStats CAnnouncementManager::m_stats = { 0, 0, 0, 0, 0 };
+
 void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
 {
   if (!listener)
@@ -72,11 +84,161 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
+  if (!Queue(flag, sender, message, data))
+    Deliver(flag, sender, message, data);
+}
+
+void CAnnouncementManager::Deinitialize()
+{
+  CDispatcher *dispatcher;
+  {
+    CSingleLock lock (m_queueSection);
+    m_stopped = true;
+    dispatcher = m_dispatcher;
+    m_dispatcher = NULL;
+  }
+
+  if (dispatcher)
+  {
+    dispatcher->Stop();
+    delete dispatcher;
+
+    LogStats();
+  }
+}
+
+void CAnnouncementManager::LogStats()
+{
+  AnnouncementStats stats = GetStats();
+  CLog::Log(LOGDEBUG, "CAnnouncementManager - %"PRIu64" announcements delivered asynchronously, %"PRIu64" coalesced, %"PRIu64" dropped, %u queued, at most %u",
+            stats.delivered, stats.coalesced, stats.dropped, stats.queued, stats.maxQueued);
+}
+
+bool CAnnouncementManager::IsSameAnnouncement(const Announcement &announcement, AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (announcement.flag != flag || announcement.message != message || announcement.sender != sender)
+    return false;
+
+  // announcements about different library or player items are all of interest. the item
+  // identifies them, the rest of the data (e.g. the playback position) may change
+  if (data.isMember("item") || announcement.data.isMember("item"))
+    return announcement.data["item"] == data["item"];
+
+  return announcement.data == data;
+}
+
+AnnouncementStats CAnnouncementManager::GetStats()
+{
+  CSingleLock lock (m_queueSection);
+  AnnouncementStats stats = m_stats;
+  stats.queued = m_queue.size();
+  return stats;
+}
+
+bool CAnnouncementManager::Queue(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (!g_advancedSettings.m_announceAsync || flag == System)
+    return false;
+
+  CSingleLock lock (m_queueSection);
+  if (m_stopped)
+    return false;
+
+  if (m_dispatcher == NULL)
+  {
+    m_dispatcher = new CDispatcher();
+    m_dispatcher->Create();
+  }
+
+  // only the latest of these is of interest, so it replaces the one that wasn't delivered yet
+  if (flag & g_advancedSettings.m_announceCoalesceFlags)
+  {
+    for (deque<Announcement>::iterator it = m_queue.begin(); it != m_queue.end(); it++)
+    {
+      if (IsSameAnnouncement(*it, flag, sender, message, data))
+      {
+        m_queue.erase(it);
+        m_stats.coalesced++;
+        break;
+      }
+    }
+  }
+
+  if (!m_queue.empty() && m_queue.size() >= g_advancedSettings.m_announceQueueSize)
+  {
+    if (m_stats.dropped++ % 100 == 0)
+      CLog::Log(LOGWARNING, "CAnnouncementManager - Queue is full, dropping %s from %s", m_queue.front().message.c_str(), m_queue.front().sender.c_str());
+    m_queue.pop_front();
+  }
+
+  Announcement announcement;
+  announcement.flag = flag;
+  announcement.sender = sender;
+  announcement.message = message;
+  m_queue.push_back(announcement);
+  m_queue.back().data = data;
+
+  if (m_queue.size() > m_stats.maxQueued)
+    m_stats.maxQueued = m_queue.size();
+
+  m_queueEvent.Set();
+  return true;
+}
+
+bool CAnnouncementManager::Dequeue(Announcement &announcement)
+{
+  CSingleLock lock (m_queueSection);
+  if (m_queue.empty())
+    return false;
+
+  announcement = m_queue.front();
+  m_queue.pop_front();
+  m_stats.delivered++;
+  return true;
+}
+
+void CAnnouncementManager::Deliver(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
   CSingleLock lock (m_critSection);
   for (unsigned int i = 0; i < m_announcers.size(); i++)
     m_announcers[i]->Announce(flag, sender, message, data);
 }
 
+void CAnnouncementManager::CDispatcher::Stop()
+{
+  m_bStop = true;
+  m_queueEvent.Set();
+  StopThread(true);
+}
+
+void CAnnouncementManager::CDispatcher::Process()
+{
+  // whatever is still queued is delivered before stopping
+  Announcement announcement;
+  unsigned int lastLog = XbmcThreads::SystemClockMillis();
+  uint64_t lastDelivered = 0;
+  while (true)
+  {
+    if (Dequeue(announcement))
+      Deliver(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.data);
+    else if (m_bStop)
+      break;
+    else
+      m_queueEvent.WaitMSec(STATS_LOG_INTERVAL);
+
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    if (now - lastLog >= STATS_LOG_INTERVAL)
+    {
+      // only while something happens, an idle queue doesn't fill the log
+      uint64_t delivered = GetStats().delivered;
+      if (delivered != lastDelivered)
+        LogStats();
+      lastDelivered = delivered;
+      lastLog = now;
+    }
+  }
+}
+
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
 {
   CVariant data;
@@ -23,10 +23,42 @@
 #include "IAnnouncer.h"
 #include "FileItem.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "utils/Variant.h"
+#include <deque>
+#include <string>
 #include <vector>
 
 namespace ANNOUNCEMENT
 {
+  /*!
+   \brief Statistics of the announcement queue
+   */
+  typedef struct AnnouncementStats
+  {
+    unsigned int queued;     ///< announcements waiting to be delivered
+    unsigned int maxQueued;  ///< most announcements that were waiting at the same time
+    uint64_t     delivered;  ///< announcements delivered from the queue
+    uint64_t     coalesced;  ///< announcements replaced by a newer one before being delivered
+    uint64_t     dropped;    ///< announcements dropped because the queue was full
+  } AnnouncementStats;
+
+  /*!
+   \brief Delivers announcements to all registered IAnnouncer
+
+   Unless disabled in advancedsettings.xml, announcements are queued and
+   delivered by a separate thread, so the announcing thread doesn't wait for
+   slow announcers. For the flags configured to be coalesced, a queued
+   announcement is replaced if the same message is announced again for the
+   same item (or with the same data, if it has no item) before it was
+   delivered. The queue statistics are logged every minute while
+   announcements are delivered.
+
+   System announcements are always delivered synchronously, because the
+   system may shut down or go to sleep right after them. They can overtake
+   queued announcements of other flags.
+   */
   class CAnnouncementManager
   {
   public:
@@ -36,8 +68,45 @@ namespace ANNOUNCEMENT
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
+
+    /*!
+     \brief Delivers all queued announcements and stops the delivering thread.
+     Later announcements are delivered synchronously.
+     */
+    static void Deinitialize();
+    static AnnouncementStats GetStats();
   private:
+    typedef struct Announcement
+    {
+      AnnouncementFlag flag;
+      std::string      sender;
+      std::string      message;
+      CVariant         data;
+    } Announcement;
+
+    class CDispatcher : public CThread
+    {
+    public:
+      CDispatcher() : CThread("CAnnouncementManager") { }
+      void Stop();
+    protected:
+      virtual void Process();
+    };
+
+    static bool Queue(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    static bool Dequeue(Announcement &announcement);
+    static bool IsSameAnnouncement(const Announcement &announcement, AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+    static void LogStats();
+    static void Deliver(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
     static std::vector<IAnnouncer *> m_announcers;
     static CCriticalSection m_critSection;
+
+    static std::deque<Announcement> m_queue;
+    static CCriticalSection m_queueSection;
+    static CEvent m_queueEvent;
+    static CDispatcher *m_dispatcher;
+    static bool m_stopped;
+    static AnnouncementStats m_stats;
   };
 }
@@ -58,7 +58,7 @@ JSONRPC_STATUS CAudioLibrary::GetArtists(const CStdString &method, ITransportLay
 
   CFileItemList items;
   if (musicdatabase.GetArtistsNav("musicdb://2/", items, genreID, albumArtistsOnly))
-    HandleFileItemList("artistid", false, "artists", items, param, result);
+    StreamFileItemList("artistid", false, "artists", items, param, result);
 
   musicdatabase.Close();
   return OK;
@@ -98,7 +98,7 @@ JSONRPC_STATUS CAudioLibrary::GetAlbums(const CStdString &method, ITransportLaye
 
   CFileItemList items;
   if (musicdatabase.GetAlbumsNav("musicdb://3/", items, genreID, artistID, -1, -1))
-    HandleFileItemList("albumid", false, "albums", items, parameterObject, result);
+    StreamFileItemList("albumid", false, "albums", items, parameterObject, result);
 
   musicdatabase.Close();
   return OK;
@@ -142,7 +142,7 @@ JSONRPC_STATUS CAudioLibrary::GetSongs(const CStdString &method, ITransportLayer
 
   CFileItemList items;
   if (musicdatabase.GetSongsNav("musicdb://4/", items, genreID, artistID, albumID))
-    HandleFileItemList("songid", true, "songs", items, parameterObject, result);
+    StreamFileItemList("songid", true, "songs", items, parameterObject, result);
 
   musicdatabase.Close();
   return OK;
@@ -190,7 +190,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyAddedAlbums(const CStdString &method, I
       items.Add(item);
     }
 
-    HandleFileItemList("albumid", false, "albums", items, parameterObject, result);
+    StreamFileItemList("albumid", false, "albums", items, parameterObject, result);
   }
 
   musicdatabase.Close();
@@ -209,7 +209,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyAddedSongs(const CStdString &method, IT
 
   CFileItemList items;
   if (musicdatabase.GetRecentlyAddedAlbumSongs("musicdb://", items, (unsigned int)amount))
-    HandleFileItemList("songid", true, "songs", items, parameterObject, result);
+    StreamFileItemList("songid", true, "songs", items, parameterObject, result);
 
   musicdatabase.Close();
   return OK;
@@ -236,7 +236,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyPlayedAlbums(const CStdString &method,
       items.Add(item);
     }
 
-    HandleFileItemList("albumid", false, "albums", items, parameterObject, result);
+    StreamFileItemList("albumid", false, "albums", items, parameterObject, result);
   }
 
   musicdatabase.Close();
@@ -251,7 +251,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyPlayedSongs(const CStdString &method, I
 
   CFileItemList items;
   if (musicdatabase.GetRecentlyPlayedAlbumSongs("musicdb://", items))
-    HandleFileItemList("songid", true, "songs", items, parameterObject, result);
+    StreamFileItemList("songid", true, "songs", items, parameterObject, result);
 
   musicdatabase.Close();
   return OK;
@@ -270,7 +270,7 @@ JSONRPC_STATUS CAudioLibrary::GetGenres(const CStdString &method, ITransportLaye
     for (unsigned int i = 0; i < (unsigned int)items.Size(); i++)
       items[i]->GetMusicInfoTag()->SetTitle(items[i]->GetLabel());
 
-    HandleFileItemList("genreid", false, "genres", items, parameterObject, result);
+    StreamFileItemList("genreid", false, "genres", items, parameterObject, result);
   }
 
   musicdatabase.Close();
@@ -27,6 +27,7 @@
 #include "FileOperations.h"
 #include "utils/URIUtils.h"
 #include "utils/ISerializable.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/Variant.h"
 #include "video/VideoInfoTag.h"
 #include "music/tags/MusicInfoTag.h"
@@ -175,11 +176,41 @@ void CFileItemHandler::FillDetails(ISerializable* info, CFileItemPtr item, const
   }
 }
 
-void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result)
+class CFileItemHandler::CStreamedFileItemList : public IStreamedValue
+{
+public:
+  CStreamedFileItemList(const char *ID, bool allowFile, const char *resultname, const CVariant &parameterObject)
+    : m_ID(ID), m_allowFile(allowFile), m_resultname(resultname), m_parameterObject(parameterObject)
+  { }
+
+  virtual void Write(CJSONStreamWriter &writer)
+  {
+    const CVariant &fields = m_parameterObject["properties"];
+
+    writer.StartArray();
+    for (std::vector<CFileItemPtr>::const_iterator it = m_items.begin(); it != m_items.end(); it++)
+    {
+      CVariant object;
+      HandleFileItem(m_ID, m_allowFile, m_resultname, *it, m_parameterObject, fields, object, false);
+      writer.WriteValue(object[m_resultname]);
+    }
+    writer.EndArray();
+  }
+
+  std::vector<CFileItemPtr> m_items;
+
+private:
+  const char *m_ID;
+  bool m_allowFile;
+  const char *m_resultname;
+  CVariant m_parameterObject;
+};
+
+void CFileItemHandler::GetLimits(CFileItemList &items, const CVariant &parameterObject, int &start, int &end, CVariant &result)
 {
   int size  = items.Size();
-  int start = (int)parameterObject["limits"]["start"].asInteger();
-  int end   = (int)parameterObject["limits"]["end"].asInteger();
+  start = (int)parameterObject["limits"]["start"].asInteger();
+  end   = (int)parameterObject["limits"]["end"].asInteger();
   end = (end <= 0 || end > size) ? size : end;
   start = start > end ? end : start;
 
@@ -188,6 +219,12 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   result["limits"]["start"] = start;
   result["limits"]["end"]   = end;
   result["limits"]["total"] = size;
+}
+
+void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result)
+{
+  int start, end;
+  GetLimits(items, parameterObject, start, end, result);
 
   for (int i = start; i < end; i++)
   {
@@ -197,6 +234,27 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   }
 }
 
+void CFileItemHandler::StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result)
+{
+  int start, end;
+  GetLimits(items, parameterObject, start, end, result);
+  if (start >= end)
+    return;
+
+  // the items are only serialized while the response is written
+  CStreamedFileItemList *streamed = new CStreamedFileItemList(ID, allowFile, resultname, parameterObject);
+  streamed->m_items.reserve(end - start);
+  for (int i = start; i < end; i++)
+    streamed->m_items.push_back(items.Get(i));
+
+  if (CJSONRPC::StreamResultMember(result, resultname, streamed))
+    return;
+
+  delete streamed;
+  for (int i = start; i < end; i++)
+    HandleFileItem(ID, allowFile, resultname, items.Get(i), parameterObject, parameterObject["properties"], result);
+}
+
 void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append /* = true */)
 {
   CVariant object;
@@ -32,10 +32,19 @@ namespace JSONRPC
   protected:
     static void FillDetails(ISerializable* info, CFileItemPtr item, const CVariant& fields, CVariant &result);
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result);
+    /*!
+     \brief Same as HandleFileItemList() but writes the items directly into the response
+     if possible, instead of adding them to the result first.
+     \sa CJSONRPC::StreamResultMember()
+     */
+    static void StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result);
     static void HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append = true);
 
     static bool FillFileItemList(const CVariant &parameterObject, CFileItemList &list);
   private:
+    class CStreamedFileItemList;
+
+    static void GetLimits(CFileItemList &items, const CVariant &parameterObject, int &start, int &end, CVariant &result);
     static bool ParseSortMethods(const CStdString &method, const bool &ignorethe, const CStdString &order, SORT_METHOD &sortmethod, SORT_ORDER &sortorder);
     static void Sort(CFileItemList &items, const CVariant& parameterObject);
   };
@@ -93,21 +93,23 @@ JSONRPC_STATUS CFileOperations::GetDirectory(const CStdString &method, ITranspor
       return InvalidParams;
   }
 
-  CStdStringArray regexps;
+  // refer to the arrays of the advanced settings, their expressions are compiled already
+  CStdStringArray noRegExps;
+  const CStdStringArray *regexps = &noRegExps;
   CStdString extensions = "";
   if (media.Equals("video"))
   {
-    regexps = g_advancedSettings.m_videoExcludeFromListingRegExps;
+    regexps = &g_advancedSettings.m_videoExcludeFromListingRegExps;
     extensions = g_settings.m_videoExtensions;
   }
   else if (media.Equals("music"))
   {
-    regexps = g_advancedSettings.m_audioExcludeFromListingRegExps;
+    regexps = &g_advancedSettings.m_audioExcludeFromListingRegExps;
     extensions = g_settings.m_musicExtensions;
   }
   else if (media.Equals("pictures"))
   {
-    regexps = g_advancedSettings.m_pictureExcludeFromListingRegExps;
+    regexps = &g_advancedSettings.m_pictureExcludeFromListingRegExps;
     extensions = g_settings.m_pictureExtensions;
   }
 
@@ -116,7 +118,7 @@ JSONRPC_STATUS CFileOperations::GetDirectory(const CStdString &method, ITranspor
     CFileItemList filteredDirectories, filteredFiles;
     for (unsigned int i = 0; i < (unsigned int)items.Size(); i++)
     {
-      if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), regexps))
+      if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), *regexps))
         continue;
 
       if (items[i]->IsSmb())
@@ -269,21 +271,22 @@ bool CFileOperations::FillFileItemList(const CVariant &parameterObject, CFileIte
     {
       CFileItemList items;
       CStdString extensions = "";
-      CStdStringArray regexps;
+      CStdStringArray noRegExps;
+      const CStdStringArray *regexps = &noRegExps;
 
       if (media.Equals("video"))
       {
-        regexps = g_advancedSettings.m_videoExcludeFromListingRegExps;
+        regexps = &g_advancedSettings.m_videoExcludeFromListingRegExps;
         extensions = g_settings.m_videoExtensions;
       }
       else if (media.Equals("music"))
       {
-        regexps = g_advancedSettings.m_audioExcludeFromListingRegExps;
+        regexps = &g_advancedSettings.m_audioExcludeFromListingRegExps;
         extensions = g_settings.m_musicExtensions;
       }
       else if (media.Equals("pictures"))
       {
-        regexps = g_advancedSettings.m_pictureExcludeFromListingRegExps;
+        regexps = &g_advancedSettings.m_pictureExcludeFromListingRegExps;
         extensions = g_settings.m_pictureExtensions;
       }
 
@@ -294,7 +297,7 @@ bool CFileOperations::FillFileItemList(const CVariant &parameterObject, CFileIte
         CFileItemList filteredDirectories;
         for (unsigned int i = 0; i < (unsigned int)items.Size(); i++)
         {
-          if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), regexps))
+          if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), *regexps))
             continue;
 
           if (items[i]->m_bIsFolder)
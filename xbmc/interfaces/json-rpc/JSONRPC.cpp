@@ -25,6 +25,8 @@
 #include "ServiceDescription.h"
 #include "interfaces/AnnouncementManager.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/ThreadLocal.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 
@@ -32,6 +34,45 @@ using namespace ANNOUNCEMENT;
 using namespace JSONRPC;
 using namespace std;
 
+/* the members of a result that are written directly into the response */
+class CStreamedResult
+{
+public:
+  CStreamedResult(const CVariant *result) : m_result(result) { }
+  ~CStreamedResult()
+  {
+    for (map<string, IStreamedValue *>::iterator it = m_values.begin(); it != m_values.end(); it++)
+      delete it->second;
+  }
+
+  void Write(CJSONStreamWriter &writer) const
+  {
+    if (m_values.empty() || !m_result->isObject())
+    {
+      writer.WriteValue(*m_result);
+      return;
+    }
+
+    writer.StartObject();
+    for (CVariant::const_iterator_map itr = m_result->begin_map(); itr != m_result->end_map(); itr++)
+    {
+      writer.WriteKey(itr->first);
+
+      map<string, IStreamedValue *>::const_iterator value = m_values.find(itr->first);
+      if (value != m_values.end())
+        value->second->Write(writer);
+      else
+        writer.WriteValue(itr->second);
+    }
+    writer.EndObject();
+  }
+
+  const CVariant                  *m_result;
+  map<string, IStreamedValue *>    m_values;
+};
+
+static XbmcThreads::ThreadLocal<CStreamedResult> streamedResult;
+
 bool CJSONRPC::m_initialized = false;
 
 void CJSONRPC::Initialize()
@@ -153,11 +194,21 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const CStdString &method, ITransportLayer *tr
 
 CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client)
 {
-  CVariant inputroot, outputroot, result;
+  CStdString str;
+  MethodCall(inputString, transport, client, str);
+  return str;
+}
+
+bool CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client, std::string &output)
+{
+  CVariant inputroot, outputroot;
   bool hasResponse = false;
+  size_t initialSize = output.size();
 
   CLog::Log(LOGDEBUG, "JSONRPC: Incoming request: %s", inputString.c_str());
   inputroot = CJSONVariantParser::Parse((unsigned char *)inputString.c_str(), inputString.length());
+
+  CJSONStreamWriter writer(output, g_advancedSettings.m_jsonOutputCompact);
   if (!inputroot.isNull())
   {
     if (inputroot.isArray())
@@ -166,39 +217,60 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
       {
         CLog::Log(LOGERROR, "JSONRPC: Empty batch call\n");
         BuildResponse(inputroot, InvalidRequest, CVariant(), outputroot);
+        writer.WriteValue(outputroot);
         hasResponse = true;
       }
       else
       {
         for (CVariant::const_iterator_array itr = inputroot.begin_array(); itr != inputroot.end_array(); itr++)
         {
-          CVariant response;
-          if (HandleMethodCall(*itr, response, transport, client))
-          {
-            outputroot.append(response);
+          if (HandleMethodCall(*itr, writer, !hasResponse, transport, client))
             hasResponse = true;
-          }
         }
+
+        if (hasResponse)
+          writer.EndArray();
       }
     }
     else
-      hasResponse = HandleMethodCall(inputroot, outputroot, transport, client);
+      hasResponse = HandleMethodCall(inputroot, writer, false, transport, client);
   }
   else
   {
     CLog::Log(LOGERROR, "JSONRPC: Failed to parse '%s'\n", inputString.c_str());
     BuildResponse(inputroot, ParseError, CVariant(), outputroot);
+    writer.WriteValue(outputroot);
     hasResponse = true;
   }
 
-  CStdString str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
-  return str;
+  if (!writer.IsValid())
+  {
+    CLog::Log(LOGERROR, "JSONRPC: Failed to write the response to '%s'", inputString.c_str());
+    output.resize(initialSize);
+    hasResponse = false;
+  }
+
+  return hasResponse;
 }
 
-bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
+bool CJSONRPC::StreamResultMember(CVariant &result, const std::string &key, IStreamedValue *value)
+{
+  CStreamedResult *streamed = streamedResult.get();
+  if (streamed == NULL || streamed->m_result != &result || streamed->m_values.find(key) != streamed->m_values.end())
+    return false;
+
+  // the placeholder makes sure the member is written in its place
+  result[key] = CVariant(CVariant::VariantTypeNull);
+  streamed->m_values[key] = value;
+
+  return true;
+}
+
+bool CJSONRPC::HandleMethodCall(const CVariant& request, CJSONStreamWriter &writer, bool startBatch, ITransportLayer *transport, IClient *client)
 {
   JSONRPC_STATUS errorCode = OK;
   CVariant result;
+  CStreamedResult streamed(&result);
   bool isNotification = false;
 
   if (IsProperJSONRPC(request))
@@ -213,7 +285,11 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
 
     CLog::Log(LOGDEBUG, "JSONRPC: Calling %s", methodName.c_str());
     if ((errorCode = CJSONServiceDescription::CheckCall(methodName, request["params"], transport, client, isNotification, method, params)) == OK)
+    {
+      streamedResult.set(&streamed);
       errorCode = method(methodName, transport, client, params, result);
+      streamedResult.set(NULL);
+    }
     else
       result = params;
   }
@@ -223,9 +299,28 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     errorCode = InvalidRequest;
   }
 
-  BuildResponse(request, errorCode, result, response);
+  if (isNotification)
+    return false;
+
+  // the result is written separately, so it doesn't have to be copied into the response
+  CVariant response;
+  BuildResponse(request, errorCode, errorCode == OK ? CVariant() : result, response);
+
+  if (startBatch)
+    writer.StartArray();
+
+  writer.StartObject();
+  for (CVariant::const_iterator_map itr = response.begin_map(); itr != response.end_map(); itr++)
+  {
+    writer.WriteKey(itr->first);
+    if (errorCode == OK && itr->first == "result")
+      streamed.Write(writer);
+    else
+      writer.WriteValue(itr->second);
+  }
+  writer.EndObject();
 
-  return !isNotification;
+  return true;
 }
 
 inline bool CJSONRPC::IsProperJSONRPC(const CVariant& inputroot)
@@ -30,8 +30,26 @@
 #include "interfaces/IAnnouncer.h"
 #include "utils/StdString.h"
 
+class CJSONStreamWriter;
+
 namespace JSONRPC
 {
+  /*!
+   \ingroup jsonrpc
+   \brief Part of a method result that is written directly into the response
+
+   Large results, like the items of a library listing, don't have to be built
+   as a CVariant tree first. They are serialized one after the other while
+   the response is written.
+   \sa CJSONRPC::StreamResultMember()
+   */
+  class IStreamedValue
+  {
+  public:
+    virtual ~IStreamedValue() { };
+    virtual void Write(CJSONStreamWriter &writer) = 0;
+  };
+
   /*!
    \ingroup jsonrpc
    \brief JSON RPC handler
@@ -63,6 +81,33 @@ namespace JSONRPC
      */
     static CStdString MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Handles an incoming JSON-RPC request
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param output String the JSON-RPC response is appended to
+     \return True if there is a response to be sent back to the client
+
+     Same as MethodCall() above but writes the response directly into the
+     given output buffer, without building it as a CVariant first.
+     */
+    static bool MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client, std::string &output);
+
+    /*
+     \brief Writes a member of a result object directly into the response
+     \param result The result object of the method call executed by the calling thread
+     \param key The key of the member
+     \param value The value of the member, owned by CJSONRPC if streaming is possible
+     \return True if the value will be streamed, false if it has to be added to the result instead
+
+     Only members of the top level result object can be streamed, and only
+     while the method is called through MethodCall(). The value is written
+     after the method returned successfully, so it must not depend on any
+     state of the method.
+     */
+    static bool StreamResultMember(CVariant &result, const std::string &key, IStreamedValue *value);
+
     static JSONRPC_STATUS Introspect(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -73,7 +118,7 @@ namespace JSONRPC
   
   private:
     static void setup();
-    static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
+    static bool HandleMethodCall(const CVariant& request, CJSONStreamWriter &writer, bool startBatch, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
     inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
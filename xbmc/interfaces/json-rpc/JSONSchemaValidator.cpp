@@ -0,0 +1,406 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "JSONSchemaValidator.h"
+#include "JSONServiceDescription.h"
+
+using namespace std;
+using namespace JSONRPC;
+
+CJSONSchemaValidator::CJSONSchemaValidator()
+  : m_compiled(false)
+{ }
+
+void CJSONSchemaValidator::Compile(const std::vector<JSONSchemaTypeDefinition> &parameters)
+{
+  m_nodes.clear();
+  m_children.clear();
+  m_properties.clear();
+  m_parameters.clear();
+  m_names.clear();
+  m_values.clear();
+  m_compiledTypes.clear();
+
+  for (unsigned int index = 0; index < parameters.size(); index++)
+    m_parameters.push_back(compileProperty(parameters.at(index)));
+
+  // only needed while compiling
+  m_compiledTypes.clear();
+  m_compiled = true;
+}
+
+JSONRPC_STATUS CJSONSchemaValidator::Validate(const CVariant &requestParameters, CVariant &outputParameters) const
+{
+  unsigned int handled = 0;
+  for (unsigned int index = 0; index < m_parameters.size(); index++)
+  {
+    const Property &parameter = m_parameters[index];
+    const std::string &name = m_names[parameter.name];
+
+    // Same lookup as ParameterExists() and GetParameter() but without copying the value
+    const CVariant *value = NULL;
+    if (requestParameters.isObject() && requestParameters.isMember(name))
+      value = &requestParameters[name];
+    else if (requestParameters.isArray() && requestParameters.size() > index)
+      value = &requestParameters[index];
+
+    if (value != NULL)
+    {
+      if (validate(parameter.node, *value, &outputParameters[name]) != OK)
+        return InvalidParams;
+
+      handled++;
+    }
+    else if (parameter.optional)
+      outputParameters[name] = m_values[parameter.defaultValue];
+    else
+      return InvalidParams;
+  }
+
+  if (handled < requestParameters.size())
+    return InvalidParams;
+
+  return OK;
+}
+
+unsigned int CJSONSchemaValidator::compileType(const JSONSchemaTypeDefinition &type)
+{
+  // Every reference to a type holds a complete copy of it,
+  // but it only needs to be compiled once
+  if (!type.ID.empty())
+  {
+    std::map<std::string, unsigned int>::const_iterator compiled = m_compiledTypes.find(type.ID);
+    if (compiled != m_compiledTypes.end())
+      return compiled->second;
+  }
+
+  Node node;
+  node.type = type.type;
+  node.unionTypes = compileTypes(type.unionTypes);
+  node.extends = compileTypes(type.extends);
+  node.items = compileTypes(type.items);
+  node.additionalItems = compileTypes(type.additionalItems);
+  node.minItems = type.minItems;
+  node.maxItems = type.maxItems;
+  node.uniqueItems = type.uniqueItems;
+
+  std::vector<Property> properties;
+  for (JSONSchemaTypeDefinition::CJsonSchemaPropertiesMap::JSONSchemaPropertiesIterator itr = type.properties.begin(); itr != type.properties.end(); itr++)
+    properties.push_back(compileProperty(itr->second));
+  node.properties.first = m_properties.size();
+  node.properties.count = properties.size();
+  m_properties.insert(m_properties.end(), properties.begin(), properties.end());
+
+  node.additionalProperties = -1;
+  node.additionalAny = false;
+  if (type.hasAdditionalProperties && type.additionalProperties != NULL)
+  {
+    node.additionalAny = type.additionalProperties->type == AnyValue;
+    node.additionalProperties = node.additionalAny ? 0 : (int)compileType(*type.additionalProperties);
+  }
+
+  node.enums.first = m_values.size();
+  node.enums.count = type.enums.size();
+  m_values.insert(m_values.end(), type.enums.begin(), type.enums.end());
+
+  node.minimum = type.minimum;
+  node.maximum = type.maximum;
+  node.exclusiveMinimum = type.exclusiveMinimum;
+  node.exclusiveMaximum = type.exclusiveMaximum;
+  node.divisibleBy = type.divisibleBy;
+  node.minLength = type.minLength;
+  node.maxLength = type.maxLength;
+
+  unsigned int index = m_nodes.size();
+  m_nodes.push_back(node);
+
+  if (!type.ID.empty())
+    m_compiledTypes[type.ID] = index;
+
+  return index;
+}
+
+CJSONSchemaValidator::Range CJSONSchemaValidator::compileTypes(const std::vector<JSONSchemaTypeDefinition> &types)
+{
+  // compile the types first, they add their own children
+  std::vector<unsigned int> nodes;
+  for (unsigned int index = 0; index < types.size(); index++)
+    nodes.push_back(compileType(types.at(index)));
+
+  Range range;
+  range.first = m_children.size();
+  range.count = nodes.size();
+  m_children.insert(m_children.end(), nodes.begin(), nodes.end());
+
+  return range;
+}
+
+CJSONSchemaValidator::Property CJSONSchemaValidator::compileProperty(const JSONSchemaTypeDefinition &type)
+{
+  Property property;
+  property.name = internName(type.name);
+  property.node = compileType(type);
+  property.optional = type.optional;
+  property.defaultValue = addValue(type.defaultValue);
+
+  return property;
+}
+
+unsigned int CJSONSchemaValidator::internName(const std::string &name)
+{
+  for (unsigned int index = 0; index < m_names.size(); index++)
+  {
+    if (m_names[index] == name)
+      return index;
+  }
+
+  m_names.push_back(name);
+  return m_names.size() - 1;
+}
+
+unsigned int CJSONSchemaValidator::addValue(const CVariant &value)
+{
+  m_values.push_back(value);
+  return m_values.size() - 1;
+}
+
+bool CJSONSchemaValidator::hasProperty(const Node &node, const std::string &name) const
+{
+  // the properties are sorted by name
+  unsigned int first = node.properties.first;
+  unsigned int last = node.properties.first + node.properties.count;
+  while (first < last)
+  {
+    unsigned int middle = first + (last - first) / 2;
+    int compare = m_names[m_properties[middle].name].compare(name);
+    if (compare == 0)
+      return true;
+    else if (compare < 0)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+
+  return false;
+}
+
+JSONRPC_STATUS CJSONSchemaValidator::validate(unsigned int nodeIndex, const CVariant &value, CVariant *output) const
+{
+  // Mirrors JSONSchemaTypeDefinition::Check() without building any error data.
+  // Without an output only the validity of the value is checked.
+  const Node &node = m_nodes[nodeIndex];
+
+  if (!IsType(value, node.type))
+    return InvalidParams;
+  else if (value.isNull() && !HasType(node.type, NullValue))
+    return InvalidParams;
+
+  if (node.unionTypes.count > 0)
+  {
+    // Find the matching union type before writing anything
+    unsigned int unionIndex;
+    for (unionIndex = 0; unionIndex < node.unionTypes.count; unionIndex++)
+    {
+      if (validate(m_children[node.unionTypes.first + unionIndex], value, NULL) == OK)
+        break;
+    }
+
+    if (unionIndex >= node.unionTypes.count)
+      return InvalidParams;
+
+    if (output != NULL)
+      validate(m_children[node.unionTypes.first + unionIndex], value, output);
+  }
+
+  for (unsigned int extendsIndex = 0; extendsIndex < node.extends.count; extendsIndex++)
+  {
+    if (validate(m_children[node.extends.first + extendsIndex], value, output) != OK)
+      return InvalidParams;
+  }
+
+  if (HasType(node.type, ArrayValue) && value.isArray())
+  {
+    // uniqueness is checked on the output values
+    CVariant uniqueOutput;
+    if (node.uniqueItems && output == NULL)
+      output = &uniqueOutput;
+
+    if (output != NULL)
+      *output = CVariant(CVariant::VariantTypeArray);
+
+    if ((node.minItems > 0 && value.size() < node.minItems) || (node.maxItems > 0 && value.size() > node.maxItems))
+      return InvalidParams;
+
+    if (node.items.count == 0)
+    {
+      if (output != NULL)
+        *output = value;
+    }
+    else if (node.items.count == 1)
+    {
+      unsigned int item = m_children[node.items.first];
+      for (unsigned int arrayIndex = 0; arrayIndex < value.size(); arrayIndex++)
+      {
+        CVariant *temp = NULL;
+        if (output != NULL)
+        {
+          output->push_back(CVariant(CVariant::VariantTypeNull));
+          temp = &(*output)[output->size() - 1];
+        }
+
+        if (validate(item, value[arrayIndex], temp) != OK)
+          return InvalidParams;
+      }
+    }
+    else
+    {
+      if (value.size() < node.items.count || (value.size() != node.items.count && node.additionalItems.count == 0))
+        return InvalidParams;
+
+      unsigned int arrayIndex;
+      for (arrayIndex = 0; arrayIndex < node.items.count; arrayIndex++)
+      {
+        if (validate(m_children[node.items.first + arrayIndex], value[arrayIndex], output != NULL ? &(*output)[arrayIndex] : NULL) != OK)
+          return InvalidParams;
+      }
+
+      for (; arrayIndex < value.size(); arrayIndex++)
+      {
+        unsigned int additionalIndex;
+        for (additionalIndex = 0; additionalIndex < node.additionalItems.count; additionalIndex++)
+        {
+          if (validate(m_children[node.additionalItems.first + additionalIndex], value[arrayIndex], NULL) == OK)
+            break;
+        }
+
+        if (additionalIndex >= node.additionalItems.count)
+          return InvalidParams;
+
+        if (output != NULL)
+          validate(m_children[node.additionalItems.first + additionalIndex], value[arrayIndex], &(*output)[arrayIndex]);
+      }
+    }
+
+    if (node.uniqueItems)
+    {
+      for (unsigned int checkingIndex = 0; checkingIndex < output->size(); checkingIndex++)
+      {
+        for (unsigned int checkedIndex = checkingIndex + 1; checkedIndex < output->size(); checkedIndex++)
+        {
+          if ((*output)[checkingIndex] == (*output)[checkedIndex])
+            return InvalidParams;
+        }
+      }
+    }
+
+    return OK;
+  }
+
+  if (HasType(node.type, ObjectValue) && value.isObject())
+  {
+    unsigned int handled = 0;
+    for (unsigned int propertyIndex = 0; propertyIndex < node.properties.count; propertyIndex++)
+    {
+      const Property &property = m_properties[node.properties.first + propertyIndex];
+      const std::string &name = m_names[property.name];
+
+      if (value.isMember(name))
+      {
+        if (validate(property.node, value[name], output != NULL ? &(*output)[name] : NULL) != OK)
+          return InvalidParams;
+        handled++;
+      }
+      else if (property.optional)
+      {
+        if (output != NULL)
+          (*output)[name] = m_values[property.defaultValue];
+      }
+      else
+        return InvalidParams;
+    }
+
+    if (handled < value.size())
+    {
+      if (node.additionalProperties < 0)
+        return InvalidParams;
+
+      for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map(); itr++)
+      {
+        if (hasProperty(node, itr->first))
+          continue;
+
+        if (node.additionalAny)
+        {
+          if (output != NULL)
+            (*output)[itr->first] = itr->second;
+        }
+        else if (validate(node.additionalProperties, itr->second, output != NULL ? &(*output)[itr->first] : NULL) != OK)
+          return InvalidParams;
+      }
+    }
+
+    return OK;
+  }
+
+  if (node.enums.count > 0)
+  {
+    bool valid = false;
+    for (unsigned int enumIndex = 0; enumIndex < node.enums.count; enumIndex++)
+    {
+      if (m_values[node.enums.first + enumIndex] == value)
+      {
+        valid = true;
+        break;
+      }
+    }
+
+    if (!valid)
+      return InvalidParams;
+  }
+
+  if ((HasType(node.type, NumberValue) && value.isDouble()) || (HasType(node.type, IntegerValue) && value.isInteger()))
+  {
+    double numberValue;
+    if (value.isDouble())
+      numberValue = value.asDouble();
+    else
+      numberValue = (double)value.asInteger();
+
+    if ((node.exclusiveMinimum && numberValue <= node.minimum) || (!node.exclusiveMinimum && numberValue < node.minimum) ||
+        (node.exclusiveMaximum && numberValue >= node.maximum) || (!node.exclusiveMaximum && numberValue > node.maximum))
+      return InvalidParams;
+
+    if (HasType(node.type, IntegerValue) && node.divisibleBy > 0 && ((int)numberValue % node.divisibleBy) != 0)
+      return InvalidParams;
+  }
+
+  if (HasType(node.type, StringValue) && value.isString())
+  {
+    int size = value.size();
+    if (size < node.minLength || (node.maxLength >= 0 && size > node.maxLength))
+      return InvalidParams;
+  }
+
+  if (output != NULL)
+    *output = value;
+
+  return OK;
+}
@@ -0,0 +1,128 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "JSONUtils.h"
+
+namespace JSONRPC
+{
+  class JSONSchemaTypeDefinition;
+
+  /*!
+   \ingroup jsonrpc
+   \brief Validates the parameters of a json rpc method call against
+   a flat, precompiled copy of the method's parameter schema.
+
+   The schema tree of a method is compiled once into an array of nodes
+   which refer to each other by index. Referenced types are only compiled
+   once per method, property names are stored once and union types are
+   tried without building any output. Validating a call therefore doesn't
+   copy any part of the schema and doesn't allocate anything but the
+   output parameters.
+
+   The validator only tells whether a call is valid. The detailed error
+   data for an invalid call is still built by JSONSchemaTypeDefinition::Check().
+   */
+  class CJSONSchemaValidator : protected CJSONUtils
+  {
+  public:
+    CJSONSchemaValidator();
+
+    /*!
+     \brief Compiles the given parameter definitions of a method
+     \param parameters Parameters of the method
+     */
+    void Compile(const std::vector<JSONSchemaTypeDefinition> &parameters);
+
+    /*!
+     \brief Whether Compile() has been called
+     */
+    bool IsCompiled() const { return m_compiled; }
+
+    /*!
+     \brief Validates the parameters of a method call
+     \param requestParameters Parameters from the request
+     \param outputParameters Cleaned up parameter list, only valid if OK is returned
+     \return OK if the parameters are valid otherwise InvalidParams
+     */
+    JSONRPC_STATUS Validate(const CVariant &requestParameters, CVariant &outputParameters) const;
+
+  private:
+    typedef struct Range
+    {
+      unsigned int first;
+      unsigned int count;
+    } Range;
+
+    typedef struct Node
+    {
+      JSONSchemaType type;
+      Range unionTypes;           ///< node indexes in m_children
+      Range extends;              ///< node indexes in m_children
+      Range items;                ///< node indexes in m_children
+      Range additionalItems;      ///< node indexes in m_children
+      unsigned int minItems;
+      unsigned int maxItems;
+      bool uniqueItems;
+      Range properties;           ///< in m_properties, sorted by name
+      int additionalProperties;   ///< node index, -1 if additional properties are not allowed
+      bool additionalAny;         ///< additional properties are copied without checking them
+      Range enums;                ///< in m_values
+      double minimum;
+      double maximum;
+      bool exclusiveMinimum;
+      bool exclusiveMaximum;
+      unsigned int divisibleBy;
+      int minLength;
+      int maxLength;
+    } Node;
+
+    typedef struct Property
+    {
+      unsigned int name;          ///< index in m_names
+      unsigned int node;
+      bool optional;
+      unsigned int defaultValue;  ///< index in m_values
+    } Property;
+
+    unsigned int compileType(const JSONSchemaTypeDefinition &type);
+    Range compileTypes(const std::vector<JSONSchemaTypeDefinition> &types);
+    Property compileProperty(const JSONSchemaTypeDefinition &type);
+    unsigned int internName(const std::string &name);
+    unsigned int addValue(const CVariant &value);
+
+    JSONRPC_STATUS validate(unsigned int node, const CVariant &value, CVariant *output) const;
+    bool hasProperty(const Node &node, const std::string &name) const;
+
+    bool m_compiled;
+    std::vector<Node> m_nodes;
+    std::vector<unsigned int> m_children;
+    std::vector<Property> m_properties;
+    std::vector<Property> m_parameters;
+    std::vector<std::string> m_names;
+    std::vector<CVariant> m_values;
+    std::map<std::string, unsigned int> m_compiledTypes;  ///< node index of every compiled reference type
+  };
+}
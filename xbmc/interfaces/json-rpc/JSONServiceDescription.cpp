@@ -24,18 +24,6 @@
 #include "utils/log.h"
 #include "utils/StdString.h"
 #include "utils/JSONVariantParser.h"
-#include "JSONRPC.h"
-#include "PlayerOperations.h"
-#include "PlaylistOperations.h"
-#include "FileOperations.h"
-#include "AudioLibrary.h"
-#include "VideoLibrary.h"
-#include "GUIOperations.h"
-#include "SystemOperations.h"
-#include "InputOperations.h"
-#include "XBMCOperations.h"
-#include "ApplicationOperations.h"
-#include "PVROperations.h"
 
 using namespace std;
 using namespace JSONRPC;
@@ -45,156 +33,6 @@ CJSONServiceDescription::CJsonRpcMethodMap CJSONServiceDescription::m_actionMap;
 std::map<std::string, JSONSchemaTypeDefinition> CJSONServiceDescription::m_types = std::map<std::string, JSONSchemaTypeDefinition>();
 CJSONServiceDescription::IncompleteSchemaDefinitionMap CJSONServiceDescription::m_incompleteDefinitions = CJSONServiceDescription::IncompleteSchemaDefinitionMap();
 
-JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
-// JSON-RPC
-  { "JSONRPC.Introspect",                           CJSONRPC::Introspect },
-  { "JSONRPC.Version",                              CJSONRPC::Version },
-  { "JSONRPC.Permission",                           CJSONRPC::Permission },
-  { "JSONRPC.Ping",                                 CJSONRPC::Ping },
-  { "JSONRPC.GetConfiguration",                     CJSONRPC::GetConfiguration },
-  { "JSONRPC.SetConfiguration",                     CJSONRPC::SetConfiguration },
-  { "JSONRPC.NotifyAll",                            CJSONRPC::NotifyAll },
-
-// Player
-  { "Player.GetActivePlayers",                      CPlayerOperations::GetActivePlayers },
-  { "Player.GetProperties",                         CPlayerOperations::GetProperties },
-  { "Player.GetItem",                               CPlayerOperations::GetItem },
-
-  { "Player.PlayPause",                             CPlayerOperations::PlayPause },
-  { "Player.Stop",                                  CPlayerOperations::Stop },
-  { "Player.SetSpeed",                              CPlayerOperations::SetSpeed },
-  { "Player.Seek",                                  CPlayerOperations::Seek },
-
-  { "Player.MoveLeft",                              CPlayerOperations::MoveLeft },
-  { "Player.MoveRight",                             CPlayerOperations::MoveRight },
-  { "Player.MoveDown",                              CPlayerOperations::MoveDown },
-  { "Player.MoveUp",                                CPlayerOperations::MoveUp },
-
-  { "Player.ZoomOut",                               CPlayerOperations::ZoomOut },
-  { "Player.ZoomIn",                                CPlayerOperations::ZoomIn },
-  { "Player.Zoom",                                  CPlayerOperations::Zoom },
-  { "Player.Rotate",                                CPlayerOperations::Rotate },
-  
-  { "Player.Open",                                  CPlayerOperations::Open },
-  { "Player.GoPrevious",                            CPlayerOperations::GoPrevious },
-  { "Player.GoNext",                                CPlayerOperations::GoNext },
-  { "Player.GoTo",                                  CPlayerOperations::GoTo },
-  { "Player.Shuffle",                               CPlayerOperations::Shuffle },
-  { "Player.UnShuffle",                             CPlayerOperations::UnShuffle },
-  { "Player.Repeat",                                CPlayerOperations::Repeat },
-  
-  { "Player.SetAudioStream",                        CPlayerOperations::SetAudioStream },
-  { "Player.SetSubtitle",                           CPlayerOperations::SetSubtitle },
-
-// Playlist
-  { "Playlist.GetPlaylists",                        CPlaylistOperations::GetPlaylists },
-  { "Playlist.GetProperties",                       CPlaylistOperations::GetProperties },
-  { "Playlist.GetItems",                            CPlaylistOperations::GetItems },
-  { "Playlist.Add",                                 CPlaylistOperations::Add },
-  { "Playlist.Insert",                              CPlaylistOperations::Insert },
-  { "Playlist.Clear",                               CPlaylistOperations::Clear },
-  { "Playlist.Remove",                              CPlaylistOperations::Remove },
-  { "Playlist.Swap",                                CPlaylistOperations::Swap },
-
-// Files
-  { "Files.GetSources",                             CFileOperations::GetRootDirectory },
-  { "Files.GetDirectory",                           CFileOperations::GetDirectory },
-  { "Files.PrepareDownload",                        CFileOperations::PrepareDownload },
-  { "Files.Download",                               CFileOperations::Download },
-
-// Music Library
-  { "AudioLibrary.GetArtists",                      CAudioLibrary::GetArtists },
-  { "AudioLibrary.GetArtistDetails",                CAudioLibrary::GetArtistDetails },
-  { "AudioLibrary.GetAlbums",                       CAudioLibrary::GetAlbums },
-  { "AudioLibrary.GetAlbumDetails",                 CAudioLibrary::GetAlbumDetails },
-  { "AudioLibrary.GetSongs",                        CAudioLibrary::GetSongs },
-  { "AudioLibrary.GetSongDetails",                  CAudioLibrary::GetSongDetails },
-  { "AudioLibrary.GetRecentlyAddedAlbums",          CAudioLibrary::GetRecentlyAddedAlbums },
-  { "AudioLibrary.GetRecentlyAddedSongs",           CAudioLibrary::GetRecentlyAddedSongs },
-  { "AudioLibrary.GetRecentlyPlayedAlbums",         CAudioLibrary::GetRecentlyPlayedAlbums },
-  { "AudioLibrary.GetRecentlyPlayedSongs",          CAudioLibrary::GetRecentlyPlayedSongs },
-  { "AudioLibrary.GetGenres",                       CAudioLibrary::GetGenres },
-  { "AudioLibrary.SetArtistDetails",                CAudioLibrary::SetArtistDetails },
-  { "AudioLibrary.SetAlbumDetails",                 CAudioLibrary::SetAlbumDetails },
-  { "AudioLibrary.SetSongDetails",                  CAudioLibrary::SetSongDetails },
-  { "AudioLibrary.Scan",                            CAudioLibrary::Scan },
-  { "AudioLibrary.Export",                          CAudioLibrary::Export },
-  { "AudioLibrary.Clean",                           CAudioLibrary::Clean },
-
-// Video Library
-  { "VideoLibrary.GetGenres",                       CVideoLibrary::GetGenres },
-  { "VideoLibrary.GetMovies",                       CVideoLibrary::GetMovies },
-  { "VideoLibrary.GetMovieDetails",                 CVideoLibrary::GetMovieDetails },
-  { "VideoLibrary.GetMovieSets",                    CVideoLibrary::GetMovieSets },
-  { "VideoLibrary.GetMovieSetDetails",              CVideoLibrary::GetMovieSetDetails },
-  { "VideoLibrary.GetTVShows",                      CVideoLibrary::GetTVShows },
-  { "VideoLibrary.GetTVShowDetails",                CVideoLibrary::GetTVShowDetails },
-  { "VideoLibrary.GetSeasons",                      CVideoLibrary::GetSeasons },
-  { "VideoLibrary.GetEpisodes",                     CVideoLibrary::GetEpisodes },
-  { "VideoLibrary.GetEpisodeDetails",               CVideoLibrary::GetEpisodeDetails },
-  { "VideoLibrary.GetMusicVideos",                  CVideoLibrary::GetMusicVideos },
-  { "VideoLibrary.GetMusicVideoDetails",            CVideoLibrary::GetMusicVideoDetails },
-  { "VideoLibrary.GetRecentlyAddedMovies",          CVideoLibrary::GetRecentlyAddedMovies },
-  { "VideoLibrary.GetRecentlyAddedEpisodes",        CVideoLibrary::GetRecentlyAddedEpisodes },
-  { "VideoLibrary.GetRecentlyAddedMusicVideos",     CVideoLibrary::GetRecentlyAddedMusicVideos },
-  { "VideoLibrary.SetMovieDetails",                 CVideoLibrary::SetMovieDetails },
-  { "VideoLibrary.SetTVShowDetails",                CVideoLibrary::SetTVShowDetails },
-  { "VideoLibrary.SetEpisodeDetails",               CVideoLibrary::SetEpisodeDetails },
-  { "VideoLibrary.SetMusicVideoDetails",            CVideoLibrary::SetMusicVideoDetails },
-  { "VideoLibrary.RemoveMovie",                     CVideoLibrary::RemoveMovie },
-  { "VideoLibrary.RemoveTVShow",                    CVideoLibrary::RemoveTVShow },
-  { "VideoLibrary.RemoveEpisode",                   CVideoLibrary::RemoveEpisode },
-  { "VideoLibrary.RemoveMusicVideo",                CVideoLibrary::RemoveMusicVideo },
-  { "VideoLibrary.Scan",                            CVideoLibrary::Scan },
-  { "VideoLibrary.Export",                          CVideoLibrary::Export },
-  { "VideoLibrary.Clean",                           CVideoLibrary::Clean },
-
-// GUI operations
-  { "GUI.GetProperties",                            CGUIOperations::GetProperties },
-  { "GUI.ShowNotification",                         CGUIOperations::ShowNotification },
-  { "GUI.SetFullscreen",                            CGUIOperations::SetFullscreen },
-
-// System operations
-  { "System.GetProperties",                         CSystemOperations::GetProperties },
-  { "System.EjectOpticalDrive",                     CSystemOperations::EjectOpticalDrive },
-  { "System.Shutdown",                              CSystemOperations::Shutdown },
-  { "System.Suspend",                               CSystemOperations::Suspend },
-  { "System.Hibernate",                             CSystemOperations::Hibernate },
-  { "System.Reboot",                                CSystemOperations::Reboot },
-
-// Input operations
-  { "Input.Left",                                   CInputOperations::Left },
-  { "Input.Right",                                  CInputOperations::Right },
-  { "Input.Down",                                   CInputOperations::Down },
-  { "Input.Up",                                     CInputOperations::Up },
-  { "Input.Select",                                 CInputOperations::Select },
-  { "Input.Back",                                   CInputOperations::Back },
-  { "Input.ContextMenu",                            CInputOperations::ContextMenu },
-  { "Input.Info",                                   CInputOperations::Info },
-  { "Input.Home",                                   CInputOperations::Home },
-
-// Application operations
-  { "Application.GetProperties",                    CApplicationOperations::GetProperties },
-  { "Application.SetVolume",                        CApplicationOperations::SetVolume },
-  { "Application.SetMute",                          CApplicationOperations::SetMute },
-  { "Application.Quit",                             CApplicationOperations::Quit },
-
-// XBMC operations
-  { "XBMC.GetInfoLabels",                           CXBMCOperations::GetInfoLabels },
-  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans },
-
-// PVR operations
-  { "PVR.ChannelSwitch",                            CPVROperations::ChannelSwitch },
-  { "PVR.ChannelUp",                                CPVROperations::ChannelUp },
-  { "PVR.ChannelDown",                              CPVROperations::ChannelDown },
-  { "PVR.RecordCurrentChannel",                     CPVROperations::RecordCurrentChannel },
-  { "PVR.ScheduleRecording",                        CPVROperations::ScheduleRecording },
-  { "PVR.IsAvailable",                              CPVROperations::IsAvailable },
-  { "PVR.IsScanningChannels",                       CPVROperations::IsScanningChannels },
-  { "PVR.IsRecording",                              CPVROperations::IsRecording },
-  { "PVR.ScanChannels",                             CPVROperations::ScanChannels }
-};
-
 JSONSchemaTypeDefinition::JSONSchemaTypeDefinition()
   : missingReference(""),
     type(AnyValue), minimum(std::numeric_limits<double>::min()), maximum(std::numeric_limits<double>::max()),
@@ -674,7 +512,7 @@ JSONRPC_STATUS JSONSchemaTypeDefinition::Check(const CVariant &value, CVariant &
       outputValue = value;
     else if (items.size() == 1)
     {
-      JSONSchemaTypeDefinition itemType = items.at(0);
+      const JSONSchemaTypeDefinition &itemType = items.at(0);
 
       // Loop through all array elements
       for (unsigned int arrayIndex = 0; arrayIndex < value.size(); arrayIndex++)
@@ -1193,6 +1031,8 @@ bool JsonRpcMethod::Parse(const CVariant &value)
     return false;
   }
 
+  m_validator.Compile(parameters);
+
   return true;
 }
 
@@ -1204,6 +1044,12 @@ JSONRPC_STATUS JsonRpcMethod::Check(const CVariant &requestParameters, ITranspor
     {
       methodCall = method;
 
+      // Valid calls only need the precompiled validator. The schema
+      // tree is only walked to describe what is wrong with a call
+      if (m_validator.IsCompiled() && m_validator.Validate(requestParameters, outputParameters) == OK)
+        return OK;
+      outputParameters = CVariant();
+
       // Count the number of actually handled (present)
       // parameters
       unsigned int handled = 0;
@@ -1369,8 +1215,7 @@ bool CJSONServiceDescription::addMethod(const std::string &jsonMethod, MethodCal
 
   if (method == NULL)
   {
-    unsigned int size = sizeof(m_methodMaps) / sizeof(JsonRpcMethodMap);
-    for (unsigned int index = 0; index < size; index++)
+    for (unsigned int index = 0; index < m_methodMapsSize; index++)
     {
       if (methodName.compare(m_methodMaps[index].name) == 0)
       {
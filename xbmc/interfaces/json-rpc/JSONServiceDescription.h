@@ -25,6 +25,7 @@
 #include <limits>
 
 #include "JSONUtils.h"
+#include "JSONSchemaValidator.h"
 
 namespace JSONRPC
 {
@@ -262,6 +263,13 @@ namespace JSONRPC
   private:
     bool parseParameter(const CVariant &value, JSONSchemaTypeDefinition &parameter);
     bool parseReturn(const CVariant &value);
+
+    /*!
+     \brief Precompiled copy of the parameter definitions
+     used to validate calls without walking the schema tree
+     */
+    CJSONSchemaValidator m_validator;
+
     static JSONRPC_STATUS checkParameter(const CVariant &requestParameters, const JSONSchemaTypeDefinition &type, unsigned int position, CVariant &outputParameters, unsigned int &handled, CVariant &errorData);
   };
 
@@ -404,7 +412,10 @@ namespace JSONRPC
     static CJsonRpcMethodMap m_actionMap;
     static std::map<std::string, JSONSchemaTypeDefinition> m_types;
     static std::map<std::string, CVariant> m_notifications;
+    // implementations of the builtin methods, defined in JSONServiceMethods.cpp
+    // so the schema handling can be linked without the method implementations
     static JsonRpcMethodMap m_methodMaps[];
+    static const unsigned int m_methodMapsSize;
 
     typedef enum SchemaDefinition
     {
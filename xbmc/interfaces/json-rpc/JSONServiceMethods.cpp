@@ -0,0 +1,188 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "JSONServiceDescription.h"
+#include "JSONRPC.h"
+#include "PlayerOperations.h"
+#include "PlaylistOperations.h"
+#include "FileOperations.h"
+#include "AudioLibrary.h"
+#include "VideoLibrary.h"
+#include "GUIOperations.h"
+#include "SystemOperations.h"
+#include "InputOperations.h"
+#include "XBMCOperations.h"
+#include "ApplicationOperations.h"
+#include "PVROperations.h"
+
+using namespace JSONRPC;
+
+JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
+// JSON-RPC
+  { "JSONRPC.Introspect",                           CJSONRPC::Introspect },
+  { "JSONRPC.Version",                              CJSONRPC::Version },
+  { "JSONRPC.Permission",                           CJSONRPC::Permission },
+  { "JSONRPC.Ping",                                 CJSONRPC::Ping },
+  { "JSONRPC.GetConfiguration",                     CJSONRPC::GetConfiguration },
+  { "JSONRPC.SetConfiguration",                     CJSONRPC::SetConfiguration },
+  { "JSONRPC.NotifyAll",                            CJSONRPC::NotifyAll },
+
+// Player
+  { "Player.GetActivePlayers",                      CPlayerOperations::GetActivePlayers },
+  { "Player.GetProperties",                         CPlayerOperations::GetProperties },
+  { "Player.GetItem",                               CPlayerOperations::GetItem },
+
+  { "Player.PlayPause",                             CPlayerOperations::PlayPause },
+  { "Player.Stop",                                  CPlayerOperations::Stop },
+  { "Player.SetSpeed",                              CPlayerOperations::SetSpeed },
+  { "Player.Seek",                                  CPlayerOperations::Seek },
+
+  { "Player.MoveLeft",                              CPlayerOperations::MoveLeft },
+  { "Player.MoveRight",                             CPlayerOperations::MoveRight },
+  { "Player.MoveDown",                              CPlayerOperations::MoveDown },
+  { "Player.MoveUp",                                CPlayerOperations::MoveUp },
+
+  { "Player.ZoomOut",                               CPlayerOperations::ZoomOut },
+  { "Player.ZoomIn",                                CPlayerOperations::ZoomIn },
+  { "Player.Zoom",                                  CPlayerOperations::Zoom },
+  { "Player.Rotate",                                CPlayerOperations::Rotate },
+  
+  { "Player.Open",                                  CPlayerOperations::Open },
+  { "Player.GoPrevious",                            CPlayerOperations::GoPrevious },
+  { "Player.GoNext",                                CPlayerOperations::GoNext },
+  { "Player.GoTo",                                  CPlayerOperations::GoTo },
+  { "Player.Shuffle",                               CPlayerOperations::Shuffle },
+  { "Player.UnShuffle",                             CPlayerOperations::UnShuffle },
+  { "Player.Repeat",                                CPlayerOperations::Repeat },
+  
+  { "Player.SetAudioStream",                        CPlayerOperations::SetAudioStream },
+  { "Player.SetSubtitle",                           CPlayerOperations::SetSubtitle },
+
+// Playlist
+  { "Playlist.GetPlaylists",                        CPlaylistOperations::GetPlaylists },
+  { "Playlist.GetProperties",                       CPlaylistOperations::GetProperties },
+  { "Playlist.GetItems",                            CPlaylistOperations::GetItems },
+  { "Playlist.Add",                                 CPlaylistOperations::Add },
+  { "Playlist.Insert",                              CPlaylistOperations::Insert },
+  { "Playlist.Clear",                               CPlaylistOperations::Clear },
+  { "Playlist.Remove",                              CPlaylistOperations::Remove },
+  { "Playlist.Swap",                                CPlaylistOperations::Swap },
+
+// Files
+  { "Files.GetSources",                             CFileOperations::GetRootDirectory },
+  { "Files.GetDirectory",                           CFileOperations::GetDirectory },
+  { "Files.PrepareDownload",                        CFileOperations::PrepareDownload },
+  { "Files.Download",                               CFileOperations::Download },
+
+// Music Library
+  { "AudioLibrary.GetArtists",                      CAudioLibrary::GetArtists },
+  { "AudioLibrary.GetArtistDetails",                CAudioLibrary::GetArtistDetails },
+  { "AudioLibrary.GetAlbums",                       CAudioLibrary::GetAlbums },
+  { "AudioLibrary.GetAlbumDetails",                 CAudioLibrary::GetAlbumDetails },
+  { "AudioLibrary.GetSongs",                        CAudioLibrary::GetSongs },
+  { "AudioLibrary.GetSongDetails",                  CAudioLibrary::GetSongDetails },
+  { "AudioLibrary.GetRecentlyAddedAlbums",          CAudioLibrary::GetRecentlyAddedAlbums },
+  { "AudioLibrary.GetRecentlyAddedSongs",           CAudioLibrary::GetRecentlyAddedSongs },
+  { "AudioLibrary.GetRecentlyPlayedAlbums",         CAudioLibrary::GetRecentlyPlayedAlbums },
+  { "AudioLibrary.GetRecentlyPlayedSongs",          CAudioLibrary::GetRecentlyPlayedSongs },
+  { "AudioLibrary.GetGenres",                       CAudioLibrary::GetGenres },
+  { "AudioLibrary.SetArtistDetails",                CAudioLibrary::SetArtistDetails },
+  { "AudioLibrary.SetAlbumDetails",                 CAudioLibrary::SetAlbumDetails },
+  { "AudioLibrary.SetSongDetails",                  CAudioLibrary::SetSongDetails },
+  { "AudioLibrary.Scan",                            CAudioLibrary::Scan },
+  { "AudioLibrary.Export",                          CAudioLibrary::Export },
+  { "AudioLibrary.Clean",                           CAudioLibrary::Clean },
+
+// Video Library
+  { "VideoLibrary.GetGenres",                       CVideoLibrary::GetGenres },
+  { "VideoLibrary.GetMovies",                       CVideoLibrary::GetMovies },
+  { "VideoLibrary.GetMovieDetails",                 CVideoLibrary::GetMovieDetails },
+  { "VideoLibrary.GetMovieSets",                    CVideoLibrary::GetMovieSets },
+  { "VideoLibrary.GetMovieSetDetails",              CVideoLibrary::GetMovieSetDetails },
+  { "VideoLibrary.GetTVShows",                      CVideoLibrary::GetTVShows },
+  { "VideoLibrary.GetTVShowDetails",                CVideoLibrary::GetTVShowDetails },
+  { "VideoLibrary.GetSeasons",                      CVideoLibrary::GetSeasons },
+  { "VideoLibrary.GetEpisodes",                     CVideoLibrary::GetEpisodes },
+  { "VideoLibrary.GetEpisodeDetails",               CVideoLibrary::GetEpisodeDetails },
+  { "VideoLibrary.GetMusicVideos",                  CVideoLibrary::GetMusicVideos },
+  { "VideoLibrary.GetMusicVideoDetails",            CVideoLibrary::GetMusicVideoDetails },
+  { "VideoLibrary.GetRecentlyAddedMovies",          CVideoLibrary::GetRecentlyAddedMovies },
+  { "VideoLibrary.GetRecentlyAddedEpisodes",        CVideoLibrary::GetRecentlyAddedEpisodes },
+  { "VideoLibrary.GetRecentlyAddedMusicVideos",     CVideoLibrary::GetRecentlyAddedMusicVideos },
+  { "VideoLibrary.SetMovieDetails",                 CVideoLibrary::SetMovieDetails },
+  { "VideoLibrary.SetTVShowDetails",                CVideoLibrary::SetTVShowDetails },
+  { "VideoLibrary.SetEpisodeDetails",               CVideoLibrary::SetEpisodeDetails },
+  { "VideoLibrary.SetMusicVideoDetails",            CVideoLibrary::SetMusicVideoDetails },
+  { "VideoLibrary.RemoveMovie",                     CVideoLibrary::RemoveMovie },
+  { "VideoLibrary.RemoveTVShow",                    CVideoLibrary::RemoveTVShow },
+  { "VideoLibrary.RemoveEpisode",                   CVideoLibrary::RemoveEpisode },
+  { "VideoLibrary.RemoveMusicVideo",                CVideoLibrary::RemoveMusicVideo },
+  { "VideoLibrary.Scan",                            CVideoLibrary::Scan },
+  { "VideoLibrary.Export",                          CVideoLibrary::Export },
+  { "VideoLibrary.Clean",                           CVideoLibrary::Clean },
+
+// GUI operations
+  { "GUI.GetProperties",                            CGUIOperations::GetProperties },
+  { "GUI.ShowNotification",                         CGUIOperations::ShowNotification },
+  { "GUI.SetFullscreen",                            CGUIOperations::SetFullscreen },
+
+// System operations
+  { "System.GetProperties",                         CSystemOperations::GetProperties },
+  { "System.EjectOpticalDrive",                     CSystemOperations::EjectOpticalDrive },
+  { "System.Shutdown",                              CSystemOperations::Shutdown },
+  { "System.Suspend",                               CSystemOperations::Suspend },
+  { "System.Hibernate",                             CSystemOperations::Hibernate },
+  { "System.Reboot",                                CSystemOperations::Reboot },
+
+// Input operations
+  { "Input.Left",                                   CInputOperations::Left },
+  { "Input.Right",                                  CInputOperations::Right },
+  { "Input.Down",                                   CInputOperations::Down },
+  { "Input.Up",                                     CInputOperations::Up },
+  { "Input.Select",                                 CInputOperations::Select },
+  { "Input.Back",                                   CInputOperations::Back },
+  { "Input.ContextMenu",                            CInputOperations::ContextMenu },
+  { "Input.Info",                                   CInputOperations::Info },
+  { "Input.Home",                                   CInputOperations::Home },
+
+// Application operations
+  { "Application.GetProperties",                    CApplicationOperations::GetProperties },
+  { "Application.SetVolume",                        CApplicationOperations::SetVolume },
+  { "Application.SetMute",                          CApplicationOperations::SetMute },
+  { "Application.Quit",                             CApplicationOperations::Quit },
+
+// XBMC operations
+  { "XBMC.GetInfoLabels",                           CXBMCOperations::GetInfoLabels },
+  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans },
+
+// PVR operations
+  { "PVR.ChannelSwitch",                            CPVROperations::ChannelSwitch },
+  { "PVR.ChannelUp",                                CPVROperations::ChannelUp },
+  { "PVR.ChannelDown",                              CPVROperations::ChannelDown },
+  { "PVR.RecordCurrentChannel",                     CPVROperations::RecordCurrentChannel },
+  { "PVR.ScheduleRecording",                        CPVROperations::ScheduleRecording },
+  { "PVR.IsAvailable",                              CPVROperations::IsAvailable },
+  { "PVR.IsScanningChannels",                       CPVROperations::IsScanningChannels },
+  { "PVR.IsRecording",                              CPVROperations::IsRecording },
+  { "PVR.ScanChannels",                             CPVROperations::ScanChannels }
+};
+
+const unsigned int CJSONServiceDescription::m_methodMapsSize = sizeof(m_methodMaps) / sizeof(JsonRpcMethodMap);
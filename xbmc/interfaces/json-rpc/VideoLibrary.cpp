@@ -72,7 +72,7 @@ JSONRPC_STATUS CVideoLibrary::GetMovieSets(const CStdString &method, ITransportL
 
   CFileItemList items;
   if (videodatabase.GetSetsNav("videodb://1/7/", items, VIDEODB_CONTENT_MOVIES))
-    HandleFileItemList("setid", false, "sets", items, parameterObject, result);
+    StreamFileItemList("setid", false, "sets", items, parameterObject, result);
 
   videodatabase.Close();
   return OK;
@@ -129,7 +129,7 @@ JSONRPC_STATUS CVideoLibrary::GetTVShows(const CStdString &method, ITransportLay
       for (int index = 0; index < items.Size(); index++)
         videodatabase.GetTvShowInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
     }
-    HandleFileItemList("tvshowid", true, "tvshows", items, parameterObject, result);
+    StreamFileItemList("tvshowid", true, "tvshows", items, parameterObject, result);
   }
 
   videodatabase.Close();
@@ -170,7 +170,7 @@ JSONRPC_STATUS CVideoLibrary::GetSeasons(const CStdString &method, ITransportLay
   strPath.Format("videodb://2/2/%i/", tvshowID);
   CFileItemList items;
   if (videodatabase.GetSeasonsNav(strPath, items, -1, -1, -1, -1, tvshowID))
-    HandleFileItemList(NULL, false, "seasons", items, parameterObject, result);
+    StreamFileItemList(NULL, false, "seasons", items, parameterObject, result);
 
   videodatabase.Close();
   return OK;
@@ -341,7 +341,7 @@ JSONRPC_STATUS CVideoLibrary::GetGenres(const CStdString &method, ITransportLaye
     for (unsigned int i = 0; i < (unsigned int)items.Size(); i++)
       items[i]->GetVideoInfoTag()->m_strTitle = items[i]->GetLabel();
  
-    HandleFileItemList("genreid", false, "genres", items, parameterObject, result);
+    StreamFileItemList("genreid", false, "genres", items, parameterObject, result);
   }
 
   videodatabase.Close();
@@ -640,7 +640,7 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalMovieDetails(const CVariant &paramete
     for (int index = 0; index < items.Size(); index++)
       videodatabase.GetMovieInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
   }
-  HandleFileItemList("movieid", true, "movies", items, parameterObject, result);
+  StreamFileItemList("movieid", true, "movies", items, parameterObject, result);
 
   return OK;
 }
@@ -663,7 +663,7 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalEpisodeDetails(const CVariant &parame
     for (int index = 0; index < items.Size(); index++)
       videodatabase.GetEpisodeInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
   }
-  HandleFileItemList("episodeid", true, "episodes", items, parameterObject, result);
+  StreamFileItemList("episodeid", true, "episodes", items, parameterObject, result);
 
   return OK;
 }
@@ -686,7 +686,7 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalMusicVideoDetails(const CVariant &par
     for (int index = 0; index < items.Size(); index++)
       videodatabase.GetMusicVideoInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
   }
-  HandleFileItemList("musicvideoid", true, "musicvideos", items, parameterObject, result);
+  StreamFileItemList("musicvideoid", true, "musicvideos", items, parameterObject, result);
 
   return OK;
 }
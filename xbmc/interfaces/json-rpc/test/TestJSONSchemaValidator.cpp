@@ -0,0 +1,242 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "interfaces/json-rpc/JSONServiceDescription.h"
+#include "interfaces/json-rpc/JSONSchemaValidator.h"
+#include "interfaces/json-rpc/ServiceDescription.h"
+#include "threads/SystemClock.h"
+#include "utils/JSONVariantParser.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace JSONRPC;
+
+/* the schema handling is linked without the method implementations,
+   every method added by the tests calls TestMethod */
+JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
+  { "", NULL }
+};
+const unsigned int CJSONServiceDescription::m_methodMapsSize = 0;
+
+namespace
+{
+  JSONRPC_STATUS TestMethod(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result)
+  {
+    return OK;
+  }
+
+  class CTestTransport : public ITransportLayer
+  {
+  public:
+    virtual bool PrepareDownload(const char *path, CVariant &details, std::string &protocol) { return false; }
+    virtual bool Download(const char *path, CVariant &result) { return false; }
+    virtual int GetCapabilities() { return Response; }
+  };
+
+  class CTestClient : public IClient
+  {
+  public:
+    virtual int GetPermissionFlags() { return OPERATION_PERMISSION_ALL; }
+    virtual int GetAnnouncementFlags() { return 0; }
+    virtual bool SetAnnouncementFlags(int flags) { return true; }
+  };
+
+  /* the same as CJSONRPC::Initialize() but with TestMethod for every method */
+  struct ServiceDescriptionFixture
+  {
+    ServiceDescriptionFixture()
+    {
+      static bool initialized = false;
+      if (initialized)
+        return;
+
+      for (unsigned int index = 0; index < sizeof(JSONRPC_SERVICE_TYPES) / sizeof(char*); index++)
+        CJSONServiceDescription::AddType(JSONRPC_SERVICE_TYPES[index]);
+      for (unsigned int index = 0; index < sizeof(JSONRPC_SERVICE_METHODS) / sizeof(char*); index++)
+        CJSONServiceDescription::AddMethod(JSONRPC_SERVICE_METHODS[index], TestMethod);
+
+      initialized = true;
+    }
+  };
+
+  struct Sample
+  {
+    const char *type;
+    const char *value;
+  };
+
+  /* valid and invalid values of the types the library methods take */
+  const Sample samples[] = {
+    { "Optional.Boolean",     "null" },
+    { "Optional.Boolean",     "true" },
+    { "Optional.Boolean",     "\"yes\"" },
+    { "Library.Id",           "5" },
+    { "Library.Id",           "-2" },
+    { "Library.Id",           "\"5\"" },
+    { "Array.Integer",        "[ 1, 2, 3 ]" },
+    { "Array.Integer",        "[ 1, \"2\" ]" },
+    { "List.Limits",          "{ \"start\": 0, \"end\": 50 }" },
+    { "List.Limits",          "{ }" },
+    { "List.Limits",          "{ \"start\": -1 }" },
+    { "List.Limits",          "{ \"start\": 0, \"stop\": 50 }" },
+    { "List.Sort",            "{ \"method\": \"title\", \"order\": \"descending\", \"ignorearticle\": true }" },
+    { "List.Sort",            "{ \"method\": \"none\" }" },
+    { "List.Sort",            "{ \"method\": \"bogus\" }" },
+    { "Video.Fields.Movie",   "[ \"title\", \"year\", \"rating\", \"thumbnail\" ]" },
+    { "Video.Fields.Movie",   "[ \"title\", \"title\" ]" },
+    { "Video.Fields.Movie",   "[ \"title\", \"bogus\" ]" },
+    { "Player.Position.Time", "{ \"hours\": 1, \"minutes\": 2, \"seconds\": 3, \"milliseconds\": 4 }" },
+    { "Player.Position.Time", "{ \"minutes\": 75 }" },
+    { "Playlist.Item",        "{ \"file\": \"/media/movie.mkv\" }" },
+    { "Playlist.Item",        "{ \"movieid\": 5 }" },
+    { "Playlist.Item",        "{ \"directory\": \"/media\", \"recursive\": true }" },
+    { "Playlist.Item",        "{ \"movieid\": \"5\" }" },
+    { "Playlist.Item",        "{ \"bogus\": 5 }" }
+  };
+
+  const unsigned int sampleCount = sizeof(samples) / sizeof(Sample);
+
+  CVariant ParseValue(const char *json)
+  {
+    return CJSONVariantParser::Parse((const unsigned char *)json, strlen(json));
+  }
+
+  /* CVariant doesn't consider two null values equal */
+  bool IsEqual(const CVariant &left, const CVariant &right)
+  {
+    return (left.isNull() && right.isNull()) || left == right;
+  }
+
+  /* a method with a single parameter of the given type */
+  JSONSchemaTypeDefinition Parameter(const char *type)
+  {
+    JSONSchemaTypeDefinition *definition = CJSONServiceDescription::GetType(type);
+    BOOST_REQUIRE_MESSAGE(definition != NULL, "unknown type " << type);
+
+    JSONSchemaTypeDefinition parameter = *definition;
+    parameter.name = "value";
+    parameter.optional = false;
+    return parameter;
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE(TestJSONSchemaValidator, ServiceDescriptionFixture)
+
+BOOST_AUTO_TEST_CASE(TestValidatorMatchesCheck)
+{
+  /* the validator accepts exactly the values JSONSchemaTypeDefinition::Check()
+     accepts and fills in the same defaults */
+  for (unsigned int index = 0; index < sampleCount; index++)
+  {
+    JSONSchemaTypeDefinition parameter = Parameter(samples[index].type);
+    CJSONSchemaValidator validator;
+    validator.Compile(std::vector<JSONSchemaTypeDefinition>(1, parameter));
+
+    CVariant value = ParseValue(samples[index].value);
+    CVariant request(CVariant::VariantTypeObject);
+    request["value"] = value;
+
+    CVariant output, errorData;
+    JSONRPC_STATUS expected = parameter.Check(value, output, errorData);
+
+    CVariant validated;
+    JSONRPC_STATUS status = validator.Validate(request, validated);
+
+    BOOST_CHECK_MESSAGE(status == expected, samples[index].type << " " << samples[index].value);
+    if (status == OK && expected == OK)
+      BOOST_CHECK_MESSAGE(IsEqual(validated["value"], output), samples[index].type << " " << samples[index].value);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestCheckCall)
+{
+  CTestTransport transport;
+  CTestClient client;
+  MethodCall method = NULL;
+
+  CVariant parameters = ParseValue("{ \"properties\": [ \"title\", \"year\" ], \"limits\": { \"start\": 0, \"end\": 25 } }");
+  CVariant output;
+  BOOST_REQUIRE_EQUAL(CJSONServiceDescription::CheckCall("videolibrary.getmovies", parameters, &transport, &client, false, method, output), OK);
+  BOOST_CHECK(method == TestMethod);
+  BOOST_CHECK(output["properties"] == parameters["properties"]);
+  BOOST_CHECK(output["sort"].isObject());
+
+  /* method names are looked up in lower case, an invalid call still gets
+     the error data of the schema tree */
+  parameters["limits"]["start"] = -1;
+  output = CVariant();
+  BOOST_CHECK_EQUAL(CJSONServiceDescription::CheckCall("videolibrary.getmovies", parameters, &transport, &client, false, method, output), InvalidParams);
+  BOOST_CHECK(output.isMember("stack"));
+}
+
+BOOST_AUTO_TEST_CASE(TestValidatorTiming)
+{
+  /* the samples validated by the schema tree and by the compiled validator, see
+       ./testMain --log_level=message --run_test=TestJSONSchemaValidator/TestValidatorTiming */
+  const unsigned int rounds = 2000;
+
+  std::vector<JSONSchemaTypeDefinition> parameters;
+  std::vector<CJSONSchemaValidator> validators(sampleCount);
+  std::vector<CVariant> values, requests;
+  for (unsigned int index = 0; index < sampleCount; index++)
+  {
+    parameters.push_back(Parameter(samples[index].type));
+    validators[index].Compile(std::vector<JSONSchemaTypeDefinition>(1, parameters.back()));
+    values.push_back(ParseValue(samples[index].value));
+    requests.push_back(CVariant(CVariant::VariantTypeObject));
+    requests.back()["value"] = values.back();
+  }
+
+  unsigned int legacyValid = 0;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int index = 0; index < sampleCount; index++)
+    {
+      CVariant output, errorData;
+      if (parameters[index].Check(values[index], output, errorData) == OK)
+        legacyValid++;
+    }
+  }
+  unsigned int legacy = XbmcThreads::SystemClockMillis() - start;
+
+  unsigned int compiledValid = 0;
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int index = 0; index < sampleCount; index++)
+    {
+      CVariant output;
+      if (validators[index].Validate(requests[index], output) == OK)
+        compiledValid++;
+    }
+  }
+  unsigned int compiled = XbmcThreads::SystemClockMillis() - start;
+
+  BOOST_TEST_MESSAGE(rounds * sampleCount << " values, schema tree " << legacy << " ms, compiled " << compiled << " ms");
+  BOOST_CHECK_EQUAL(compiledValid, legacyValid);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -53,6 +53,7 @@
 #include "storage/MediaManager.h"
 #include "settings/Settings.h"
 #include "utils/StringUtils.h"
+#include "utils/TextSearchIndex.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -71,6 +72,11 @@ using ADDON::AddonPtr;
 #define RECENTLY_PLAYED_LIMIT 25
 #define MIN_FULL_SEARCH_LENGTH 3
 
+// item types in the searchtoken table
+#define SEARCH_TOKEN_ARTIST 1
+#define SEARCH_TOKEN_ALBUM  2
+#define SEARCH_TOKEN_SONG   3
+
 #ifdef HAS_DVD_DRIVE
 using namespace CDDB;
 #endif
@@ -132,6 +138,9 @@ bool CMusicDatabase::CreateTables()
     m_pDS->exec("CREATE TABLE karaokedata ( iKaraNumber integer, idSong integer, iKaraDelay integer, strKaraEncoding text, "
                 "strKaralyrics text, strKaraLyrFileCRC text )\n");
 
+    CLog::Log(LOGINFO, "create searchtoken table");
+    m_pDS->exec("CREATE TABLE searchtoken ( strToken varchar(256), idItem integer, iType integer)\n");
+
     // Indexes
     CLog::Log(LOGINFO, "create exartistsong index");
     m_pDS->exec("CREATE INDEX idxExtraArtistSong ON exartistsong(idSong)");
@@ -185,6 +194,10 @@ bool CMusicDatabase::CreateTables()
     m_pDS->exec("CREATE INDEX idxKaraNumber on karaokedata(iKaraNumber)");
     m_pDS->exec("CREATE INDEX idxKarSong on karaokedata(idSong)");
 
+    CLog::Log(LOGINFO, "create searchtoken index");
+    m_pDS->exec("CREATE INDEX idxSearchToken ON searchtoken(strToken)");
+    m_pDS->exec("CREATE INDEX idxSearchToken2 ON searchtoken(iType, idItem)");
+
     // Trigger
     CLog::Log(LOGINFO, "create albuminfo trigger");
     m_pDS->exec("CREATE TRIGGER tgrAlbumInfo AFTER delete ON albuminfo FOR EACH ROW BEGIN delete from albuminfosong where albuminfosong.idAlbumInfo=old.idAlbumInfo; END");
@@ -372,6 +385,8 @@ void CMusicDatabase::AddSong(CSong& song, bool bCheck)
         idSong = (int)m_pDS->lastinsertid();
       else
         idSong = song.idSong;
+
+      AddSearchTokens(SEARCH_TOKEN_SONG, idSong, song.strTitle);
     }
 
     // add extra artists and genres
@@ -467,6 +482,7 @@ int CMusicDatabase::AddAlbum(const CStdString& strAlbum1, int idArtist, const CS
       album.idArtist = idArtist;
       album.artist = StringUtils::Split(strArtist, g_advancedSettings.m_musicItemSeparator);
       m_albumCache.insert(pair<CStdString, CAlbumCache>(album.strAlbum + strArtist, album));
+      AddSearchTokens(SEARCH_TOKEN_ALBUM, album.idAlbum, strAlbum);
       return album.idAlbum;
     }
     else
@@ -580,6 +596,7 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist1)
       m_pDS->exec(strSQL.c_str());
       int idArtist = (int)m_pDS->lastinsertid();
       m_artistCache.insert(pair<CStdString, int>(strArtist1, idArtist));
+      AddSearchTokens(SEARCH_TOKEN_ARTIST, idArtist, strArtist);
       return idArtist;
     }
     else
@@ -1109,6 +1126,7 @@ bool CMusicDatabase::SearchArtists(const CStdString& search, CFileItemList &arti
       strSQL=PrepareSQL("select * from artist "
                                 "where strArtist like '%s%%' and idArtist <> %i "
                                 , search.c_str(), idVariousArtist );
+    strSQL += GetSearchTokenFilter(SEARCH_TOKEN_ARTIST, "idArtist", search);
 
     if (!m_pDS->query(strSQL.c_str())) return false;
     if (m_pDS->num_rows() == 0)
@@ -1758,9 +1776,10 @@ bool CMusicDatabase::SearchSongs(const CStdString& search, CFileItemList &items)
 
     CStdString strSQL;
     if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' or strTitle like '%% %s%%' limit 1000", search.c_str(), search.c_str());
+      strSQL=PrepareSQL("select * from songview where (strTitle like '%s%%' or strTitle like '%% %s%%')", search.c_str(), search.c_str());
     else
-      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' limit 1000", search.c_str());
+      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%'", search.c_str());
+    strSQL += GetSearchTokenFilter(SEARCH_TOKEN_SONG, "idSong", search) + " limit 1000";
 
     if (!m_pDS->query(strSQL.c_str())) return false;
     if (m_pDS->num_rows() == 0) return false;
@@ -1794,9 +1813,10 @@ bool CMusicDatabase::SearchAlbums(const CStdString& search, CFileItemList &album
 
     CStdString strSQL;
     if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str());
+      strSQL=PrepareSQL("select * from albumview where (strAlbum like '%s%%' or strAlbum like '%% %s%%')", search.c_str(), search.c_str());
     else
       strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%'", search.c_str());
+    strSQL += GetSearchTokenFilter(SEARCH_TOKEN_ALBUM, "idAlbum", search);
 
     if (!m_pDS->query(strSQL.c_str())) return false;
 
@@ -2233,6 +2253,26 @@ bool CMusicDatabase::CleanupArtists()
   return false;
 }
 
+bool CMusicDatabase::CleanupSearchTokens()
+{
+  try
+  {
+    // Must be executed AFTER the song, album and artist tables have been cleaned.
+    CStdString strSQL = PrepareSQL("delete from searchtoken where iType=%i and idItem not in (select idSong from song)", SEARCH_TOKEN_SONG);
+    m_pDS->exec(strSQL.c_str());
+    strSQL = PrepareSQL("delete from searchtoken where iType=%i and idItem not in (select idAlbum from album)", SEARCH_TOKEN_ALBUM);
+    m_pDS->exec(strSQL.c_str());
+    strSQL = PrepareSQL("delete from searchtoken where iType=%i and idItem not in (select idArtist from artist)", SEARCH_TOKEN_ARTIST);
+    m_pDS->exec(strSQL.c_str());
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "Exception in CMusicDatabase::CleanupSearchTokens() or was aborted");
+  }
+  return false;
+}
+
 bool CMusicDatabase::CleanupGenres()
 {
   try
@@ -2263,6 +2303,7 @@ bool CMusicDatabase::CleanupOrphanedItems()
   if (!CleanupArtists()) return false;
   if (!CleanupGenres()) return false;
   if (!CleanupThumbs()) return false;
+  if (!CleanupSearchTokens()) return false;
   return true;
 }
 
@@ -2321,7 +2362,7 @@ int CMusicDatabase::Cleanup(CGUIDialogProgress *pDlgProgress)
     pDlgProgress->SetPercentage(60);
     pDlgProgress->Progress();
   }
-  if (!CleanupArtists())
+  if (!CleanupArtists() || !CleanupSearchTokens())
   {
     RollbackTransaction();
     return ERROR_REORG_ARTIST;
@@ -3377,6 +3418,15 @@ bool CMusicDatabase::UpdateOldVersion(int version)
       sql = PrepareSQL("UPDATE album SET strExtraArtists=SUBSTR(strExtraArtists,%i), strExtraGenres=SUBSTR(strExtraGenres,%i)", len, len);
       m_pDS->exec(sql.c_str());
     }
+    if (version < 21)
+    {
+      m_pDS->exec("CREATE TABLE searchtoken ( strToken varchar(256), idItem integer, iType integer)\n");
+      m_pDS->exec("CREATE INDEX idxSearchToken ON searchtoken(strToken)");
+      m_pDS->exec("CREATE INDEX idxSearchToken2 ON searchtoken(iType, idItem)");
+      AddSearchTokensFromQuery(SEARCH_TOKEN_ARTIST, "select idArtist, strArtist from artist");
+      AddSearchTokensFromQuery(SEARCH_TOKEN_ALBUM, "select idAlbum, strAlbum from album");
+      AddSearchTokensFromQuery(SEARCH_TOKEN_SONG, "select idSong, strTitle from song");
+    }
 
     // always recreate the views after any table change
     CreateViews();
@@ -3391,6 +3441,52 @@ bool CMusicDatabase::UpdateOldVersion(int version)
   return true;
 }
 
+void CMusicDatabase::AddSearchTokens(int iType, int idItem, const CStdString &strText)
+{
+  CStdString strSQL = PrepareSQL("delete from searchtoken where iType=%i and idItem=%i", iType, idItem);
+  m_pDS->exec(strSQL.c_str());
+
+  vector<CStdString> tokens;
+  CTextSearchIndex::Tokenize(strText, tokens);
+  for (vector<CStdString>::const_iterator it = tokens.begin(); it != tokens.end(); it++)
+  {
+    strSQL = PrepareSQL("insert into searchtoken (strToken, idItem, iType) values ('%s', %i, %i)", it->c_str(), idItem, iType);
+    m_pDS->exec(strSQL.c_str());
+  }
+}
+
+void CMusicDatabase::AddSearchTokensFromQuery(int iType, const CStdString &strSQL)
+{
+  if (!m_pDS2->query(strSQL.c_str()))
+    return;
+
+  while (!m_pDS2->eof())
+  {
+    AddSearchTokens(iType, m_pDS2->fv(0).get_asInt(), m_pDS2->fv(1).get_asString());
+    m_pDS2->next();
+  }
+  m_pDS2->close();
+}
+
+CStdString CMusicDatabase::GetSearchTokenFilter(int iType, const CStdString &strIdField, const CStdString &strSearch) const
+{
+  // every item that matches the search has a word starting with the first word of the search.
+  // the token table is only used to narrow down the items the (unindexed) like is applied to.
+  size_t iEnd = strSearch.find_first_of(" \t\r\n");
+  if (iEnd == 0)
+    return "";
+
+  CStdString strWord = strSearch.substr(0, iEnd);
+  strWord.ToLower();
+  if (strWord.IsEmpty() || strWord.find_first_of("%_*?[") != CStdString::npos)
+    return "";
+
+  if (m_sqlite)
+    return PrepareSQL(" and %s in (select idItem from searchtoken where iType=%i and strToken glob '%s*')", strIdField.c_str(), iType, strWord.c_str());
+
+  return PrepareSQL(" and %s in (select idItem from searchtoken where iType=%i and strToken like '%s%%')", strIdField.c_str(), iType, strWord.c_str());
+}
+
 int CMusicDatabase::AddThumb(const CStdString& strThumb1)
 {
   CStdString strSQL;
@@ -366,7 +366,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
 
   // Discard all excluded files defined by m_musicExcludeRegExps
 
-  CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
+  const CStdStringArray &regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
   if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
     return true;
@@ -453,7 +453,7 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
 
   VECSONGS songsToAdd;
 
-  CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
+  const CStdStringArray &regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
   // for every file found, but skip folder
   for (int i = 0; i < items.Size(); ++i)
@@ -23,15 +23,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <errno.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#ifdef TCPSERVER_USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "interfaces/AnnouncementManager.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "websocket/WebSocketManager.h"
 
 static const char     bt_service_name[] = "XBMC JSON-RPC";
@@ -57,6 +68,113 @@ using namespace ANNOUNCEMENT;
 
 #define RECEIVEBUFFER 1024
 
+/* the amount of queued data after which a client doesn't get any announcements and isn't read from anymore */
+#define MAX_SENDQUEUE (1024 * 1024)
+/* the number of requests a client can queue before it isn't read from anymore */
+#define MAX_REQUESTS  16
+/* the number of events handled per epoll_wait() call */
+#define MAX_EVENTS    64
+/* the time after which a warning is logged while stopping the server waits for running requests */
+#define REAP_TIMEOUT  5000
+
+static bool SetNonBlocking(SOCKET socket)
+{
+#ifdef _WIN32
+  u_long nonblocking = 1;
+  return ioctlsocket(socket, FIONBIO, &nonblocking) == 0;
+#else
+  int flags = fcntl(socket, F_GETFL, 0);
+  return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+static bool WouldBlock()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+static bool Interrupted()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEINTR;
+#else
+  return errno == EINTR;
+#endif
+}
+
+static int Receive(SOCKET socket, char *buffer, int length)
+{
+  int res;
+  do
+  {
+    res = recv(socket, buffer, length, 0);
+  } while (res < 0 && Interrupted());
+
+  return res;
+}
+
+static int Send(SOCKET socket, const char *data, int length)
+{
+  int res;
+  do
+  {
+    res = send(socket, data, length, 0);
+  } while (res < 0 && Interrupted());
+
+  return res;
+}
+
+class CTCPServer::CRequestJob : public CJob
+{
+public:
+  CRequestJob(CTCPServer *host, CTCPClient *client, const std::string &request) :
+    m_host(host),
+    m_client(client),
+    m_request(request)
+  {
+    m_client->AddJob();
+  }
+
+  /* the client and the server are kept until every job referencing them is destroyed, which also
+     happens when the job is cancelled while it's queued */
+  virtual ~CRequestJob()
+  {
+    m_client->RemoveJob();
+  }
+
+  virtual bool DoWork()
+  {
+    /* the connection may have been closed while this job was queued */
+    bool closed;
+    {
+      CSingleLock lock(m_client->m_critSection);
+      closed = m_client->m_socket == INVALID_SOCKET;
+    }
+
+    if (!closed)
+    {
+      std::string response;
+      if (CJSONRPC::MethodCall(m_request, m_host, m_client, response))
+        m_client->Send(response.c_str(), response.size());
+    }
+
+    return true;
+  }
+
+  virtual const char *GetType() const { return "jsonrpc"; }
+
+  CTCPClient *GetClient() const { return m_client; }
+
+private:
+  CTCPServer  *m_host;
+  CTCPClient  *m_client;
+  std::string  m_request;
+};
+
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
 bool CTCPServer::StartServer(int port, bool nonlocal)
@@ -91,6 +209,10 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("CTCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+#ifdef TCPSERVER_USE_EPOLL
+  m_epoll = -1;
+  m_wakeup = -1;
+#endif
 }
 
 void CTCPServer::Process()
@@ -99,10 +221,53 @@ void CTCPServer::Process()
 
   while (!m_bStop)
   {
+#ifdef TCPSERVER_USE_EPOLL
+    struct epoll_event events[MAX_EVENTS];
+    int res = epoll_wait(m_epoll, events, MAX_EVENTS, 1000);
+    if (res < 0 && errno != EINTR)
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: epoll_wait failed");
+      Sleep(1000);
+      Initialize();
+      continue;
+    }
+
+    for (int i = 0; i < res; i++)
+    {
+      SOCKET socket = events[i].data.fd;
+      if (socket == m_wakeup)
+      {
+        /* a request finished or data was queued from another thread */
+        uint64_t count;
+        if (read(m_wakeup, &count, sizeof(count)) < 0 && errno != EAGAIN)
+          CLog::Log(LOGERROR, "JSONRPC Server: Failed to read the wakeup event");
+        FlushConnections();
+        continue;
+      }
+
+      if (IsServer(socket))
+      {
+        AcceptConnection(socket);
+        continue;
+      }
+
+      int index = GetConnection(socket);
+      if (index < 0)
+        continue;
+
+      if (events[i].events & EPOLLOUT)
+        m_connections[index]->Flush();
+
+      /* errors and hangups are detected when reading */
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        m_connections[index]->m_readPending = true;
+    }
+#else
     SOCKET          max_fd = 0;
-    fd_set          rfds;
+    fd_set          rfds, wfds;
     struct timeval  to     = {1, 0};
     FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
 
     for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
     {
@@ -113,83 +278,268 @@ void CTCPServer::Process()
 
     for (unsigned int i = 0; i < m_connections.size(); i++)
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
+      if (!m_connections[i]->IsStalled())
+        FD_SET(m_connections[i]->m_socket, &rfds);
+      if (!m_connections[i]->Flush())
+        FD_SET(m_connections[i]->m_socket, &wfds);
       if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
         max_fd = m_connections[i]->m_socket;
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+    int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
     if (res < 0)
     {
       CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
+      continue;
+    }
+
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+    {
+      if (FD_ISSET(m_connections[i]->m_socket, &wfds))
+        m_connections[i]->Flush();
+      if (FD_ISSET(m_connections[i]->m_socket, &rfds))
+        m_connections[i]->m_readPending = true;
     }
-    else if (res > 0)
+
+    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
+      if (FD_ISSET(*it, &rfds))
+        AcceptConnection(*it);
+    }
+#endif
+
+    ReadConnections();
+    ReapConnections(false);
+  }
+
+  Deinitialize();
+}
+
+void CTCPServer::FlushConnections()
+{
+  /* the sockets are edge triggered, data queued while a socket was writable isn't reported */
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+    m_connections[i]->Flush();
+}
+
+void CTCPServer::WakeUp()
+{
+#ifdef TCPSERVER_USE_EPOLL
+  uint64_t count = 1;
+  if (m_wakeup >= 0 && write(m_wakeup, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to signal the wakeup event");
+#endif
+}
+
+void CTCPServer::AcceptConnection(SOCKET server)
+{
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  CTCPClient *newconnection = new CTCPClient();
+  newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
+    delete newconnection;
+    return;
+  }
+
+  if (!SetNonBlocking(newconnection->m_socket))
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to make the new connection non-blocking");
+    newconnection->Close();
+    delete newconnection;
+    return;
+  }
+
+#ifdef TCPSERVER_USE_EPOLL
+  /* edge triggered, so the socket doesn't have to be removed from the set while nothing is queued
+     for it. it's read until it's empty and written until it's full instead */
+  struct epoll_event event = {};
+  event.events  = EPOLLIN | EPOLLOUT | EPOLLET;
+  event.data.fd = newconnection->m_socket;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, newconnection->m_socket, &event) < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to add the new connection to epoll");
+    newconnection->Close();
+    delete newconnection;
+    return;
+  }
+#endif
+
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+  CSingleLock lock(m_critSection);
+  m_connections.push_back(newconnection);
+}
+
+bool CTCPServer::ReadConnection(unsigned int index)
+{
+  do
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = Receive(m_connections[index]->m_socket, (char*)&buffer, RECEIVEBUFFER);
+    if (nread < 0 && WouldBlock())
+    {
+      m_connections[index]->m_readPending = false;
+      break;
+    }
+    else if (nread <= 0)
+      return false;
+
+    std::string response;
+    if (m_connections[index]->IsNew())
+    {
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+      if (response.size() > 0)
+        m_connections[index]->Send(response.c_str(), response.size());
+
+      if (websocket != NULL)
       {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-          }
-          if (nread <= 0)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
+        // Replace the CTCPClient with a CWebSocketClient
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[index]));
+        CSingleLock lock(m_critSection);
+        delete m_connections[index];
+        m_connections[index] = websocketClient;
       }
+    }
+
+    if (response.size() <= 0)
+      m_connections[index]->PushBuffer(this, buffer, nread);
+
+    DispatchRequest(m_connections[index]);
+
+#ifndef TCPSERVER_USE_EPOLL
+    /* select() reports the socket again if there's more to read */
+    m_connections[index]->m_readPending = false;
+#endif
+  } while (m_connections[index]->m_readPending && !m_connections[index]->IsStalled());
+
+  return true;
+}
+
+void CTCPServer::ReadConnections()
+{
+  for (int i = m_connections.size() - 1; i >= 0; i--)
+  {
+    /* clients that are held back are read again once they caught up */
+    if (!m_connections[i]->m_readPending || m_connections[i]->IsStalled())
+      continue;
+
+    if (!ReadConnection(i))
+    {
+      CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+      RemoveConnection(i);
+    }
+  }
+}
+
+void CTCPServer::RemoveConnection(unsigned int index)
+{
+  CTCPClient *client;
+  {
+    CSingleLock lock(m_critSection);
+    client = m_connections[index];
+    m_connections.erase(m_connections.begin() + index);
+  }
+
+#ifdef TCPSERVER_USE_EPOLL
+  struct epoll_event event = {};
+  epoll_ctl(m_epoll, EPOLL_CTL_DEL, client->m_socket, &event);
+#endif
+
+  client->Disconnect();
+  client->Close();
+
+  /* a running request still uses the client. it's deleted once the request finished */
+  m_closedConnections.push_back(client);
+}
+
+void CTCPServer::ReapConnections(bool bWait)
+{
+  unsigned int jobID;
+  if (bWait)
+  {
+    /* queued requests are dropped, running ones don't report back to the server anymore */
+    for (unsigned int i = 0; i < m_closedConnections.size(); i++)
+    {
+      if (m_closedConnections[i]->GetJob(jobID))
+        CJobManager::GetInstance().CancelJob(jobID);
+    }
+  }
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  XbmcThreads::EndTime timeout(REAP_TIMEOUT);
+  bool warned = false;
+  while (!m_closedConnections.empty())
+  {
+    for (int i = m_closedConnections.size() - 1; i >= 0; i--)
+    {
+      if (!m_closedConnections[i]->GetJob(jobID))
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed");
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+        delete m_closedConnections[i];
+        m_closedConnections.erase(m_closedConnections.begin() + i);
       }
     }
+
+    if (!bWait || m_closedConnections.empty())
+      break;
+
+    /* the jobs still use the clients and the server, so they can't be deleted before they finished */
+    if (!warned && timeout.IsTimePast())
+    {
+      CLog::Log(LOGWARNING, "JSONRPC Server: Waiting for %u requests that are still running", (unsigned int)m_closedConnections.size());
+      warned = true;
+    }
+
+    Sleep(10);
   }
+}
 
-  Deinitialize();
+int CTCPServer::GetConnection(SOCKET socket) const
+{
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    if (m_connections[i]->m_socket == socket)
+      return i;
+  }
+
+  return -1;
+}
+
+bool CTCPServer::IsServer(SOCKET socket) const
+{
+  for (std::vector<SOCKET>::const_iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  {
+    if (*it == socket)
+      return true;
+  }
+
+  return false;
+}
+
+void CTCPServer::DispatchRequest(CTCPClient *client)
+{
+  /* the job id is stored before a finishing job can dispatch the next request */
+  CSingleLock lock(client->m_critSection);
+  std::string request;
+  if (client->PopRequest(request))
+    client->SetJob(CJobManager::GetInstance().AddJob(new CRequestJob(this, client, request), this, CJob::PRIORITY_NORMAL));
+}
+
+void CTCPServer::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CTCPClient *client = ((CRequestJob *)job)->GetClient();
+
+  /* requests of a client are executed one after the other, so responses keep their order */
+  CSingleLock lock(client->m_critSection);
+  client->FinishRequest();
+  if (client->m_socket != INVALID_SOCKET)
+    DispatchRequest(client);
+
+  /* a stalled client can be read from again and its response may still be queued */
+  WakeUp();
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -211,6 +561,7 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
+  CSingleLock lock(m_critSection);
   for (unsigned int i = 0; i < m_connections.size(); i++)
   {
     {
@@ -219,8 +570,17 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
         continue;
     }
 
+    /* don't let clients that don't keep up pile up announcements */
+    if (m_connections[i]->IsSendQueueFull())
+    {
+      CLog::Log(LOGDEBUG, "JSONRPC Server: Skipping announcement %s for a client that doesn't keep up", message);
+      continue;
+    }
+
     m_connections[i]->Send(str.c_str(), str.size());
   }
+
+  WakeUp();
 }
 
 bool CTCPServer::Initialize()
@@ -232,12 +592,15 @@ bool CTCPServer::Initialize()
   started |= InitializeBlue();
   started |= InitializeTCP();
 
-  if(started)
+  if(started && InitializePoller())
   {
     CAnnouncementManager::AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
   }
+
+  /* don't keep the sockets and the epoll instance around until the next attempt */
+  Deinitialize();
   return false;
 }
 
@@ -422,6 +785,43 @@ bool CTCPServer::InitializeBlue()
   return false;
 }
 
+bool CTCPServer::InitializePoller()
+{
+#ifdef TCPSERVER_USE_EPOLL
+  m_epoll = epoll_create(64);
+  if (m_epoll < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to create epoll instance");
+    return false;
+  }
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  {
+    struct epoll_event event = {};
+    event.events  = EPOLLIN;
+    event.data.fd = *it;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, *it, &event) < 0)
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to add serversocket to epoll");
+      return false;
+    }
+  }
+
+  /* signalled by WakeUp(), so finished requests don't wait for the epoll_wait() timeout */
+  m_wakeup = eventfd(0, EFD_NONBLOCK);
+  struct epoll_event event = {};
+  event.events  = EPOLLIN;
+  event.data.fd = m_wakeup;
+  if (m_wakeup < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event) < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to add the wakeup event to epoll");
+    return false;
+  }
+#endif
+
+  return true;
+}
+
 bool CTCPServer::InitializeTCP()
 {
 
@@ -463,26 +863,34 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
-  {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+  /* announcements are sent from another thread, stop them before the sockets go away */
+  CAnnouncementManager::RemoveAnnouncer(this);
 
-  m_connections.clear();
+  while (!m_connections.empty())
+    RemoveConnection(m_connections.size() - 1);
+
+  ReapConnections(true);
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
 
   m_servers.clear();
 
+#ifdef TCPSERVER_USE_EPOLL
+  if (m_epoll >= 0)
+    close(m_epoll);
+  m_epoll = -1;
+
+  if (m_wakeup >= 0)
+    close(m_wakeup);
+  m_wakeup = -1;
+#endif
+
 #ifdef HAVE_LIBBLUETOOTH
   if(m_sdpd)
     sdp_close( (sdp_session_t*)m_sdpd );
   m_sdpd = NULL;
 #endif
-
-  CAnnouncementManager::RemoveAnnouncer(this);
 }
 
 CTCPServer::CTCPClient::CTCPClient()
@@ -490,6 +898,10 @@ CTCPServer::CTCPClient::CTCPClient()
   m_new = true;
   m_announcementflags = ANNOUNCE_ALL;
   m_socket = INVALID_SOCKET;
+  m_readPending = false;
+  m_busy = false;
+  m_jobs = 0;
+  m_jobID = 0;
   m_beginBrackets = 0;
   m_endBrackets = 0;
   m_beginChar = 0;
@@ -527,12 +939,94 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  /* only send directly if nothing is queued, to keep the data in order */
   unsigned int sent = 0;
-  do
+  if (m_sendQueue.empty())
+  {
+    int res = ::Send(m_socket, data, size);
+    if (res > 0)
+      sent = res;
+  }
+
+  /* the rest is written by the server thread when the socket becomes writable */
+  if (sent < size)
+    m_sendQueue.append(data + sent, size - sent);
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  size_t sent = 0;
+  while (sent < m_sendQueue.size() && m_socket != INVALID_SOCKET)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
-  } while (sent < size);
+    int res = ::Send(m_socket, m_sendQueue.c_str() + sent, m_sendQueue.size() - sent);
+    if (res <= 0)
+      break;
+    sent += res;
+  }
+  m_sendQueue.erase(0, sent);
+
+  return m_sendQueue.empty();
+}
+
+bool CTCPServer::CTCPClient::IsSendQueueFull()
+{
+  CSingleLock lock (m_critSection);
+  return m_sendQueue.size() > MAX_SENDQUEUE;
+}
+
+bool CTCPServer::CTCPClient::IsStalled()
+{
+  CSingleLock lock (m_critSection);
+  return m_sendQueue.size() > MAX_SENDQUEUE || m_requests.size() > MAX_REQUESTS;
+}
+
+bool CTCPServer::CTCPClient::PopRequest(std::string &request)
+{
+  CSingleLock lock (m_critSection);
+  if (m_busy || m_requests.empty())
+    return false;
+
+  request = m_requests.front();
+  m_requests.pop_front();
+  m_busy = true;
+
+  return true;
+}
+
+void CTCPServer::CTCPClient::FinishRequest()
+{
+  CSingleLock lock (m_critSection);
+  m_busy = false;
+}
+
+void CTCPServer::CTCPClient::AddJob()
+{
+  CSingleLock lock (m_critSection);
+  m_jobs++;
+}
+
+void CTCPServer::CTCPClient::RemoveJob()
+{
+  CSingleLock lock (m_critSection);
+  m_jobs--;
+}
+
+void CTCPServer::CTCPClient::SetJob(unsigned int jobID)
+{
+  CSingleLock lock (m_critSection);
+  m_jobID = jobID;
+}
+
+bool CTCPServer::CTCPClient::GetJob(unsigned int &jobID)
+{
+  CSingleLock lock (m_critSection);
+  jobID = m_jobID;
+  return m_jobs > 0;
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -563,8 +1057,10 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        /* executed by the job manager, see CTCPServer::DispatchRequest() */
+        CSingleLock lock (m_critSection);
+        m_requests.push_back(m_buffer);
+        lock.Leave();
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -574,9 +1070,14 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
 
 void CTCPServer::CTCPClient::Disconnect()
 {
-  if (m_socket > 0)
+  Close();
+}
+
+void CTCPServer::CTCPClient::Close()
+{
+  CSingleLock lock (m_critSection);
+  if (m_socket != INVALID_SOCKET)
   {
-    CSingleLock lock (m_critSection);
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -595,6 +1096,12 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_sendQueue         = client.m_sendQueue;
+  m_requests          = client.m_requests;
+  m_busy              = client.m_busy;
+  m_jobs              = client.m_jobs;
+  m_jobID             = client.m_jobID;
+  m_readPending       = client.m_readPending;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -632,6 +1139,8 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
 
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
+  /* responses and announcements are sent from different threads */
+  CSingleLock lock (m_critSection);
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
   if (msg == NULL || !msg->IsComplete())
     return;
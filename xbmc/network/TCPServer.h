@@ -20,6 +20,7 @@
  *
  */
 
+#include <deque>
 #include <vector>
 #include <sys/socket.h>
 
@@ -28,11 +29,25 @@
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "utils/Job.h"
 #include "websocket/WebSocket.h"
 
+#if defined(TARGET_LINUX)
+#define TCPSERVER_USE_EPOLL
+#endif
+
 namespace JSONRPC
 {
-  class CTCPServer : public ITransportLayer, public JSONRPC::IJSONRPCAnnouncer, public CThread
+  /*!
+   * @brief JSON-RPC server for raw TCP, websocket and bluetooth clients.
+   *
+   * All sockets are non-blocking and served by a single thread, using epoll where it's available
+   * and select() otherwise. Data sent to a client is queued when the socket can't take it and
+   * written once it becomes writable again. Method calls are executed by the job manager, one call
+   * per client at a time, so slow calls don't hold up other clients. Clients that don't read their
+   * responses fast enough are skipped for announcements and not read from until they catch up.
+   */
+  class CTCPServer : public ITransportLayer, public JSONRPC::IJSONRPCAnnouncer, public CThread, public IJobCallback
   {
   public:
     static bool StartServer(int port, bool nonlocal);
@@ -43,6 +58,8 @@ namespace JSONRPC
     virtual int GetCapabilities();
 
     virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
   protected:
     void Process();
   private:
@@ -50,8 +67,27 @@ namespace JSONRPC
     bool Initialize();
     bool InitializeBlue();
     bool InitializeTCP();
+    bool InitializePoller();
     void Deinitialize();
 
+    class CTCPClient;
+    class CRequestJob;
+
+    void AcceptConnection(SOCKET server);
+    bool ReadConnection(unsigned int index);
+    void ReadConnections();
+    void RemoveConnection(unsigned int index);
+    void ReapConnections(bool bWait);
+    int  GetConnection(SOCKET socket) const;
+    bool IsServer(SOCKET socket) const;
+    void DispatchRequest(CTCPClient *client);
+    void FlushConnections();
+
+    /*!
+     * @brief Interrupt the server thread's wait, called from other threads after queueing data or finishing a request.
+     */
+    void WakeUp();
+
     class CTCPClient : public IClient
     {
     public:
@@ -72,9 +108,61 @@ namespace JSONRPC
 
       virtual bool IsNew() const { return m_new; }
 
+      /*!
+       * @brief Write as much of the queued data as the socket takes.
+       * @return True if all queued data was written.
+       */
+      bool Flush();
+
+      /*!
+       * @brief Close the socket, without the websocket closing handshake.
+       */
+      void Close();
+
+      /*!
+       * @return True if more data is queued than the client is allowed to lag behind.
+       */
+      bool IsSendQueueFull();
+
+      /*!
+       * @return True if the client shouldn't be read from until it caught up with its responses and requests.
+       */
+      bool IsStalled();
+
+      /*!
+       * @brief Get the next request to execute, if the previous one finished.
+       * @param request The request.
+       * @return True if a request was returned, false otherwise.
+       */
+      bool PopRequest(std::string &request);
+
+      /*!
+       * @brief Mark the running request as finished.
+       */
+      void FinishRequest();
+
+      /*!
+       * @brief Called by a request job of this client when it's created and destroyed.
+       */
+      void AddJob();
+      void RemoveJob();
+
+      /*!
+       * @param jobID The id of the job that executes the running request.
+       */
+      void SetJob(unsigned int jobID);
+
+      /*!
+       * @brief Get the running request's job, the client can't be deleted until it's gone.
+       * @param jobID The id of the job.
+       * @return True if a request job still references this client.
+       */
+      bool GetJob(unsigned int &jobID);
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
+      bool             m_readPending;
       CCriticalSection m_critSection;
 
     protected:
@@ -85,6 +173,11 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_sendQueue;
+      std::deque<std::string> m_requests;
+      bool m_busy;
+      unsigned int m_jobs;   /*!< request jobs that reference this client */
+      unsigned int m_jobID;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -107,7 +200,13 @@ namespace JSONRPC
     };
 
     std::vector<CTCPClient*> m_connections;
+    std::vector<CTCPClient*> m_closedConnections;
     std::vector<SOCKET> m_servers;
+    CCriticalSection m_critSection;
+#ifdef TCPSERVER_USE_EPOLL
+    int m_epoll;
+    int m_wakeup;   /*!< eventfd that interrupts epoll_wait() */
+#endif
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
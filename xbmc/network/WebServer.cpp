@@ -304,6 +304,10 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
       ret = CreateMemoryDownloadResponse(request.connection, handler->GetHTTPResponseData(), handler->GetHTTPResonseDataLength(), true, true, response);
       break;
 
+    case HTTPStringDownload:
+      ret = CreateStringDownloadResponse(request.connection, handler->DetachHTTPResponseString(), response);
+      break;
+
     case HTTPError:
       ret = CreateErrorResponse(request.connection, handler->GetHTTPResonseCode(), request.method, response);
       break;
@@ -434,6 +438,23 @@ int CWebServer::CreateMemoryDownloadResponse(struct MHD_Connection *connection,
   return MHD_NO;
 }
 
+int CWebServer::CreateStringDownloadResponse(struct MHD_Connection *connection, string *data, struct MHD_Response *&response)
+{
+  if (data == NULL)
+    return MHD_NO;
+
+  // the string is read from directly and deleted together with the response
+  response = MHD_create_response_from_callback ( data->size(),
+                                                 32 * 1024,
+                                                 &CWebServer::StringReaderCallback, data,
+                                                 &CWebServer::StringReaderFreeCallback);
+  if (response)
+    return MHD_YES;
+
+  delete data;
+  return MHD_NO;
+}
+
 int CWebServer::SendErrorResponse(struct MHD_Connection *connection, int errorType, HTTPMethod method)
 {
   struct MHD_Response *response = NULL;
@@ -478,6 +499,30 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
   delete file;
 }
 
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::StringReaderCallback (void *cls, uint64_t pos, char *buf, size_t max)
+#elif (MHD_VERSION >= 0x00040001)
+int CWebServer::StringReaderCallback(void *cls, uint64_t pos, char *buf, int max)
+#else   //libmicrohttpd < 0.4.0
+int CWebServer::StringReaderCallback(void *cls, size_t pos, char *buf, int max)
+#endif
+{
+  string *data = (string *)cls;
+  if (pos >= data->size())
+    return -1;
+
+  size_t size = data->size() - (size_t)pos;
+  if (size > (size_t)max)
+    size = (size_t)max;
+  memcpy(buf, data->c_str() + pos, size);
+  return size;
+}
+
+void CWebServer::StringReaderFreeCallback(void *cls)
+{
+  delete (string *)cls;
+}
+
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
   // WARNING: when using MHD_USE_THREAD_PER_CONNECTION, set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
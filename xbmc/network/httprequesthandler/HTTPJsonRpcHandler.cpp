@@ -26,6 +26,8 @@
 #include "interfaces/json-rpc/JSONUtils.h"
 
 #define MAX_STRING_POST_SIZE 20000
+// responses bigger than this are handed over to the webserver instead of being copied
+#define MIN_STRING_DOWNLOAD_SIZE 65536
 #define PAGE_JSONRPC_INFO   "<html><head><title>JSONRPC</title></head><body>JSONRPC active and working</body></html>"
 
 using namespace std;
@@ -50,7 +52,8 @@ int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
     }
 
     CHTTPClient client;
-    m_response = CJSONRPC::MethodCall(m_request, request.webserver, &client);
+    m_response.clear();
+    CJSONRPC::MethodCall(m_request, request.webserver, &client, m_response);
 
     m_responseHeaderFields.insert(pair<string, string>("Content-Type", "application/json"));
 
@@ -59,12 +62,19 @@ int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
   else
     m_response = PAGE_JSONRPC_INFO;
   
-  m_responseType = HTTPMemoryDownloadNoFreeCopy;
+  m_responseType = m_response.size() >= MIN_STRING_DOWNLOAD_SIZE ? HTTPStringDownload : HTTPMemoryDownloadNoFreeCopy;
   m_responseCode = MHD_HTTP_OK;
 
   return MHD_YES;
 }
 
+std::string* CHTTPJsonRpcHandler::DetachHTTPResponseString()
+{
+  string *response = new string();
+  response->swap(m_response);
+  return response;
+}
+
 #if (MHD_VERSION >= 0x00040001)
 bool CHTTPJsonRpcHandler::appendPostData(const char *data, size_t size)
 #else
@@ -34,6 +34,7 @@ public:
 
   virtual void* GetHTTPResponseData() const { return (void *)m_response.c_str(); };
   virtual size_t GetHTTPResonseDataLength() const { return m_response.size(); }
+  virtual std::string* DetachHTTPResponseString();
 
   virtual int GetPriority() const { return 2; }
 
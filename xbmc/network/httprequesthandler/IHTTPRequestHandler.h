@@ -51,7 +51,8 @@ enum HTTPResponseType
   HTTPMemoryDownloadNoFreeNoCopy,
   HTTPMemoryDownloadNoFreeCopy,
   HTTPMemoryDownloadFreeNoCopy,
-  HTTPMemoryDownloadFreeCopy
+  HTTPMemoryDownloadFreeCopy,
+  HTTPStringDownload
 };
 
 typedef struct HTTPRequest
@@ -76,6 +77,8 @@ public:
   virtual size_t GetHTTPResonseDataLength() const { return 0; }
   virtual std::string GetHTTPRedirectUrl() const { return ""; }
   virtual std::string GetHTTPResponseFile() const { return ""; }
+  // Hands the response over to the webserver without copying it (HTTPStringDownload)
+  virtual std::string* DetachHTTPResponseString() { return NULL; }
 
   // The higher the more important
   virtual int GetPriority() const { return 0; }
@@ -1071,3 +1071,25 @@ int CPVRChannelGroup::GetEPGAll(CFileItemList &results)
 
   return results.Size() - iInitialSize;
 }
+
+int CPVRChannelGroup::GetEPGChannels(CFileItemList &results)
+{
+  int iInitialSize = results.Size();
+  CSingleLock lock(m_critSection);
+
+  for (unsigned int iChannelPtr = 0; iChannelPtr < size(); iChannelPtr++)
+  {
+    CPVRChannel *channel = at(iChannelPtr).channel;
+    if (!channel || channel->IsHidden())
+      continue;
+
+    CEpg *epg = channel->GetEPG();
+    if (!epg || epg->Size() == 0)
+      continue;
+
+    CFileItemPtr entry(new CFileItem(*channel));
+    results.Add(entry);
+  }
+
+  return results.Size() - iInitialSize;
+}
@@ -369,6 +369,14 @@ namespace PVR
      */
     virtual int GetEPGAll(CFileItemList &results);
 
+    /*!
+     * @brief Get all visible channels that have an EPG table with entries.
+     *        The entries themselves can be retrieved from the EPG index.
+     * @param results The fileitem list to store the results in.
+     * @return The amount of channels that were added.
+     */
+    virtual int GetEPGChannels(CFileItemList &results);
+
     /*!
      * @brief Get all entries that are active now.
      * @param results The fileitem list to store the results in.
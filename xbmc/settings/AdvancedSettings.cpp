@@ -26,7 +26,9 @@
 #include "Application.h"
 #include "network/DNSNameCache.h"
 #include "filesystem/File.h"
+#include "interfaces/IAnnouncer.h"
 #include "utils/LangCodeExpander.h"
+#include "utils/RegExp.h"
 #include "LangInfo.h"
 #include "settings/GUISettings.h"
 #include "settings/Settings.h"
@@ -35,6 +37,7 @@
 #include "utils/URIUtils.h"
 #include "utils/XMLUtils.h"
 #include "utils/log.h"
+#include "threads/SingleLock.h"
 #include "filesystem/SpecialProtocol.h"
 
 using namespace XFILE;
@@ -50,6 +53,7 @@ void CAdvancedSettings::Initialize()
   m_audioApplyDrc = true;
   m_dvdplayerIgnoreDTSinWAV = false;
   m_audioResample = 0;
+  m_audioResampleQuality = 1;
   m_allowTranscode44100 = false;
   m_audioForceDirectSound = false;
   m_audioAudiophile = false;
@@ -92,6 +96,8 @@ void CAdvancedSettings::Initialize()
   m_videoDefaultPlayer = "dvdplayer";
   m_videoDefaultDVDPlayer = "dvdplayer";
   m_videoIgnoreSecondsAtStart = 3*60;
+  m_videoProbeCache = true;
+  m_videoKeyframeIndexRate = 2048;
   m_videoIgnorePercentAtEnd   = 8.0f;
   m_videoPlayCountMinimumPercent = 90.0f;
   m_videoVDPAUScaling = false;
@@ -188,6 +194,7 @@ void CAdvancedSettings::Initialize()
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
   m_sambastatfiles = true;
+  m_sambastatthreads = 4; // directory entries are stat'ed with this many connections
 
   m_bHTTPDirectoryStatFilesize = false;
 
@@ -252,6 +259,8 @@ void CAdvancedSettings::Initialize()
   m_curlretries = 2;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
+  m_nfsFileContexts = 8;          //nfs connections per export for files opened for reading
+  m_nfsReadAhead = 4;             //nfs READs kept in flight for sequential reads
 
   m_fullScreen = m_startFullScreen = false;
   m_showExitButton = true;
@@ -301,12 +310,18 @@ void CAdvancedSettings::Initialize()
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_announceAsync = true;
+  m_announceCoalesceFlags = 0;
+  m_announceQueueSize = 1000;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 0;
+  m_guiTraceDirtyRegions = false;
   m_guiDirtyRegionNoFlipTimeout = -1;
+  m_guiIdleRefreshInterval = 500;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -322,6 +337,10 @@ bool CAdvancedSettings::Load()
   for (unsigned int i = 0; i < m_settingsFiles.size(); i++)
     ParseSettingsFile(m_settingsFiles[i]);
   ParseSettingsFile(g_settings.GetUserDataItem("advancedsettings.xml"));
+
+  // the expressions of the previous profile aren't needed anymore
+  CompileRegExpLists();
+  CRegExp::ClearCache();
   return true;
 }
 
@@ -378,6 +397,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "percentseekbackwardbig", m_musicPercentSeekBackwardBig, -100, 0);
 
     XMLUtils::GetInt(pElement, "resample", m_audioResample, 0, 192000);
+    XMLUtils::GetInt(pElement, "resamplequality", m_audioResampleQuality, 0, 2);
     XMLUtils::GetBoolean(pElement, "allowtranscode44100", m_allowTranscode44100);
     XMLUtils::GetBoolean(pElement, "forceDirectSound", m_audioForceDirectSound);
     XMLUtils::GetBoolean(pElement, "audiophile", m_audioAudiophile);
@@ -437,6 +457,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     // 101 on purpose - can be used to never automark as watched
     XMLUtils::GetFloat(pElement, "playcountminimumpercent", m_videoPlayCountMinimumPercent, 0.0f, 101.0f);
     XMLUtils::GetInt(pElement, "ignoresecondsatstart", m_videoIgnoreSecondsAtStart, 0, 900);
+    XMLUtils::GetBoolean(pElement, "probecache", m_videoProbeCache);
+    XMLUtils::GetInt(pElement, "keyframeindexrate", m_videoKeyframeIndexRate, 0, 1024 * 1024);
     XMLUtils::GetFloat(pElement, "ignorepercentatend", m_videoIgnorePercentAtEnd, 0, 100.0f);
 
     XMLUtils::GetInt(pElement, "smallstepbackseconds", m_videoSmallStepBackSeconds, 1, INT_MAX);
@@ -671,6 +693,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetInt(pElement, "nfsfilecontexts", m_nfsFileContexts, 0, 64);
+    XMLUtils::GetInt(pElement, "nfsreadahead", m_nfsReadAhead, 1, 16);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
   }
 
@@ -681,12 +705,39 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("announcements");
+  if (pElement)
+  {
+    XMLUtils::GetBoolean(pElement, "async", m_announceAsync);
+    XMLUtils::GetUInt(pElement, "queuesize", m_announceQueueSize);
+    /* the queue has to hold at least the announcement that's being added */
+    if (m_announceQueueSize < 1)
+      m_announceQueueSize = 1;
+
+    CStdString coalesce;
+    if (XMLUtils::GetString(pElement, "coalesce", coalesce))
+    {
+      m_announceCoalesceFlags = 0;
+      CStdStringArray flags = StringUtils::SplitString(coalesce, ",");
+      for (unsigned int i = 0; i < flags.size(); i++)
+      {
+        flags[i].Trim();
+        for (int flag = ANNOUNCEMENT::Player; flag <= ANNOUNCEMENT::Other; flag <<= 1)
+        {
+          if (flags[i].Equals(ANNOUNCEMENT::AnnouncementFlagToString((ANNOUNCEMENT::AnnouncementFlag)flag)))
+            m_announceCoalesceFlags |= flag;
+        }
+      }
+    }
+  }
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
     XMLUtils::GetString(pElement,  "doscodepage",   m_sambadoscodepage);
     XMLUtils::GetInt(pElement, "clienttimeout", m_sambaclienttimeout, 5, 100);
     XMLUtils::GetBoolean(pElement, "statfiles", m_sambastatfiles);
+    XMLUtils::GetInt(pElement, "statthreads", m_sambastatthreads, 0, 16);
   }
 
   pElement = pRootElement->FirstChildElement("httpdirectory");
@@ -1030,7 +1081,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   {
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
+    XMLUtils::GetBoolean(pElement, "tracedirtyregions",     m_guiTraceDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetInt(pElement, "idlerefreshinterval",       m_guiIdleRefreshInterval, 40, 10000);
   }
 
   // load in the GUISettings overrides:
@@ -1048,6 +1101,60 @@ void CAdvancedSettings::Clear()
   m_audioExcludeFromScanRegExps.clear();
   m_audioExcludeFromListingRegExps.clear();
   m_pictureExcludeFromListingRegExps.clear();
+
+  CSingleLock lock(m_regExpSection);
+  m_regExpLists.clear();
+  m_tvshowEnumRegExpList.reset();
+}
+
+void CAdvancedSettings::CompileRegExpLists()
+{
+  const CStdStringArray *arrays[] = { &m_videoExcludeFromListingRegExps, &m_moviesExcludeFromScanRegExps,
+                                      &m_tvshowExcludeFromScanRegExps, &m_audioExcludeFromListingRegExps,
+                                      &m_audioExcludeFromScanRegExps, &m_pictureExcludeFromListingRegExps,
+                                      &m_videoStackRegExps };
+
+  /* the lists are built first and swapped in at once, GetRegExpList() is called from other threads */
+  RegExpLists regExpLists;
+  for (unsigned int i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+  {
+    CRegExpList *list = new CRegExpList(true);
+    for (unsigned int j = 0; j < arrays[i]->size(); j++)
+    {
+      if (!list->Add((*arrays[i])[j]))
+        CLog::Log(LOGERROR, "%s: Invalid RegExp:'%s'", __FUNCTION__, (*arrays[i])[j].c_str());
+    }
+    list->Combine();
+    regExpLists[arrays[i]] = boost::shared_ptr<const CRegExpList>(list);
+  }
+
+  CRegExpList *tvshowEnum = new CRegExpList();
+  for (unsigned int i = 0; i < m_tvshowEnumRegExps.size(); i++)
+  {
+    if (!tvshowEnum->Add(m_tvshowEnumRegExps[i].regexp))
+      CLog::Log(LOGERROR, "%s: Invalid TV show RegExp:'%s'", __FUNCTION__, m_tvshowEnumRegExps[i].regexp.c_str());
+  }
+  tvshowEnum->Combine();
+  boost::shared_ptr<const CRegExpList> tvshowEnumRegExpList(tvshowEnum);
+
+  CSingleLock lock(m_regExpSection);
+  m_regExpLists.swap(regExpLists);
+  m_tvshowEnumRegExpList.swap(tvshowEnumRegExpList);
+}
+
+boost::shared_ptr<const CRegExpList> CAdvancedSettings::GetRegExpList(const CStdStringArray &regexps) const
+{
+  CSingleLock lock(m_regExpSection);
+  RegExpLists::const_iterator it = m_regExpLists.find(&regexps);
+  if (it == m_regExpLists.end())
+    return boost::shared_ptr<const CRegExpList>();
+  return it->second;
+}
+
+boost::shared_ptr<const CRegExpList> CAdvancedSettings::GetTVShowEnumRegExpList() const
+{
+  CSingleLock lock(m_regExpSection);
+  return m_tvshowEnumRegExpList;
 }
 
 void CAdvancedSettings::GetCustomTVRegexps(TiXmlElement *pRootElement, SETTINGS_TVSHOWLIST& settings)
@@ -20,11 +20,15 @@
  *
  */
 
+#include <map>
 #include <vector>
+#include <boost/shared_ptr.hpp>
+#include "threads/CriticalSection.h"
 #include "utils/StdString.h"
 #include "utils/GlobalsHandling.h"
 
 class TiXmlElement;
+class CRegExpList;
 
 class DatabaseSettings
 {
@@ -95,6 +99,7 @@ class CAdvancedSettings
     float m_audioPlayCountMinimumPercent;
     bool m_dvdplayerIgnoreDTSinWAV;
     int m_audioResample;
+    int m_audioResampleQuality;
     bool m_allowTranscode44100;
     bool m_audioForceDirectSound;
     bool m_audioAudiophile;
@@ -131,6 +136,8 @@ class CAdvancedSettings
     int m_musicPercentSeekBackwardBig;
     int m_videoBlackBarColour;
     int m_videoIgnoreSecondsAtStart;
+    bool m_videoProbeCache;
+    int m_videoKeyframeIndexRate; ///< KB/s the keyframes of a file are indexed at in the background, 0 to not index them
     float m_videoIgnorePercentAtEnd;
     CStdString m_audioHost;
     bool m_audioApplyDrc;
@@ -210,6 +217,7 @@ class CAdvancedSettings
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
     bool m_sambastatfiles;
+    int m_sambastatthreads;
 
     bool m_bHTTPDirectoryStatFilesize;
 
@@ -279,6 +287,8 @@ class CAdvancedSettings
     int m_curllowspeedtime;
     int m_curlretries;
     bool m_curlDisableIPV6;
+    int m_nfsFileContexts;
+    int m_nfsReadAhead;
 
     bool m_fullScreen;
     bool m_startFullScreen;
@@ -331,18 +341,44 @@ class CAdvancedSettings
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
+    bool m_guiTraceDirtyRegions;  // record the dirty regions and rendered passes to special://temp/dirtyregions.trace
     int  m_guiDirtyRegionNoFlipTimeout;
+    int  m_guiIdleRefreshInterval; // ms between GUI updates while nothing is drawn and nothing wakes the render loop
 
     unsigned int m_cacheMemBufferSize;
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    bool m_announceAsync;             /*!< deliver announcements from a separate thread */
+    int m_announceCoalesceFlags;      /*!< announcement flags for which only the latest of each message and item is delivered */
+    unsigned int m_announceQueueSize; /*!< maximum number of announcements waiting to be delivered */
+
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
     void ParseSettingsFile(const CStdString &file);
 
     float GetDisplayLatency(float refreshrate);
+
+    /*!
+     \brief Get the compiled (case insensitive) list of one of the exclude or stacking expression arrays
+     \param regexps one of the arrays above, e.g. m_videoExcludeFromListingRegExps or m_videoStackRegExps
+     \return the list compiled when the settings were loaded, empty if regexps isn't one of the arrays
+     */
+    boost::shared_ptr<const CRegExpList> GetRegExpList(const CStdStringArray &regexps) const;
+
+    /*!
+     \brief Get the compiled list of the expressions of m_tvshowEnumRegExps
+     */
+    boost::shared_ptr<const CRegExpList> GetTVShowEnumRegExpList() const;
+
+  private:
+    void CompileRegExpLists();
+
+    typedef std::map<const CStdStringArray*, boost::shared_ptr<const CRegExpList> > RegExpLists;
+    RegExpLists m_regExpLists;
+    boost::shared_ptr<const CRegExpList> m_tvshowEnumRegExpList;
+    mutable CCriticalSection m_regExpSection; /*!< the lists are replaced while other threads get them */
 };
 
 XBMC_GLOBAL(CAdvancedSettings,g_advancedSettings);
@@ -105,6 +105,7 @@ void CAppParamParser::DisplayHelp()
   printf("  --debug\t\tEnable debug logging\n");
   printf("  --version\t\tPrint version information\n");
   printf("  --test\t\tEnable test mode. [FILE] required.\n");
+  printf("  --startup-benchmark\tQuit once the first window is shown and print the startup time\n");
   printf("  --settings=<filename>\t\tLoads specified file after advancedsettings.xml replacing any settings specified\n");
   printf("  \t\t\t\tspecified file must exist in special://xbmc/system/\n");
   exit(0);
@@ -135,6 +136,8 @@ void CAppParamParser::ParseArg(const CStdString &arg)
     g_application.SetEnableLegacyRes(true);
   else if (arg == "--test")
     m_testmode = true;
+  else if (arg == "--startup-benchmark")
+    g_application.SetStartupBenchmark(true);
   else if (arg.substr(0, 11) == "--settings=")
     g_advancedSettings.AddSettingsFile(arg.substr(11));
   else if (arg.length() != 0 && arg[0] != '-')
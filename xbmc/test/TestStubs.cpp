@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "TestStubs.h"
+#include "filesystem/File.h"
+#include "filesystem/Directory.h"
+#include "utils/log.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+/* utils/log.o would pull in the log writer thread and the file layer */
+CLog::CLogGlobals::~CLogGlobals()
+{ }
+
+void CLog::Log(int loglevel, const char *format, ... )
+{ }
+
+/* CJobManager only sleeps while it cancels its jobs, linux/XTimeUtils.o would pull in the timezone */
+void WINAPI Sleep(DWORD dwMilliSeconds)
+{
+  usleep(dwMilliSeconds * 1000);
+}
+
+std::map<std::string, std::string> g_testFiles;
+
+namespace
+{
+  std::string *g_openFile = NULL;
+  size_t g_position = 0;
+}
+
+namespace XFILE
+{
+  CFile::CFile() : m_flags(0), m_pFile(NULL), m_pBuffer(NULL), m_bitStreamStats(NULL) { }
+  CFile::~CFile() { Close(); }
+
+  bool CFile::Open(const CStdString& strFileName, unsigned int flags)
+  {
+    std::map<std::string, std::string>::iterator it = g_testFiles.find(strFileName);
+    if (it == g_testFiles.end())
+      return false;
+    g_openFile = &it->second;
+    g_position = 0;
+    return true;
+  }
+
+  bool CFile::OpenForWrite(const CStdString& strFileName, bool bOverWrite)
+  {
+    g_openFile = &g_testFiles[strFileName];
+    g_openFile->clear();
+    g_position = 0;
+    return true;
+  }
+
+  unsigned int CFile::Read(void* lpBuf, int64_t uiBufSize)
+  {
+    if (!g_openFile)
+      return 0;
+    size_t size = std::min((size_t)uiBufSize, g_openFile->size() - g_position);
+    memcpy(lpBuf, g_openFile->c_str() + g_position, size);
+    g_position += size;
+    return size;
+  }
+
+  int CFile::Write(const void* lpBuf, int64_t uiBufSize)
+  {
+    if (!g_openFile)
+      return -1;
+    g_openFile->append((const char*)lpBuf, (size_t)uiBufSize);
+    return (int)uiBufSize;
+  }
+
+  int64_t CFile::GetLength()
+  {
+    return g_openFile ? g_openFile->size() : 0;
+  }
+
+  void CFile::Close()
+  {
+    g_openFile = NULL;
+  }
+
+  int CFile::Stat(const CStdString& strFileName, struct __stat64* buffer)
+  {
+    std::map<std::string, std::string>::iterator it = g_testFiles.find(strFileName);
+    if (it == g_testFiles.end())
+      return -1;
+    memset(buffer, 0, sizeof(struct __stat64));
+    buffer->st_size = it->second.size();
+    return 0;
+  }
+
+  bool CDirectory::Exists(const CStdString& strPath) { return true; }
+  bool CDirectory::Create(const CStdString& strPath) { return true; }
+}
@@ -0,0 +1,36 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+/*!
+ * @brief Stubs shared by the unit tests, linked as test/TestStubs.o.
+ *
+ * Nothing is logged, and the file layer keeps the files in g_testFiles. Only one file is open at a
+ * time. CDirectory::Exists() is always true and CDirectory::Create() always succeeds. Sleep() is
+ * implemented with usleep().
+ */
+
+/*! @brief The files known to XFILE::CFile, by path. Tests clear it to start without files. */
+extern std::map<std::string, std::string> g_testFiles;
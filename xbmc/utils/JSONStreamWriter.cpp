@@ -0,0 +1,197 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <locale>
+#include <math.h>
+#include <sstream>
+
+#include "JSONStreamWriter.h"
+
+using namespace std;
+
+CJSONStreamWriter::CJSONStreamWriter(string &output, bool compact) :
+    m_output(output),
+    m_bValid(true)
+{
+#if YAJL_MAJOR == 2
+  m_gen = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_gen, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_gen, yajl_gen_indent_string, "\t");
+#else
+  yajl_gen_config conf = { compact ? 0 : 1, "\t" };
+  m_gen = yajl_gen_alloc(&conf, NULL);
+#endif
+}
+
+CJSONStreamWriter::~CJSONStreamWriter(void)
+{
+  yajl_gen_clear(m_gen);
+  yajl_gen_free(m_gen);
+}
+
+void CJSONStreamWriter::StartObject(void)
+{
+  m_bValid &= yajl_gen_status_ok == yajl_gen_map_open(m_gen);
+  Flush();
+}
+
+void CJSONStreamWriter::EndObject(void)
+{
+  m_bValid &= yajl_gen_status_ok == yajl_gen_map_close(m_gen);
+  Flush();
+}
+
+void CJSONStreamWriter::StartArray(void)
+{
+  m_bValid &= yajl_gen_status_ok == yajl_gen_array_open(m_gen);
+  Flush();
+}
+
+void CJSONStreamWriter::EndArray(void)
+{
+  m_bValid &= yajl_gen_status_ok == yajl_gen_array_close(m_gen);
+  Flush();
+}
+
+void CJSONStreamWriter::WriteKey(const string &key)
+{
+  m_bValid &= WriteString(key);
+  Flush();
+}
+
+void CJSONStreamWriter::WriteValue(const CVariant &value)
+{
+  m_bValid &= InternalWrite(value);
+  Flush();
+}
+
+void CJSONStreamWriter::Flush(void)
+{
+  const unsigned char * buffer;
+
+#if YAJL_MAJOR == 2
+  size_t length;
+  yajl_gen_get_buf(m_gen, &buffer, &length);
+#else
+  unsigned int length;
+  yajl_gen_get_buf(m_gen, &buffer, &length);
+#endif
+  m_output.append((const char *)buffer, length);
+
+  // only clears the buffer, the generator keeps its state
+  yajl_gen_clear(m_gen);
+}
+
+bool CJSONStreamWriter::WriteString(const string &value)
+{
+#if YAJL_MAJOR == 2
+  return yajl_gen_status_ok == yajl_gen_string(m_gen, (const unsigned char*)value.c_str(), (size_t)value.size());
+#else
+  return yajl_gen_status_ok == yajl_gen_string(m_gen, (const unsigned char*)value.c_str(), value.size());
+#endif
+}
+
+bool CJSONStreamWriter::WriteDouble(double value)
+{
+  // yajl_gen_double() formats with the process' LC_NUMERIC, which other threads may change.
+  // Format the number with the classic locale instead, as yajl would in the "C" locale
+  if (isnan(value) || isinf(value))
+    return false;
+
+  ostringstream number;
+  number.imbue(locale::classic());
+  number.precision(20);
+  number << value;
+
+  string str = number.str();
+#if YAJL_MAJOR == 2
+  return yajl_gen_status_ok == yajl_gen_number(m_gen, str.c_str(), (size_t)str.size());
+#else
+  return yajl_gen_status_ok == yajl_gen_number(m_gen, str.c_str(), str.size());
+#endif
+}
+
+bool CJSONStreamWriter::InternalWrite(const CVariant &value)
+{
+  bool success = false;
+
+  switch (value.type())
+  {
+  case CVariant::VariantTypeInteger:
+#if YAJL_MAJOR == 2
+    success = yajl_gen_status_ok == yajl_gen_integer(m_gen, (long long int)value.asInteger());
+#else
+    success = yajl_gen_status_ok == yajl_gen_integer(m_gen, (long int)value.asInteger());
+#endif
+    break;
+  case CVariant::VariantTypeUnsignedInteger:
+#if YAJL_MAJOR == 2
+    success = yajl_gen_status_ok == yajl_gen_integer(m_gen, (long long int)value.asUnsignedInteger());
+#else
+    success = yajl_gen_status_ok == yajl_gen_integer(m_gen, (long int)value.asUnsignedInteger());
+#endif
+    break;
+  case CVariant::VariantTypeDouble:
+    success = WriteDouble(value.asDouble());
+    break;
+  case CVariant::VariantTypeBoolean:
+    success = yajl_gen_status_ok == yajl_gen_bool(m_gen, value.asBoolean() ? 1 : 0);
+    break;
+  case CVariant::VariantTypeString:
+#if YAJL_MAJOR == 2
+    success = yajl_gen_status_ok == yajl_gen_string(m_gen, (const unsigned char*)value.c_str(), (size_t)value.size());
+#else
+    success = yajl_gen_status_ok == yajl_gen_string(m_gen, (const unsigned char*)value.c_str(), value.size());
+#endif
+    break;
+  case CVariant::VariantTypeArray:
+    success = yajl_gen_status_ok == yajl_gen_array_open(m_gen);
+
+    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array() && success; itr++)
+      success &= InternalWrite(*itr);
+
+    if (success)
+      success = yajl_gen_status_ok == yajl_gen_array_close(m_gen);
+
+    break;
+  case CVariant::VariantTypeObject:
+    success = yajl_gen_status_ok == yajl_gen_map_open(m_gen);
+
+    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map() && success; itr++)
+    {
+      success &= WriteString(itr->first);
+      if (success)
+        success &= InternalWrite(itr->second);
+    }
+
+    if (success)
+      success &= yajl_gen_status_ok == yajl_gen_map_close(m_gen);
+
+    break;
+  case CVariant::VariantTypeConstNull:
+  case CVariant::VariantTypeNull:
+  default:
+    success = yajl_gen_status_ok == yajl_gen_null(m_gen);
+    break;
+  }
+
+  return success;
+}
@@ -0,0 +1,80 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+#include "Variant.h"
+#include <string>
+#include <yajl/yajl_gen.h>
+#ifdef HAVE_YAJL_YAJL_VERSION_H
+#include <yajl/yajl_version.h>
+#endif
+
+/*!
+ * @brief Writes JSON incrementally into a string.
+ *
+ * Unlike CJSONVariantWriter the document doesn't have to exist as a CVariant tree, it can be written
+ * value by value. Output is appended to the string after every call, so yajl never holds more than
+ * the value that was just written. Numbers are always written with the classic locale, the
+ * process' LC_NUMERIC setting isn't touched.
+ */
+class CJSONStreamWriter
+{
+public:
+  /*!
+   * @param output The string to append the JSON to.
+   * @param compact False to indent the output.
+   */
+  CJSONStreamWriter(std::string &output, bool compact);
+  virtual ~CJSONStreamWriter(void);
+
+  void StartObject(void);
+  void EndObject(void);
+  void StartArray(void);
+  void EndArray(void);
+
+  /*!
+   * @brief Write the key of the next member of an object.
+   * @param key The key.
+   */
+  void WriteKey(const std::string &key);
+
+  /*!
+   * @brief Write a value, which can be a complete object or array.
+   * @param value The value.
+   */
+  void WriteValue(const CVariant &value);
+
+  /*!
+   * @return False if writing any of the values failed.
+   */
+  bool IsValid(void) const { return m_bValid; }
+
+private:
+  bool InternalWrite(const CVariant &value);
+  bool WriteString(const std::string &value);
+  bool WriteDouble(double value);
+  void Flush(void);
+
+  std::string &m_output;
+  yajl_gen     m_gen;
+  bool         m_bValid;
+};
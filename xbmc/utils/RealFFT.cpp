@@ -0,0 +1,227 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "RealFFT.h"
+
+#include <math.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+CRealFFT::CRealFFT(unsigned int size, WindowType window, unsigned int samples)
+{
+  // the size has to be a power of 2, the complex transform needs at least 2 points
+  m_size = 4;
+  while (m_size < size)
+    m_size <<= 1;
+  m_half = m_size / 2;
+
+  m_samples = samples && samples < m_size ? samples : m_size;
+
+  // the window, periodic so that consecutive blocks overlap nicely
+  m_window.resize(m_samples);
+  m_windowGain = 0.0f;
+  for (unsigned int i = 0; i < m_samples; i++)
+  {
+    double phase = 2.0 * M_PI * i / m_samples;
+    switch (window)
+    {
+    case WINDOW_HANN:
+      m_window[i] = (float)(0.5 - 0.5 * cos(phase));
+      break;
+    case WINDOW_HAMMING:
+      m_window[i] = (float)(0.54 - 0.46 * cos(phase));
+      break;
+    case WINDOW_BLACKMAN:
+      m_window[i] = (float)(0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase));
+      break;
+    default:
+      m_window[i] = 1.0f;
+      break;
+    }
+    m_windowGain += m_window[i];
+  }
+
+  // where each point goes before the butterflies
+  unsigned int bits = 0;
+  while ((1U << bits) < m_half)
+    bits++;
+  m_bitReverse.resize(m_half);
+  for (unsigned int i = 0; i < m_half; i++)
+  {
+    unsigned int reversed = 0;
+    for (unsigned int bit = 0; bit < bits; bit++)
+      if (i & (1U << bit))
+        reversed |= 1U << (bits - 1 - bit);
+    m_bitReverse[i] = reversed;
+  }
+
+  // twiddle factors of the stage with span h are stored at offset h - 1
+  m_twiddleRe.resize(m_half);
+  m_twiddleIm.resize(m_half);
+  for (unsigned int h = 1; h < m_half; h <<= 1)
+  {
+    for (unsigned int j = 0; j < h; j++)
+    {
+      double phase = -M_PI * j / h;
+      m_twiddleRe[h - 1 + j] = (float)cos(phase);
+      m_twiddleIm[h - 1 + j] = (float)sin(phase);
+    }
+  }
+
+  m_unpackRe.resize(m_half + 1);
+  m_unpackIm.resize(m_half + 1);
+  for (unsigned int k = 0; k <= m_half; k++)
+  {
+    double phase = -2.0 * M_PI * k / m_size;
+    m_unpackRe[k] = (float)cos(phase);
+    m_unpackIm[k] = (float)sin(phase);
+  }
+
+  m_re.resize(m_half);
+  m_im.resize(m_half);
+  m_outRe.resize(m_half + 1);
+  m_outIm.resize(m_half + 1);
+}
+
+void CRealFFT::Pack(const float *input, unsigned int stride)
+{
+  // even samples go into the real, odd ones into the imaginary parts
+  for (unsigned int n = 0; n < m_half; n++)
+  {
+    unsigned int i = 2 * n;
+    float even = i     < m_samples ? input[i * stride] * m_window[i] : 0.0f;
+    float odd  = i + 1 < m_samples ? input[(i + 1) * stride] * m_window[i + 1] : 0.0f;
+    m_re[m_bitReverse[n]] = even;
+    m_im[m_bitReverse[n]] = odd;
+  }
+}
+
+void CRealFFT::Butterflies()
+{
+  float *re = &m_re[0];
+  float *im = &m_im[0];
+
+  for (unsigned int h = 1; h < m_half; h <<= 1)
+  {
+    const float *twRe = &m_twiddleRe[h - 1];
+    const float *twIm = &m_twiddleIm[h - 1];
+
+    for (unsigned int s = 0; s < m_half; s += 2 * h)
+    {
+      float *aRe = re + s;
+      float *aIm = im + s;
+      float *bRe = aRe + h;
+      float *bIm = aIm + h;
+      unsigned int j = 0;
+
+#if defined(__SSE__)
+      for (; j + 4 <= h; j += 4)
+      {
+        __m128 wr = _mm_loadu_ps(twRe + j);
+        __m128 wi = _mm_loadu_ps(twIm + j);
+        __m128 xr = _mm_loadu_ps(bRe + j);
+        __m128 xi = _mm_loadu_ps(bIm + j);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+        __m128 ar = _mm_loadu_ps(aRe + j);
+        __m128 ai = _mm_loadu_ps(aIm + j);
+        _mm_storeu_ps(bRe + j, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(bIm + j, _mm_sub_ps(ai, ti));
+        _mm_storeu_ps(aRe + j, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(aIm + j, _mm_add_ps(ai, ti));
+      }
+#elif defined(__ARM_NEON__)
+      for (; j + 4 <= h; j += 4)
+      {
+        float32x4_t wr = vld1q_f32(twRe + j);
+        float32x4_t wi = vld1q_f32(twIm + j);
+        float32x4_t xr = vld1q_f32(bRe + j);
+        float32x4_t xi = vld1q_f32(bIm + j);
+        float32x4_t tr = vmlsq_f32(vmulq_f32(xr, wr), xi, wi);
+        float32x4_t ti = vmlaq_f32(vmulq_f32(xr, wi), xi, wr);
+        float32x4_t ar = vld1q_f32(aRe + j);
+        float32x4_t ai = vld1q_f32(aIm + j);
+        vst1q_f32(bRe + j, vsubq_f32(ar, tr));
+        vst1q_f32(bIm + j, vsubq_f32(ai, ti));
+        vst1q_f32(aRe + j, vaddq_f32(ar, tr));
+        vst1q_f32(aIm + j, vaddq_f32(ai, ti));
+      }
+#endif
+
+      // the first stages, and whatever the vector units didn't do
+      for (; j < h; j++)
+      {
+        float tr = bRe[j] * twRe[j] - bIm[j] * twIm[j];
+        float ti = bRe[j] * twIm[j] + bIm[j] * twRe[j];
+        bRe[j] = aRe[j] - tr;
+        bIm[j] = aIm[j] - ti;
+        aRe[j] += tr;
+        aIm[j] += ti;
+      }
+    }
+  }
+}
+
+void CRealFFT::Unpack(float *re, float *im)
+{
+  // X[k] = E[k] + W^k * O[k], where E and O are the spectra of the even and
+  // odd samples, recovered from Z[k] and conj(Z[N/2 - k])
+  for (unsigned int k = 0; k <= m_half; k++)
+  {
+    unsigned int a = k < m_half ? k : 0;
+    unsigned int b = k > 0 ? m_half - k : 0;
+
+    float zr = m_re[a], zi = m_im[a];
+    float cr = m_re[b], ci = -m_im[b];
+
+    float er = 0.5f * (zr + cr);
+    float ei = 0.5f * (zi + ci);
+    float or_ = 0.5f * (zi - ci);
+    float oi = -0.5f * (zr - cr);
+
+    re[k] = er + m_unpackRe[k] * or_ - m_unpackIm[k] * oi;
+    im[k] = ei + m_unpackRe[k] * oi + m_unpackIm[k] * or_;
+  }
+}
+
+void CRealFFT::Transform(const float *input, unsigned int stride, float *re, float *im)
+{
+  Pack(input, stride);
+  Butterflies();
+  Unpack(re, im);
+}
+
+void CRealFFT::Power(const float *input, unsigned int stride, float *power, unsigned int powerStride)
+{
+  Transform(input, stride, &m_outRe[0], &m_outIm[0]);
+  for (unsigned int k = 0; k <= m_half; k++)
+    power[k * powerStride] = m_outRe[k] * m_outRe[k] + m_outIm[k] * m_outIm[k];
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <vector>
+
+/*!
+ \brief Fast fourier transformation of real valued samples.
+
+ The samples are windowed, packed into a complex FFT of half the size and the
+ spectrum of the real signal is unpacked from its result. The bit reversal
+ and twiddle factors are computed once when the transform is created, the
+ butterflies of the larger stages run four at a time with SSE or NEON where
+ available.
+
+ The transform keeps its work buffers, so an instance must not be used by
+ several threads at the same time. Create one per user instead.
+ */
+class CRealFFT
+{
+public:
+  enum WindowType
+  {
+    WINDOW_RECTANGULAR = 0,
+    WINDOW_HANN,
+    WINDOW_HAMMING,
+    WINDOW_BLACKMAN
+  };
+
+  /*!
+   \brief Create a transform
+   \param size number of points of the transform, a power of 2 of at least 4
+   \param window the window applied to the samples
+   \param samples number of samples that are windowed, the transform is zero
+   padded up to size. 0 to use size samples
+   */
+  CRealFFT(unsigned int size, WindowType window = WINDOW_HANN, unsigned int samples = 0);
+
+  unsigned int GetSize() const { return m_size; }
+
+  /*!
+   \brief Number of bins of the spectrum, from DC up to and including Nyquist
+   */
+  unsigned int GetBins() const { return m_size / 2 + 1; }
+
+  /*!
+   \brief Transform samples into their spectrum
+   \param input the samples
+   \param stride distance between two samples in input, e.g. the number of channels
+   \param re real parts of the GetBins() bins
+   \param im imaginary parts of the GetBins() bins
+   */
+  void Transform(const float *input, unsigned int stride, float *re, float *im);
+
+  /*!
+   \brief Transform samples into the power |X[k]|^2 of each bin
+   \param input the samples
+   \param stride distance between two samples in input
+   \param power the GetBins() results
+   \param powerStride distance between two results in power
+   */
+  void Power(const float *input, unsigned int stride, float *power, unsigned int powerStride = 1);
+
+  /*!
+   \brief Sum of the window coefficients, the gain of the window for a constant signal
+   */
+  float GetWindowGain() const { return m_windowGain; }
+
+private:
+  void Pack(const float *input, unsigned int stride);
+  void Butterflies();
+  void Unpack(float *re, float *im);
+
+  unsigned int m_size;
+  unsigned int m_half;                ///< size of the complex transform
+  unsigned int m_samples;
+  float m_windowGain;
+  std::vector<float> m_window;
+  std::vector<unsigned int> m_bitReverse;
+  std::vector<float> m_twiddleRe;     ///< twiddle factors of all stages, one stage after the other
+  std::vector<float> m_twiddleIm;
+  std::vector<float> m_unpackRe;      ///< twiddle factors to unpack the real spectrum
+  std::vector<float> m_unpackIm;
+  std::vector<float> m_re;            ///< work buffers of the complex transform
+  std::vector<float> m_im;
+  std::vector<float> m_outRe;
+  std::vector<float> m_outIm;
+};
@@ -24,12 +24,113 @@
 #include "RegExp.h"
 #include "StdString.h"
 #include "log.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+
+#include <map>
 
 using namespace PCRE;
 
+// maximum number of compiled patterns kept in the cache
+#define REGEXP_CACHE_SIZE 1024
+
+struct CRegExp::CompiledPattern
+{
+  CompiledPattern(pcre* re, pcre_extra* sd) : m_re(re), m_sd(sd) {}
+  ~CompiledPattern()
+  {
+    if (m_sd)
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pcre_free_study(m_sd);
+#else
+      pcre_free(m_sd);
+#endif
+    pcre_free(m_re);
+  }
+
+  pcre*       m_re;
+  pcre_extra* m_sd;
+};
+
+namespace
+{
+  typedef boost::shared_ptr<CRegExp::CompiledPattern> CompiledPatternPtr;
+  typedef std::map<std::pair<std::string, int>, CompiledPatternPtr> CompiledPatternMap;
+
+  class CCompiledPatternCache
+  {
+  public:
+    CompiledPatternPtr Get(const std::string& re, int options, bool log)
+    {
+      std::pair<std::string, int> key(re, options);
+      {
+        CSingleLock lock(m_critSection);
+        CompiledPatternMap::const_iterator it = m_patterns.find(key);
+        if (it != m_patterns.end())
+          return it->second;
+      }
+
+      // compile outside of the lock, patterns are compiled from several threads
+      const char *errMsg = NULL;
+      int errOffset      = 0;
+      pcre* compiled = pcre_compile(re.c_str(), options, &errMsg, &errOffset, NULL);
+      if (!compiled)
+      {
+        if (log)
+          CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
+                    errMsg, errOffset, re.c_str());
+        return CompiledPatternPtr();
+      }
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pcre_extra* sd = pcre_study(compiled, PCRE_STUDY_JIT_COMPILE, &errMsg);
+#else
+      pcre_extra* sd = pcre_study(compiled, 0, &errMsg);
+#endif
+      CompiledPatternPtr pattern(new CRegExp::CompiledPattern(compiled, sd));
+
+      CSingleLock lock(m_critSection);
+      // another thread may have compiled the same pattern in the meantime
+      CompiledPatternMap::const_iterator it = m_patterns.find(key);
+      if (it != m_patterns.end())
+        return it->second;
+
+      if (m_patterns.size() >= REGEXP_CACHE_SIZE)
+        Purge();
+      if (m_patterns.size() < REGEXP_CACHE_SIZE)
+        m_patterns.insert(std::make_pair(key, pattern));
+
+      return pattern;
+    }
+
+    void Purge()
+    {
+      CSingleLock lock(m_critSection);
+      for (CompiledPatternMap::iterator it = m_patterns.begin(); it != m_patterns.end();)
+      {
+        if (it->second.unique())
+          m_patterns.erase(it++);
+        else
+          ++it;
+      }
+    }
+
+  private:
+    CCriticalSection   m_critSection;
+    CompiledPatternMap m_patterns;
+  };
+
+  CCompiledPatternCache& GetCompiledPatternCache()
+  {
+    static CCompiledPatternCache cache;
+    return cache;
+  }
+}
+
 CRegExp::CRegExp(bool caseless)
 {
   m_re          = NULL;
+  m_sd          = NULL;
   m_iOptions    = PCRE_DOTALL;
   if(caseless)
     m_iOptions |= PCRE_CASELESS;
@@ -41,29 +142,28 @@ CRegExp::CRegExp(bool caseless)
 CRegExp::CRegExp(const CRegExp& re)
 {
   m_re = NULL;
+  m_sd = NULL;
   m_iOptions = re.m_iOptions;
   *this = re;
 }
 
 const CRegExp& CRegExp::operator=(const CRegExp& re)
 {
-  size_t size;
-  Cleanup();
+  if (this == &re)
+    return *this;
+
+  // compiled patterns are immutable, so they can be shared
+  m_compiled = re.m_compiled;
+  m_re = re.m_re;
+  m_sd = re.m_sd;
   m_pattern = re.m_pattern;
-  if (re.m_re)
+  m_iOptions = re.m_iOptions;
+  if (m_re)
   {
-    if (pcre_fullinfo(re.m_re, NULL, PCRE_INFO_SIZE, &size) >= 0)
-    {
-      if ((m_re = (pcre*)malloc(size)))
-      {
-        memcpy(m_re, re.m_re, size);
-        memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
-        m_iMatchCount = re.m_iMatchCount;
-        m_bMatched = re.m_bMatched;
-        m_subject = re.m_subject;
-        m_iOptions = re.m_iOptions;
-      }
-    }
+    memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
+    m_iMatchCount = re.m_iMatchCount;
+    m_bMatched = re.m_bMatched;
+    m_subject = re.m_subject;
   }
   return *this;
 }
@@ -74,29 +174,47 @@ CRegExp::~CRegExp()
 }
 
 CRegExp* CRegExp::RegComp(const char *re)
+{
+  return Compile(re, true) ? this : NULL;
+}
+
+bool CRegExp::Compile(const char *re, bool log)
 {
   if (!re)
-    return NULL;
+    return false;
 
   m_bMatched         = false;
   m_iMatchCount      = 0;
-  const char *errMsg = NULL;
-  int errOffset      = 0;
 
   Cleanup();
 
-  m_re = pcre_compile(re, m_iOptions, &errMsg, &errOffset, NULL);
-  if (!m_re)
+  m_compiled = GetCompiledPatternCache().Get(re, m_iOptions, log);
+  if (!m_compiled)
   {
     m_pattern.clear();
-    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
-              errMsg, errOffset, re);
-    return NULL;
+    return false;
   }
 
+  m_re = m_compiled->m_re;
+  m_sd = m_compiled->m_sd;
   m_pattern = re;
 
-  return this;
+  return true;
+}
+
+void CRegExp::ClearCache()
+{
+  GetCompiledPatternCache().Purge();
+}
+
+bool CRegExp::Test(const char *str) const
+{
+  // like RegFind() but the match isn't kept, so it can be called concurrently
+  if (!m_re || !str)
+    return false;
+
+  int ovector[OVECCOUNT];
+  return pcre_exec(m_re, m_sd, str, strlen(str), 0, 0, ovector, OVECCOUNT) >= 0;
 }
 
 int CRegExp::RegFind(const char* str, int startoffset)
@@ -117,7 +235,7 @@ int CRegExp::RegFind(const char* str, int startoffset)
   }
 
   m_subject = str;
-  int rc = pcre_exec(m_re, NULL, str, strlen(str), startoffset, 0, m_iOvector, OVECCOUNT);
+  int rc = pcre_exec(m_re, m_sd, str, strlen(str), startoffset, 0, m_iOvector, OVECCOUNT);
 
   if (rc<1)
   {
@@ -264,3 +382,96 @@ void CRegExp::DumpOvector(int iLog /* = LOGDEBUG */)
   str += "}";
   CLog::Log(iLog, "regexp ovector=%s", str.c_str());
 }
+
+CRegExpList::CRegExpList(bool caseless)
+  : m_caseless(caseless), m_combined(caseless)
+{
+  m_bCombinable = true;
+  m_bCombined   = false;
+}
+
+bool CRegExpList::Add(const std::string& re)
+{
+  CRegExp regExp(m_caseless);
+  if (!regExp.RegComp(re.c_str()))
+    return false;
+
+  m_patterns.push_back(regExp);
+  m_bCombined = false;
+
+  // references and recursion by number or name don't work once the patterns
+  // are wrapped into a group of an alternation
+  static const char *uncombinable[] = { "\\g", "\\k", "(?P=", "(?P>", "(?&", "(?R", "(?(", "(*" };
+  for (unsigned int i = 0; i < sizeof(uncombinable) / sizeof(uncombinable[0]) && m_bCombinable; i++)
+  {
+    if (re.find(uncombinable[i]) != std::string::npos)
+      m_bCombinable = false;
+  }
+  for (size_t pos = 0; pos + 1 < re.size() && m_bCombinable; pos++)
+  {
+    if (re[pos] == '\\')
+    {
+      if (isdigit(re[pos + 1]) && re[pos + 1] != '0')
+        m_bCombinable = false;
+      pos++; // skip the escaped character
+    }
+    else if (re[pos] == '(' && re[pos + 1] == '?' && pos + 2 < re.size() &&
+             (isdigit(re[pos + 2]) || re[pos + 2] == '+' || re[pos + 2] == '-'))
+      m_bCombinable = false;
+  }
+
+  return true;
+}
+
+void CRegExpList::Clear()
+{
+  m_patterns.clear();
+  m_bCombinable = true;
+  m_bCombined   = false;
+}
+
+void CRegExpList::Combine()
+{
+  m_bCombined = false;
+  if (!m_bCombinable || m_patterns.size() < 2)
+    return;
+
+  std::string combined;
+  for (VECCREGEXP::const_iterator it = m_patterns.begin(); it != m_patterns.end(); ++it)
+  {
+    if (!combined.empty())
+      combined += "|";
+    combined += "(?:" + it->GetPattern() + ")";
+  }
+
+  if (!m_combined.Compile(combined.c_str(), false))
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to combine %u patterns, matching them one by one", __FUNCTION__, (unsigned int)m_patterns.size());
+    m_bCombinable = false;
+    return;
+  }
+
+  m_bCombined = true;
+}
+
+bool CRegExpList::Matches(const char *str) const
+{
+  if (m_bCombined)
+    return m_combined.Test(str);
+
+  return FindFirst(str) >= 0;
+}
+
+int CRegExpList::FindFirst(const char *str) const
+{
+  // most strings don't match any of the patterns
+  if (m_bCombined && !m_combined.Test(str))
+    return -1;
+
+  for (unsigned int i = 0; i < m_patterns.size(); i++)
+  {
+    if (m_patterns[i].Test(str))
+      return (int)i;
+  }
+  return -1;
+}
@@ -25,6 +25,7 @@
 
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 namespace PCRE {
 #ifdef _WIN32
@@ -39,6 +40,14 @@ namespace PCRE {
 // OVEVCOUNT must be a multiple of 3
 const int OVECCOUNT=(20+1)*3;
 
+/*!
+ \brief PCRE regular expression.
+
+ Compiled patterns are cached and shared by all CRegExp that use the same
+ pattern and options, so compiling a pattern that was compiled before only
+ costs a lookup. Patterns are studied (and JIT compiled where PCRE supports
+ it) once when they are first compiled.
+ */
 class CRegExp
 {
 public:
@@ -63,16 +72,29 @@ public:
   int GetSubLength(int iSub) { return (m_iOvector[(iSub*2)+1] - m_iOvector[(iSub*2)]); } // correct spelling
   int GetCaptureTotal();
   std::string GetMatch(int iSub = 0);
-  const std::string& GetPattern() { return m_pattern; }
+  const std::string& GetPattern() const { return m_pattern; }
   bool GetNamedSubPattern(const char* strName, std::string& strMatch);
   void DumpOvector(int iLog);
   const CRegExp& operator= (const CRegExp& re);
 
+  /*!
+   \brief Remove all compiled patterns from the cache that are not in use
+   */
+  static void ClearCache();
+
+  struct CompiledPattern;
+
 private:
-  void Cleanup() { if (m_re) { PCRE::pcre_free(m_re); m_re = NULL; } }
+  friend class CRegExpList;
+
+  bool Compile(const char *re, bool log);
+  bool Test(const char *str) const;
+  void Cleanup() { m_compiled.reset(); m_re = NULL; m_sd = NULL; }
 
 private:
-  PCRE::pcre* m_re;
+  boost::shared_ptr<CompiledPattern> m_compiled;
+  PCRE::pcre*       m_re;
+  PCRE::pcre_extra* m_sd;
   int         m_iOvector[OVECCOUNT];
   int         m_iMatchCount;
   int         m_iOptions;
@@ -83,5 +105,61 @@ private:
 
 typedef std::vector<CRegExp> VECCREGEXP;
 
+/*!
+ \brief List of regular expressions that are matched against the same strings.
+
+ Besides the single patterns, the list compiles one alternation of all of
+ them, so finding out whether any of the patterns matches only takes one
+ pass over the string. Most strings usually match none of the patterns
+ (exclude rules, stacking or episode expressions), so the single patterns
+ only have to be tried for the few that do. Patterns that use
+ backreferences can't be combined, in that case every pattern is tried.
+
+ Matching doesn't change the list, so a list that is compiled once (see
+ CAdvancedSettings::GetRegExpList()) can be matched from several threads.
+ */
+class CRegExpList
+{
+public:
+  CRegExpList(bool caseless = false);
+
+  /*!
+   \brief Add a pattern to the end of the list
+   \param re the pattern
+   \return false if the pattern is invalid, it isn't added then
+   */
+  bool Add(const std::string& re);
+  void Clear();
+  unsigned int Size() const { return m_patterns.size(); }
+
+  /*!
+   \brief Compile the alternation of the patterns added so far. Until it is
+   compiled the patterns are matched one by one.
+   */
+  void Combine();
+
+  /*!
+   \brief Check whether any of the patterns matches
+   */
+  bool Matches(const char *str) const;
+  bool Matches(const std::string& str) const { return Matches(str.c_str()); }
+
+  /*!
+   \brief Find the first pattern in the list that matches
+   \return index of the pattern or -1 if none matches
+   */
+  int FindFirst(const char *str) const;
+  int FindFirst(const std::string& str) const { return FindFirst(str.c_str()); }
+
+  const std::string& GetPattern(unsigned int index) const { return m_patterns[index].GetPattern(); }
+
+private:
+  bool        m_caseless;
+  VECCREGEXP  m_patterns;
+  CRegExp     m_combined;
+  bool        m_bCombinable;
+  bool        m_bCombined;
+};
+
 #endif
 
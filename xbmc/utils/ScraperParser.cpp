@@ -29,16 +29,373 @@
 #include "Util.h"
 #include "log.h"
 #include "CharsetConverter.h"
+#include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Event.h"
+#include "JobManager.h"
 
 #include <sstream>
 #include <cstring>
+#include <map>
+#include <boost/weak_ptr.hpp>
 
 using namespace std;
 using namespace ADDON;
 using namespace XFILE;
 
+// sibling expressions are only run in parallel when their inputs are at least this large
+#define SCRAPER_PARALLEL_MIN_INPUT (64 * 1024)
+
+/*! \brief A RegExp element of a scraper function */
+struct CScraperParser::CompiledNode
+{
+  std::vector<CompiledNode>  children;
+  std::vector<unsigned int>  stages;       ///< first child of each group of independent children
+
+  int          iDest;
+  bool         bAppend;
+  bool         bHasInput;
+  CScraperTemplate input;
+  CStdString   strConditional;
+  bool         bInverse;
+
+  bool         bHasExpression;
+  CScraperTemplate expression;
+  CScraperTemplate output;
+  bool         bInsensitive;
+  bool         bStatic;                    ///< the expression doesn't reference anything, regexp is compiled
+  CRegExp      regexp;
+  bool         bRepeat;
+  bool         bClear;
+  bool         bClean[MAX_SCRAPER_BUFFERS];
+  bool         bTrim[MAX_SCRAPER_BUFFERS];
+  bool         bFixChars[MAX_SCRAPER_BUFFERS];
+  bool         bEncode[MAX_SCRAPER_BUFFERS];
+  int          iOptional;
+  int          iCompare;
+
+  uint32_t     iReads;                     ///< buffers read by this node and its children through the templates
+  uint32_t     iWrites;                    ///< buffers written by this node and its children
+};
+
+/*! \brief The functions of a scraper, compiled */
+struct CScraperParser::CompiledScraper
+{
+  struct Function
+  {
+    int                       iDest;
+    bool                      bClearBuffers;
+    std::vector<CompiledNode> nodes;
+    std::vector<unsigned int> stages;
+  };
+  std::map<CStdString, Function> functions;
+};
+
+namespace
+{
+  void GetBufferParams(bool* result, const char* attribute, bool defvalue)
+  {
+    for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
+      result[iBuf] = defvalue;
+    if (attribute)
+    {
+      vector<CStdString> vecBufs;
+      CUtil::Tokenize(attribute,vecBufs,",");
+      for (size_t nToken=0; nToken < vecBufs.size(); nToken++)
+      {
+        int index = atoi(vecBufs[nToken].c_str())-1;
+        if (index >= 0 && index < MAX_SCRAPER_BUFFERS)
+          result[index] = !defvalue;
+      }
+    }
+  }
+
+  void CompileNodes(TiXmlElement* element, std::vector<CScraperParser::CompiledNode>& nodes, std::vector<unsigned int>& stages);
+
+  void CompileNode(TiXmlElement* pReg, CScraperParser::CompiledNode& node)
+  {
+    TiXmlElement* pChildReg = pReg->FirstChildElement("RegExp");
+    if (!pChildReg)
+      pChildReg = pReg->FirstChildElement("clear");
+    if (pChildReg)
+      CompileNodes(pChildReg, node.children, node.stages);
+
+    node.iDest = 1;
+    node.bAppend = false;
+    const char* szDest = pReg->Attribute("dest");
+    if (szDest && strlen(szDest))
+    {
+      if (szDest[strlen(szDest)-1] == '+')
+        node.bAppend = true;
+
+      node.iDest = atoi(szDest);
+    }
+
+    const char *szInput = pReg->Attribute("input");
+    node.bHasInput = szInput != NULL;
+    if (szInput)
+      node.input.Parse(szInput);
+
+    const char* szConditional = pReg->Attribute("conditional");
+    node.bInverse = false;
+    if (szConditional)
+    {
+      if (szConditional[0] == '!')
+      {
+        node.bInverse = true;
+        szConditional++;
+      }
+      node.strConditional = szConditional;
+    }
+
+    TiXmlElement* pExpression = pReg->FirstChildElement("expression");
+    node.bHasExpression = pExpression != NULL;
+    node.bStatic = false;
+    node.iOptional = -1;
+    node.iCompare = -1;
+    if (pExpression)
+    {
+      node.bInsensitive = true;
+      const char* sensitive = pExpression->Attribute("cs");
+      if (sensitive && stricmp(sensitive,"yes") == 0)
+        node.bInsensitive = false; // match case sensitive
+
+      node.expression.Parse(pExpression->FirstChild() ? pExpression->FirstChild()->Value() : "(.*)");
+      node.output.Parse(pReg->Attribute("output"));
+
+      // expressions without references can be compiled up front
+      if (node.expression.IsStatic())
+      {
+        node.regexp = CRegExp(node.bInsensitive);
+        node.bStatic = node.regexp.RegComp(node.expression.Expand(NULL, NULL).c_str()) != NULL;
+      }
+
+      const char* szRepeat = pExpression->Attribute("repeat");
+      node.bRepeat = szRepeat && stricmp(szRepeat,"yes") == 0;
+
+      const char* szClear = pExpression->Attribute("clear");
+      node.bClear = szClear && stricmp(szClear,"yes") == 0;
+
+      GetBufferParams(node.bClean,pExpression->Attribute("noclean"),true);
+      GetBufferParams(node.bTrim,pExpression->Attribute("trim"),false);
+      GetBufferParams(node.bFixChars,pExpression->Attribute("fixchars"),false);
+      GetBufferParams(node.bEncode,pExpression->Attribute("encode"),false);
+
+      pExpression->QueryIntAttribute("optional",&node.iOptional);
+      pExpression->QueryIntAttribute("compare",&node.iCompare);
+      if (node.iCompare < 1 || node.iCompare > MAX_SCRAPER_BUFFERS)
+        node.iCompare = -1;
+    }
+
+    // buffers this node depends on. a template that can't be parsed may reference any buffer,
+    // references in the inserted values are only found when the node is run, see ParseParallel()
+    node.iReads = node.iWrites = 0;
+    if (node.iDest > 0 && node.iDest <= MAX_SCRAPER_BUFFERS)
+    {
+      node.iWrites |= 1 << (node.iDest - 1);
+      if (node.bAppend)
+        node.iReads |= 1 << (node.iDest - 1);
+    }
+    if (node.iCompare > 0)
+    {
+      node.iReads  |= 1 << (node.iCompare - 1);
+      node.iWrites |= 1 << (node.iCompare - 1);
+    }
+    node.iReads |= node.bHasInput ? node.input.GetBuffers() : 1;
+    node.iReads |= node.expression.GetBuffers() | node.output.GetBuffers();
+    if (node.input.IsLegacy() || node.expression.IsLegacy() || node.output.IsLegacy())
+      node.iReads = 0xFFFFFFFF;
+    for (std::vector<CScraperParser::CompiledNode>::const_iterator it = node.children.begin(); it != node.children.end(); ++it)
+    {
+      node.iReads  |= it->iReads;
+      node.iWrites |= it->iWrites;
+    }
+  }
+
+  void CompileNodes(TiXmlElement* element, std::vector<CScraperParser::CompiledNode>& nodes, std::vector<unsigned int>& stages)
+  {
+    for (TiXmlElement* pReg = element; pReg; pReg = pReg->NextSiblingElement("RegExp"))
+    {
+      nodes.push_back(CScraperParser::CompiledNode());
+      CompileNode(pReg, nodes.back());
+    }
+
+    // group consecutive siblings that don't depend on each other
+    uint32_t iReads = 0, iWrites = 0;
+    for (unsigned int i = 0; i < nodes.size(); i++)
+    {
+      const CScraperParser::CompiledNode& node = nodes[i];
+      if (stages.empty() || (node.iReads & iWrites) || (node.iWrites & (iReads | iWrites)))
+      {
+        stages.push_back(i);
+        iReads = iWrites = 0;
+      }
+      iReads  |= node.iReads;
+      iWrites |= node.iWrites;
+    }
+  }
+
+  boost::shared_ptr<const CScraperParser::CompiledScraper> CompileScraper(TiXmlElement* pRootElement)
+  {
+    CScraperParser::CompiledScraper* compiled = new CScraperParser::CompiledScraper;
+    for (TiXmlElement* pFunction = pRootElement->FirstChildElement(); pFunction; pFunction = pFunction->NextSiblingElement())
+    {
+      // the first function of a name is the one that's used
+      if (compiled->functions.find(pFunction->Value()) != compiled->functions.end())
+        continue;
+
+      CScraperParser::CompiledScraper::Function& function = compiled->functions[pFunction->Value()];
+      function.iDest = 1; // default to param 1
+      pFunction->QueryIntAttribute("dest",&function.iDest);
+      const char* szClearBuffers = pFunction->Attribute("clearbuffers");
+      function.bClearBuffers = !szClearBuffers || stricmp(szClearBuffers,"no") != 0;
+
+      TiXmlElement* pChildStart = pFunction->FirstChildElement("RegExp");
+      if (pChildStart)
+        CompileNodes(pChildStart, function.nodes, function.stages);
+    }
+    return boost::shared_ptr<const CScraperParser::CompiledScraper>(compiled);
+  }
+
+  typedef std::map<CStdString, boost::weak_ptr<const CScraperParser::CompiledScraper> > CompiledScraperMap;
+
+  CCriticalSection& GetCompiledScrapersSection()
+  {
+    static CCriticalSection section;
+    return section;
+  }
+
+  CompiledScraperMap& GetCompiledScrapers()
+  {
+    static CompiledScraperMap scrapers;
+    return scrapers;
+  }
+
+  CStdString GetCacheKey(const CStdString& strFile)
+  {
+    struct __stat64 st;
+    CStdString strKey;
+    if (CFile::Stat(strFile, &st) == 0)
+      strKey.Format("%s|%"PRId64";", strFile.c_str(), (int64_t)st.st_mtime);
+    else
+      strKey.Format("%s;", strFile.c_str());
+    return strKey;
+  }
+}
+
+/*!
+ \brief A group of independent sibling expressions, each run on its own copy of the buffers.
+
+ A branch is run by the first of its job and the parser that claims it, so the parser
+ doesn't wait for jobs that haven't started while all workers are busy. The jobs hold a
+ reference to the group, a job started after the parser returned finds its branch done.
+ */
+class CScraperParser::CBranches
+{
+public:
+  CBranches(CScraperParser& parser, const vector<CompiledNode>& nodes, unsigned int first, unsigned int last, const CStdString* params)
+    : m_parser(parser), m_nodes(nodes), m_first(first), m_count(last - first),
+      m_params(m_count * MAX_SCRAPER_BUFFERS), m_reads(m_count, 0), m_state(m_count, Queued), m_done(0)
+  {
+    for (unsigned int i = 0; i < m_count; i++)
+    {
+      for (int iBuf = 0; iBuf < MAX_SCRAPER_BUFFERS; iBuf++)
+        m_params[i * MAX_SCRAPER_BUFFERS + iBuf] = params[iBuf];
+    }
+  }
+
+  unsigned int Size() const { return m_count; }
+
+  void Run(unsigned int index)
+  {
+    {
+      CSingleLock lock(m_section);
+      if (m_state[index] != Queued)
+        return;
+      m_state[index] = Running;
+    }
+
+    m_parser.ParseNode(m_nodes[m_first + index], &m_params[index * MAX_SCRAPER_BUFFERS], &m_reads[index]);
+
+    CSingleLock lock(m_section);
+    m_state[index] = Done;
+    if (++m_done == m_count)
+      m_finished.Set();
+  }
+
+  void Wait()
+  {
+    m_finished.Wait();
+  }
+
+  /*! \brief Copy the buffers the branches wrote
+   \return false if a branch read a buffer another one wrote, the buffers are unchanged then
+   */
+  bool CopyResults(CStdString* params, uint32_t* pReads) const
+  {
+    for (unsigned int i = 0; i < m_count; i++)
+    {
+      for (unsigned int j = 0; j < m_count; j++)
+      {
+        if (i != j && (m_reads[i] & m_nodes[m_first + j].iWrites))
+          return false;
+      }
+    }
+
+    for (unsigned int i = 0; i < m_count; i++)
+    {
+      const CompiledNode& node = m_nodes[m_first + i];
+      for (int iBuf = 0; iBuf < MAX_SCRAPER_BUFFERS; iBuf++)
+      {
+        if (node.iWrites & (1 << iBuf))
+          params[iBuf] = m_params[i * MAX_SCRAPER_BUFFERS + iBuf];
+      }
+      if (pReads)
+        *pReads |= m_reads[i];
+    }
+    return true;
+  }
+
+private:
+  enum State { Queued, Running, Done };
+
+  CScraperParser&             m_parser;
+  const vector<CompiledNode>& m_nodes;
+  unsigned int                m_first;
+  unsigned int                m_count;
+  vector<CStdString>          m_params; ///< the buffers of each branch
+  vector<uint32_t>            m_reads;  ///< buffers each branch inserted while it ran
+  vector<State>               m_state;
+  unsigned int                m_done;
+  CCriticalSection            m_section;
+  CEvent                      m_finished;
+};
+
+class CScraperParser::CBranchJob : public CJob
+{
+public:
+  CBranchJob(const boost::shared_ptr<CBranches>& branches, unsigned int index)
+    : m_branches(branches), m_index(index)
+  {
+  }
+
+  virtual bool DoWork()
+  {
+    m_branches->Run(m_index);
+    return true;
+  }
+
+  virtual const char* GetType() const { return "scraperbranch"; }
+
+private:
+  boost::shared_ptr<CBranches> m_branches;
+  unsigned int                 m_index;
+};
+
 CScraperParser::CScraperParser()
 {
+  m_scraper = NULL;
   m_pRootElement = NULL;
   m_document = NULL;
   m_SearchStringEncoding = "UTF-8";
@@ -46,6 +403,8 @@ CScraperParser::CScraperParser()
 
 CScraperParser::CScraperParser(const CScraperParser& parser)
 {
+  m_scraper = NULL;
+  m_pRootElement = NULL;
   m_document = NULL;
   m_SearchStringEncoding = "UTF-8";
   *this = parser;
@@ -60,7 +419,10 @@ CScraperParser &CScraperParser::operator=(const CScraperParser &parser)
     {
       m_scraper = parser.m_scraper;
       m_document = new CXBMCTinyXML(*parser.m_document);
-      LoadFromXML();
+      m_strFile = parser.m_strFile;
+      m_strCacheKey = parser.m_strCacheKey;
+      if (LoadFromXML())
+        m_compiled = parser.m_compiled;
     }
   }
   return *this;
@@ -78,6 +440,8 @@ void CScraperParser::Clear()
 
   m_document = NULL;
   m_strFile.Empty();
+  m_strCacheKey.Empty();
+  m_compiled.reset();
 }
 
 bool CScraperParser::Load(const CStdString& strXMLFile)
@@ -90,6 +454,7 @@ bool CScraperParser::Load(const CStdString& strXMLFile)
     return false;
 
   m_strFile = strXMLFile;
+  m_strCacheKey = GetCacheKey(strXMLFile);
 
   if (m_document->LoadFile())
     return LoadFromXML();
@@ -137,117 +502,77 @@ bool CScraperParser::LoadFromXML()
   return false;
 }
 
-void CScraperParser::ReplaceBuffers(CStdString& strDest)
+boost::shared_ptr<const CScraperParser::CompiledScraper> CScraperParser::GetCompiled()
 {
-  // insert buffers
-  int iIndex;
-  for (int i=MAX_SCRAPER_BUFFERS-1; i>=0; i--)
+  if (m_compiled)
+    return m_compiled;
+
+  CSingleLock lock(GetCompiledScrapersSection());
+  CompiledScraperMap& scrapers = GetCompiledScrapers();
+  CompiledScraperMap::iterator it = scrapers.find(m_strCacheKey);
+  if (it != scrapers.end())
+    m_compiled = it->second.lock();
+
+  if (!m_compiled)
   {
-    CStdString temp;
-    iIndex = 0;
-    temp.Format("$$%i",i+1);
-    while ((size_t)(iIndex = strDest.find(temp,iIndex)) != CStdString::npos) // COPIED FROM CStdString WITH THE ADDITION OF $ ESCAPING
+    m_compiled = CompileScraper(m_pRootElement);
+    CLog::Log(LOGDEBUG, "%s - compiled %u functions of %s", __FUNCTION__, (unsigned int)m_compiled->functions.size(), m_strFile.c_str());
+
+    // forget about scrapers that are no longer in use
+    for (CompiledScraperMap::iterator it = scrapers.begin(); it != scrapers.end();)
     {
-      strDest.replace(strDest.begin()+iIndex,strDest.begin()+iIndex+temp.GetLength(),m_param[i]);
-      iIndex += m_param[i].length();
+      if (it->second.expired())
+        scrapers.erase(it++);
+      else
+        ++it;
     }
+    if (!m_strCacheKey.IsEmpty())
+      scrapers[m_strCacheKey] = m_compiled;
   }
-  // insert settings
-  iIndex = 0;
-  while ((size_t)(iIndex = strDest.find("$INFO[",iIndex)) != CStdString::npos)
-  {
-    int iEnd = strDest.Find("]",iIndex);
-    CStdString strInfo = strDest.Mid(iIndex+6,iEnd-iIndex-6);
-    CStdString strReplace;
-    if (m_scraper)
-      strReplace = m_scraper->GetSetting(strInfo);
-    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iEnd+1,strReplace);
-    iIndex += strReplace.length();
-  }
-  // insert localize strings
-  iIndex = 0;
-  while ((size_t)(iIndex = strDest.find("$LOCALIZE[",iIndex)) != CStdString::npos)
-  {
-    int iEnd = strDest.Find("]",iIndex);
-    CStdString strInfo = strDest.Mid(iIndex+10,iEnd-iIndex-10);
-    CStdString strReplace;
-    if (m_scraper)
-      strReplace = m_scraper->GetString(strtol(strInfo.c_str(),NULL,10));
-    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iEnd+1,strReplace);
-    iIndex += strReplace.length();
-  }
-  iIndex = 0;
-  while ((size_t)(iIndex = strDest.find("\\n",iIndex)) != CStdString::npos)
-    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iIndex+2,"\n");
+  return m_compiled;
 }
 
-void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest, TiXmlElement* element, bool bAppend)
+CStdString CScraperParser::GetSetting(const CStdString& strName)
 {
-  CStdString strOutput = element->Attribute("output");
+  if (m_scraper)
+    return m_scraper->GetSetting(strName);
+  return "";
+}
 
-  TiXmlElement* pExpression = element->FirstChildElement("expression");
-  if (pExpression)
-  {
-    bool bInsensitive=true;
-    const char* sensitive = pExpression->Attribute("cs");
-    if (sensitive)
-      if (stricmp(sensitive,"yes") == 0)
-        bInsensitive=false; // match case sensitive
-
-    CRegExp reg(bInsensitive);
-    CStdString strExpression;
-    if (pExpression->FirstChild())
-      strExpression = pExpression->FirstChild()->Value();
-    else
-      strExpression = "(.*)";
-    ReplaceBuffers(strExpression);
-    ReplaceBuffers(strOutput);
+CStdString CScraperParser::GetString(int iString)
+{
+  if (m_scraper)
+    return m_scraper->GetString(iString);
+  return "";
+}
 
-    if (!reg.RegComp(strExpression.c_str()))
-    {
+void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest, const CompiledNode& node, bool bAppend, CStdString* params, uint32_t* pReads)
+{
+  if (node.bHasExpression)
+  {
+    CRegExp reg(node.bInsensitive);
+    if (node.bStatic)
+      reg = node.regexp;
+    else if (!reg.RegComp(node.expression.Expand(params, this, pReads).c_str()))
       return;
-    }
-
-    bool bRepeat = false;
-    const char* szRepeat = pExpression->Attribute("repeat");
-    if (szRepeat)
-      if (stricmp(szRepeat,"yes") == 0)
-        bRepeat = true;
-
-    const char* szClear = pExpression->Attribute("clear");
-    if (szClear)
-      if (stricmp(szClear,"yes") == 0)
-        dest=""; // clear no matter if regexp fails
-
-    bool bClean[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bClean,pExpression->Attribute("noclean"),true);
-
-    bool bTrim[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bTrim,pExpression->Attribute("trim"),false);
+    CStdString strOutput = node.output.Expand(params, this, pReads);
 
-    bool bFixChars[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bFixChars,pExpression->Attribute("fixchars"),false);
+    if (node.bClear)
+      dest=""; // clear no matter if regexp fails
 
-    bool bEncode[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bEncode,pExpression->Attribute("encode"),false);
-
-    int iOptional = -1;
-    pExpression->QueryIntAttribute("optional",&iOptional);
-
-    int iCompare = -1;
-    pExpression->QueryIntAttribute("compare",&iCompare);
+    int iCompare = node.iCompare;
     if (iCompare > -1)
-      m_param[iCompare-1].ToLower();
+      params[iCompare-1].ToLower();
     CStdString curInput = input;
     for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
     {
-      if (bClean[iBuf])
+      if (node.bClean[iBuf])
         InsertToken(strOutput,iBuf+1,"!!!CLEAN!!!");
-      if (bTrim[iBuf])
+      if (node.bTrim[iBuf])
         InsertToken(strOutput,iBuf+1,"!!!TRIM!!!");
-      if (bFixChars[iBuf])
+      if (node.bFixChars[iBuf])
         InsertToken(strOutput,iBuf+1,"!!!FIXCHARS!!!");
-      if (bEncode[iBuf])
+      if (node.bEncode[iBuf])
         InsertToken(strOutput,iBuf+1,"!!!ENCODE!!!");
     }
     int i = reg.RegFind(curInput.c_str());
@@ -260,10 +585,10 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
       }
       CStdString strCurOutput=strOutput;
 
-      if (iOptional > -1) // check that required param is there
+      if (node.iOptional > -1) // check that required param is there
       {
         char temp[4];
-        sprintf(temp,"\\%i",iOptional);
+        sprintf(temp,"\\%i",node.iOptional);
         char* szParam = reg.GetReplaceString(temp);
         CRegExp reg2;
         reg2.RegComp("(.*)(\\\\\\(.*\\\\2.*)\\\\\\)(.*)");
@@ -297,12 +622,12 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
         CStdString strResult(result);
         strResult.Replace("!!!AMPAMP!!!","&");
         Clean(strResult);
-        ReplaceBuffers(strResult);
+        CScraperTemplate::ReplaceBuffers(strResult, params, this, pReads);
         if (iCompare > -1)
         {
           CStdString strResultNoCase = strResult;
           strResultNoCase.ToLower();
-          if (strResultNoCase.Find(m_param[iCompare-1]) != -1)
+          if (strResultNoCase.Find(params[iCompare-1]) != -1)
             dest += strResult;
         }
         else
@@ -310,7 +635,7 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
 
         free(result);
       }
-      if (bRepeat && iLen > 0)
+      if (node.bRepeat && iLen > 0)
       {
         curInput.erase(0,i+iLen>(int)curInput.size()?curInput.size():i+iLen);
         i = reg.RegFind(curInput.c_str());
@@ -321,90 +646,113 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
   }
 }
 
-void CScraperParser::ParseNext(TiXmlElement* element)
+void CScraperParser::ParseNodes(const vector<CompiledNode>& nodes, const vector<unsigned int>& stages, CStdString* params, uint32_t* pReads)
 {
-  TiXmlElement* pReg = element;
-  while (pReg)
+  for (unsigned int stage = 0; stage < stages.size(); stage++)
   {
-    TiXmlElement* pChildReg = pReg->FirstChildElement("RegExp");
-    if (pChildReg)
-      ParseNext(pChildReg);
-    else
-    {
-      TiXmlElement* pChildReg = pReg->FirstChildElement("clear");
-      if (pChildReg)
-        ParseNext(pChildReg);
-    }
-
-    int iDest = 1;
-    bool bAppend = false;
-    const char* szDest = pReg->Attribute("dest");
-    if (szDest)
-      if (strlen(szDest))
-      {
-        if (szDest[strlen(szDest)-1] == '+')
-          bAppend = true;
-
-        iDest = atoi(szDest);
-      }
+    unsigned int first = stages[stage];
+    unsigned int last = stage + 1 < stages.size() ? stages[stage + 1] : nodes.size();
 
-      const char *szInput = pReg->Attribute("input");
-      CStdString strInput;
-      if (szInput)
-      {
-        strInput = szInput;
-        ReplaceBuffers(strInput);
-      }
-      else
-        strInput = m_param[0];
-
-      const char* szConditional = pReg->Attribute("conditional");
-      bool bExecute = true;
-      if (szConditional)
+    if (last - first > 1)
+    {
+      size_t iInput = 0;
+      for (unsigned int i = first; i < last; i++)
       {
-        bool bInverse=false;
-        if (szConditional[0] == '!')
+        for (int iBuf = 0; iBuf < MAX_SCRAPER_BUFFERS; iBuf++)
         {
-          bInverse = true;
-          szConditional++;
+          if (nodes[i].iReads & (1 << iBuf))
+            iInput += params[iBuf].size();
         }
-        CStdString strSetting;
-        if (m_scraper && m_scraper->HasSettings())
-           strSetting = m_scraper->GetSetting(szConditional);
-        bExecute = bInverse != strSetting.Equals("true");
       }
-
-      if (bExecute)
+      if (iInput >= SCRAPER_PARALLEL_MIN_INPUT)
       {
-        if (iDest-1 < MAX_SCRAPER_BUFFERS && iDest-1 > -1)
-          ParseExpression(strInput, m_param[iDest-1],pReg,bAppend);
-        else
-          CLog::Log(LOGERROR,"CScraperParser::ParseNext: destination buffer "
-                             "out of bounds, skipping expression");
+        ParseParallel(nodes, first, last, params, pReads);
+        continue;
       }
+    }
+
+    for (unsigned int i = first; i < last; i++)
+      ParseNode(nodes[i], params, pReads);
+  }
+}
 
-      pReg = pReg->NextSiblingElement("RegExp");
+void CScraperParser::ParseParallel(const vector<CompiledNode>& nodes, unsigned int first, unsigned int last, CStdString* params, uint32_t* pReads)
+{
+  // settings and strings are loaded on first use, make sure that doesn't happen on several threads
+  if (m_scraper && m_scraper->HasSettings())
+    m_scraper->GetString(0);
+
+  boost::shared_ptr<CBranches> branches(new CBranches(*this, nodes, first, last, params));
+  vector<unsigned int> jobs;
+  for (unsigned int i = 1; i < branches->Size(); i++)
+    jobs.push_back(CJobManager::GetInstance().AddJob(new CBranchJob(branches, i), NULL, CJob::PRIORITY_NORMAL));
+
+  // run the branches no worker picked up yet here
+  for (unsigned int i = 0; i < branches->Size(); i++)
+    branches->Run(i);
+  branches->Wait();
+
+  for (unsigned int i = 0; i < jobs.size(); i++)
+    CJobManager::GetInstance().CancelJob(jobs[i]);
+
+  // a value inserted into a template may reference a buffer that wasn't known when the
+  // scraper was compiled. if that is one another branch wrote, run the group again in order
+  if (!branches->CopyResults(params, pReads))
+  {
+    CLog::Log(LOGDEBUG, "%s - expressions %u to %u of %s depend on each other, running them in order", __FUNCTION__, first, last - 1, m_strFile.c_str());
+    for (unsigned int i = first; i < last; i++)
+      ParseNode(nodes[i], params, pReads);
+  }
+}
+
+void CScraperParser::ParseNode(const CompiledNode& node, CStdString* params, uint32_t* pReads)
+{
+  ParseNodes(node.children, node.stages, params, pReads);
+
+  CStdString strInput;
+  if (node.bHasInput)
+    strInput = node.input.Expand(params, this, pReads);
+  else
+    strInput = params[0];
+
+  bool bExecute = true;
+  if (!node.strConditional.IsEmpty())
+  {
+    CStdString strSetting;
+    if (m_scraper && m_scraper->HasSettings())
+       strSetting = m_scraper->GetSetting(node.strConditional);
+    bExecute = node.bInverse != strSetting.Equals("true");
+  }
+
+  if (bExecute)
+  {
+    if (node.iDest-1 < MAX_SCRAPER_BUFFERS && node.iDest-1 > -1)
+      ParseExpression(strInput, params[node.iDest-1], node, node.bAppend, params, pReads);
+    else
+      CLog::Log(LOGERROR,"CScraperParser::ParseNext: destination buffer "
+                         "out of bounds, skipping expression");
   }
 }
 
 const CStdString CScraperParser::Parse(const CStdString& strTag,
                                        CScraper* scraper)
 {
-  TiXmlElement* pChildElement = m_pRootElement->FirstChildElement(strTag.c_str());
-  if(pChildElement == NULL)
+  if (!m_pRootElement)
+    return "";
+
+  boost::shared_ptr<const CompiledScraper> compiled = GetCompiled();
+  map<CStdString, CompiledScraper::Function>::const_iterator function = compiled->functions.find(strTag);
+  if (function == compiled->functions.end())
   {
     CLog::Log(LOGERROR,"%s: Could not find scraper function %s",__FUNCTION__,strTag.c_str());
     return "";
   }
-  int iResult = 1; // default to param 1
-  pChildElement->QueryIntAttribute("dest",&iResult);
-  TiXmlElement* pChildStart = pChildElement->FirstChildElement("RegExp");
+  int iResult = function->second.iDest;
   m_scraper = scraper;
-  ParseNext(pChildStart);
+  ParseNodes(function->second.nodes, function->second.stages, m_param, NULL);
   CStdString tmp = m_param[iResult-1];
 
-  const char* szClearBuffers = pChildElement->Attribute("clearbuffers");
-  if (!szClearBuffers || stricmp(szClearBuffers,"no") != 0)
+  if (function->second.bClearBuffers)
     ClearBuffers();
 
   return tmp;
@@ -530,23 +878,6 @@ void CScraperParser::ClearBuffers()
     m_param[i].clear();
 }
 
-void CScraperParser::GetBufferParams(bool* result, const char* attribute, bool defvalue)
-{
-  for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
-    result[iBuf] = defvalue;;
-  if (attribute)
-  {
-    vector<CStdString> vecBufs;
-    CUtil::Tokenize(attribute,vecBufs,",");
-    for (size_t nToken=0; nToken < vecBufs.size(); nToken++)
-    {
-      int index = atoi(vecBufs[nToken].c_str())-1;
-      if (index < MAX_SCRAPER_BUFFERS)
-        result[index] = !defvalue;
-    }
-  }
-}
-
 void CScraperParser::InsertToken(CStdString& strOutput, int buf, const char* token)
 {
   char temp[4];
@@ -563,6 +894,9 @@ void CScraperParser::InsertToken(CStdString& strOutput, int buf, const char* tok
 
 void CScraperParser::AddDocument(const CXBMCTinyXML* doc)
 {
+  m_compiled.reset();
+  m_strCacheKey += GetCacheKey(doc->Value());
+
   const TiXmlNode* node = doc->RootElement()->FirstChild();
   while (node)
   {
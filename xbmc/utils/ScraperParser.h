@@ -23,11 +23,11 @@
  */
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include "StdString.h"
+#include "ScraperTemplate.h"
 #include "addons/IAddon.h"
 
-#define MAX_SCRAPER_BUFFERS 20
-
 namespace ADDON
 {
   class CScraper;
@@ -38,7 +38,22 @@ class CXBMCTinyXML;
 
 class CScraperSettings;
 
-class CScraperParser
+/*!
+ \brief Runs the functions of a scraper XML.
+
+ Before the first function is run, the scraper XML is compiled into a tree of
+ expressions with their attributes resolved, the references to buffers,
+ settings and localized strings in the templates located, and the expressions
+ that don't depend on any buffer compiled. The compiled scraper is shared by
+ all parsers that loaded the same files.
+
+ Sibling RegExp elements that neither read nor write a buffer another one of
+ them writes are independent of each other. When they work on large inputs,
+ they are run as jobs, each on its own copy of the buffers. References that
+ only appear once a value is inserted are recorded while they run, a group
+ that read a buffer another one of them wrote is run again in order.
+ */
+class CScraperParser : private IScraperTemplateValues
 {
 public:
   CScraperParser();
@@ -58,11 +73,21 @@ public:
 
   CStdString m_param[MAX_SCRAPER_BUFFERS];
 
+  struct CompiledScraper;
+  struct CompiledNode;
+
 private:
+  class CBranches;
+  class CBranchJob;
+
   bool LoadFromXML();
-  void ReplaceBuffers(CStdString& strDest);
-  void ParseExpression(const CStdString& input, CStdString& dest, TiXmlElement* element, bool bAppend);
-  void ParseNext(TiXmlElement* element);
+  boost::shared_ptr<const CompiledScraper> GetCompiled();
+  virtual CStdString GetSetting(const CStdString& strName);
+  virtual CStdString GetString(int iString);
+  void ParseExpression(const CStdString& input, CStdString& dest, const CompiledNode& node, bool bAppend, CStdString* params, uint32_t* pReads);
+  void ParseNodes(const std::vector<CompiledNode>& nodes, const std::vector<unsigned int>& stages, CStdString* params, uint32_t* pReads);
+  void ParseNode(const CompiledNode& node, CStdString* params, uint32_t* pReads);
+  void ParseParallel(const std::vector<CompiledNode>& nodes, unsigned int first, unsigned int last, CStdString* params, uint32_t* pReads);
   void Clean(CStdString& strDirty);
   /*! \brief Remove spaces, tabs, and newlines from a string
    \param string the string in question, which will be modified.
@@ -70,12 +95,14 @@ private:
   void RemoveWhiteSpace(CStdString &string);
   void ConvertJSON(CStdString &string);
   void ClearBuffers();
-  void GetBufferParams(bool* result, const char* attribute, bool defvalue);
   void InsertToken(CStdString& strOutput, int buf, const char* token);
 
   CXBMCTinyXML* m_document;
   TiXmlElement* m_pRootElement;
 
+  CStdString m_strCacheKey; ///< files the document was loaded from, with their modification times
+  boost::shared_ptr<const CompiledScraper> m_compiled;
+
   const char* m_SearchStringEncoding;
 
   CStdString m_strFile;
@@ -0,0 +1,257 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "ScraperTemplate.h"
+
+#include <stdlib.h>
+#include <ctype.h>
+
+CScraperTemplate::CScraperTemplate()
+{
+  m_bLegacy = false;
+  m_bNewlines = false;
+  m_iBuffers = 0;
+}
+
+void CScraperTemplate::Parse(const CStdString &strRaw)
+{
+  m_strRaw = strRaw;
+  m_segments.clear();
+  m_bLegacy = false;
+  m_bNewlines = false;
+  m_iBuffers = 0;
+
+  CStdString strLiteral;
+  size_t i = 0;
+  while (i < strRaw.size())
+  {
+    Segment segment;
+    if (strRaw.compare(i, 2, "$$") == 0 && i + 2 < strRaw.size() && strRaw[i + 2] >= '1' && strRaw[i + 2] <= '9')
+    { // buffers are replaced from $$20 down to $$1, so $$21 is $$2 followed by a 1
+      int iBuffer = strRaw[i + 2] - '0';
+      size_t iLen = 3;
+      if (i + 3 < strRaw.size() && isdigit(strRaw[i + 3]) && iBuffer * 10 + strRaw[i + 3] - '0' <= MAX_SCRAPER_BUFFERS)
+      {
+        iBuffer = iBuffer * 10 + strRaw[i + 3] - '0';
+        iLen = 4;
+      }
+      segment.type = Buffer;
+      segment.index = iBuffer - 1;
+      m_iBuffers |= 1 << segment.index;
+      i += iLen;
+    }
+    else if (strRaw.compare(i, 6, "$INFO[") == 0 || strRaw.compare(i, 10, "$LOCALIZE[") == 0)
+    {
+      bool bInfo = strRaw[i + 1] == 'I';
+      size_t iStart = i + (bInfo ? 6 : 10);
+      size_t iEnd = strRaw.find(']', iStart);
+      if (iEnd == CStdString::npos || strRaw.find('$', iStart) < iEnd)
+      {
+        m_bLegacy = true;
+        return;
+      }
+      segment.type = bInfo ? Setting : Localize;
+      segment.value = strRaw.substr(iStart, iEnd - iStart);
+      segment.index = bInfo ? 0 : strtol(segment.value.c_str(), NULL, 10);
+      i = iEnd + 1;
+    }
+    else if (strRaw[i] == '$')
+    { // may combine with a buffer or setting into a reference
+      m_bLegacy = true;
+      return;
+    }
+    else
+    {
+      if (strRaw[i] == '\\')
+        m_bNewlines = true;
+      strLiteral += strRaw[i++];
+      continue;
+    }
+
+    if (!strLiteral.empty())
+    {
+      Segment literal;
+      literal.type = Literal;
+      literal.value = strLiteral;
+      literal.index = 0;
+      m_segments.push_back(literal);
+      strLiteral.clear();
+    }
+    m_segments.push_back(segment);
+  }
+
+  if (!strLiteral.empty())
+  {
+    Segment literal;
+    literal.type = Literal;
+    literal.value = strLiteral;
+    literal.index = 0;
+    m_segments.push_back(literal);
+  }
+}
+
+bool CScraperTemplate::IsStatic() const
+{
+  return !m_bLegacy && m_segments.size() <= 1 && (m_segments.empty() || m_segments[0].type == Literal);
+}
+
+CStdString CScraperTemplate::Expand(const CStdString *params, IScraperTemplateValues *values, uint32_t *pReads) const
+{
+  CStdString strResult;
+  if (!m_bLegacy)
+  {
+    // newlines are escaped in the scraper XML and in the buffers alike, a \ may be followed by an n from the next value
+    bool bNewlines = m_bNewlines;
+    // a $$1 or $$2 is still in the string when the buffers above it are inserted, a digit after it makes a new reference
+    bool bLowBuffer = false;
+    std::vector<Segment>::const_iterator it = m_segments.begin();
+    for (; it != m_segments.end(); ++it)
+    {
+      if (it->type == Literal)
+      {
+        strResult += it->value;
+        bLowBuffer = false;
+        continue;
+      }
+
+      CStdString strValue;
+      const CStdString *value = &strValue;
+      if (it->type == Buffer)
+        value = &params[it->index];
+      else if (values && it->type == Setting)
+        strValue = values->GetSetting(it->value);
+      else if (values && it->type == Localize)
+        strValue = values->GetString(it->index);
+
+      if (MayInsertReference(*value))
+        break;
+      if (it->type == Buffer)
+      {
+        if (bLowBuffer && !value->empty() && isdigit((unsigned char)(*value)[0]))
+          break;
+        if (it->index <= 1)
+          bLowBuffer = true;
+        else if (!value->empty())
+          bLowBuffer = false;
+      }
+      else if (!value->empty())
+        bLowBuffer = false;
+      if (!bNewlines && value->find('\\') != CStdString::npos)
+        bNewlines = true;
+      strResult += *value;
+    }
+
+    if (it == m_segments.end())
+    {
+      if (bNewlines)
+        ReplaceNewlines(strResult);
+      return strResult;
+    }
+  }
+
+  strResult = m_strRaw;
+  ReplaceBuffers(strResult, params, values, pReads);
+  return strResult;
+}
+
+bool CScraperTemplate::MayInsertReference(const CStdString &strValue)
+{
+  for (size_t i = strValue.find('$'); i != CStdString::npos; i = strValue.find('$', i + 1))
+  {
+    // the start of a reference at the end may be completed by what follows the value
+    if (strValue.size() - i < 10)
+      return true;
+    if (strValue[i + 1] == '$' && strValue[i + 2] >= '1' && strValue[i + 2] <= '9')
+      return true;
+    if (strValue.compare(i, 6, "$INFO[") == 0 || strValue.compare(i, 10, "$LOCALIZE[") == 0)
+      return true;
+  }
+  return false;
+}
+
+void CScraperTemplate::ReplaceBuffers(CStdString &strDest, const CStdString *params, IScraperTemplateValues *values, uint32_t *pReads)
+{
+  if (strDest.find('$') == CStdString::npos)
+  {
+    ReplaceNewlines(strDest);
+    return;
+  }
+
+  // insert buffers
+  int iIndex;
+  for (int i=MAX_SCRAPER_BUFFERS-1; i>=0; i--)
+  {
+    CStdString temp;
+    iIndex = 0;
+    temp.Format("$$%i",i+1);
+    while ((size_t)(iIndex = strDest.find(temp,iIndex)) != CStdString::npos) // COPIED FROM CStdString WITH THE ADDITION OF $ ESCAPING
+    {
+      strDest.replace(strDest.begin()+iIndex,strDest.begin()+iIndex+temp.GetLength(),params[i]);
+      iIndex += params[i].length();
+      if (pReads)
+        *pReads |= 1 << i;
+    }
+  }
+  // insert settings
+  iIndex = 0;
+  while ((size_t)(iIndex = strDest.find("$INFO[",iIndex)) != CStdString::npos)
+  {
+    int iEnd = strDest.Find("]",iIndex);
+    CStdString strInfo = strDest.Mid(iIndex+6,iEnd-iIndex-6);
+    CStdString strReplace;
+    if (values)
+      strReplace = values->GetSetting(strInfo);
+    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iEnd+1,strReplace);
+    iIndex += strReplace.length();
+  }
+  // insert localize strings
+  iIndex = 0;
+  while ((size_t)(iIndex = strDest.find("$LOCALIZE[",iIndex)) != CStdString::npos)
+  {
+    int iEnd = strDest.Find("]",iIndex);
+    CStdString strInfo = strDest.Mid(iIndex+10,iEnd-iIndex-10);
+    CStdString strReplace;
+    if (values)
+      strReplace = values->GetString(strtol(strInfo.c_str(),NULL,10));
+    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iEnd+1,strReplace);
+    iIndex += strReplace.length();
+  }
+  ReplaceNewlines(strDest);
+}
+
+void CScraperTemplate::ReplaceNewlines(CStdString &strDest)
+{
+  size_t iIndex = strDest.find("\\n");
+  if (iIndex == CStdString::npos)
+    return;
+
+  CStdString strResult;
+  strResult.reserve(strDest.size());
+  size_t iStart = 0;
+  for (; iIndex != CStdString::npos; iIndex = strDest.find("\\n", iStart))
+  {
+    strResult.append(strDest, iStart, iIndex - iStart);
+    strResult += '\n';
+    iStart = iIndex + 2;
+  }
+  strResult.append(strDest, iStart, CStdString::npos);
+  strDest.swap(strResult);
+}
@@ -0,0 +1,104 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+#include "StdString.h"
+
+#define MAX_SCRAPER_BUFFERS 20
+
+/*!
+ \brief Looks up the settings ($INFO[]) and localized strings ($LOCALIZE[]) inserted into a template
+ */
+class IScraperTemplateValues
+{
+public:
+  virtual ~IScraperTemplateValues() {}
+  virtual CStdString GetSetting(const CStdString &strName) = 0;
+  virtual CStdString GetString(int iString) = 0;
+};
+
+/*!
+ \brief A string of a scraper XML with references to buffers ($$1), settings ($INFO[]) and
+ localized strings ($LOCALIZE[]).
+
+ The references are located once by Parse(), Expand() then inserts the values in a single
+ pass. ReplaceBuffers() replaces the references one kind after the other, searching the
+ values inserted before again. Expand() gives the same result, it only replaces a template
+ by ReplaceBuffers() when an inserted value contains a reference itself, or the start of
+ one at its end.
+ */
+class CScraperTemplate
+{
+public:
+  CScraperTemplate();
+
+  void Parse(const CStdString &strRaw);
+
+  /*! \brief Insert the buffers, settings and localized strings
+   \param params the buffers
+   \param values the settings and localized strings, NULL inserts empty strings
+   \param pReads if not NULL, the buffers inserted by ReplaceBuffers() are added to it
+   \return the expanded template
+   */
+  CStdString Expand(const CStdString *params, IScraperTemplateValues *values, uint32_t *pReads = NULL) const;
+
+  /*! \brief The template can't be split into references up front, it is always expanded by ReplaceBuffers() */
+  bool IsLegacy() const { return m_bLegacy; }
+
+  /*! \brief The template doesn't reference anything */
+  bool IsStatic() const;
+
+  /*! \brief Bitmask of the buffers the template references */
+  uint32_t GetBuffers() const { return m_iBuffers; }
+
+  const CStdString &GetRaw() const { return m_strRaw; }
+
+  /*! \brief Replace the buffers from $$20 down to $$1, then the settings, the localized strings and
+   escaped newlines, each in the string the previous step returned
+   \param strDest the string to replace the references in
+   \param params the buffers
+   \param values the settings and localized strings, NULL inserts empty strings
+   \param pReads if not NULL, the buffers that are inserted are added to it
+   */
+  static void ReplaceBuffers(CStdString &strDest, const CStdString *params, IScraperTemplateValues *values, uint32_t *pReads = NULL);
+
+  /*! \brief Whether inserting the value may let ReplaceBuffers() find another reference */
+  static bool MayInsertReference(const CStdString &strValue);
+
+private:
+  enum SegmentType { Literal, Buffer, Setting, Localize };
+  struct Segment
+  {
+    SegmentType type;
+    CStdString  value;  ///< literal text or the setting name
+    int         index;  ///< buffer index or string id
+  };
+
+  static void ReplaceNewlines(CStdString &strDest);
+
+  CStdString           m_strRaw;
+  std::vector<Segment> m_segments;
+  bool                 m_bLegacy;
+  bool                 m_bNewlines; ///< the literal text contains a backslash
+  uint32_t             m_iBuffers;
+};
@@ -0,0 +1,151 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "StartupTimeline.h"
+#include "threads/SingleLock.h"
+#include "filesystem/File.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+#include "utils/log.h"
+
+#define STARTUP_TRACE_FILE "special://temp/xbmc-startup.json"
+
+CStartupTimeline &CStartupTimeline::Get()
+{
+  static CStartupTimeline timeline;
+  return timeline;
+}
+
+CStartupTimeline::CStartupTimeline()
+{
+  m_recording = true;
+  m_origin    = CurrentHostCounter();
+}
+
+int CStartupTimeline::Begin(const char *name)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_recording)
+    return -1;
+
+  Phase phase;
+  phase.name   = name;
+  phase.thread = GetThreadIndex();
+  phase.start  = CurrentHostCounter();
+  phase.end    = 0;
+  m_phases.push_back(phase);
+  return m_phases.size() - 1;
+}
+
+void CStartupTimeline::End(int id)
+{
+  CSingleLock lock(m_critSection);
+  if (m_recording && id >= 0 && id < (int)m_phases.size())
+    m_phases[id].end = CurrentHostCounter();
+}
+
+unsigned int CStartupTimeline::GetThreadIndex()
+{
+  ThreadIdentifier thread = CThread::GetCurrentThreadId();
+  for (unsigned int i = 0; i < m_threads.size(); i++)
+  {
+    if (m_threads[i] == thread)
+      return i;
+  }
+  m_threads.push_back(thread);
+  return m_threads.size() - 1;
+}
+
+CStdString CStartupTimeline::GetThreadName(unsigned int index)
+{
+  // phases start on the main thread, any other thread is a job worker
+  CStdString name = "main";
+  if (index > 0)
+    name.Format("worker %u", index);
+  return name;
+}
+
+double CStartupTimeline::ToMs(int64_t counter) const
+{
+  return 1000.0 * (counter - m_origin) / CurrentHostFrequency();
+}
+
+double CStartupTimeline::Finish()
+{
+  CSingleLock lock(m_critSection);
+  if (!m_recording)
+    return 0.0;
+  m_recording = false;
+
+  int64_t now = CurrentHostCounter();
+
+  CLog::Log(LOGNOTICE, "Startup timeline (start, duration, thread):");
+  for (std::vector<Phase>::const_iterator it = m_phases.begin(); it != m_phases.end(); ++it)
+  {
+    int64_t end = it->end ? it->end : now;
+    CLog::Log(LOGNOTICE, "  %9.1f ms %9.1f ms  %-9s %s%s", ToMs(it->start), ToMs(end) - ToMs(it->start),
+              GetThreadName(it->thread).c_str(), it->name, it->end ? "" : " (not finished)");
+  }
+  CLog::Log(LOGNOTICE, "Startup took %.1f ms", ToMs(now));
+
+  WriteTrace(STARTUP_TRACE_FILE, now);
+  return ToMs(now);
+}
+
+void CStartupTimeline::WriteTrace(const std::string &path, int64_t end) const
+{
+  // chrome trace event format, timestamps are in microseconds
+  CVariant events(CVariant::VariantTypeArray);
+  for (unsigned int i = 0; i < m_threads.size(); i++)
+  {
+    CVariant event;
+    event["name"] = "thread_name";
+    event["ph"]   = "M";
+    event["pid"]  = 1;
+    event["tid"]  = i;
+    event["args"]["name"] = GetThreadName(i);
+    events.push_back(event);
+  }
+
+  for (std::vector<Phase>::const_iterator it = m_phases.begin(); it != m_phases.end(); ++it)
+  {
+    double start = ToMs(it->start);
+    CVariant event;
+    event["name"] = it->name;
+    event["ph"]   = "X";
+    event["pid"]  = 1;
+    event["tid"]  = it->thread;
+    event["ts"]   = (int64_t)(start * 1000.0);
+    event["dur"]  = (int64_t)((ToMs(it->end ? it->end : end) - start) * 1000.0);
+    events.push_back(event);
+  }
+
+  CVariant trace;
+  trace["traceEvents"] = events;
+  std::string json = CJSONVariantWriter::Write(trace, true);
+
+  XFILE::CFile file;
+  if (file.OpenForWrite(path, true) && file.Write(json.c_str(), json.size()) == (int)json.size())
+    CLog::Log(LOGNOTICE, "Startup trace written to %s", path.c_str());
+  else
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, path.c_str());
+}
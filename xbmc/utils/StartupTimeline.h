@@ -0,0 +1,109 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+#include "utils/StdString.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Records how long each phase of the startup takes and on which thread.
+
+ Phases are recorded from the start of the process until Finish() is called once
+ the first window is on screen. Finish() logs a summary and writes the timeline as
+ a trace file (special://temp/xbmc-startup.json) that can be loaded into
+ chrome://tracing.
+
+ \sa CStartupPhase
+ */
+class CStartupTimeline
+{
+public:
+  static CStartupTimeline &Get();
+
+  /*! \brief Start a phase on the calling thread
+   \param name the name of the phase, must stay valid until Finish()
+   \return the id to pass to End(), -1 if the timeline is no longer recording
+   */
+  int Begin(const char *name);
+  void End(int id);
+
+  bool IsRecording() const { return m_recording; }
+
+  /*! \brief Stop recording, log the phases and write the trace file
+   \return the time from the first phase until now in milliseconds
+   */
+  double Finish();
+
+private:
+  CStartupTimeline();
+
+  struct Phase
+  {
+    const char  *name;
+    unsigned int thread; ///< index into m_threads
+    int64_t      start;
+    int64_t      end;    ///< 0 while the phase is running
+  };
+
+  unsigned int GetThreadIndex();
+  static CStdString GetThreadName(unsigned int index);
+  double ToMs(int64_t counter) const;
+  void WriteTrace(const std::string &path, int64_t end) const;
+
+  CCriticalSection              m_critSection;
+  bool                          m_recording;
+  int64_t                       m_origin;
+  std::vector<Phase>            m_phases;
+  std::vector<ThreadIdentifier> m_threads; ///< in order of their first phase
+};
+
+/*!
+ \brief Records a phase of the startup for as long as it is in scope.
+
+ \code
+ {
+   CStartupPhase phase("load settings");
+   ...
+ }
+ \endcode
+ */
+class CStartupPhase
+{
+public:
+  CStartupPhase(const char *name) : m_id(CStartupTimeline::Get().Begin(name)) {}
+  ~CStartupPhase() { End(); }
+
+  /*! \brief End the phase before the scope ends */
+  void End()
+  {
+    if (m_id >= 0)
+      CStartupTimeline::Get().End(m_id);
+    m_id = -1;
+  }
+
+private:
+  int m_id;
+};
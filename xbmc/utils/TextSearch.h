@@ -39,6 +39,9 @@ public:
   bool Search(const CStdString &strHaystack) const;
   bool IsValid(void) const;
 
+  const std::vector<CStdString> &GetANDTerms(void) const { return m_AND; }
+  const std::vector<CStdString> &GetORTerms(void) const { return m_OR; }
+
 private:
   void GetAndCutNextTerm(CStdString &strSearchTerm, CStdString &strNextTerm);
   void ExtractSearchTerms(const CStdString &strSearchTerm, TextSearchDefault defaultSearchMode);
@@ -0,0 +1,209 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "TextSearchIndex.h"
+#include "threads/SingleLock.h"
+
+#include <algorithm>
+
+using namespace std;
+
+#define TEXTSEARCHINDEX_WHITESPACE " \t\r\n"
+
+void CTextSearchIndex::Tokenize(const CStdString &strText, vector<CStdString> &words)
+{
+  CStdString strLower(strText);
+  strLower.ToLower();
+
+  size_t iStart = strLower.find_first_not_of(TEXTSEARCHINDEX_WHITESPACE);
+  while (iStart != CStdString::npos)
+  {
+    size_t iEnd = strLower.find_first_of(TEXTSEARCHINDEX_WHITESPACE, iStart);
+    CStdString strWord = strLower.substr(iStart, iEnd == CStdString::npos ? CStdString::npos : iEnd - iStart);
+    if (find(words.begin(), words.end(), strWord) == words.end())
+      words.push_back(strWord);
+
+    iStart = strLower.find_first_not_of(TEXTSEARCHINDEX_WHITESPACE, iEnd);
+  }
+}
+
+void CTextSearchIndex::Add(DocumentId id, const CStdString &strText)
+{
+  vector<CStdString> words;
+  Tokenize(strText, words);
+
+  CSingleLock lock(m_critSection);
+  vector<CStdString> &documentWords = m_documents[id];
+  for (vector<CStdString>::const_iterator it = words.begin(); it != words.end(); it++)
+  {
+    vector<CStdString>::iterator pos = lower_bound(documentWords.begin(), documentWords.end(), *it);
+    if (pos != documentWords.end() && *pos == *it)
+      continue;
+
+    documentWords.insert(pos, *it);
+    AddPosting(*it, id);
+  }
+}
+
+void CTextSearchIndex::Update(DocumentId id, const CStdString &strText)
+{
+  vector<CStdString> words;
+  Tokenize(strText, words);
+  sort(words.begin(), words.end());
+
+  CSingleLock lock(m_critSection);
+  vector<CStdString> &documentWords = m_documents[id];
+
+  /* both word lists are sorted, walk them side by side */
+  vector<CStdString>::const_iterator oldIt = documentWords.begin();
+  vector<CStdString>::const_iterator newIt = words.begin();
+  while (oldIt != documentWords.end() || newIt != words.end())
+  {
+    if (newIt == words.end() || (oldIt != documentWords.end() && *oldIt < *newIt))
+      RemovePosting(*oldIt++, id);
+    else if (oldIt == documentWords.end() || *newIt < *oldIt)
+      AddPosting(*newIt++, id);
+    else
+    {
+      oldIt++;
+      newIt++;
+    }
+  }
+
+  if (words.empty())
+    m_documents.erase(id);
+  else
+    documentWords.swap(words);
+}
+
+void CTextSearchIndex::Remove(DocumentId id)
+{
+  CSingleLock lock(m_critSection);
+  Documents::iterator document = m_documents.find(id);
+  if (document != m_documents.end())
+    RemoveUnlocked(document);
+}
+
+void CTextSearchIndex::RemoveRange(DocumentId first, DocumentId last)
+{
+  CSingleLock lock(m_critSection);
+  Documents::iterator end = m_documents.upper_bound(last);
+  for (Documents::iterator it = m_documents.lower_bound(first); it != end;)
+    RemoveUnlocked(it++);
+}
+
+void CTextSearchIndex::RemoveUnlocked(Documents::iterator document)
+{
+  for (vector<CStdString>::const_iterator it = document->second.begin(); it != document->second.end(); it++)
+    RemovePosting(*it, document->first);
+  m_documents.erase(document);
+}
+
+void CTextSearchIndex::AddPosting(const CStdString &strWord, DocumentId id)
+{
+  vector<DocumentId> &documents = m_postings[strWord];
+
+  /* documents are usually added in ascending order */
+  if (documents.empty() || documents.back() < id)
+    documents.push_back(id);
+  else
+  {
+    vector<DocumentId>::iterator pos = lower_bound(documents.begin(), documents.end(), id);
+    if (pos == documents.end() || *pos != id)
+      documents.insert(pos, id);
+  }
+}
+
+void CTextSearchIndex::RemovePosting(const CStdString &strWord, DocumentId id)
+{
+  Postings::iterator it = m_postings.find(strWord);
+  if (it == m_postings.end())
+    return;
+
+  vector<DocumentId> &documents = it->second;
+  vector<DocumentId>::iterator pos = lower_bound(documents.begin(), documents.end(), id);
+  if (pos != documents.end() && *pos == id)
+    documents.erase(pos);
+
+  if (documents.empty())
+    m_postings.erase(it);
+}
+
+void CTextSearchIndex::Clear(void)
+{
+  CSingleLock lock(m_critSection);
+  m_postings.clear();
+  m_documents.clear();
+}
+
+void CTextSearchIndex::SortUnique(vector<DocumentId> &documents)
+{
+  sort(documents.begin(), documents.end());
+  documents.erase(unique(documents.begin(), documents.end()), documents.end());
+}
+
+int CTextSearchIndex::FindPrefix(const CStdString &strPrefix, vector<DocumentId> &results) const
+{
+  CStdString strLower(strPrefix);
+  strLower.ToLower();
+
+  vector<DocumentId> found;
+  CSingleLock lock(m_critSection);
+  for (Postings::const_iterator it = m_postings.lower_bound(strLower);
+      it != m_postings.end() && it->first.compare(0, strLower.length(), strLower) == 0; it++)
+    found.insert(found.end(), it->second.begin(), it->second.end());
+
+  SortUnique(found);
+  results.swap(found);
+  return (int) results.size();
+}
+
+int CTextSearchIndex::FindSubstring(const CStdString &strText, vector<DocumentId> &results) const
+{
+  /* a word can't contain whitespace. look up the longest part of the string instead */
+  vector<CStdString> parts;
+  Tokenize(strText, parts);
+
+  CStdString strPart;
+  for (vector<CStdString>::const_iterator it = parts.begin(); it != parts.end(); it++)
+  {
+    if (it->length() > strPart.length())
+      strPart = *it;
+  }
+
+  vector<DocumentId> found;
+  CSingleLock lock(m_critSection);
+  for (Postings::const_iterator it = m_postings.begin(); it != m_postings.end(); it++)
+  {
+    if (it->first.find(strPart) != CStdString::npos)
+      found.insert(found.end(), it->second.begin(), it->second.end());
+  }
+
+  SortUnique(found);
+  results.swap(found);
+  return (int) results.size();
+}
+
+size_t CTextSearchIndex::Size(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_postings.size();
+}
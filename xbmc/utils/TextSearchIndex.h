@@ -0,0 +1,123 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "StdString.h"
+#include "threads/CriticalSection.h"
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+/*!
+ * @brief In-memory inverted index of the words in a set of documents.
+ *
+ * Texts are lower cased and split on whitespace. Every distinct word keeps a sorted list of the
+ * documents it occurs in, so documents containing a word, a word prefix or any part of a word can
+ * be found without looking at the documents themselves.
+ */
+class CTextSearchIndex
+{
+public:
+  typedef uint64_t DocumentId;
+
+  CTextSearchIndex(void) {};
+  virtual ~CTextSearchIndex(void) {};
+
+  /*!
+   * @brief Split a text into lower cased words.
+   * @param strText The text to split.
+   * @param words The distinct words in the text.
+   */
+  static void Tokenize(const CStdString &strText, std::vector<CStdString> &words);
+
+  /*!
+   * @brief Add the words of a text to the index.
+   * @param id The document the text belongs to.
+   * @param strText The text.
+   */
+  void Add(DocumentId id, const CStdString &strText);
+
+  /*!
+   * @brief Replace the words of a document. Only the words that were added or dropped are updated.
+   * @param id The document.
+   * @param strText The new text of the document.
+   */
+  void Update(DocumentId id, const CStdString &strText);
+
+  /*!
+   * @brief Remove a document.
+   * @param id The document to remove.
+   */
+  void Remove(DocumentId id);
+
+  /*!
+   * @brief Remove all documents in the given range.
+   * @param first The first document to remove.
+   * @param last The last document to remove.
+   */
+  void RemoveRange(DocumentId first, DocumentId last);
+
+  /*!
+   * @brief Remove all documents.
+   */
+  void Clear(void);
+
+  /*!
+   * @brief Find all documents containing a word that starts with the given prefix.
+   * @param strPrefix The prefix. Should not contain whitespace.
+   * @param results The documents that were found, sorted and without duplicates.
+   * @return The amount of documents that were found.
+   */
+  int FindPrefix(const CStdString &strPrefix, std::vector<DocumentId> &results) const;
+
+  /*!
+   * @brief Find all documents containing a word that contains the given string.
+   *
+   * Only the words of the index are searched, not the documents, so this is a lot cheaper than
+   * a substring search of all documents. Whitespace in the string is treated as a word boundary
+   * and only the longest part of it is looked up, so the results are a superset of the documents
+   * that contain the string.
+   *
+   * @param strText The string to find.
+   * @param results The documents that were found, sorted and without duplicates.
+   * @return The amount of documents that were found.
+   */
+  int FindSubstring(const CStdString &strText, std::vector<DocumentId> &results) const;
+
+  /*!
+   * @return The number of distinct words in the index.
+   */
+  size_t Size(void) const;
+
+private:
+  typedef std::map<CStdString, std::vector<DocumentId> > Postings;
+  typedef std::map<DocumentId, std::vector<CStdString> > Documents;
+
+  static void SortUnique(std::vector<DocumentId> &documents);
+  void AddPosting(const CStdString &strWord, DocumentId id);
+  void RemovePosting(const CStdString &strWord, DocumentId id);
+  void RemoveUnlocked(Documents::iterator document);
+
+  Postings         m_postings;    /*!< the documents each word occurs in, sorted */
+  Documents        m_documents;   /*!< the words of each document, sorted */
+  CCriticalSection m_critSection;
+};
@@ -23,20 +23,306 @@
 #include "log.h"
 #include "stdio_utf8.h"
 #include "stat_utf8.h"
+#include "threads/Atomics.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StdString.h"
 
+// number of lines that can be queued for the writer, a power of 2
+#define LOG_QUEUE_SIZE     4096
+// lines up to this length are formatted on the stack
+#define LOG_LINE_SIZE      2048
+// how often the writer wakes up to write out the queued lines
+#define LOG_FLUSH_INTERVAL 100
+// how long a thread logging an error waits for room in the queue before the line is dropped
+#define LOG_FULL_TIMEOUT   100
+
+static char levelNames[][8] =
+{"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
+
+/*!
+ \brief Writes the log on its own thread, so that logging never waits for the disk.
+
+ Lines are handed over in a bounded multiple producer, single consumer ring
+ that doesn't take any lock. Each slot carries a sequence number telling
+ whether it is free for the producer at that position or filled for the
+ consumer. When the ring is full debug and info lines are dropped and
+ counted, more important lines wait a little for room first.
+ */
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter();
+  virtual ~CLogWriter();
+
+  /*!
+   \brief Queue a line, called by any thread
+   \return false if the line was dropped
+   */
+  bool Push(int loglevel, const char *line, size_t length);
+
+  /*!
+   \brief Stop the thread after it wrote out everything that was queued
+   */
+  void Stop();
+
+  /*!
+   \brief Write a line out right away, for when there is no writer thread
+   */
+  static void Write(int loglevel, const char *line, size_t length);
+
+protected:
+  virtual void Process();
+
+private:
+  struct Entry
+  {
+    volatile long sequence;
+    int           level;
+    uint64_t      threadId;
+    SYSTEMTIME    time;
+    std::string   line;
+  };
+
+  bool TryPush(int loglevel, const char *line, size_t length, const SYSTEMTIME &time);
+  void Drain();
+  static void Format(std::string &batch, int loglevel, uint64_t threadId, const SYSTEMTIME &time, const std::string &line);
+  static void AppendLine(std::string &batch, int loglevel, uint64_t threadId, const SYSTEMTIME &time, const CStdString &line);
+
+  Entry         *m_entries;
+  volatile long  m_enqueuePos;
+  long           m_dequeuePos;    ///< only used by the writer thread
+  volatile long  m_dropped;
+  std::string    m_batch;         ///< the lines written out at once
+  CEvent         m_wake;
+};
+
+CLog::CLogGlobals::~CLogGlobals()
+{
+  // Log() writes synchronously from now on
+  CLogWriter *writer = m_writer;
+  m_writer = NULL;
+  if (!writer)
+    return;
+
+  // wait for the threads still pushing to it, then write out what they queued
+  while (m_writerUsers)
+    ::Sleep(1);
+  writer->Stop();
+  delete writer;
+}
+
 #define critSec XBMC_GLOBAL_USE(CLog::CLogGlobals).critSec
 #define m_file XBMC_GLOBAL_USE(CLog::CLogGlobals).m_file
 #define m_repeatCount XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatCount
 #define m_repeatLogLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLogLevel
 #define m_repeatLine XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLine
 #define m_logLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_logLevel
+#define m_writer XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writer
+#define m_writerUsers XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writerUsers
 
-static char levelNames[][8] =
-{"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
+CLogWriter::CLogWriter() : CThread("CLogWriter")
+{
+  m_entries = new Entry[LOG_QUEUE_SIZE];
+  for (long i = 0; i < LOG_QUEUE_SIZE; i++)
+    m_entries[i].sequence = i;
+  m_enqueuePos = 0;
+  m_dequeuePos = 0;
+  m_dropped    = 0;
+}
+
+CLogWriter::~CLogWriter()
+{
+  Stop();
+  delete[] m_entries;
+}
+
+void CLogWriter::Stop()
+{
+  StopThread();
+}
+
+bool CLogWriter::TryPush(int loglevel, const char *line, size_t length, const SYSTEMTIME &time)
+{
+  long pos = m_enqueuePos;
+  for (;;)
+  {
+    Entry &entry = m_entries[pos & (LOG_QUEUE_SIZE - 1)];
+    long diff = (long)((unsigned long)entry.sequence - (unsigned long)pos);
+    if (diff == 0)
+    {
+      // the slot is free, claim it
+      long next = (long)((unsigned long)pos + 1);
+      if (cas(&m_enqueuePos, pos, next) == pos)
+      {
+        entry.level    = loglevel;
+        entry.threadId = (uint64_t)CThread::GetCurrentThreadId();
+        entry.time     = time;
+        entry.line.assign(line, length);
+        // hand it over to the writer
+        AtomicIncrement(&entry.sequence);
+
+        // don't let the queue fill up before the next timed flush
+        if ((next & (LOG_QUEUE_SIZE / 4 - 1)) == 0)
+          m_wake.Set();
+        return true;
+      }
+      pos = m_enqueuePos;
+    }
+    else if (diff < 0)
+      return false; // the writer hasn't caught up with this slot yet, the queue is full
+    else
+      pos = m_enqueuePos; // another thread took the slot
+  }
+}
+
+bool CLogWriter::Push(int loglevel, const char *line, size_t length)
+{
+  SYSTEMTIME time;
+  GetLocalTime(&time);
+
+  if (TryPush(loglevel, line, length, time))
+  {
+    // errors shouldn't get lost when we crash right after them
+    if (loglevel >= LOGERROR)
+      m_wake.Set();
+    return true;
+  }
+
+  // the queue is full, only the important lines are worth waiting for
+  if (loglevel >= LOGERROR)
+  {
+    m_wake.Set();
+    for (int i = 0; i < LOG_FULL_TIMEOUT; i++)
+    {
+      ::Sleep(1);
+      if (TryPush(loglevel, line, length, time))
+        return true;
+    }
+  }
+
+  AtomicIncrement(&m_dropped);
+  return false;
+}
+
+void CLogWriter::Process()
+{
+  while (!m_bStop)
+  {
+    AbortableWait(m_wake, LOG_FLUSH_INTERVAL);
+    Drain();
+  }
+  Drain();
+}
+
+void CLogWriter::Drain()
+{
+  m_batch.clear();
+
+  for (;;)
+  {
+    Entry &entry = m_entries[m_dequeuePos & (LOG_QUEUE_SIZE - 1)];
+    long expected = (long)((unsigned long)m_dequeuePos + 1);
+    // the atomic read makes sure the line is read after its sequence
+    if (cas(&entry.sequence, expected, expected) != expected)
+      break;
+
+    Format(m_batch, entry.level, entry.threadId, entry.time, entry.line);
+
+    // hand the slot back for the next round of producers
+    AtomicAdd(&entry.sequence, LOG_QUEUE_SIZE - 1);
+    m_dequeuePos = expected;
+  }
+
+  long dropped = m_dropped;
+  if (dropped)
+  {
+    AtomicSubtract(&m_dropped, dropped);
+
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    CStdString strData;
+    strData.Format("%ld lines were dropped, the log couldn't keep up", dropped);
+    Format(m_batch, LOGWARNING, (uint64_t)CThread::GetCurrentThreadId(), time, strData);
+  }
+
+  if (!m_batch.empty() && m_file)
+  {
+    fwrite(m_batch.c_str(), m_batch.size(), 1, m_file);
+    fflush(m_file);
+  }
+}
+
+void CLogWriter::Write(int loglevel, const char *line, size_t length)
+{
+  SYSTEMTIME time;
+  GetLocalTime(&time);
+
+  CSingleLock waitLock(critSec);
+  if (!m_file)
+    return;
+
+  std::string batch;
+  Format(batch, loglevel, (uint64_t)CThread::GetCurrentThreadId(), time, std::string(line, length));
+  if (!batch.empty())
+  {
+    fwrite(batch.c_str(), batch.size(), 1, m_file);
+    fflush(m_file);
+  }
+}
+
+void CLogWriter::Format(std::string &batch, int loglevel, uint64_t threadId, const SYSTEMTIME &time, const std::string &line)
+{
+  if (m_repeatLogLevel == loglevel && m_repeatLine == line)
+  {
+    m_repeatCount++;
+    return;
+  }
+  else if (m_repeatCount)
+  {
+    CStdString strData;
+    strData.Format("Previous line repeats %d times.", m_repeatCount);
+    AppendLine(batch, m_repeatLogLevel, threadId, time, strData);
+    m_repeatCount = 0;
+  }
+
+  m_repeatLine      = line;
+  m_repeatLogLevel  = loglevel;
+
+  CStdString strData(line);
+  unsigned int length = 0;
+  while ( length != strData.length() )
+  {
+    length = strData.length();
+    strData.TrimRight(" ");
+    strData.TrimRight('\n');
+    strData.TrimRight("\r");
+  }
+
+  if (!length)
+    return;
+
+  AppendLine(batch, loglevel, threadId, time, strData);
+}
+
+void CLogWriter::AppendLine(std::string &batch, int loglevel, uint64_t threadId, const SYSTEMTIME &time, const CStdString &line)
+{
+  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
+
+  CLog::OutputDebugString(line);
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), prefixFormat, time.wHour, time.wMinute, time.wSecond, threadId, levelNames[loglevel]);
+  batch += prefix;
+
+  /* fixup newline alignment, number of spaces should equal prefix length */
+  CStdString strData(line);
+  strData.Replace("\n", LINE_ENDING"                                            ");
+  batch += strData;
+  batch += LINE_ENDING;
+}
 
 CLog::CLog()
 {}
@@ -46,8 +332,11 @@ CLog::~CLog()
 
 void CLog::Close()
 {
-  
   CSingleLock waitLock(critSec);
+  // write out what is still queued before the file goes away
+  if (m_writer)
+    m_writer->Stop();
+
   if (m_file)
   {
     fclose(m_file);
@@ -58,71 +347,42 @@ void CLog::Close()
 
 void CLog::Log(int loglevel, const char *format, ... )
 {
-  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
-  CSingleLock waitLock(critSec);
+  // checked without any lock, a line more or less while the level changes doesn't matter
 #if !(defined(_DEBUG) || defined(PROFILE))
-  if (m_logLevel > LOG_LEVEL_NORMAL ||
-     (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
+  if (m_logLevel <= LOG_LEVEL_NORMAL &&
+     (m_logLevel <= LOG_LEVEL_NONE || loglevel < LOGNOTICE))
+    return;
 #endif
-  {
-    if (!m_file)
-      return;
 
-    SYSTEMTIME time;
-    GetLocalTime(&time);
+  if (!m_file || loglevel < LOGDEBUG || loglevel > LOGNONE)
+    return;
 
-    CStdString strPrefix, strData;
+  // format on the stack of the calling thread, only long lines need the heap
+  char buffer[LOG_LINE_SIZE];
+  const char *line = buffer;
+  CStdString strData;
+  va_list va;
+  va_start(va, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, va);
+  va_end(va);
 
-    strData.reserve(16384);
-    va_list va;
+  if (length < 0 || length >= (int)sizeof(buffer))
+  {
     va_start(va, format);
-    strData.FormatV(format,va);
+    strData.FormatV(format, va);
     va_end(va);
-
-    if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
-    {
-      m_repeatCount++;
-      return;
-    }
-    else if (m_repeatCount)
-    {
-      CStdString strData2;
-      strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[m_repeatLogLevel]);
-
-      strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
-      fputs(strPrefix.c_str(), m_file);
-      fputs(strData2.c_str(), m_file);
-      OutputDebugString(strData2);
-      m_repeatCount = 0;
-    }
-    
-    m_repeatLine      = strData;
-    m_repeatLogLevel  = loglevel;
-
-    unsigned int length = 0;
-    while ( length != strData.length() )
-    {
-      length = strData.length();
-      strData.TrimRight(" ");
-      strData.TrimRight('\n');
-      strData.TrimRight("\r");
-    }
-
-    if (!length)
-      return;
-    
-    OutputDebugString(strData);
-
-    /* fixup newline alignment, number of spaces should equal prefix length */
-    strData.Replace("\n", LINE_ENDING"                                            ");
-    strData += LINE_ENDING;
-
-    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[loglevel]);
-
-    fputs(strPrefix.c_str(), m_file);
-    fputs(strData.c_str(), m_file);
-    fflush(m_file);
+    line   = strData.c_str();
+    length = strData.length();
   }
+
+  // the writer isn't deleted while it is used here
+  AtomicIncrement(&m_writerUsers);
+  CLogWriter *writer = m_writer;
+  if (writer && writer->IsRunning())
+    writer->Push(loglevel, line, length);
+  else // not started yet, stopped by Close() or gone at exit
+    CLogWriter::Write(loglevel, line, length);
+  AtomicDecrement(&m_writerUsers);
 }
 
 bool CLog::Init(const char* path)
@@ -152,6 +412,11 @@ bool CLog::Init(const char* path)
   {
     unsigned char BOM[3] = {0xEF, 0xBB, 0xBF};
     fwrite(BOM, sizeof(BOM), 1, m_file);
+
+    if (!m_writer)
+      m_writer = new CLogWriter();
+    if (!m_writer->IsRunning())
+      m_writer->Create();
   }
 
   return m_file != NULL;
@@ -34,6 +34,8 @@
 #define ATTRIB_LOG_FORMAT
 #endif
 
+class CLogWriter;
+
 class CLog
 {
 public:
@@ -41,12 +43,15 @@ public:
   class CLogGlobals
   {
   public:
-    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG) {}
+    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_writer(NULL), m_writerUsers(0) {}
+    ~CLogGlobals();
     FILE*       m_file;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
+    CLogWriter* m_writer;      ///< queues the lines and writes them out on its own thread
+    volatile long m_writerUsers; ///< threads pushing to the writer, it isn't deleted before they are done
     CCriticalSection critSec;
   };
 
@@ -59,6 +64,7 @@ public:
   static void SetLogLevel(int level);
   static int  GetLogLevel();
 private:
+  friend class CLogWriter;
   static void OutputDebugString(const std::string& line);
 };
 
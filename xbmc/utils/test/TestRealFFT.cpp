@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/RealFFT.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  // straight from the definition, in double precision
+  void ReferenceDFT(const std::vector<float> &input, std::vector<double> &re, std::vector<double> &im)
+  {
+    unsigned int n = input.size();
+    re.assign(n / 2 + 1, 0.0);
+    im.assign(n / 2 + 1, 0.0);
+    for (unsigned int k = 0; k <= n / 2; k++)
+    {
+      for (unsigned int i = 0; i < n; i++)
+      {
+        double phase = -2.0 * M_PI * k * i / n;
+        re[k] += input[i] * cos(phase);
+        im[k] += input[i] * sin(phase);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestRealFFTMatchesDFT)
+{
+  srand(0);
+  for (unsigned int size = 4; size <= 2048; size <<= 1)
+  {
+    std::vector<float> input(size);
+    for (unsigned int i = 0; i < size; i++)
+      input[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+
+    CRealFFT fft(size, CRealFFT::WINDOW_RECTANGULAR);
+    BOOST_REQUIRE_EQUAL(fft.GetBins(), size / 2 + 1);
+
+    std::vector<float> re(fft.GetBins()), im(fft.GetBins());
+    fft.Transform(&input[0], 1, &re[0], &im[0]);
+
+    std::vector<double> refRe, refIm;
+    ReferenceDFT(input, refRe, refIm);
+
+    // the error of a float FFT grows with log(size) * sqrt(size) for this input
+    double tolerance = 1e-5 * sqrt((double)size) * log((double)size);
+    for (unsigned int k = 0; k < fft.GetBins(); k++)
+    {
+      BOOST_CHECK_SMALL(re[k] - refRe[k], tolerance);
+      BOOST_CHECK_SMALL(im[k] - refIm[k], tolerance);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestRealFFTStrideAndPadding)
+{
+  // the second channel of a stereo signal, zero padded to twice its length
+  const unsigned int samples = 256;
+  std::vector<float> stereo(2 * samples);
+  std::vector<float> padded(2 * samples, 0.0f);
+  for (unsigned int i = 0; i < samples; i++)
+  {
+    stereo[2 * i]     = (float)sin(0.1 * i);
+    stereo[2 * i + 1] = (float)cos(0.37 * i);
+    padded[i] = stereo[2 * i + 1];
+  }
+
+  CRealFFT strided(2 * samples, CRealFFT::WINDOW_RECTANGULAR, samples);
+  CRealFFT plain(2 * samples, CRealFFT::WINDOW_RECTANGULAR);
+
+  std::vector<float> power1(strided.GetBins()), power2(plain.GetBins());
+  strided.Power(&stereo[1], 2, &power1[0]);
+  plain.Power(&padded[0], 1, &power2[0]);
+
+  for (unsigned int k = 0; k < strided.GetBins(); k++)
+    BOOST_CHECK_CLOSE(power1[k] + 1.0f, power2[k] + 1.0f, 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(TestRealFFTWindowedSine)
+{
+  // a full scale sine centred on a bin shows up there with the window gain
+  const unsigned int size = 1024;
+  const unsigned int bin = 100;
+  std::vector<float> input(size);
+  for (unsigned int i = 0; i < size; i++)
+    input[i] = (float)sin(2.0 * M_PI * bin * i / size);
+
+  CRealFFT fft(size, CRealFFT::WINDOW_HANN);
+  BOOST_CHECK_CLOSE(fft.GetWindowGain(), size / 2.0f, 0.01);
+
+  std::vector<float> power(fft.GetBins());
+  fft.Power(&input[0], 1, &power[0]);
+
+  float expected = fft.GetWindowGain() / 2.0f;
+  BOOST_CHECK_CLOSE(sqrt(power[bin]), expected, 0.1);
+  BOOST_CHECK_CLOSE(sqrt(power[bin - 1]), expected / 2.0f, 0.1);
+  BOOST_CHECK_CLOSE(sqrt(power[bin + 1]), expected / 2.0f, 0.1);
+  BOOST_CHECK_SMALL(sqrt(power[bin + 10]), expected * 1e-4f);
+}
@@ -0,0 +1,233 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/RegExp.h"
+#include "threads/SystemClock.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  /* the default stacking, exclude and episode expressions of CAdvancedSettings */
+  const char *stackRegExps[] = {
+    "(.*?)([ _.-]*(?:cd|dvd|p(?:(?:ar)?t)|dis[ck]|d)[ _.-]*[0-9]+)(.*?)(\\.[^.]+)$",
+    "(.*?)([ _.-]*(?:cd|dvd|p(?:(?:ar)?t)|dis[ck]|d)[ _.-]*[a-d])(.*?)(\\.[^.]+)$",
+    "(.*?)([ ._-]*[a-d])(.*?)(\\.[^.]+)$"
+  };
+
+  const char *excludeRegExps[] = {
+    "-trailer",
+    "[!-._ \\\\/]sample[-._ \\\\/]",
+    "\\.AppleDouble",
+    "[\\\\/]extrafanart[\\\\/]"
+  };
+
+  const char *episodeRegExps[] = {
+    "[Ss]([0-9]+)[][ ._-]*[Ee]([0-9]+)([^\\\\/]*)$",
+    "[\\._ -]()[Ee][Pp]_?([0-9]+)([^\\\\/]*)$",
+    "([0-9]{4})[\\.-]([0-9]{2})[\\.-]([0-9]{2})",
+    "([0-9]{2})[\\.-]([0-9]{2})[\\.-]([0-9]{4})",
+    "[\\\\/\\._ \\[\\(-]([0-9]+)x([0-9]+)([^\\\\/]*)$",
+    "[\\\\/\\._ -]([0-9]+)([0-9][0-9])([\\._ -][^\\\\/]*)$",
+    "[\\/._ -]p(?:ar)?t[_. -]()([ivx]+)([._ -][^\\/]*)$"
+  };
+
+  /* the backreference keeps the list from being combined */
+  const char *uncombinableRegExps[] = {
+    "([a-z])\\1[0-9]",
+    "-trailer"
+  };
+
+  struct PatternList
+  {
+    const char **patterns;
+    unsigned int count;
+    bool caseless;
+  };
+
+  const PatternList lists[] = {
+    { stackRegExps,        sizeof(stackRegExps) / sizeof(char*),        true },
+    { excludeRegExps,      sizeof(excludeRegExps) / sizeof(char*),      true },
+    { episodeRegExps,      sizeof(episodeRegExps) / sizeof(char*),      false },
+    { uncombinableRegExps, sizeof(uncombinableRegExps) / sizeof(char*), true }
+  };
+
+  const unsigned int listCount = sizeof(lists) / sizeof(PatternList);
+
+  /* file names of a typical library, most of them match none of the expressions */
+  std::vector<std::string> FileNames()
+  {
+    static const char *titles[] = { "the.movie.2010", "Another Film (1999)", "some_show", "Documentary-HD", "a" };
+    static const char *suffixes[] = { "", "-cd1", ".part2", " disc 3", "b", "-trailer", ".sample.", ".s01e02", "_ep12",
+                                      ".2011-05-04", " 3x07", ".412.", " part ii ", "/extrafanart/", "aa1" };
+    static const char *extensions[] = { ".mkv", ".avi", ".nfo" };
+
+    std::vector<std::string> names;
+    for (unsigned int i = 0; i < sizeof(titles) / sizeof(char*); i++)
+    {
+      for (unsigned int j = 0; j < sizeof(suffixes) / sizeof(char*); j++)
+      {
+        for (unsigned int k = 0; k < sizeof(extensions) / sizeof(char*); k++)
+          names.push_back(std::string("/media/videos/") + titles[i] + suffixes[j] + extensions[k]);
+      }
+    }
+    return names;
+  }
+
+  void Compile(const PatternList &patterns, CRegExpList &list, std::vector<CRegExp> &regExps)
+  {
+    for (unsigned int i = 0; i < patterns.count; i++)
+    {
+      BOOST_REQUIRE(list.Add(patterns.patterns[i]));
+      regExps.push_back(CRegExp(patterns.caseless));
+      BOOST_REQUIRE(regExps.back().RegComp(patterns.patterns[i]));
+    }
+  }
+
+  /* what the callers did before the lists: try every expression on its own */
+  int FindFirstSequential(std::vector<CRegExp> &regExps, const std::string &str)
+  {
+    for (unsigned int i = 0; i < regExps.size(); i++)
+    {
+      if (regExps[i].RegFind(str) >= 0)
+        return i;
+    }
+    return -1;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestRegExpListMatchesSequential)
+{
+  /* the combined list finds the same first expression as trying them one by one */
+  std::vector<std::string> names = FileNames();
+  for (unsigned int l = 0; l < listCount; l++)
+  {
+    CRegExpList list(lists[l].caseless);
+    std::vector<CRegExp> regExps;
+    Compile(lists[l], list, regExps);
+    BOOST_CHECK_EQUAL(list.Size(), lists[l].count);
+
+    for (unsigned int combined = 0; combined < 2; combined++)
+    {
+      if (combined)
+        list.Combine();
+
+      unsigned int matches = 0;
+      for (unsigned int i = 0; i < names.size(); i++)
+      {
+        int expected = FindFirstSequential(regExps, names[i]);
+        BOOST_CHECK_MESSAGE(list.FindFirst(names[i]) == expected, "list " << l << " " << names[i]);
+        BOOST_CHECK_MESSAGE(list.Matches(names[i]) == (expected >= 0), "list " << l << " " << names[i]);
+        if (expected >= 0)
+          matches++;
+      }
+      BOOST_CHECK(matches > 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestRegExpListInvalidPattern)
+{
+  CRegExpList list(true);
+  BOOST_CHECK(list.Add("-trailer"));
+  BOOST_CHECK(!list.Add("(unbalanced"));
+  BOOST_CHECK(list.Add("sample"));
+  list.Combine();
+
+  BOOST_CHECK_EQUAL(list.Size(), 2U);
+  BOOST_CHECK_EQUAL(list.GetPattern(1), "sample");
+  BOOST_CHECK_EQUAL(list.FindFirst("movie-TRAILER.mkv"), 0);
+  BOOST_CHECK_EQUAL(list.FindFirst("movie.Sample.mkv"), 1);
+  BOOST_CHECK_EQUAL(list.FindFirst("movie.mkv"), -1);
+
+  list.Clear();
+  BOOST_CHECK_EQUAL(list.Size(), 0U);
+  BOOST_CHECK(!list.Matches("movie-trailer.mkv"));
+}
+
+BOOST_AUTO_TEST_CASE(TestRegExpListTiming)
+{
+  /* the file names matched against the stacking and exclude expressions by
+     - compiling the list for every file, as ExcludeFileOrFolder() did
+     - trying precompiled expressions one by one
+     - the list compiled once, as CAdvancedSettings keeps them
+     see ./testMain --log_level=message --run_test=TestRegExpListTiming */
+  const unsigned int rounds = 100;
+  std::vector<std::string> names = FileNames();
+
+  CRegExpList stack(true), exclude(true);
+  std::vector<CRegExp> stackRegExps, excludeRegExps;
+  Compile(lists[0], stack, stackRegExps);
+  Compile(lists[1], exclude, excludeRegExps);
+  stack.Combine();
+  exclude.Combine();
+
+  unsigned int perFileMatches = 0;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+      CRegExpList perFileStack(true), perFileExclude(true);
+      for (unsigned int j = 0; j < lists[0].count; j++)
+        perFileStack.Add(lists[0].patterns[j]);
+      for (unsigned int j = 0; j < lists[1].count; j++)
+        perFileExclude.Add(lists[1].patterns[j]);
+      perFileStack.Combine();
+      perFileExclude.Combine();
+      if (perFileStack.Matches(names[i]) || perFileExclude.FindFirst(names[i]) >= 0)
+        perFileMatches++;
+    }
+  }
+  unsigned int perFile = XbmcThreads::SystemClockMillis() - start;
+
+  unsigned int sequentialMatches = 0;
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+      if (FindFirstSequential(stackRegExps, names[i]) >= 0 || FindFirstSequential(excludeRegExps, names[i]) >= 0)
+        sequentialMatches++;
+    }
+  }
+  unsigned int sequential = XbmcThreads::SystemClockMillis() - start;
+
+  unsigned int compiledMatches = 0;
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+      if (stack.Matches(names[i]) || exclude.FindFirst(names[i]) >= 0)
+        compiledMatches++;
+    }
+  }
+  unsigned int compiled = XbmcThreads::SystemClockMillis() - start;
+
+  BOOST_TEST_MESSAGE(rounds * names.size() << " file names, compiled per file " << perFile << " ms, "
+                     "one by one " << sequential << " ms, compiled once " << compiled << " ms");
+  BOOST_CHECK_EQUAL(compiledMatches, sequentialMatches);
+  BOOST_CHECK_EQUAL(compiledMatches, perFileMatches);
+}
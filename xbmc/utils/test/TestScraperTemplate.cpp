@@ -0,0 +1,334 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/ScraperTemplate.h"
+#include "threads/SystemClock.h"
+
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+  class CTestValues : public IScraperTemplateValues
+  {
+  public:
+    CTestValues(const CStdString &strSetting = "en", const CStdString &strString = "Movies")
+      : m_strSetting(strSetting), m_strString(strString) {}
+
+    virtual CStdString GetSetting(const CStdString &strName)
+    {
+      return strName + "=" + m_strSetting;
+    }
+
+    virtual CStdString GetString(int iString)
+    {
+      CStdString strString;
+      strString.Format("%i:%s", iString, m_strString.c_str());
+      return strString;
+    }
+
+  private:
+    CStdString m_strSetting;
+    CStdString m_strString;
+  };
+
+  /* what the parser did before the templates were compiled */
+  CStdString ReplaceBuffers(const CStdString &strRaw, const CStdString *params, IScraperTemplateValues *values)
+  {
+    CStdString strResult = strRaw;
+    CScraperTemplate::ReplaceBuffers(strResult, params, values);
+    return strResult;
+  }
+
+  CStdString Expand(const CStdString &strRaw, const CStdString *params, IScraperTemplateValues *values, uint32_t *pReads = NULL)
+  {
+    CScraperTemplate tmpl;
+    tmpl.Parse(strRaw);
+    return tmpl.Expand(params, values, pReads);
+  }
+
+  /* a random sequence of pieces of references, escaped newlines and text */
+  CStdString RandomString(unsigned int &seed, unsigned int maxTokens)
+  {
+    static const char *tokens[] = { "a", "x y", "1", "2", "5", "0", "n", "]", "\\", "\\n", "$", "$$",
+                                    "$$1", "$$2", "$$5", "$$12", "$$20", "$$21", "$INFO[lang]", "$LOCALIZE[5]",
+                                    "$IN", "FO[lang]", "$LOCALIZ", "E[5]" };
+    CStdString strResult;
+    seed = seed * 1103515245 + 12345;
+    unsigned int count = (seed >> 16) % (maxTokens + 1);
+    for (unsigned int i = 0; i < count; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      strResult += tokens[(seed >> 16) % (sizeof(tokens) / sizeof(char*))];
+    }
+    return strResult;
+  }
+
+  /* a page as it is downloaded by a scraper, with scripts and escaped JSON */
+  CStdString Page(unsigned int size)
+  {
+    CStdString strPage = "<html><head><script>$(document).ready(function() { $('#plot').show(); });</script></head><body>\n";
+    while (strPage.size() < size)
+    {
+      strPage += "<div class=\"cast\"><a href=\"/name/nm0000123/\">Some Actor</a> as <a href=\"/character/ch01/\">A Role</a></div>\n";
+      strPage += "<script>var data = {\"plot\":\"A line\\nand the next, costs $5 \\\"quoted\\\"\"};</script>\n";
+    }
+    strPage += "</body></html>\n";
+    return strPage;
+  }
+
+  std::string Unescape(const std::string &strXML)
+  {
+    static const char *entities[][2] = { { "&lt;", "<" }, { "&gt;", ">" }, { "&quot;", "\"" }, { "&apos;", "'" }, { "&amp;", "&" } };
+    std::string strResult = strXML;
+    for (unsigned int i = 0; i < sizeof(entities) / sizeof(entities[0]); i++)
+    {
+      size_t pos = 0;
+      while ((pos = strResult.find(entities[i][0], pos)) != std::string::npos)
+      {
+        strResult.replace(pos, strlen(entities[i][0]), entities[i][1]);
+        pos += strlen(entities[i][1]);
+      }
+    }
+    return strResult;
+  }
+
+  std::string ReadFile(const char *file)
+  {
+    std::ifstream stream(file);
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    return buffer.str();
+  }
+
+  /* the input and output attributes and the expressions of a scraper XML */
+  void LoadTemplates(const char *file, std::vector<CStdString> &templates)
+  {
+    std::string strXML = ReadFile(file);
+
+    static const char *attributes[] = { " input=\"", " output=\"" };
+    for (unsigned int i = 0; i < sizeof(attributes) / sizeof(char*); i++)
+    {
+      for (size_t pos = strXML.find(attributes[i]); pos != std::string::npos; pos = strXML.find(attributes[i], pos))
+      {
+        pos += strlen(attributes[i]);
+        size_t end = strXML.find('"', pos);
+        templates.push_back(Unescape(strXML.substr(pos, end - pos)));
+      }
+    }
+    for (size_t pos = strXML.find("<expression"); pos != std::string::npos; pos = strXML.find("<expression", pos))
+    {
+      pos = strXML.find('>', pos) + 1;
+      size_t end = strXML.find("</expression>", pos);
+      if (strXML[pos - 2] != '/' && end != std::string::npos)
+        templates.push_back(Unescape(strXML.substr(pos, end - pos)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestExpandMatchesReplaceBuffers)
+{
+  /* values with references, the start of one at their end, escaped newlines and scripts */
+  const char *templates[] = {
+    "", "plain text", "$$1", "<url>http://www.imdb.com/title/$$2/</url>", "$$1$$2$$3", "$$21", "$$12$$1",
+    "a\\nb", "\\$$1", "$$1\\", "$$2n", "$$1$INFO[lang]", "$INFO[lang]$$1", "$LOCALIZE[5] $$3",
+    "$$3FO[lang]", "$$2$$5", "$INFO[$$1]", "$LOCALIZE[21]", "$$20 - $$10 - $$2", "$$4\\n$$4"
+  };
+  const char *values[] = {
+    "", "text", "$('#plot').show();", "costs $5", "A line\\nand the next", "ends with \\", "n",
+    "$$5", "$$12", "$INFO[lang]", "$LOCALIZE[3]", "ends with $", "ends with $$", "ends with $IN",
+    "$1.99 or $$", "FO[lang]", "\\\\n", "a $$20 b"
+  };
+  const unsigned int templateCount = sizeof(templates) / sizeof(char*);
+  const unsigned int valueCount = sizeof(values) / sizeof(char*);
+
+  for (unsigned int t = 0; t < templateCount; t++)
+  {
+    for (unsigned int v = 0; v < valueCount; v++)
+    {
+      CStdString params[MAX_SCRAPER_BUFFERS];
+      for (int i = 0; i < MAX_SCRAPER_BUFFERS; i++)
+        params[i] = values[(v + i) % valueCount];
+
+      CTestValues settings(values[v], values[(v + 1) % valueCount]);
+      BOOST_CHECK_MESSAGE(Expand(templates[t], params, &settings) == ReplaceBuffers(templates[t], params, &settings),
+                          "template \"" << templates[t] << "\" value \"" << values[v] << "\"");
+      BOOST_CHECK_MESSAGE(Expand(templates[t], params, NULL) == ReplaceBuffers(templates[t], params, NULL),
+                          "template \"" << templates[t] << "\" value \"" << values[v] << "\" without settings");
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestExpandRandom)
+{
+  unsigned int seed = 1;
+  for (unsigned int round = 0; round < 20000; round++)
+  {
+    CStdString strTemplate = RandomString(seed, 8);
+    CStdString params[MAX_SCRAPER_BUFFERS];
+    for (int i = 0; i < MAX_SCRAPER_BUFFERS; i++)
+      params[i] = RandomString(seed, 3);
+    CTestValues settings(RandomString(seed, 3), RandomString(seed, 3));
+
+    CStdString strExpected = ReplaceBuffers(strTemplate, params, &settings);
+    CStdString strResult = Expand(strTemplate, params, &settings);
+    BOOST_CHECK_MESSAGE(strResult == strExpected, "template \"" << strTemplate << "\" gives \"" << strResult << "\" instead of \"" << strExpected << "\"");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestExpandReads)
+{
+  CStdString params[MAX_SCRAPER_BUFFERS];
+  params[0] = "$('#plot') \\n";
+  params[1] = "two";
+  params[2] = "<a>$$2</a>";
+
+  CScraperTemplate tmpl;
+  tmpl.Parse("$$1 $$3");
+  BOOST_CHECK_EQUAL(tmpl.GetBuffers(), (uint32_t)((1 << 0) | (1 << 2)));
+  BOOST_CHECK(!tmpl.IsLegacy());
+
+  /* $$2 is only found in the value of $$3 */
+  uint32_t iReads = 0;
+  BOOST_CHECK_EQUAL(tmpl.Expand(params, NULL, &iReads), "$('#plot') \n <a>two</a>");
+  BOOST_CHECK(iReads & (1 << 1));
+
+  /* nothing is read but the buffers in the template */
+  params[2] = "<a>$5</a> in total";
+  iReads = 0;
+  BOOST_CHECK_EQUAL(tmpl.Expand(params, NULL, &iReads), "$('#plot') \n <a>$5</a> in total");
+  BOOST_CHECK_EQUAL(iReads, 0U);
+
+  BOOST_CHECK(!CScraperTemplate::MayInsertReference("$('#plot').show(); costs $5, see below"));
+  BOOST_CHECK(CScraperTemplate::MayInsertReference("costs $$5 in total"));
+  BOOST_CHECK(CScraperTemplate::MayInsertReference("ends with $"));
+}
+
+BOOST_AUTO_TEST_CASE(TestExpandReplay)
+{
+  /* the templates of the bundled scrapers, expanded with downloaded pages in the buffers
+     by ReplaceBuffers() as the parser did before and by the compiled templates, see
+       ./testMain --log_level=message --run_test=TestExpandReplay */
+  const char *files[] = {
+    "../../../addons/metadata.themoviedb.org/tmdb.xml",
+    "../../../addons/metadata.common.themoviedb.org/tmdb.xml",
+    "../../../addons/metadata.common.imdb.com/imdb.xml",
+    "../../../addons/metadata.tvdb.com/tvdb.xml",
+    "../../../addons/metadata.common.allmusic.com/allmusic.xml"
+  };
+  const unsigned int rounds = 20;
+
+  std::vector<CStdString> templates;
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(char*); i++)
+    LoadTemplates(files[i], templates);
+  BOOST_REQUIRE_MESSAGE(!templates.empty(), "the scrapers are read relative to xbmc/utils/test");
+
+  std::vector<CScraperTemplate> compiled(templates.size());
+  for (unsigned int i = 0; i < templates.size(); i++)
+    compiled[i].Parse(templates[i]);
+
+  CStdString params[MAX_SCRAPER_BUFFERS];
+  params[0] = Page(100 * 1024);
+  params[1] = "tt0123456";
+  params[2] = Page(20 * 1024);
+  for (int i = 3; i < MAX_SCRAPER_BUFFERS; i++)
+    params[i] = "<thumb>http://images.example.com/poster.jpg</thumb>";
+  CTestValues settings;
+
+  size_t legacySize = 0;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int i = 0; i < templates.size(); i++)
+      legacySize += ReplaceBuffers(templates[i], params, &settings).size();
+  }
+  unsigned int legacy = XbmcThreads::SystemClockMillis() - start;
+
+  size_t compiledSize = 0;
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int round = 0; round < rounds; round++)
+  {
+    for (unsigned int i = 0; i < compiled.size(); i++)
+      compiledSize += compiled[i].Expand(params, &settings).size();
+  }
+  unsigned int expanded = XbmcThreads::SystemClockMillis() - start;
+
+  unsigned int differences = 0;
+  for (unsigned int i = 0; i < templates.size(); i++)
+  {
+    if (compiled[i].Expand(params, &settings) != ReplaceBuffers(templates[i], params, &settings))
+      differences++;
+  }
+
+  BOOST_TEST_MESSAGE(rounds * templates.size() << " templates, ReplaceBuffers " << legacy << " ms, compiled " << expanded << " ms");
+  BOOST_CHECK_EQUAL(differences, 0U);
+  BOOST_CHECK_EQUAL(compiledSize, legacySize);
+}
+
+BOOST_AUTO_TEST_CASE(TestExpandFixtures)
+{
+  /* short responses in the format of the sites of the bundled scrapers, in the buffers as the
+     scrapers put them: the page in $$1, the id in $$2 and another page of the same site in $$3 */
+  struct Fixture
+  {
+    const char *scraper;
+    const char *id;
+    const char *pages[2];
+  } fixtures[] = {
+    { "../../../addons/metadata.themoviedb.org/tmdb.xml", "550", { "testdata/tmdb-search.json", "testdata/tmdb-movie.json" } },
+    { "../../../addons/metadata.common.themoviedb.org/tmdb.xml", "550", { "testdata/tmdb-movie.json", "testdata/tmdb-search.json" } },
+    { "../../../addons/metadata.common.imdb.com/imdb.xml", "tt0137523", { "testdata/imdb-combined.html", "testdata/tmdb-movie.json" } },
+    { "../../../addons/metadata.tvdb.com/tvdb.xml", "80379", { "testdata/tvdb-series.xml", "testdata/tvdb-series.xml" } },
+    { "../../../addons/metadata.common.allmusic.com/allmusic.xml", "d20572fqzt5", { "testdata/allmusic-album.html", "testdata/allmusic-album.html" } }
+  };
+
+  for (unsigned int f = 0; f < sizeof(fixtures) / sizeof(fixtures[0]); f++)
+  {
+    std::vector<CStdString> templates;
+    LoadTemplates(fixtures[f].scraper, templates);
+    BOOST_REQUIRE_MESSAGE(!templates.empty(), "the scrapers are read relative to xbmc/utils/test");
+
+    CStdString params[MAX_SCRAPER_BUFFERS];
+    params[0] = ReadFile(fixtures[f].pages[0]);
+    params[1] = fixtures[f].id;
+    params[2] = ReadFile(fixtures[f].pages[1]);
+    BOOST_REQUIRE(!params[0].empty() && !params[2].empty());
+
+    /* the later buffers hold what earlier expressions of the scrapers extracted */
+    params[3] = "<title>Fight Club</title><year>1999</year>";
+    params[4] = "$$2";
+    params[5] = "http://thetvdb.com/banners/posters/80379-9.jpg";
+
+    CTestValues settings("en", "Fight Club $$1");
+    for (unsigned int i = 0; i < templates.size(); i++)
+    {
+      CScraperTemplate tmpl;
+      tmpl.Parse(templates[i]);
+      BOOST_CHECK_MESSAGE(tmpl.Expand(params, &settings) == ReplaceBuffers(templates[i], params, &settings),
+                          fixtures[f].scraper << " template \"" << templates[i] << "\"");
+    }
+  }
+}
@@ -671,21 +671,22 @@ bool CGUIMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList
   }
 
   int iWindow = GetID();
-  CStdStringArray regexps;
+  // refer to the arrays of the advanced settings, their expressions are compiled already
+  const CStdStringArray *regexps = NULL;
 
   // TODO: Do we want to limit the directories we apply the video ones to?
   if (iWindow == WINDOW_VIDEO_NAV)
-    regexps = g_advancedSettings.m_videoExcludeFromListingRegExps;
+    regexps = &g_advancedSettings.m_videoExcludeFromListingRegExps;
   if (iWindow == WINDOW_MUSIC_FILES)
-    regexps = g_advancedSettings.m_audioExcludeFromListingRegExps;
+    regexps = &g_advancedSettings.m_audioExcludeFromListingRegExps;
   if (iWindow == WINDOW_PICTURES)
-    regexps = g_advancedSettings.m_pictureExcludeFromListingRegExps;
+    regexps = &g_advancedSettings.m_pictureExcludeFromListingRegExps;
 
-  if (regexps.size())
+  if (regexps && regexps->size())
   {
     for (int i=0; i < items.Size();)
     {
-      if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), regexps))
+      if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), *regexps))
         items.Remove(i);
       else
         i++;